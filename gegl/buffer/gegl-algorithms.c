@@ -28,9 +28,21 @@
 #include "gegl-buffer.h"
 #include "gegl-buffer-formats.h"
 #include "gegl-algorithms.h"
+#include "gegl-cpuaccel.h"
+#include "gegl-types.h"
+#include "gegl-parallel.h"
 
 #include <math.h>
 
+#if defined(ARCH_X86) && defined(USE_SSE) && defined(__GNUC__)
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 void gegl_downscale_2x2 (const Babl *format,
                          gint        src_width,
                          gint        src_height,
@@ -915,6 +927,579 @@ gegl_downscale_2x2_u8_rgb (const Babl *format,
 }
 
 
+/* vectorized variants of the linear 2x2 downscale functions, for formats
+ * with four components, such as "RGBA float" or "RaGaBaA u16".  they produce
+ * exactly the same results as the generic functions, and are selected at
+ * runtime by gegl_downscale_2x2_get_fun(), according to the instruction sets
+ * supported by the cpu.
+ */
+
+#if defined(ARCH_X86) && defined(USE_SSE) && defined(__GNUC__)
+
+#define HAVE_DOWNSCALE_2X2_SSE2 1
+
+__attribute__ ((target ("sse2")))
+static void
+gegl_downscale_2x2_float_4c_sse2 (const Babl *format,
+                                    gint        src_width,
+                                    gint        src_height,
+                                    guchar     *src_data,
+                                    gint        src_rowstride,
+                                    guchar     *dst_data,
+                                    gint        dst_rowstride)
+{
+  const __m128 quarter = _mm_set1_ps (0.25f);
+  gint         y;
+
+  if (!src_data || !dst_data)
+    return;
+
+  for (y = 0; y < src_height / 2; y++)
+    {
+      const gfloat *a   = (const gfloat *) (src_data + src_rowstride * y * 2);
+      const gfloat *b   = (const gfloat *) ((const guchar *) a + src_rowstride);
+      gfloat       *dst = (gfloat *) (dst_data + dst_rowstride * y);
+      gint          x;
+
+      for (x = 0; x < src_width / 2; x++)
+        {
+          __m128 sum;
+
+          sum = _mm_add_ps (_mm_loadu_ps (a), _mm_loadu_ps (a + 4));
+          sum = _mm_add_ps (sum, _mm_loadu_ps (b));
+          sum = _mm_add_ps (sum, _mm_loadu_ps (b + 4));
+
+          _mm_storeu_ps (dst, _mm_mul_ps (sum, quarter));
+
+          a   += 8;
+          b   += 8;
+          dst += 4;
+        }
+    }
+}
+
+__attribute__ ((target ("sse2")))
+static void
+gegl_downscale_2x2_u16_4c_sse2 (const Babl *format,
+                                  gint        src_width,
+                                  gint        src_height,
+                                  guchar     *src_data,
+                                  gint        src_rowstride,
+                                  guchar     *dst_data,
+                                  gint        dst_rowstride)
+{
+  const __m128i zero   = _mm_setzero_si128 ();
+  const __m128i bias32 = _mm_set1_epi32 (0x8000);
+  const __m128i bias16 = _mm_set1_epi16 ((gshort) 0x8000);
+  gint          y;
+
+  if (!src_data || !dst_data)
+    return;
+
+  for (y = 0; y < src_height / 2; y++)
+    {
+      const guint16 *a   = (const guint16 *) (src_data + src_rowstride * y * 2);
+      const guint16 *b   = (const guint16 *) ((const guchar *) a + src_rowstride);
+      guint16       *dst = (guint16 *) (dst_data + dst_rowstride * y);
+      gint           x;
+
+      /* two destination pixels at a time */
+      for (x = 0; x + 1 < src_width / 2; x += 2)
+        {
+          __m128i a0 = _mm_loadu_si128 ((const __m128i *) a);
+          __m128i a1 = _mm_loadu_si128 ((const __m128i *) (a + 8));
+          __m128i b0 = _mm_loadu_si128 ((const __m128i *) b);
+          __m128i b1 = _mm_loadu_si128 ((const __m128i *) (b + 8));
+          __m128i s0;
+          __m128i s1;
+
+          s0 = _mm_add_epi32 (_mm_unpacklo_epi16 (a0, zero),
+                              _mm_unpackhi_epi16 (a0, zero));
+          s0 = _mm_add_epi32 (s0, _mm_unpacklo_epi16 (b0, zero));
+          s0 = _mm_add_epi32 (s0, _mm_unpackhi_epi16 (b0, zero));
+
+          s1 = _mm_add_epi32 (_mm_unpacklo_epi16 (a1, zero),
+                              _mm_unpackhi_epi16 (a1, zero));
+          s1 = _mm_add_epi32 (s1, _mm_unpacklo_epi16 (b1, zero));
+          s1 = _mm_add_epi32 (s1, _mm_unpackhi_epi16 (b1, zero));
+
+          /* sse2 has no unsigned 32-to-16 bit pack; bias the values into
+           * the signed range, pack with signed saturation (which never
+           * saturates), and undo the bias.
+           */
+          s0 = _mm_sub_epi32 (_mm_srli_epi32 (s0, 2), bias32);
+          s1 = _mm_sub_epi32 (_mm_srli_epi32 (s1, 2), bias32);
+
+          _mm_storeu_si128 ((__m128i *) dst,
+                            _mm_xor_si128 (_mm_packs_epi32 (s0, s1), bias16));
+
+          a   += 16;
+          b   += 16;
+          dst += 8;
+        }
+
+      if (x < src_width / 2)
+        {
+          gint i;
+
+          for (i = 0; i < 4; i++)
+            dst[i] = ((guint) a[i] + a[i + 4] + b[i] + b[i + 4]) / 4;
+        }
+    }
+}
+
+__attribute__ ((target ("sse2")))
+static void
+gegl_downscale_2x2_u8_4c_sse2 (const Babl *format,
+                                 gint        src_width,
+                                 gint        src_height,
+                                 guchar     *src_data,
+                                 gint        src_rowstride,
+                                 guchar     *dst_data,
+                                 gint        dst_rowstride)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  gint          y;
+
+  if (!src_data || !dst_data)
+    return;
+
+  for (y = 0; y < src_height / 2; y++)
+    {
+      const guchar *a   = src_data + src_rowstride * y * 2;
+      const guchar *b   = a + src_rowstride;
+      guchar       *dst = dst_data + dst_rowstride * y;
+      gint          x;
+
+      /* two destination pixels at a time */
+      for (x = 0; x + 1 < src_width / 2; x += 2)
+        {
+          __m128i va = _mm_loadu_si128 ((const __m128i *) a);
+          __m128i vb = _mm_loadu_si128 ((const __m128i *) b);
+          __m128i lo;
+          __m128i hi;
+          __m128i sum;
+
+          /* vertical sums of the four source columns */
+          lo = _mm_add_epi16 (_mm_unpacklo_epi8 (va, zero),
+                              _mm_unpacklo_epi8 (vb, zero));
+          hi = _mm_add_epi16 (_mm_unpackhi_epi8 (va, zero),
+                              _mm_unpackhi_epi8 (vb, zero));
+
+          /* horizontal sums of each pair of columns */
+          sum = _mm_add_epi16 (_mm_unpacklo_epi64 (lo, hi),
+                               _mm_unpackhi_epi64 (lo, hi));
+          sum = _mm_srli_epi16 (sum, 2);
+
+          _mm_storel_epi64 ((__m128i *) dst, _mm_packus_epi16 (sum, sum));
+
+          a   += 16;
+          b   += 16;
+          dst += 8;
+        }
+
+      if (x < src_width / 2)
+        {
+          gint i;
+
+          for (i = 0; i < 4; i++)
+            dst[i] = ((guint) a[i] + a[i + 4] + b[i] + b[i + 4]) / 4;
+        }
+    }
+}
+
+#define HAVE_DOWNSCALE_2X2_AVX2 1
+
+__attribute__ ((target ("avx2")))
+static void
+gegl_downscale_2x2_float_4c_avx2 (const Babl *format,
+                                    gint        src_width,
+                                    gint        src_height,
+                                    guchar     *src_data,
+                                    gint        src_rowstride,
+                                    guchar     *dst_data,
+                                    gint        dst_rowstride)
+{
+  const __m256 quarter = _mm256_set1_ps (0.25f);
+  gint         y;
+
+  if (!src_data || !dst_data)
+    return;
+
+  for (y = 0; y < src_height / 2; y++)
+    {
+      const gfloat *a   = (const gfloat *) (src_data + src_rowstride * y * 2);
+      const gfloat *b   = (const gfloat *) ((const guchar *) a + src_rowstride);
+      gfloat       *dst = (gfloat *) (dst_data + dst_rowstride * y);
+      gint          x;
+
+      /* two destination pixels at a time */
+      for (x = 0; x + 1 < src_width / 2; x += 2)
+        {
+          __m256 a0 = _mm256_loadu_ps (a);
+          __m256 a1 = _mm256_loadu_ps (a + 8);
+          __m256 b0 = _mm256_loadu_ps (b);
+          __m256 b1 = _mm256_loadu_ps (b + 8);
+          __m256 sum;
+
+          /* gather the left and the right source pixel of both destination
+           * pixels, and sum them in the same order as the generic code.
+           */
+          sum = _mm256_add_ps (_mm256_permute2f128_ps (a0, a1, 0x20),
+                               _mm256_permute2f128_ps (a0, a1, 0x31));
+          sum = _mm256_add_ps (sum, _mm256_permute2f128_ps (b0, b1, 0x20));
+          sum = _mm256_add_ps (sum, _mm256_permute2f128_ps (b0, b1, 0x31));
+
+          _mm256_storeu_ps (dst, _mm256_mul_ps (sum, quarter));
+
+          a   += 16;
+          b   += 16;
+          dst += 8;
+        }
+
+      if (x < src_width / 2)
+        {
+          gint i;
+
+          for (i = 0; i < 4; i++)
+            dst[i] = (a[i] + a[i + 4] + b[i] + b[i + 4]) / 4.0f;
+        }
+    }
+}
+
+__attribute__ ((target ("avx2")))
+static void
+gegl_downscale_2x2_u16_4c_avx2 (const Babl *format,
+                                  gint        src_width,
+                                  gint        src_height,
+                                  guchar     *src_data,
+                                  gint        src_rowstride,
+                                  guchar     *dst_data,
+                                  gint        dst_rowstride)
+{
+  gint y;
+
+  if (!src_data || !dst_data)
+    return;
+
+  for (y = 0; y < src_height / 2; y++)
+    {
+      const guint16 *a   = (const guint16 *) (src_data + src_rowstride * y * 2);
+      const guint16 *b   = (const guint16 *) ((const guchar *) a + src_rowstride);
+      guint16       *dst = (guint16 *) (dst_data + dst_rowstride * y);
+      gint           x;
+
+      /* four destination pixels at a time */
+      for (x = 0; x + 3 < src_width / 2; x += 4)
+        {
+          __m256i v[4];
+          __m256i s0;
+          __m256i s1;
+          gint    i;
+
+          /* vertical sums of each pair of source pixels, as 32-bit values */
+          for (i = 0; i < 4; i++)
+            {
+              v[i] = _mm256_add_epi32 (
+                _mm256_cvtepu16_epi32 (_mm_loadu_si128 ((const __m128i *) (a + 8 * i))),
+                _mm256_cvtepu16_epi32 (_mm_loadu_si128 ((const __m128i *) (b + 8 * i))));
+            }
+
+          /* horizontal sums; s0 holds destination pixels 0 and 1, and s1
+           * holds pixels 2 and 3.
+           */
+          s0 = _mm256_add_epi32 (_mm256_permute2x128_si256 (v[0], v[1], 0x20),
+                                 _mm256_permute2x128_si256 (v[0], v[1], 0x31));
+          s1 = _mm256_add_epi32 (_mm256_permute2x128_si256 (v[2], v[3], 0x20),
+                                 _mm256_permute2x128_si256 (v[2], v[3], 0x31));
+
+          s0 = _mm256_srli_epi32 (s0, 2);
+          s1 = _mm256_srli_epi32 (s1, 2);
+
+          /* the pack works within each 128-bit lane, interleaving the
+           * pixels as 0, 2, 1, 3; put them back in order.
+           */
+          _mm256_storeu_si256 ((__m256i *) dst,
+                               _mm256_permute4x64_epi64 (
+                                 _mm256_packus_epi32 (s0, s1),
+                                 _MM_SHUFFLE (3, 1, 2, 0)));
+
+          a   += 32;
+          b   += 32;
+          dst += 16;
+        }
+
+      for (; x < src_width / 2; x++)
+        {
+          gint i;
+
+          for (i = 0; i < 4; i++)
+            dst[i] = ((guint) a[i] + a[i + 4] + b[i] + b[i + 4]) / 4;
+
+          a   += 8;
+          b   += 8;
+          dst += 4;
+        }
+    }
+}
+
+__attribute__ ((target ("avx2")))
+static void
+gegl_downscale_2x2_u8_4c_avx2 (const Babl *format,
+                                 gint        src_width,
+                                 gint        src_height,
+                                 guchar     *src_data,
+                                 gint        src_rowstride,
+                                 guchar     *dst_data,
+                                 gint        dst_rowstride)
+{
+  const __m256i order = _mm256_setr_epi32 (0, 4, 1, 5, 2, 6, 3, 7);
+  gint          y;
+
+  if (!src_data || !dst_data)
+    return;
+
+  for (y = 0; y < src_height / 2; y++)
+    {
+      const guchar *a   = src_data + src_rowstride * y * 2;
+      const guchar *b   = a + src_rowstride;
+      guchar       *dst = dst_data + dst_rowstride * y;
+      gint          x;
+
+      /* four destination pixels at a time */
+      for (x = 0; x + 3 < src_width / 2; x += 4)
+        {
+          __m256i lo;
+          __m256i hi;
+          __m256i sum;
+
+          /* vertical sums of the eight source columns, as 16-bit values */
+          lo = _mm256_add_epi16 (
+            _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i *) a)),
+            _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i *) b)));
+          hi = _mm256_add_epi16 (
+            _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i *) (a + 16))),
+            _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i *) (b + 16))));
+
+          /* horizontal sums of each pair of columns; the lanes hold
+           * destination pixels 0, 2 and 1, 3.
+           */
+          sum = _mm256_add_epi16 (_mm256_unpacklo_epi64 (lo, hi),
+                                  _mm256_unpackhi_epi64 (lo, hi));
+          sum = _mm256_srli_epi16 (sum, 2);
+          sum = _mm256_permutevar8x32_epi32 (_mm256_packus_epi16 (sum, sum),
+                                             order);
+
+          _mm_storeu_si128 ((__m128i *) dst, _mm256_castsi256_si128 (sum));
+
+          a   += 32;
+          b   += 32;
+          dst += 16;
+        }
+
+      for (; x < src_width / 2; x++)
+        {
+          gint i;
+
+          for (i = 0; i < 4; i++)
+            dst[i] = ((guint) a[i] + a[i + 4] + b[i] + b[i + 4]) / 4;
+
+          a   += 8;
+          b   += 8;
+          dst += 4;
+        }
+    }
+}
+
+#endif /* defined(ARCH_X86) && defined(USE_SSE) && defined(__GNUC__) */
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#define HAVE_DOWNSCALE_2X2_NEON 1
+
+static void
+gegl_downscale_2x2_float_4c_neon (const Babl *format,
+                                    gint        src_width,
+                                    gint        src_height,
+                                    guchar     *src_data,
+                                    gint        src_rowstride,
+                                    guchar     *dst_data,
+                                    gint        dst_rowstride)
+{
+  gint y;
+
+  if (!src_data || !dst_data)
+    return;
+
+  for (y = 0; y < src_height / 2; y++)
+    {
+      const gfloat *a   = (const gfloat *) (src_data + src_rowstride * y * 2);
+      const gfloat *b   = (const gfloat *) ((const guchar *) a + src_rowstride);
+      gfloat       *dst = (gfloat *) (dst_data + dst_rowstride * y);
+      gint          x;
+
+      for (x = 0; x < src_width / 2; x++)
+        {
+          float32x4_t sum;
+
+          sum = vaddq_f32 (vld1q_f32 (a), vld1q_f32 (a + 4));
+          sum = vaddq_f32 (sum, vld1q_f32 (b));
+          sum = vaddq_f32 (sum, vld1q_f32 (b + 4));
+
+          vst1q_f32 (dst, vmulq_n_f32 (sum, 0.25f));
+
+          a   += 8;
+          b   += 8;
+          dst += 4;
+        }
+    }
+}
+
+static void
+gegl_downscale_2x2_u16_4c_neon (const Babl *format,
+                                  gint        src_width,
+                                  gint        src_height,
+                                  guchar     *src_data,
+                                  gint        src_rowstride,
+                                  guchar     *dst_data,
+                                  gint        dst_rowstride)
+{
+  gint y;
+
+  if (!src_data || !dst_data)
+    return;
+
+  for (y = 0; y < src_height / 2; y++)
+    {
+      const guint16 *a   = (const guint16 *) (src_data + src_rowstride * y * 2);
+      const guint16 *b   = (const guint16 *) ((const guchar *) a + src_rowstride);
+      guint16       *dst = (guint16 *) (dst_data + dst_rowstride * y);
+      gint           x;
+
+      for (x = 0; x < src_width / 2; x++)
+        {
+          uint16x8_t va = vld1q_u16 (a);
+          uint16x8_t vb = vld1q_u16 (b);
+          uint32x4_t sum;
+
+          sum = vaddl_u16 (vget_low_u16 (va), vget_high_u16 (va));
+          sum = vaddq_u32 (sum, vaddl_u16 (vget_low_u16 (vb),
+                                           vget_high_u16 (vb)));
+
+          vst1_u16 (dst, vshrn_n_u32 (sum, 2));
+
+          a   += 8;
+          b   += 8;
+          dst += 4;
+        }
+    }
+}
+
+static void
+gegl_downscale_2x2_u8_4c_neon (const Babl *format,
+                                 gint        src_width,
+                                 gint        src_height,
+                                 guchar     *src_data,
+                                 gint        src_rowstride,
+                                 guchar     *dst_data,
+                                 gint        dst_rowstride)
+{
+  gint y;
+
+  if (!src_data || !dst_data)
+    return;
+
+  for (y = 0; y < src_height / 2; y++)
+    {
+      const guchar *a   = src_data + src_rowstride * y * 2;
+      const guchar *b   = a + src_rowstride;
+      guchar       *dst = dst_data + dst_rowstride * y;
+      gint          x;
+
+      /* two destination pixels at a time */
+      for (x = 0; x + 1 < src_width / 2; x += 2)
+        {
+          uint8x16_t va = vld1q_u8 (a);
+          uint8x16_t vb = vld1q_u8 (b);
+          uint16x8_t lo;
+          uint16x8_t hi;
+          uint16x8_t sum;
+
+          /* vertical sums of the four source columns */
+          lo = vaddl_u8 (vget_low_u8 (va),  vget_low_u8 (vb));
+          hi = vaddl_u8 (vget_high_u8 (va), vget_high_u8 (vb));
+
+          /* horizontal sums of each pair of columns */
+          sum = vcombine_u16 (vadd_u16 (vget_low_u16 (lo), vget_high_u16 (lo)),
+                              vadd_u16 (vget_low_u16 (hi), vget_high_u16 (hi)));
+
+          vst1_u8 (dst, vshrn_n_u16 (sum, 2));
+
+          a   += 16;
+          b   += 16;
+          dst += 8;
+        }
+
+      if (x < src_width / 2)
+        {
+          gint i;
+
+          for (i = 0; i < 4; i++)
+            dst[i] = ((guint) a[i] + a[i + 4] + b[i] + b[i + 4]) / 4;
+        }
+    }
+}
+
+#endif /* defined(__ARM_NEON) || defined(__ARM_NEON__) */
+
+static GeglDownscale2x2Fun
+gegl_downscale_2x2_get_simd_fun (const Babl *format)
+{
+  const Babl *comp_type = babl_format_get_type (format, 0);
+
+  if (babl_format_get_n_components (format) != 4)
+    return NULL;
+
+#ifdef HAVE_DOWNSCALE_2X2_AVX2
+  if (gegl_cpu_accel_get_support () & GEGL_CPU_ACCEL_X86_AVX2)
+    {
+      if (comp_type == gegl_babl_float ())
+        return gegl_downscale_2x2_float_4c_avx2;
+      else if (comp_type == gegl_babl_u16 ())
+        return gegl_downscale_2x2_u16_4c_avx2;
+      else if (comp_type == gegl_babl_u8 ())
+        return gegl_downscale_2x2_u8_4c_avx2;
+    }
+#endif
+
+#ifdef HAVE_DOWNSCALE_2X2_SSE2
+  if (gegl_cpu_accel_get_support () & GEGL_CPU_ACCEL_X86_SSE2)
+    {
+      if (comp_type == gegl_babl_float ())
+        return gegl_downscale_2x2_float_4c_sse2;
+      else if (comp_type == gegl_babl_u16 ())
+        return gegl_downscale_2x2_u16_4c_sse2;
+      else if (comp_type == gegl_babl_u8 ())
+        return gegl_downscale_2x2_u8_4c_sse2;
+    }
+#endif
+
+#ifdef HAVE_DOWNSCALE_2X2_NEON
+  if (gegl_cpu_accel_get_support () & GEGL_CPU_ACCEL_ARM_NEON)
+    {
+      if (comp_type == gegl_babl_float ())
+        return gegl_downscale_2x2_float_4c_neon;
+      else if (comp_type == gegl_babl_u16 ())
+        return gegl_downscale_2x2_u16_4c_neon;
+      else if (comp_type == gegl_babl_u8 ())
+        return gegl_downscale_2x2_u8_4c_neon;
+    }
+#endif
+
+  return NULL;
+}
+
+
 /* FIXME:  disable the _alpha() variants for now, so that we use the same gamma
  * curve for the alpha component as we do for the color components.  this is
  * necessary to avoid producing over-saturated pixels when using a format with
@@ -944,7 +1529,13 @@ GeglDownscale2x2Fun gegl_downscale_2x2_get_fun (const Babl *format)
   if ((model_flags & BABL_MODEL_FLAG_LINEAR)||
       (model_flags & BABL_MODEL_FLAG_CMYK))
   {
-    if (comp_type == gegl_babl_float())
+    GeglDownscale2x2Fun simd_fun = gegl_downscale_2x2_get_simd_fun (format);
+
+    if (simd_fun)
+    {
+      return simd_fun;
+    }
+    else if (comp_type == gegl_babl_float())
     {
       return gegl_downscale_2x2_float;
     }
@@ -1312,6 +1903,369 @@ gegl_resample_nearest (guchar              *dst,
 #undef IMPL
 }
 
+/* separable polyphase resampling.  each output pixel is a weighted sum of a
+ * fixed number of source pixels along each axis.  the weights of all output
+ * columns and rows -- the filter banks -- are computed once per call, after
+ * which the source is filtered horizontally into a temporary buffer, and
+ * then vertically into the destination.  when downscaling, the kernel is
+ * stretched by 1/scale, so that it acts as a low-pass filter.
+ *
+ * the inner loops work on plain float arrays with no data-dependent
+ * branches, so that they get vectorized by the compiler.
+ */
+
+#define GEGL_RESAMPLE_FILTER_THREAD_COST 16384.0
+
+typedef struct
+{
+  gint    n_taps;
+  gint   *offsets; /* first source pixel of each output pixel, relative to
+                    * the source rectangle
+                    */
+  gfloat *weights; /* n_taps normalized weights for each output pixel */
+} GeglResampleFilterBank;
+
+typedef struct
+{
+  const guchar                 *src;
+  gint                          s_rowstride;
+  guchar                       *dst;
+  gint                          d_rowstride;
+  gint                          width;
+  gint                          components;
+  const GeglResampleFilterBank *bank;
+} GeglResampleFilterPass;
+
+static inline gdouble
+gegl_resample_filter_sinc (gdouble x)
+{
+  if (fabs (x) < 1e-9)
+    return 1.0;
+
+  x *= G_PI;
+
+  return sin (x) / x;
+}
+
+static gdouble
+gegl_resample_filter_kernel (GeglAbyssPolicy filter,
+                             gdouble         x)
+{
+  x = fabs (x);
+
+  if (filter == GEGL_BUFFER_FILTER_MITCHELL)
+    {
+      /* Mitchell-Netravali, with B = C = 1/3 */
+      const gdouble B = 1.0 / 3.0;
+      const gdouble C = 1.0 / 3.0;
+
+      if (x < 1.0)
+        {
+          return ((12.0 - 9.0 * B - 6.0 * C) * x * x * x +
+                  (-18.0 + 12.0 * B + 6.0 * C) * x * x +
+                  (6.0 - 2.0 * B)) / 6.0;
+        }
+      else if (x < 2.0)
+        {
+          return ((-B - 6.0 * C) * x * x * x +
+                  (6.0 * B + 30.0 * C) * x * x +
+                  (-12.0 * B - 48.0 * C) * x +
+                  (8.0 * B + 24.0 * C)) / 6.0;
+        }
+    }
+  else
+    {
+      /* Lanczos-3 */
+      if (x < 3.0)
+        return gegl_resample_filter_sinc (x) * gegl_resample_filter_sinc (x / 3.0);
+    }
+
+  return 0.0;
+}
+
+static inline gdouble
+gegl_resample_filter_radius (gdouble         scale,
+                             GeglAbyssPolicy filter)
+{
+  gdouble support = filter == GEGL_BUFFER_FILTER_MITCHELL ? 2.0 : 3.0;
+
+  return support / MIN (scale, 1.0);
+}
+
+static inline gint
+gegl_resample_filter_n_taps (gdouble radius)
+{
+  return ceil (2.0 * radius);
+}
+
+/* the first source pixel whose center lies within the kernel of output
+ * pixel @d
+ */
+static inline gint
+gegl_resample_filter_first_tap (gint    d,
+                                gdouble scale,
+                                gdouble radius)
+{
+  return (gint) floor ((d + 0.5) / scale - 0.5 - radius) + 1;
+}
+
+static void
+gegl_resample_filter_bank_init (GeglResampleFilterBank *bank,
+                                gint                    dst_start,
+                                gint                    dst_length,
+                                gint                    src_start,
+                                gdouble                 scale,
+                                GeglAbyssPolicy         filter)
+{
+  gdouble radius = gegl_resample_filter_radius (scale, filter);
+  gdouble step   = MIN (scale, 1.0);
+  gint    n_taps = gegl_resample_filter_n_taps (radius);
+  gint    i;
+
+  bank->n_taps  = n_taps;
+  bank->offsets = gegl_malloc (dst_length * sizeof (gint));
+  bank->weights = gegl_malloc (dst_length * n_taps * sizeof (gfloat));
+
+  for (i = 0; i < dst_length; i++)
+    {
+      gdouble  center  = (dst_start + i + 0.5) / scale - 0.5;
+      gint     first   = gegl_resample_filter_first_tap (dst_start + i,
+                                                         scale, radius);
+      gfloat  *weights = bank->weights + i * n_taps;
+      gdouble  sum     = 0.0;
+      gint     k;
+
+      for (k = 0; k < n_taps; k++)
+        {
+          weights[k] = gegl_resample_filter_kernel (filter,
+                                                    (first + k - center) *
+                                                    step);
+          sum += weights[k];
+        }
+
+      for (k = 0; k < n_taps; k++)
+        weights[k] /= sum;
+
+      bank->offsets[i] = first - src_start;
+    }
+}
+
+static void
+gegl_resample_filter_bank_clear (GeglResampleFilterBank *bank)
+{
+  gegl_free (bank->offsets);
+  gegl_free (bank->weights);
+}
+
+static void
+gegl_resample_filter_horizontal (gsize                   offset,
+                                 gsize                   size,
+                                 GeglResampleFilterPass *pass)
+{
+  const gint n_taps     = pass->bank->n_taps;
+  const gint components = pass->components;
+  gsize      y;
+
+  for (y = offset; y < offset + size; y++)
+    {
+      const gfloat *src     = (const gfloat *) (pass->src +
+                                                y * pass->s_rowstride);
+      gfloat       *dst     = (gfloat *) (pass->dst + y * pass->d_rowstride);
+      const gint   *offsets = pass->bank->offsets;
+      const gfloat *weights = pass->bank->weights;
+      gint          x;
+
+      if (components == 4)
+        {
+          for (x = 0; x < pass->width; x++)
+            {
+              const gfloat *s      = src + 4 * offsets[x];
+              gfloat        sum[4] = { 0.0f };
+              gint          k;
+
+              for (k = 0; k < n_taps; k++)
+                {
+                  sum[0] += weights[k] * s[0];
+                  sum[1] += weights[k] * s[1];
+                  sum[2] += weights[k] * s[2];
+                  sum[3] += weights[k] * s[3];
+
+                  s += 4;
+                }
+
+              dst[0] = sum[0];
+              dst[1] = sum[1];
+              dst[2] = sum[2];
+              dst[3] = sum[3];
+
+              dst     += 4;
+              weights += n_taps;
+            }
+        }
+      else
+        {
+          for (x = 0; x < pass->width; x++)
+            {
+              gint c;
+
+              for (c = 0; c < components; c++)
+                {
+                  const gfloat *s   = src + components * offsets[x] + c;
+                  gfloat        sum = 0.0f;
+                  gint          k;
+
+                  for (k = 0; k < n_taps; k++)
+                    sum += weights[k] * s[k * components];
+
+                  dst[c] = sum;
+                }
+
+              dst     += components;
+              weights += n_taps;
+            }
+        }
+    }
+}
+
+static void
+gegl_resample_filter_vertical (gsize                   offset,
+                               gsize                   size,
+                               GeglResampleFilterPass *pass)
+{
+  const gint n_taps = pass->bank->n_taps;
+  const gint n      = pass->width * pass->components;
+  gsize      y;
+
+  for (y = offset; y < offset + size; y++)
+    {
+      const guchar *src     = pass->src +
+                              pass->bank->offsets[y] * pass->s_rowstride;
+      gfloat       *dst     = (gfloat *) (pass->dst + y * pass->d_rowstride);
+      const gfloat *weights = pass->bank->weights + y * n_taps;
+      gint          i;
+      gint          k;
+
+      {
+        const gfloat *s = (const gfloat *) src;
+        const gfloat  w = weights[0];
+
+        for (i = 0; i < n; i++)
+          dst[i] = w * s[i];
+      }
+
+      for (k = 1; k < n_taps; k++)
+        {
+          const gfloat *s = (const gfloat *) (src + k * pass->s_rowstride);
+          const gfloat  w = weights[k];
+
+          for (i = 0; i < n; i++)
+            dst[i] += w * s[i];
+        }
+    }
+}
+
+void
+gegl_resample_filter_get_source_rect (const GeglRectangle *dst_rect,
+                                      gdouble              scale,
+                                      GeglAbyssPolicy      filter,
+                                      GeglRectangle       *src_rect)
+{
+  gdouble radius = gegl_resample_filter_radius (scale,
+                                                filter &
+                                                GEGL_BUFFER_FILTER_ALL);
+  gint    n_taps = gegl_resample_filter_n_taps (radius);
+  gint    x1, x2;
+  gint    y1, y2;
+
+  x1 = gegl_resample_filter_first_tap (dst_rect->x, scale, radius);
+  x2 = gegl_resample_filter_first_tap (dst_rect->x + dst_rect->width - 1,
+                                       scale, radius) + n_taps;
+  y1 = gegl_resample_filter_first_tap (dst_rect->y, scale, radius);
+  y2 = gegl_resample_filter_first_tap (dst_rect->y + dst_rect->height - 1,
+                                       scale, radius) + n_taps;
+
+  src_rect->x      = x1;
+  src_rect->y      = y1;
+  src_rect->width  = x2 - x1;
+  src_rect->height = y2 - y1;
+}
+
+const Babl *
+gegl_resample_filter_get_format (const Babl *format)
+{
+  BablModelFlag model_flags = babl_get_model_flags (format);
+
+  if (model_flags & BABL_MODEL_FLAG_CMYK)
+    return babl_format_with_space ("camayakaA float", format);
+  else if (model_flags & BABL_MODEL_FLAG_GRAY)
+    return babl_format_with_space ("YaA float", format);
+  else
+    return babl_format_with_space ("RaGaBaA float", format);
+}
+
+void
+gegl_resample_filter_float (guchar              *dest_buf,
+                            const guchar        *source_buf,
+                            const GeglRectangle *dst_rect,
+                            const GeglRectangle *src_rect,
+                            gint                 s_rowstride,
+                            gdouble              scale,
+                            gint                 components,
+                            gint                 d_rowstride,
+                            GeglAbyssPolicy      filter)
+{
+  GeglResampleFilterBank h_bank;
+  GeglResampleFilterBank v_bank;
+  GeglResampleFilterPass pass;
+  gint                   tmp_rowstride;
+  guchar                *tmp;
+
+  filter &= GEGL_BUFFER_FILTER_ALL;
+
+  gegl_resample_filter_bank_init (&h_bank,
+                                  dst_rect->x, dst_rect->width, src_rect->x,
+                                  scale, filter);
+  gegl_resample_filter_bank_init (&v_bank,
+                                  dst_rect->y, dst_rect->height, src_rect->y,
+                                  scale, filter);
+
+  tmp_rowstride = dst_rect->width * components * sizeof (gfloat);
+  tmp           = gegl_malloc (src_rect->height * tmp_rowstride);
+
+  pass.src         = source_buf;
+  pass.s_rowstride = s_rowstride;
+  pass.dst         = tmp;
+  pass.d_rowstride = tmp_rowstride;
+  pass.width       = dst_rect->width;
+  pass.components  = components;
+  pass.bank        = &h_bank;
+
+  gegl_parallel_distribute_range (
+    src_rect->height,
+    GEGL_RESAMPLE_FILTER_THREAD_COST /
+    (dst_rect->width * components * h_bank.n_taps),
+    (GeglParallelDistributeRangeFunc) gegl_resample_filter_horizontal,
+    &pass);
+
+  pass.src         = tmp;
+  pass.s_rowstride = tmp_rowstride;
+  pass.dst         = dest_buf;
+  pass.d_rowstride = d_rowstride;
+  pass.bank        = &v_bank;
+
+  gegl_parallel_distribute_range (
+    dst_rect->height,
+    GEGL_RESAMPLE_FILTER_THREAD_COST /
+    (dst_rect->width * components * v_bank.n_taps),
+    (GeglParallelDistributeRangeFunc) gegl_resample_filter_vertical,
+    &pass);
+
+  gegl_free (tmp);
+
+  gegl_resample_filter_bank_clear (&h_bank);
+  gegl_resample_filter_bank_clear (&v_bank);
+}
+
 #define BOXFILTER_FUNCNAME   gegl_resample_boxfilter_double
 #define BOXFILTER_TYPE       gdouble
 #define BOXFILTER_TEMP_TYPE  gdouble
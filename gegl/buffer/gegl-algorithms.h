@@ -213,6 +213,29 @@ void gegl_resample_nearest (guchar              *dst,
                             gint                 bpp,
                             gint                 dst_stride);
 
+/* Resample with a separable Lanczos-3 or Mitchell filter, as selected by
+ * #filter.  #source_buf and #dest_buf hold #components float components per
+ * pixel, and #src_rect must be the rectangle returned by
+ * gegl_resample_filter_get_source_rect() for #dst_rect.
+ */
+void gegl_resample_filter_float (guchar              *dest_buf,
+                                 const guchar        *source_buf,
+                                 const GeglRectangle *dst_rect,
+                                 const GeglRectangle *src_rect,
+                                 gint                 s_rowstride,
+                                 gdouble              scale,
+                                 gint                 components,
+                                 gint                 d_rowstride,
+                                 GeglAbyssPolicy      filter);
+
+void gegl_resample_filter_get_source_rect (const GeglRectangle *dst_rect,
+                                           gdouble              scale,
+                                           GeglAbyssPolicy      filter,
+                                           GeglRectangle       *src_rect);
+
+/* The premultiplied linear float format #format is filtered in. */
+const Babl * gegl_resample_filter_get_format (const Babl *format);
+
 GeglDownscale2x2Fun gegl_downscale_2x2_get_fun (const Babl *format);
 
 G_END_DECLS
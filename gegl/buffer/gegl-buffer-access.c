@@ -129,16 +129,10 @@ gegl_buffer_get_pixel (GeglBuffer     *buffer,
           tile->x == indice_x &&
           tile->y == indice_y))
       {
-        g_rec_mutex_lock (&buffer->tile_storage->mutex);
-
         if (tile)
           gegl_tile_unref (tile);
 
-        tile = gegl_tile_source_get_tile ((GeglTileSource *) (buffer),
-                                          indice_x, indice_y,
-                                          0);
-
-        g_rec_mutex_unlock (&buffer->tile_storage->mutex);
+        tile = gegl_buffer_get_tile (buffer, indice_x, indice_y, 0);
       }
 
     if (tile)
@@ -977,12 +971,10 @@ gegl_buffer_iterate_read_simple (GeglBuffer          *buffer,
           else
             pixels = tile_width - offsetx;
 
-          g_rec_mutex_lock (&buffer->tile_storage->mutex);
-          tile = gegl_tile_source_get_tile ((GeglTileSource *) (buffer),
-                                          gegl_tile_indice (tiledx, tile_width),
-                                          gegl_tile_indice (tiledy, tile_height),
-                                          level);
-          g_rec_mutex_unlock (&buffer->tile_storage->mutex);
+          tile = gegl_buffer_get_tile (buffer,
+                                       gegl_tile_indice (tiledx, tile_width),
+                                       gegl_tile_indice (tiledy, tile_height),
+                                       level);
 
           if (!tile)
             {
@@ -1966,15 +1958,158 @@ gegl_buffer_set (GeglBuffer          *buffer,
                                  GEGL_BUFFER_SET_FLAG_NOTIFY);
 }
 
+static inline gboolean
+gegl_buffer_filter_is_separable (GeglAbyssPolicy filter)
+{
+  filter &= GEGL_BUFFER_FILTER_ALL;
+
+  return filter == GEGL_BUFFER_FILTER_LANCZOS ||
+         filter == GEGL_BUFFER_FILTER_MITCHELL;
+}
+
+/* the mipmap level separable filters read from, leaving a residual
+ * downscale of less than 4x, which is returned in @scale.
+ */
+static inline gint
+gegl_buffer_get_filtered_level (gdouble *scale)
+{
+  gint level = 0;
+
+  while (*scale <= 0.25)
+    {
+      *scale *= 2.0;
+      level++;
+    }
+
+  return level;
+}
+
+/* the level-0 rectangle read by gegl_buffer_get_filtered() for @roi */
+static GeglRectangle
+gegl_buffer_get_filtered_required (const GeglRectangle *roi,
+                                   gdouble              scale,
+                                   GeglAbyssPolicy      filter)
+{
+  GeglRectangle src_rect;
+  gint          level;
+  gint          factor;
+
+  level  = gegl_buffer_get_filtered_level (&scale);
+  factor = 1 << level;
+
+  gegl_resample_filter_get_source_rect (roi, scale, filter, &src_rect);
+
+  src_rect.x      *= factor;
+  src_rect.y      *= factor;
+  src_rect.width  *= factor;
+  src_rect.height *= factor;
+
+  return src_rect;
+}
+
+/* resamples @rect using a separable filter.  the source is read in the
+ * premultiplied linear float format returned by
+ * gegl_resample_filter_get_format(), in chunks of destination rows, and
+ * filtered in parallel.
+ */
+static void
+gegl_buffer_get_filtered (GeglBuffer          *buffer,
+                          gdouble              scale,
+                          const GeglRectangle *rect,
+                          const Babl          *format,
+                          guchar              *dest_buf,
+                          gint                 rowstride,
+                          GeglAbyssPolicy      repeat_mode,
+                          GeglAbyssPolicy      filter)
+{
+  const Babl *filter_format = gegl_resample_filter_get_format (format);
+  gint        bpp           = babl_format_get_bytes_per_pixel (format);
+  gint        filter_bpp    = babl_format_get_bytes_per_pixel (filter_format);
+  gint        components    = babl_format_get_n_components (filter_format);
+  gint        level;
+  gint        factor;
+  gint        chunk_height;
+  gint        y;
+
+  level  = gegl_buffer_get_filtered_level (&scale);
+  factor = 1 << level;
+
+  if (rowstride == GEGL_AUTO_ROWSTRIDE)
+    rowstride = rect->width * bpp;
+
+  chunk_height = (1024 * 1024) / (rect->width * filter_bpp);
+  chunk_height = MAX (chunk_height, 32);
+
+  for (y = 0; y < rect->height; y += chunk_height)
+    {
+      GeglRectangle dst_rect;
+      GeglRectangle src_rect;
+      GeglRectangle sample_rect;
+      gint          src_rowstride;
+      guchar       *src_buf;
+
+      dst_rect.x      = rect->x;
+      dst_rect.y      = rect->y + y;
+      dst_rect.width  = rect->width;
+      dst_rect.height = MIN (chunk_height, rect->height - y);
+
+      gegl_resample_filter_get_source_rect (&dst_rect, scale, filter,
+                                            &src_rect);
+
+      src_rowstride = src_rect.width * filter_bpp;
+      src_buf       = gegl_malloc (src_rect.height * src_rowstride);
+
+      sample_rect.x      = factor * src_rect.x;
+      sample_rect.y      = factor * src_rect.y;
+      sample_rect.width  = factor * src_rect.width;
+      sample_rect.height = factor * src_rect.height;
+
+      gegl_buffer_iterate_read_dispatch (buffer, &sample_rect,
+                                         src_buf, src_rowstride,
+                                         filter_format, level, repeat_mode);
+
+      if (format == filter_format)
+        {
+          gegl_resample_filter_float (dest_buf + y * rowstride, src_buf,
+                                      &dst_rect, &src_rect, src_rowstride,
+                                      scale, components, rowstride, filter);
+        }
+      else
+        {
+          gint    tmp_rowstride = dst_rect.width * filter_bpp;
+          guchar *tmp_buf       = gegl_malloc (dst_rect.height *
+                                               tmp_rowstride);
+
+          gegl_resample_filter_float (tmp_buf, src_buf,
+                                      &dst_rect, &src_rect, src_rowstride,
+                                      scale, components, tmp_rowstride,
+                                      filter);
+
+          babl_process_rows (babl_fish (filter_format, format),
+                             tmp_buf, tmp_rowstride,
+                             dest_buf + y * rowstride, rowstride,
+                             dst_rect.width, dst_rect.height);
+
+          gegl_free (tmp_buf);
+        }
+
+      gegl_free (src_buf);
+    }
+}
+
 /* Expand roi by scale so it uncludes all pixels needed
- * to satisfy a gegl_buffer_get() call at level 0.
+ * to satisfy a gegl_buffer_get() call at level 0, using
+ * the given filter.
  */
 GeglRectangle
 _gegl_get_required_for_scale (const GeglRectangle *roi,
-                              gdouble              scale)
+                              gdouble              scale,
+                              GeglAbyssPolicy      filter)
 {
   if (GEGL_FLOAT_EQUAL (scale, 1.0))
     return *roi;
+  else if (gegl_buffer_filter_is_separable (filter))
+    return gegl_buffer_get_filtered_required (roi, scale, filter);
   else
     {
       gint x1 = floorf (roi->x / scale + GEGL_SCALE_EPSILON);
@@ -2074,6 +2209,13 @@ _gegl_buffer_get_unlocked (GeglBuffer          *buffer,
                                          format, 0, repeat_mode);
       return;
     }
+  else if (gegl_buffer_filter_is_separable (flags))
+    {
+      gegl_buffer_get_filtered (buffer, scale, rect, format, dest_buf,
+                                rowstride, repeat_mode,
+                                flags & GEGL_BUFFER_FILTER_ALL);
+      return;
+    }
   else
   {
     gint chunk_height;
@@ -35,7 +35,12 @@ enum
 {
   PROP_0,
   PROP_TILE_CACHE_SIZE,
+  PROP_TILE_CACHE_POLICY,
   PROP_SWAP,
+  PROP_SWAP_COMPRESSION,
+  PROP_SWAP_POOL_SIZE,
+  PROP_FILE_COMPRESSION,
+  PROP_TILE_ALLOC_NUMA,
   PROP_TILE_WIDTH,
   PROP_TILE_HEIGHT,
   PROP_QUEUE_SIZE,
@@ -55,6 +60,10 @@ gegl_buffer_config_get_property (GObject    *gobject,
         g_value_set_uint64 (value, config->tile_cache_size);
         break;
 
+      case PROP_TILE_CACHE_POLICY:
+        g_value_set_enum (value, config->tile_cache_policy);
+        break;
+
       case PROP_TILE_WIDTH:
         g_value_set_int (value, config->tile_width);
         break;
@@ -67,6 +76,22 @@ gegl_buffer_config_get_property (GObject    *gobject,
         g_value_set_string (value, config->swap);
         break;
 
+      case PROP_SWAP_COMPRESSION:
+        g_value_set_string (value, config->swap_compression);
+        break;
+
+      case PROP_SWAP_POOL_SIZE:
+        g_value_set_uint64 (value, config->swap_pool_size);
+        break;
+
+      case PROP_FILE_COMPRESSION:
+        g_value_set_string (value, config->file_compression);
+        break;
+
+      case PROP_TILE_ALLOC_NUMA:
+        g_value_set_boolean (value, config->tile_alloc_numa);
+        break;
+
       case PROP_QUEUE_SIZE:
         g_value_set_int (value, config->queue_size);
         break;
@@ -90,6 +115,9 @@ gegl_buffer_config_set_property (GObject      *gobject,
       case PROP_TILE_CACHE_SIZE:
         config->tile_cache_size = g_value_get_uint64 (value);
         break;
+      case PROP_TILE_CACHE_POLICY:
+        config->tile_cache_policy = g_value_get_enum (value);
+        break;
       case PROP_TILE_WIDTH:
         config->tile_width = g_value_get_int (value);
         break;
@@ -103,6 +131,20 @@ gegl_buffer_config_set_property (GObject      *gobject,
         g_free (config->swap);
         config->swap = g_value_dup_string (value);
         break;
+      case PROP_SWAP_COMPRESSION:
+        g_free (config->swap_compression);
+        config->swap_compression = g_value_dup_string (value);
+        break;
+      case PROP_SWAP_POOL_SIZE:
+        config->swap_pool_size = g_value_get_uint64 (value);
+        break;
+      case PROP_FILE_COMPRESSION:
+        g_free (config->file_compression);
+        config->file_compression = g_value_dup_string (value);
+        break;
+      case PROP_TILE_ALLOC_NUMA:
+        config->tile_alloc_numa = g_value_get_boolean (value);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, property_id, pspec);
         break;
@@ -115,6 +157,8 @@ gegl_buffer_config_finalize (GObject *gobject)
   GeglBufferConfig *config = GEGL_BUFFER_CONFIG (gobject);
 
   g_free (config->swap);
+  g_free (config->swap_compression);
+  g_free (config->file_compression);
 
   G_OBJECT_CLASS (gegl_buffer_config_parent_class)->finalize (gobject);
 }
@@ -155,6 +199,15 @@ gegl_buffer_config_class_init (GeglBufferConfigClass *klass)
                                                         G_PARAM_READWRITE |
                                                         G_PARAM_CONSTRUCT));
 
+  g_object_class_install_property (gobject_class, PROP_TILE_CACHE_POLICY,
+                                   g_param_spec_enum ("tile-cache-policy",
+                                                      "Tile Cache policy",
+                                                      "eviction policy of the tile cache",
+                                                      GEGL_TYPE_TILE_CACHE_POLICY,
+                                                      GEGL_TILE_CACHE_POLICY_LRU,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_CONSTRUCT));
+
   g_object_class_install_property (gobject_class, PROP_SWAP,
                                    g_param_spec_string ("swap",
                                                         "Swap",
@@ -163,6 +216,38 @@ gegl_buffer_config_class_init (GeglBufferConfigClass *klass)
                                                         G_PARAM_READWRITE |
                                                         G_PARAM_CONSTRUCT));
 
+  g_object_class_install_property (gobject_class, PROP_SWAP_COMPRESSION,
+                                   g_param_spec_string ("swap-compression",
+                                                        "Swap compression",
+                                                        "compression algorithm used for data stored in the swap",
+                                                        "fast",
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_CONSTRUCT));
+
+  g_object_class_install_property (gobject_class, PROP_SWAP_POOL_SIZE,
+                                   g_param_spec_uint64 ("swap-pool-size",
+                                                        "Swap pool size",
+                                                        "size of the in-memory pool of compressed swap data in bytes",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_CONSTRUCT));
+
+  g_object_class_install_property (gobject_class, PROP_FILE_COMPRESSION,
+                                   g_param_spec_string ("file-compression",
+                                                        "File compression",
+                                                        "compression algorithm used for tiles written by gegl_buffer_save(), or NULL to store them uncompressed",
+                                                        NULL,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_CONSTRUCT));
+
+  g_object_class_install_property (gobject_class, PROP_TILE_ALLOC_NUMA,
+                                   g_param_spec_boolean ("tile-alloc-numa",
+                                                         "Tile allocation NUMA",
+                                                         "allocate tile data from pools bound to the NUMA node of the allocating thread",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_CONSTRUCT));
+
   g_object_class_install_property (gobject_class, PROP_QUEUE_SIZE,
                                    g_param_spec_int ("queue-size",
                                                      "Queue size",
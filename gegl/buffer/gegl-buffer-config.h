@@ -22,6 +22,8 @@
 #include <glib.h>
 #include <glib-object.h>
 
+#include "gegl-buffer-enums.h"
+
 G_BEGIN_DECLS
 
 #define GEGL_BUFFER_CONFIG_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  GEGL_TYPE_BUFFER_CONFIG, GeglBufferConfigClass))
@@ -43,11 +45,16 @@ struct _GeglBufferConfig
 {
   GObject  parent_instance;
 
-  gchar   *swap;
-  guint64  tile_cache_size;
-  gint     tile_width;
-  gint     tile_height;
-  gint     queue_size;
+  gchar               *swap;
+  gchar               *swap_compression;
+  guint64              swap_pool_size;
+  gchar               *file_compression;
+  gboolean             tile_alloc_numa;
+  guint64              tile_cache_size;
+  GeglTileCachePolicy  tile_cache_policy;
+  gint                 tile_width;
+  gint                 tile_height;
+  gint                 queue_size;
 };
 
 struct _GeglBufferConfigClass
@@ -55,9 +55,16 @@ typedef enum {
   GEGL_BUFFER_FILTER_BILINEAR = 16,
   GEGL_BUFFER_FILTER_NEAREST  = 32,
   GEGL_BUFFER_FILTER_BOX      = 48,
+  /* separable polyphase filters, slower than the above but sharper.  they
+   * extend the filter bits, changing GEGL_BUFFER_FILTER_ALL from 48 to 112.
+   */
+  GEGL_BUFFER_FILTER_LANCZOS  = 64,
+  GEGL_BUFFER_FILTER_MITCHELL = 80,
   GEGL_BUFFER_FILTER_ALL      = (GEGL_BUFFER_FILTER_BILINEAR|
                                  GEGL_BUFFER_FILTER_NEAREST|
-                                 GEGL_BUFFER_FILTER_BOX),
+                                 GEGL_BUFFER_FILTER_BOX|
+                                 GEGL_BUFFER_FILTER_LANCZOS|
+                                 GEGL_BUFFER_FILTER_MITCHELL),
 } GeglAbyssPolicy;
 
 GType gegl_abyss_policy_get_type (void) G_GNUC_CONST;
@@ -87,6 +94,16 @@ GType gegl_sampler_type_get_type (void) G_GNUC_CONST;
 
 #define GEGL_TYPE_SAMPLER_TYPE (gegl_sampler_type_get_type ())
 
+
+typedef enum {
+  GEGL_TILE_CACHE_POLICY_LRU,
+  GEGL_TILE_CACHE_POLICY_2Q
+} GeglTileCachePolicy;
+
+GType gegl_tile_cache_policy_get_type (void) G_GNUC_CONST;
+
+#define GEGL_TYPE_TILE_CACHE_POLICY (gegl_tile_cache_policy_get_type ())
+
 G_END_DECLS
 
 #endif /* __GEGL_ENUMS_H__ */
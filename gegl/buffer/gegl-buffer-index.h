@@ -9,9 +9,35 @@ GeglBuffer on disk representation
 
 
 /* Increase this number when the structures change.*/
-#define GEGL_FILE_SPEC_REV     0
+#define GEGL_FILE_SPEC_REV     1
+
+/* Revision 0 files store the index as a linked list of GeglBufferBlock's.
+ * GeglTileBackendFile still writes such files, since it updates the index
+ * of a shared file in place; both revisions can be read.
+ */
+#define GEGL_FILE_SPEC_REV_LINKED 0
+
 #define GEGL_MAGIC             {'G','E','G','L'}
 
+/* Revision 1 files with compressed tiles use a different magic, since
+ * revision 0 readers can't read their tiles, and would otherwise open them
+ * as empty buffers.
+ */
+#define GEGL_MAGIC_COMPRESSED  {'G','E','G','Z'}
+
+#define gegl_buffer_header_check_magic(header) \
+  (! memcmp (((GeglBufferHeader*)(header))->magic, "GEGL", 4) || \
+   ! memcmp (((GeglBufferHeader*)(header))->magic, "GEGZ", 4))
+
+/* gegl_buffer_save() stores the tile data following the header, starting
+ * at an offset aligned to this, so that it can be used in place from a
+ * mapping of the file; the index is written after the tile data.
+ */
+#define GEGL_FILE_TILE_ALIGNMENT 4096
+
+/* the number of compression algorithms a revision 1 file can use */
+#define GEGL_FILE_N_CODECS     3
+
 #define GEGL_FLAG_TILE         1
 #define GEGL_FLAG_FREE_TILE    0xf+2
 
@@ -59,13 +85,31 @@ typedef struct {
 
   guint32 rev;             /* if it changes on disk it means the index has changed */
 
-  gint32  padding[36];     /* Pad the structure to be 256 bytes long */
+  /* the following fields are only used by revision 1 files, and are zero
+   * in revision 0 files.  revision 1 files whose tiles are all stored as is
+   * also point next at a linked index of the same tiles, which readers of
+   * revision 0 follow; other files have next set to 0.
+   */
+  guint64 index_offset;    /* offset to the flat index, an array of n_entries
+                            * GeglBufferIndexEntry's, sorted by z, y and x */
+  guint32 n_entries;
+  guint32 index_checksum;  /* gegl_buffer_checksum() of the index */
+  guint32 n_levels;        /* number of stored mipmap levels */
+
+  gchar   codecs[GEGL_FILE_N_CODECS][16]; /* names of the compression
+                                           * algorithms used by the tiles,
+                                           * as passed to gegl_compression() */
+
+  gint32  padding[19];     /* Pad the structure to be 256 bytes long */
 } GeglBufferHeader;
 
 /* the revision of the format is stored in the flags of the header in the
  * lower 8 bits
  */
 #define gegl_buffer_header_get_rev(header)  (((GeglBufferHeader*)(header))->flags&0xff)
+#define gegl_buffer_header_set_rev(header, rev) \
+  (((GeglBufferHeader*)(header))->flags = \
+     (((GeglBufferHeader*)(header))->flags & ~0xff) | (rev))
 
 /* The GeglBuffer index is written to the file as a linked list of
  * GeglBufferBlock's, each block encodes it's own length and the offset
@@ -99,6 +143,32 @@ typedef struct {
                             own state when revision differs. */
 } GeglBufferTile;
 
+/* Revision 1 files store the index as a contiguous array of entries, sorted
+ * by z, y and x, so that tiles can be looked up using a binary search.  The
+ * data of each tile is stored either as is, or compressed using one of the
+ * codecs listed in the header, and is optionally checksummed.
+ */
+#define GEGL_ENTRY_CODEC_MASK     0xff /* 0 for uncompressed data, or the
+                                        * 1-based index of the codec in the
+                                        * header */
+#define GEGL_ENTRY_CODEC_NONE     0    /* the data is stored as is */
+#define GEGL_ENTRY_CODEC(i)       ((i) + 1) /* the data is compressed using
+                                             * codecs[i] of the header */
+#define GEGL_ENTRY_CODEC_INDEX(codec) ((codec) - 1)
+#define GEGL_ENTRY_FLAG_CHECKSUM  (1<<8)
+
+typedef struct {
+  gint32  x;
+  gint32  y;
+  gint32  z;
+  guint32 flags;     /* codec, and whether the data is checksummed */
+  guint64 offset;    /* offset into file for the tile data */
+  guint32 size;      /* size of the stored, possibly compressed, data */
+  guint32 checksum;  /* gegl_buffer_checksum() of the stored data */
+  guint32 rev;
+  guint32 padding;
+} GeglBufferIndexEntry;
+
 /* A convenience union to allow quick and simple casting */
 typedef union {
   guint32          length;
@@ -129,6 +199,26 @@ GeglBufferItem *gegl_buffer_read_header(int      i,
 GList          *gegl_buffer_read_index (int      i,
                                         goffset *offset);
 
+/* reads the flat index of a revision 1 file, returning NULL if it can't be
+ * read, or if its checksum doesn't match.
+ */
+GeglBufferIndexEntry *gegl_buffer_read_flat_index (int                     i,
+                                                   const GeglBufferHeader *header);
+
+/* looks up the entry of a tile in a flat index */
+const GeglBufferIndexEntry *
+                gegl_buffer_index_lookup (const GeglBufferIndexEntry *entries,
+                                          gint                        n_entries,
+                                          gint                        x,
+                                          gint                        y,
+                                          gint                        z);
+gint            gegl_buffer_index_entry_compare (gconstpointer a,
+                                                 gconstpointer b);
+
+/* an Adler-32 checksum, used for the index and the tile data */
+guint32         gegl_buffer_checksum   (gconstpointer data,
+                                        gsize         size);
+
 #define struct_check_padding(type, size) \
   if (sizeof (type) != size) \
     {\
@@ -141,7 +231,8 @@ GList          *gegl_buffer_read_index (int      i,
     }
 #define GEGL_BUFFER_STRUCT_CHECK_PADDING \
   {struct_check_padding (GeglBufferBlock, 16);\
-  struct_check_padding (GeglBufferHeader, 256);}
+  struct_check_padding (GeglBufferHeader, 256);\
+  struct_check_padding (GeglBufferIndexEntry, 40);}
 #define GEGL_BUFFER_SANITY {static gboolean done=FALSE;if(!done){GEGL_BUFFER_STRUCT_CHECK_PADDING;done=TRUE;}}
 
 #endif
@@ -67,6 +67,13 @@ typedef struct _SubIterState {
   /* Linear data members */
   GeglTile            *linear_tile;
   gpointer             linear;
+  /* Planar data members */
+  gboolean             planar;
+  gint                 n_components;
+  gint                 component_bpp;
+  gpointer             planar_data;      /* the planar view of the chunk   */
+  gint                 planar_size;      /* its capacity, in pixels        */
+  gpointer             interleaved_data; /* the chunk the view was made of */
 } SubIterState;
 
 struct _GeglBufferIteratorPriv
@@ -154,6 +161,10 @@ _gegl_buffer_iterator_add (GeglBufferIterator  *iter,
       sub->current_tile = NULL;
       sub->real_data    = NULL;
       sub->linear_tile  = NULL;
+      sub->planar       = FALSE;
+      sub->planar_data  = NULL;
+      sub->planar_size  = 0;
+      sub->interleaved_data = NULL;
       sub->format       = format;
       sub->format_bpp   = babl_format_get_bytes_per_pixel (format);
       sub->level        = level;
@@ -182,6 +193,49 @@ abyss_policy);
 }
 
 
+void
+gegl_buffer_iterator_set_planar (GeglBufferIterator *iter,
+                                 gint                index,
+                                 gboolean            planar)
+{
+  GeglBufferIteratorPriv *priv = iter->priv;
+  SubIterState           *sub;
+  gint                    n_components;
+  gint                    c;
+
+  g_return_if_fail (index >= 0 && index < priv->num_buffers);
+
+  if (priv->state == GeglIteratorState_Invalid)
+    return;
+
+  g_return_if_fail (priv->state == GeglIteratorState_Start);
+
+  sub          = &priv->sub_iter[index];
+  n_components = babl_format_get_n_components (sub->format);
+
+  sub->planar = planar                                 &&
+                n_components > 1                       &&
+                ! babl_format_is_palette (sub->format);
+
+  /* the planes are only meaningful when all the components are of the same
+   * type, otherwise the data is kept interleaved.
+   */
+  for (c = 1; sub->planar && c < n_components; c++)
+    {
+      if (babl_format_get_type (sub->format, c) !=
+          babl_format_get_type (sub->format, 0))
+        {
+          sub->planar = FALSE;
+        }
+    }
+
+  if (sub->planar)
+    {
+      sub->n_components  = n_components;
+      sub->component_bpp = sub->format_bpp / n_components;
+    }
+}
+
 GeglBufferIterator *
 gegl_buffer_iterator_new (GeglBuffer          *buf,
                           const GeglRectangle *roi,
@@ -198,6 +252,196 @@ gegl_buffer_iterator_new (GeglBuffer          *buf,
   return iter;
 }
 
+#define DEFINE_PLANAR_CONVERSION(type)                                        \
+static void                                                                   \
+deinterleave_##type (const type *src,                                         \
+                     type       *dst,                                         \
+                     gint        n_pixels,                                    \
+                     gint        n_components)                                \
+{                                                                             \
+  gint c;                                                                     \
+  gint i;                                                                     \
+                                                                              \
+  for (c = 0; c < n_components; c++)                                          \
+    {                                                                         \
+      const type *s = src + c;                                                \
+      type       *d = dst + (gsize) c * n_pixels;                             \
+                                                                              \
+      for (i = 0; i < n_pixels; i++)                                          \
+        d[i] = s[i * n_components];                                           \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+interleave_##type (const type *src,                                           \
+                   type       *dst,                                           \
+                   gint        n_pixels,                                      \
+                   gint        n_components)                                  \
+{                                                                             \
+  gint c;                                                                     \
+  gint i;                                                                     \
+                                                                              \
+  for (c = 0; c < n_components; c++)                                          \
+    {                                                                         \
+      const type *s = src + (gsize) c * n_pixels;                             \
+      type       *d = dst + c;                                                \
+                                                                              \
+      for (i = 0; i < n_pixels; i++)                                          \
+        d[i * n_components] = s[i];                                           \
+    }                                                                         \
+}
+
+DEFINE_PLANAR_CONVERSION (guint8)
+DEFINE_PLANAR_CONVERSION (guint16)
+DEFINE_PLANAR_CONVERSION (guint32)
+DEFINE_PLANAR_CONVERSION (guint64)
+
+#undef DEFINE_PLANAR_CONVERSION
+
+/* replaces the data of the current chunk with a planar copy, holding each
+ * component of all the chunk's pixels contiguously.
+ */
+static inline void
+load_planar (GeglBufferIterator *iter,
+             int                 index)
+{
+  GeglBufferIteratorPriv *priv = iter->priv;
+  SubIterState           *sub  = &priv->sub_iter[index];
+  gpointer                data = iter->items[index].data;
+  gint                    n    = iter->length;
+
+  if (! sub->planar || ! data)
+    return;
+
+  if (sub->planar_size < n)
+    {
+      if (sub->planar_data)
+        gegl_free (sub->planar_data);
+
+      sub->planar_data = gegl_malloc ((gsize) n * sub->format_bpp);
+      sub->planar_size = n;
+    }
+
+  if (sub->access_mode & GEGL_ACCESS_READ)
+    {
+      switch (sub->component_bpp)
+        {
+        case 1:
+          deinterleave_guint8 (data, sub->planar_data, n, sub->n_components);
+          break;
+        case 2:
+          deinterleave_guint16 (data, sub->planar_data, n, sub->n_components);
+          break;
+        case 4:
+          deinterleave_guint32 (data, sub->planar_data, n, sub->n_components);
+          break;
+        case 8:
+          deinterleave_guint64 (data, sub->planar_data, n, sub->n_components);
+          break;
+        default:
+          {
+            const guchar *src = data;
+            guchar       *dst = sub->planar_data;
+            gint          c;
+            gint          i;
+
+            for (c = 0; c < sub->n_components; c++)
+              {
+                for (i = 0; i < n; i++)
+                  {
+                    memcpy (dst + ((gsize) c * n + i) * sub->component_bpp,
+                            src + (gsize) i * sub->format_bpp +
+                                  c * sub->component_bpp,
+                            sub->component_bpp);
+                  }
+              }
+          }
+          break;
+        }
+    }
+
+  sub->interleaved_data   = data;
+  iter->items[index].data = sub->planar_data;
+}
+
+/* writes the planar copy of the current chunk back, if needed, and restores
+ * the chunk's interleaved data.
+ */
+static inline void
+store_planar (GeglBufferIterator *iter,
+              int                 index)
+{
+  GeglBufferIteratorPriv *priv = iter->priv;
+  SubIterState           *sub  = &priv->sub_iter[index];
+  gpointer                data = sub->interleaved_data;
+  gint                    n    = iter->length;
+
+  if (! data)
+    return;
+
+  if (sub->access_mode & GEGL_ACCESS_WRITE)
+    {
+      switch (sub->component_bpp)
+        {
+        case 1:
+          interleave_guint8 (sub->planar_data, data, n, sub->n_components);
+          break;
+        case 2:
+          interleave_guint16 (sub->planar_data, data, n, sub->n_components);
+          break;
+        case 4:
+          interleave_guint32 (sub->planar_data, data, n, sub->n_components);
+          break;
+        case 8:
+          interleave_guint64 (sub->planar_data, data, n, sub->n_components);
+          break;
+        default:
+          {
+            const guchar *src = sub->planar_data;
+            guchar       *dst = data;
+            gint          c;
+            gint          i;
+
+            for (c = 0; c < sub->n_components; c++)
+              {
+                for (i = 0; i < n; i++)
+                  {
+                    memcpy (dst + (gsize) i * sub->format_bpp +
+                                  c * sub->component_bpp,
+                            src + ((gsize) c * n + i) * sub->component_bpp,
+                            sub->component_bpp);
+                  }
+              }
+          }
+          break;
+        }
+    }
+
+  sub->interleaved_data   = NULL;
+  iter->items[index].data = data;
+}
+
+static inline void
+load_planar_all (GeglBufferIterator *iter)
+{
+  GeglBufferIteratorPriv *priv = iter->priv;
+  gint                    index;
+
+  for (index = 0; index < priv->num_buffers; index++)
+    load_planar (iter, index);
+}
+
+static inline void
+store_planar_all (GeglBufferIterator *iter)
+{
+  GeglBufferIteratorPriv *priv         = iter->priv;
+  const gint             *access_order = get_access_order (iter);
+  gint                    i;
+
+  for (i = 0; i < priv->num_buffers; i++)
+    store_planar (iter, access_order[i]);
+}
+
 static inline void
 release_tile (GeglBufferIterator *iter,
               int index)
@@ -294,6 +538,38 @@ retile_subs (GeglBufferIterator *iter,
     }
 }
 
+/* hints the buffers read by the iterator that the tile row starting at @y,
+ * in the coordinates of the first buffer, is going to be accessed soon.
+ */
+static inline void
+prefetch_row (GeglBufferIterator *iter,
+              int                 y)
+{
+  GeglBufferIteratorPriv *priv     = iter->priv;
+  SubIterState           *lead_sub = &priv->sub_iter[0];
+  int index;
+
+  if (y >= lead_sub->full_rect.y + lead_sub->full_rect.height)
+    return;
+
+  for (index = 0; index < priv->num_buffers; index++)
+    {
+      SubIterState  *sub = &priv->sub_iter[index];
+      GeglRectangle  row;
+
+      if (! (sub->access_mode & GEGL_ACCESS_READ) || sub->linear_tile)
+        continue;
+
+      row.x      = sub->full_rect.x;
+      row.y      = y + sub->full_rect.y - lead_sub->full_rect.y;
+      row.width  = sub->full_rect.width;
+      row.height = MIN (priv->origin_tile.height,
+                        lead_sub->full_rect.y + lead_sub->full_rect.height - y);
+
+      gegl_buffer_prefetch (sub->buffer, &row, sub->level);
+    }
+}
+
 static inline gboolean
 initialize_rects (GeglBufferIterator *iter)
 {
@@ -302,6 +578,15 @@ initialize_rects (GeglBufferIterator *iter)
 
   retile_subs (iter, sub->full_rect.x, sub->full_rect.y);
 
+  /* when iterating over more than a single tile, fetch the rest of the
+   * first row, and the next row, ahead of time.
+   */
+  if (! gegl_rectangle_equal (&iter->items[0].roi, &sub->full_rect))
+    {
+      prefetch_row (iter, iter->items[0].roi.y);
+      prefetch_row (iter, iter->items[0].roi.y + iter->items[0].roi.height);
+    }
+
   return TRUE;
 }
 
@@ -326,6 +611,13 @@ increment_rects (GeglBufferIterator *iter)
           /* All done */
           return FALSE;
         }
+
+      retile_subs (iter, x, y);
+
+      /* fetch the row after this one ahead of time */
+      prefetch_row (iter, y + iter->items[0].roi.height);
+
+      return TRUE;
     }
 
   retile_subs (iter, x, y);
@@ -570,6 +862,8 @@ load_rects (GeglBufferIterator *iter)
 
   iter->length = iter->items[0].roi.width * iter->items[0].roi.height;
   priv->state  = next_state;
+
+  load_planar_all (iter);
 }
 
 static inline void
@@ -583,6 +877,8 @@ _gegl_buffer_iterator_stop (GeglBufferIterator *iter)
     {
       priv->state = GeglIteratorState_Invalid;
 
+      store_planar_all (iter);
+
       for (i = priv->num_buffers - 1; i >= 0; i--)
         {
           gint          index = access_order[i];
@@ -618,6 +914,9 @@ _gegl_buffer_iterator_stop (GeglBufferIterator *iter)
 
           gegl_buffer_unlock (sub->buffer);
 
+          if (sub->planar_data)
+            gegl_free (sub->planar_data);
+
           if ((sub->access_mode & GEGL_ACCESS_WRITE) &&
               ! (sub->access_mode & GEGL_ITERATOR_NO_NOTIFY))
             {
@@ -681,6 +980,8 @@ static void linear_shortcut (GeglBufferIterator *iter)
 
   iter->length = iter->items[0].roi.width * iter->items[0].roi.height;
   priv->state  = GeglIteratorState_Stop; /* quit on next iterator_next */
+
+  load_planar_all (iter);
 }
 
 gboolean
@@ -738,6 +1039,8 @@ gegl_buffer_iterator_next (GeglBufferIterator *iter)
     {
       gint index;
 
+      store_planar_all (iter);
+
       for (index = 0; index < priv->num_buffers; index++)
         {
           iter->items[index].data   = ((char *)iter->items[index].data) + priv->sub_iter[index].row_stride;
@@ -749,12 +1052,16 @@ gegl_buffer_iterator_next (GeglBufferIterator *iter)
       if (priv->remaining_rows == 0)
         priv->state = GeglIteratorState_InTile;
 
+      load_planar_all (iter);
+
       return TRUE;
     }
   else if (priv->state == GeglIteratorState_InTile)
     {
       gint i;
 
+      store_planar_all (iter);
+
       for (i = priv->num_buffers - 1; i >= 0; i--)
         {
           gint index = access_order[i];
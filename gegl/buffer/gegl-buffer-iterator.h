@@ -123,6 +123,28 @@ gint                 gegl_buffer_iterator_add  (GeglBufferIterator  *iterator,
                                                 GeglAccessMode       access_mode,
                                                 GeglAbyssPolicy      abyss_policy);
 
+/**
+ * gegl_buffer_iterator_set_planar: (skip)
+ * @iterator: a #GeglBufferIterator
+ * @index: the handle of a buffer added to the iterator
+ * @planar: whether to hand out the buffer's data in planar form
+ *
+ * Makes the data of the buffer added at @index be handed out in planar
+ * (structure-of-arrays) form: instead of interleaved pixels, the data of
+ * each iteration holds all the values of the first component, followed by
+ * all the values of the second component, and so on, component c starting
+ * at byte offset c * iterator->length * (bytes per component).  The data is
+ * converted from, and, when the buffer is accessed for writing, back to,
+ * the interleaved format of the buffer by the iterator.
+ *
+ * Formats whose components differ in size, as well as palettized formats,
+ * are always handed out interleaved.  Must be called before the first call
+ * to gegl_buffer_iterator_next().
+ */
+void                 gegl_buffer_iterator_set_planar (GeglBufferIterator *iterator,
+                                                      gint                index,
+                                                      gboolean            planar);
+
 /**
  * gegl_buffer_iterator_stop: (skip)
  * @iterator: a GeglBufferIterator
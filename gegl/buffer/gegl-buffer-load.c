@@ -18,6 +18,7 @@
 
 #include "config.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 
@@ -29,6 +30,8 @@
 #include "gegl-buffer.h"
 #include "gegl-buffer-private.h"
 #include "gegl-buffer-index.h"
+#include "gegl-compression.h"
+#include "gegl-tile-backend-mmap.h"
 #include "gegl-debug.h"
 
 #include <glib/gprintf.h>
@@ -106,10 +109,7 @@ gegl_buffer_read_header (int i,
                    ret->header.width,
                    ret->header.height);
 
-  if (!(ret->header.magic[0]=='G' &&
-       ret->header.magic[1]=='E' &&
-       ret->header.magic[2]=='G' &&
-       ret->header.magic[3]=='L'))
+  if (!gegl_buffer_header_check_magic (&ret->header))
     {
       g_warning ("Magic is wrong! %s", ret->header.magic);
     }
@@ -224,6 +224,154 @@ gegl_buffer_read_index (int           i,
 }
 
 
+static gboolean
+read_all (int      i,
+          gpointer data,
+          gsize    size)
+{
+  gchar *p = data;
+
+  while (size > 0)
+    {
+      gssize sz_read = read (i, p, size);
+
+      if (sz_read < 0 && errno == EINTR)
+        continue;
+
+      if (sz_read <= 0)
+        return FALSE;
+
+      p    += sz_read;
+      size -= sz_read;
+    }
+
+  return TRUE;
+}
+
+GeglBufferIndexEntry *
+gegl_buffer_read_flat_index (int                     i,
+                             const GeglBufferHeader *header)
+{
+  GeglBufferIndexEntry *entries;
+  gsize                 size;
+
+  if (header->n_entries > G_MAXSIZE / sizeof (GeglBufferIndexEntry))
+    return NULL;
+
+  size    = header->n_entries * sizeof (GeglBufferIndexEntry);
+  entries = g_try_malloc (MAX (size, sizeof (GeglBufferIndexEntry)));
+
+  if (! entries)
+    return NULL;
+
+  if (lseek (i, header->index_offset, SEEK_SET) == -1 ||
+      ! read_all (i, entries, size))
+    {
+      g_warning ("failed reading the buffer index");
+      g_free (entries);
+      return NULL;
+    }
+
+  if (gegl_buffer_checksum (entries, size) != header->index_checksum)
+    {
+      g_warning ("the buffer index is corrupt");
+      g_free (entries);
+      return NULL;
+    }
+
+  GEGL_NOTE (GEGL_DEBUG_BUFFER_LOAD, "read flat index of %i entries",
+             header->n_entries);
+
+  return entries;
+}
+
+gint
+gegl_buffer_index_entry_compare (gconstpointer a,
+                                 gconstpointer b)
+{
+  const GeglBufferIndexEntry *entry_a = a;
+  const GeglBufferIndexEntry *entry_b = b;
+
+  if (entry_a->z != entry_b->z)
+    return entry_a->z < entry_b->z ? -1 : +1;
+  if (entry_a->y != entry_b->y)
+    return entry_a->y < entry_b->y ? -1 : +1;
+  if (entry_a->x != entry_b->x)
+    return entry_a->x < entry_b->x ? -1 : +1;
+
+  return 0;
+}
+
+const GeglBufferIndexEntry *
+gegl_buffer_index_lookup (const GeglBufferIndexEntry *entries,
+                          gint                        n_entries,
+                          gint                        x,
+                          gint                        y,
+                          gint                        z)
+{
+  GeglBufferIndexEntry key;
+
+  key.x = x;
+  key.y = y;
+  key.z = z;
+
+  return bsearch (&key, entries, n_entries, sizeof (GeglBufferIndexEntry),
+                  gegl_buffer_index_entry_compare);
+}
+
+/* reads the data of @entry into @data, which is @tile_size bytes long,
+ * decompressing and verifying it as needed.
+ */
+static gboolean
+load_entry (LoadInfo                   *info,
+            const GeglBufferIndexEntry *entry,
+            guchar                     *data)
+{
+  gint     codec      = entry->flags & GEGL_ENTRY_CODEC_MASK;
+  guchar  *compressed = NULL;
+  guchar  *stored     = data;
+  gboolean success;
+
+  if (codec > GEGL_FILE_N_CODECS ||
+      (codec == GEGL_ENTRY_CODEC_NONE && entry->size != info->tile_size))
+    {
+      return FALSE;
+    }
+
+  if (codec != GEGL_ENTRY_CODEC_NONE)
+    stored = compressed = g_try_malloc (entry->size);
+
+  success = stored                                        &&
+            lseek (info->i, entry->offset, SEEK_SET) != -1 &&
+            read_all (info->i, stored, entry->size);
+
+  if (success && (entry->flags & GEGL_ENTRY_FLAG_CHECKSUM))
+    success = gegl_buffer_checksum (stored, entry->size) == entry->checksum;
+
+  if (success && codec != GEGL_ENTRY_CODEC_NONE)
+    {
+      const GeglCompression *compression;
+      gchar                  name[sizeof (info->header.codecs[0]) + 1] = "";
+
+      memcpy (name, info->header.codecs[GEGL_ENTRY_CODEC_INDEX (codec)],
+              sizeof (info->header.codecs[0]));
+
+      compression = gegl_compression (name);
+
+      success = compression &&
+                gegl_compression_decompress (compression,
+                                             info->header.bytes_per_pixel,
+                                             data,
+                                             info->tile_size /
+                                             info->header.bytes_per_pixel,
+                                             compressed, entry->size);
+    }
+
+  g_free (compressed);
+
+  return success;
+}
+
 static void sanity(void) { GEGL_BUFFER_SANITY; }
 
 
@@ -241,12 +389,46 @@ gegl_buffer_open (const gchar *path)
                        NULL);
 }
 
+GeglBuffer *
+gegl_buffer_load_mapped (const gchar *path)
+{
+  GeglBuffer      *ret;
+  GeglTileBackend *backend;
+
+  /* map the file if possible, in which case tiles are only read when
+   * accessed, directly from the mapping.
+   */
+  backend = gegl_tile_backend_mmap_new (path);
+
+  if (! backend)
+    return gegl_buffer_load (path);
+
+  {
+    GeglRectangle extent = gegl_tile_backend_get_extent (backend);
+
+    ret = g_object_new (GEGL_TYPE_BUFFER,
+                        "backend", backend,
+                        "x",       extent.x,
+                        "y",       extent.y,
+                        "width",   extent.width,
+                        "height",  extent.height,
+                        NULL);
+  }
+
+  g_object_unref (backend);
+
+  GEGL_NOTE (GEGL_DEBUG_BUFFER_LOAD, "buffer mapped %s", path);
+
+  return ret;
+}
+
 GeglBuffer *
 gegl_buffer_load (const gchar *path)
 {
-  GeglBuffer *ret;
+  GeglBuffer      *ret;
+  LoadInfo        *info;
 
-  LoadInfo *info = g_slice_new0 (LoadInfo);
+  info = g_slice_new0 (LoadInfo);
 
   info->path = g_strdup (path);
   info->i = g_open (info->path, O_RDONLY, 0770);
@@ -276,6 +458,8 @@ gegl_buffer_load (const gchar *path)
                       "format", info->format,
                       "tile-width", info->header.tile_width,
                       "tile-height", info->header.tile_height,
+                      "x", info->header.x,
+                      "y", info->header.y,
                       "height", info->header.height,
                       "width", info->header.width,
                       NULL);
@@ -284,6 +468,46 @@ gegl_buffer_load (const gchar *path)
   */
   g_assert (babl_format_get_bytes_per_pixel (info->format) == info->header.bytes_per_pixel);
 
+  if (gegl_buffer_header_get_rev (&info->header) == GEGL_FILE_SPEC_REV)
+    {
+      GeglBufferIndexEntry *entries;
+      gint                  n_loaded = 0;
+      gint                  j;
+
+      entries = gegl_buffer_read_flat_index (info->i, &info->header);
+
+      /* only level 0 is loaded, the buffer regenerates the other levels */
+      for (j = 0; entries && j < (gint) info->header.n_entries; j++)
+        {
+          GeglTile *tile;
+
+          if (entries[j].z != 0)
+            continue;
+
+          tile = gegl_tile_source_get_tile (GEGL_TILE_SOURCE (ret),
+                                            entries[j].x,
+                                            entries[j].y,
+                                            0);
+          gegl_tile_lock (tile);
+
+          if (load_entry (info, &entries[j], gegl_tile_get_data (tile)))
+            n_loaded++;
+          else
+            g_warning ("failed loading tile %i, %i from %s",
+                       entries[j].x, entries[j].y, info->path);
+
+          gegl_tile_unlock (tile);
+          gegl_tile_unref (tile);
+        }
+
+      g_free (entries);
+
+      GEGL_NOTE (GEGL_DEBUG_BUFFER_LOAD, "%i tiles loaded", n_loaded);
+
+      load_info_destroy (info);
+      return ret;
+    }
+
   info->tiles = gegl_buffer_read_index (info->i, &info->offset);
 
   /* load each tile */
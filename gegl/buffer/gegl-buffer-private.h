@@ -23,6 +23,7 @@
 #include "gegl-buffer.h"
 #include "gegl-tile-handler.h"
 #include "gegl-buffer-iterator.h"
+#include "gegl-tile-table.h"
 
 #define GEGL_BUFFER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  GEGL_TYPE_BUFFER, GeglBufferClass))
 #define GEGL_IS_BUFFER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  GEGL_TYPE_BUFFER))
@@ -68,6 +69,11 @@ struct _GeglBuffer
                                                    with no listeners */
 
   GeglTileBackend  *backend;
+
+  gint              freeze_count; /* number of outstanding gegl_buffer_freeze()
+                                     calls; protected by the storage mutex */
+  GeglTileTable    *tile_table;   /* lock-free tile lookup table, present
+                                     while the buffer is frozen */
 };
 
 struct _GeglBufferClass
@@ -91,6 +97,18 @@ GeglTileBackend * gegl_buffer_backend2    (GeglBuffer *buffer); /* non-cached */
 
 gboolean          gegl_buffer_is_shared   (GeglBuffer *buffer);
 
+void              gegl_buffer_prefetch    (GeglBuffer          *buffer,
+                                           const GeglRectangle *rect,
+                                           gint                 level);
+
+/* the highest level gegl_buffer_build_pyramid() builds when asked to build
+ * all levels
+ */
+#define GEGL_BUFFER_MAX_PYRAMID_LEVEL 16
+
+/* the maximal number of tiles a frozen buffer looks up without locking */
+#define GEGL_BUFFER_MAX_FROZEN_TILES (1 << 16)
+
 #define GEGL_BUFFER_DISABLE_LOCKS 1
 
 #ifdef GEGL_BUFFER_DISABLE_LOCKS
@@ -195,7 +213,8 @@ gboolean gegl_tile_damage         (GeglTile *tile,
 void _gegl_buffer_drop_hot_tile (GeglBuffer *buffer);
 
 GeglRectangle _gegl_get_required_for_scale (const GeglRectangle *roi,
-                                            gdouble              scale);
+                                            gdouble              scale,
+                                            GeglAbyssPolicy      filter);
 
 gboolean gegl_buffer_scan_compatible (GeglBuffer *bufferA,
                                       gint        xA,
@@ -32,25 +32,31 @@
 #include "gegl-buffer.h"
 #include "gegl-buffer-types.h"
 #include "gegl-buffer-private.h"
+#include "gegl-buffer-config.h"
+#include "gegl-compression.h"
 #include "gegl-debug.h"
 #include "gegl-tile-storage.h"
 #include "gegl-tile.h"
 #include "gegl-buffer-index.h"
 
+#ifndef HAVE_FSYNC
+
+#ifdef G_OS_WIN32
+#define fsync _commit
+#endif
+
+#endif
+
 typedef struct
 {
-  GeglBufferHeader header;
-  GList           *tiles;
-  gchar           *path;
-  gint             o;
-
-  gint             tile_size;
-  gint             offset;
-  gint             entry_count;
-  GeglBufferBlock *in_holding; /* we need to write one block added behind
-                                * to be able to recompute the forward pointing
-                                * link from one entry to the next.
-                                */
+  GeglBufferHeader  header;
+  GArray           *entries;
+  gchar            *path;
+  gchar            *tmp_path;
+  gint              o;
+
+  gint              tile_size;
+  goffset           offset;
 } SaveInfo;
 
 
@@ -75,32 +81,6 @@ gegl_tile_entry_destroy (GeglBufferTile *entry)
   g_free (entry);
 }
 
-static gsize write_block (SaveInfo        *info,
-                          GeglBufferBlock *block)
-{
-   gssize ret = 0;
-
-   if (info->in_holding)
-     {
-       glong allocated_pos = info->offset + info->in_holding->length;
-       info->in_holding->next = allocated_pos;
-
-       if (block == NULL)
-         info->in_holding->next = 0;
-
-       ret = write (info->o, info->in_holding, info->in_holding->length);
-	   if (ret == -1)
-         ret = 0;
-       info->offset += ret;
-       g_assert (allocated_pos == info->offset);
-     }
-  /* write block should also allocate the block and update the
-   * previously added blocks next pointer
-   */
-   info->in_holding = block;
-   return ret;
-}
-
 static void
 save_info_destroy (SaveInfo *info)
 {
@@ -109,56 +89,229 @@ save_info_destroy (SaveInfo *info)
   if (info->path)
     g_free (info->path);
   if (info->o != -1)
-    close (info->o);
-  if (info->tiles != NULL)
     {
-      GList *iter;
-      for (iter = info->tiles; iter; iter = iter->next)
-        gegl_tile_entry_destroy (iter->data);
-      g_list_free (info->tiles);
-      info->tiles = NULL;
+      close (info->o);
+      g_unlink (info->tmp_path);
     }
+  g_free (info->tmp_path);
+  if (info->entries)
+    g_array_free (info->entries, TRUE);
   g_slice_free (SaveInfo, info);
 }
 
 
 
-static glong z_order (const GeglBufferTile *entry)
+/* Adler-32, computed in blocks of at most ADLER_NMAX bytes, the largest
+ * number of bytes for which the sums can't overflow before being reduced.
+ */
+#define ADLER_BASE 65521
+#define ADLER_NMAX 5552
+
+guint32
+gegl_buffer_checksum (gconstpointer data,
+                      gsize         size)
 {
-  glong value;
+  const guchar *p = data;
+  guint32       a = 1;
+  guint32       b = 0;
 
-  gint  i;
-  gint  srcA = entry->x;
-  gint  srcB = entry->y;
-  gint  srcC = entry->z;
+  while (size > 0)
+    {
+      gsize n = MIN (size, ADLER_NMAX);
 
-  /* interleave the 10 least significant bits of all coordinates,
-   * this gives us Z-order / morton order of the space and should
-   * work well as a hash
-   */
-  value = 0;
-  for (i = 20; i >= 0; i--)
+      size -= n;
+
+      while (n--)
+        {
+          a += *p++;
+          b += a;
+        }
+
+      a %= ADLER_BASE;
+      b %= ADLER_BASE;
+    }
+
+  return (b << 16) | a;
+}
+
+static gboolean
+save_write (SaveInfo      *info,
+            gconstpointer  data,
+            gsize          size)
+{
+  const gchar *p = data;
+
+  while (size > 0)
     {
-#define ADD_BIT(bit)    do { value |= (((bit) != 0) ? 1 : 0); value <<= 1; \
-    } \
-  while (0)
-      ADD_BIT (srcA & (1 << i));
-      ADD_BIT (srcB & (1 << i));
-      ADD_BIT (srcC & (1 << i));
-#undef ADD_BIT
+      gssize ret = write (info->o, p, size);
+
+      if (ret < 0 && errno == EINTR)
+        continue;
+
+      if (ret <= 0)
+        {
+          g_warning ("%s: Could not write to '%s': %s",
+                     G_STRFUNC, info->tmp_path, g_strerror (errno));
+          return FALSE;
+        }
+
+      p            += ret;
+      size         -= ret;
+      info->offset += ret;
     }
-  return value;
+
+  return TRUE;
+}
+
+static gboolean
+save_pad (SaveInfo *info,
+          gint      alignment)
+{
+  static const gchar padding[GEGL_FILE_TILE_ALIGNMENT];
+
+  g_assert (alignment <= GEGL_FILE_TILE_ALIGNMENT);
+
+  return save_write (info, padding,
+                     (alignment - info->offset % alignment) % alignment);
 }
 
-static gint z_order_compare (gconstpointer a,
-                             gconstpointer b)
+/* writes the data of tile x, y, z, if there is any, and appends its entry
+ * to the index.  uncompressed data is aligned so that it can be used in
+ * place from a mapping of the file.
+ */
+static gboolean
+save_tile (SaveInfo              *info,
+           GeglBuffer            *buffer,
+           const GeglCompression *compression,
+           gpointer               scratch,
+           gint                   bpp,
+           gint                   x,
+           gint                   y,
+           gint                   z)
 {
-  const GeglBufferTile *entryA = a;
-  const GeglBufferTile *entryB = b;
+  GeglBufferIndexEntry  entry = { 0, };
+  GeglTile             *tile;
+  gconstpointer         data;
+  gint                  size;
+  gboolean              success;
+
+  tile = gegl_tile_source_get_tile (GEGL_TILE_SOURCE (buffer), x, y, z);
+
+  if (! tile)
+    return TRUE;
+
+  /* levels above 0 are generated on demand, and have no data where the
+   * level below has none.
+   */
+  if (z > 0 && tile->is_zero_tile)
+    {
+      gegl_tile_unref (tile);
+      return TRUE;
+    }
+
+  gegl_tile_read_lock (tile);
+
+  data = gegl_tile_get_data (tile);
+  size = info->tile_size;
+
+  entry.x     = x;
+  entry.y     = y;
+  entry.z     = z;
+  entry.rev   = gegl_tile_get_rev (tile);
+  entry.flags = GEGL_ENTRY_FLAG_CHECKSUM;
+
+  if (compression &&
+      gegl_compression_compress (compression, bpp,
+                                 data, info->tile_size / bpp,
+                                 scratch, &size, info->tile_size - 1))
+    {
+      data         = scratch;
+      entry.flags |= GEGL_ENTRY_CODEC (0);
+    }
+  else
+    {
+      size = info->tile_size;
+    }
+
+  success = (entry.flags & GEGL_ENTRY_CODEC_MASK) ||
+            save_pad (info, 16);
+
+  entry.offset   = info->offset;
+  entry.size     = size;
+  entry.checksum = gegl_buffer_checksum (data, size);
+
+  success = success && save_write (info, data, size);
 
-  return z_order (entryB) - z_order (entryA);
+  gegl_tile_read_unlock (tile);
+  gegl_tile_unref (tile);
+
+  if (success)
+    g_array_append_val (info->entries, entry);
+
+  return success;
 }
 
+/* writes the index as a linked list of GeglBufferTile's, as described by
+ * revision 0 of the format, and points the header at it.  this is only
+ * possible when none of the tiles are compressed.
+ */
+static gboolean
+save_linked_index (SaveInfo *info)
+{
+  GeglBufferTile *tiles;
+  gboolean        success;
+  guint           i;
+
+  for (i = 0; i < info->entries->len; i++)
+    {
+      GeglBufferIndexEntry *entry = &g_array_index (info->entries,
+                                                    GeglBufferIndexEntry, i);
+
+      if (entry->flags & GEGL_ENTRY_CODEC_MASK)
+        {
+          memcpy (info->header.magic, "GEGZ", 4);
+          info->header.next = 0;
+
+          return TRUE;
+        }
+    }
+
+  info->header.next = 0;
+
+  if (info->entries->len == 0)
+    return TRUE;
+
+  if (! save_pad (info, 16))
+    return FALSE;
+
+  tiles = g_new0 (GeglBufferTile, info->entries->len);
+
+  for (i = 0; i < info->entries->len; i++)
+    {
+      GeglBufferIndexEntry *entry = &g_array_index (info->entries,
+                                                    GeglBufferIndexEntry, i);
+
+      tiles[i].block.length = sizeof (GeglBufferTile);
+      tiles[i].block.flags  = GEGL_FLAG_TILE;
+      tiles[i].block.next   = i + 1 < info->entries->len ?
+                              info->offset + (i + 1) * sizeof (GeglBufferTile) :
+                              0;
+      tiles[i].offset       = entry->offset;
+      tiles[i].x            = entry->x;
+      tiles[i].y            = entry->y;
+      tiles[i].z            = entry->z;
+      tiles[i].rev          = entry->rev;
+    }
+
+  info->header.next = info->offset;
+
+  success = save_write (info, tiles,
+                        info->entries->len * sizeof (GeglBufferTile));
+
+  g_free (tiles);
+
+  return success;
+}
 
 void
 gegl_buffer_header_init (GeglBufferHeader *header,
@@ -192,12 +345,17 @@ gegl_buffer_save (GeglBuffer          *buffer,
                   const gchar         *path,
                   const GeglRectangle *roi)
 {
-  SaveInfo *info = g_slice_new0 (SaveInfo);
-
-  glong prediction = 0;
-  gint bpp;
-  gint tile_width;
-  gint tile_height;
+  SaveInfo              *info        = g_slice_new0 (SaveInfo);
+  const GeglCompression *compression = NULL;
+  const gchar           *compression_name;
+  gpointer               scratch     = NULL;
+  gboolean               success     = TRUE;
+  gint                   bpp;
+  gint                   tile_width;
+  gint                   tile_height;
+  gint                   n_levels;
+  gint                   max_z       = 0;
+  gint                   z;
 
   GEGL_BUFFER_SANITY;
 
@@ -208,22 +366,27 @@ gegl_buffer_save (GeglBuffer          *buffer,
              "starting to save buffer %s, roi: %d,%d %dx%d",
              path, roi->x, roi->y, roi->width, roi->height);
 
-  /* a header should follow the same structure as a blockdef with
-   * respect to the flags and next offsets, thus this is a valid
-   * cast shortcut.
-   */
-
-  info->path = g_strdup (path);
+  info->path     = g_strdup (path);
+  info->tmp_path = g_strdup_printf ("%s.XXXXXX", path);
+  info->entries  = g_array_new (FALSE, FALSE, sizeof (GeglBufferIndexEntry));
 
+  /* write to a temporary file, which replaces the file at path once
+   * complete, rather than truncating a file that may be mapped by a buffer
+   * loaded from it.
+   */
 #ifndef G_OS_WIN32
-  info->o    = g_open (info->path, O_RDWR|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH);
+  info->o    = g_mkstemp_full (info->tmp_path, O_RDWR, S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH);
 #else
-  info->o    = g_open (info->path, O_RDWR|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR);
+  info->o    = g_mkstemp_full (info->tmp_path, O_RDWR, S_IRUSR|S_IWUSR);
 #endif
 
-
   if (info->o == -1)
-    g_warning ("%s: Could not open '%s': %s", G_STRFUNC, info->path, g_strerror(errno));
+    {
+      g_warning ("%s: Could not open '%s': %s", G_STRFUNC, info->tmp_path, g_strerror(errno));
+      save_info_destroy (info);
+      return;
+    }
+
   tile_width  = buffer->tile_storage->tile_width;
   tile_height = buffer->tile_storage->tile_height;
   g_object_get (buffer, "px-size", &bpp, NULL);
@@ -238,127 +401,147 @@ gegl_buffer_save (GeglBuffer          *buffer,
                            bpp,
                            buffer->tile_storage->format
                            );
-  info->header.next = (prediction += sizeof (GeglBufferHeader));
   info->tile_size = tile_width * tile_height * bpp;
 
   g_assert (info->tile_size % 16 == 0);
 
-  GEGL_NOTE (GEGL_DEBUG_BUFFER_SAVE,
-             "collecting list of tiles to be written");
-  {
-    gint z;
-    gint factor = 1;
+  compression_name = gegl_buffer_config ()->file_compression;
+
+  if (compression_name && *compression_name)
+    {
+      compression = gegl_compression (compression_name);
 
-    for (z = 0; z < 1; z++)
-      {
-        gint bufy = roi->y;
-        while (bufy < roi->y + roi->height)
+      if (compression)
+        {
+          g_strlcpy (info->header.codecs[0],
+                     gegl_compression_get_name (compression),
+                     sizeof (info->header.codecs[0]));
+
+          scratch = g_malloc (info->tile_size);
+        }
+      else
+        {
+          g_warning ("unknown file compression algorithm '%s'",
+                     compression_name);
+        }
+    }
+
+  /* store the mipmap tiles the buffer already has, up to the level at which
+   * the whole roi fits in a single tile, so that zoomed-out views of the
+   * loaded buffer don't have to read all of level 0.  levels are not
+   * generated for the sake of saving.
+   */
+  n_levels = 1;
+
+  while ((roi->width  >> (n_levels - 1)) > tile_width ||
+         (roi->height >> (n_levels - 1)) > tile_height)
+    {
+      n_levels++;
+    }
+
+  /* the header is written last, once the index is known; reserve room for
+   * it, and start the tile data at an aligned offset.
+   */
+  success = save_write (info, &info->header, sizeof (GeglBufferHeader)) &&
+            save_pad (info, GEGL_FILE_TILE_ALIGNMENT);
+
+  for (z = 0; success && z < n_levels && ! gegl_rectangle_is_empty (roi); z++)
+    {
+      gint x0 = gegl_tile_indice (roi->x, tile_width << z);
+      gint y0 = gegl_tile_indice (roi->y, tile_height << z);
+      gint x1 = gegl_tile_indice (roi->x + roi->width - 1, tile_width << z);
+      gint y1 = gegl_tile_indice (roi->y + roi->height - 1, tile_height << z);
+      gint x;
+      gint y;
+
+      /* the tiles are written in the order of the index, by row */
+      for (y = y0; success && y <= y1; y++)
+        for (x = x0; success && x <= x1; x++)
           {
-            gint tiledy  = roi->y + bufy;
-            gint offsety = gegl_tile_offset (tiledy, tile_height);
-            gint bufx    = roi->x;
-
-            while (bufx < roi->x + roi->width)
-              {
-                gint tiledx  = roi->x + bufx;
-                gint offsetx = gegl_tile_offset (tiledx, tile_width);
-
-                gint tx = gegl_tile_indice (tiledx / factor, tile_width);
-                gint ty = gegl_tile_indice (tiledy / factor, tile_height);
-
-                if (gegl_tile_source_exist (GEGL_TILE_SOURCE (buffer), tx, ty, z))
-                  {
-                    GeglBufferTile *entry;
-
-                    GEGL_NOTE (GEGL_DEBUG_BUFFER_SAVE,
-                               "Found tile to save, tx, ty, z = %d, %d, %d",
-                               tx, ty, z);
-
-                    entry = gegl_tile_entry_new (tx, ty, z);
-                    info->tiles = g_list_prepend (info->tiles, entry);
-                    info->entry_count++;
-                  }
-                bufx += (tile_width - offsetx) * factor;
-              }
-            bufy += (tile_height - offsety) * factor;
+            if (! gegl_tile_source_exist (GEGL_TILE_SOURCE (buffer), x, y, z))
+              continue;
+
+            GEGL_NOTE (GEGL_DEBUG_BUFFER_SAVE,
+                       "saving tile, tx, ty, z = %d, %d, %d", x, y, z);
+
+            success = save_tile (info, buffer, compression, scratch, bpp,
+                                 x, y, z);
+
+            max_z = MAX (max_z, z);
           }
-        factor *= 2;
-      }
-  GEGL_NOTE (GEGL_DEBUG_BUFFER_SAVE,
-             "size of list of tiles to be written: %d",
-             g_list_length (info->tiles));
-  }
+    }
 
-  /* sort the list of tiles into zorder */
-  info->tiles = g_list_sort (info->tiles, z_order_compare);
+  g_free (scratch);
 
-  /* set the offset in the file each tile will be stored on */
-  {
-    GList *iter;
-    gint   predicted_offset = sizeof (GeglBufferHeader) +
-                              sizeof (GeglBufferTile) * (info->entry_count);
-    for (iter = info->tiles; iter; iter = iter->next)
-      {
-        GeglBufferTile *entry = iter->data;
-        entry->block.next = iter->next?
-                            (prediction += sizeof (GeglBufferTile)):0;
-        entry->offset = predicted_offset;
-        predicted_offset += info->tile_size;
-      }
-  }
+  GEGL_NOTE (GEGL_DEBUG_BUFFER_SAVE,
+             "number of tiles written: %d", info->entries->len);
 
-  /* save the header */
-  {
-    ssize_t ret = write (info->o, &info->header, sizeof (GeglBufferHeader));
-	if (ret != -1)
-      info->offset += ret;
-  }
-  g_assert (info->offset == info->header.next);
+  /* when all tiles are stored as is, write the index as a linked list too,
+   * so that revision 0 readers can still read the file; otherwise, mark it
+   * with a magic they don't accept.
+   */
+  if (success)
+    success = save_linked_index (info);
 
-  /* save the index */
-  {
-    GList *iter;
-    for (iter = info->tiles; iter; iter = iter->next)
-      {
-        GeglBufferItem *item = iter->data;
+  /* write the index after the tile data, and point the header at it */
+  if (success)
+    {
+      gsize index_size = info->entries->len * sizeof (GeglBufferIndexEntry);
 
-        write_block (info, &item->block);
+      success = save_pad (info, 16);
 
-      }
-  }
-  write_block (info, NULL); /* terminate the index */
+      info->header.index_offset   = info->offset;
+      info->header.n_entries      = info->entries->len;
+      info->header.index_checksum = gegl_buffer_checksum (info->entries->data,
+                                                          index_size);
+      info->header.n_levels       = max_z + 1;
 
-  /* update header to point to start of new index (already done for
-   * this serial saver, and the header is already written.
-   */
+      success = success && save_write (info, info->entries->data, index_size);
+    }
 
-  /* save each tile */
-  {
-    GList *iter;
-    gint   i = 0;
-    for (iter = info->tiles; iter; iter = iter->next)
-      {
-        GeglBufferTile *entry = iter->data;
-        guchar          *data;
-        GeglTile        *tile;
-
-        tile = gegl_tile_source_get_tile (GEGL_TILE_SOURCE (buffer),
-                                          entry->x,
-                                          entry->y,
-                                          entry->z);
-        g_assert (tile);
-        data = gegl_tile_get_data (tile);
-        g_assert (data);
-
-        g_assert (info->offset == entry->offset);
+  if (success)
+    {
+      if (lseek (info->o, 0, SEEK_SET) == -1)
         {
-          ssize_t ret = write (info->o, data, info->tile_size);
-	      if (ret != -1)
-            info->offset += ret;
+          g_warning ("%s: failed seeking in '%s'", G_STRFUNC, info->tmp_path);
+          success = FALSE;
         }
-        gegl_tile_unref (tile);
-        i++;
-      }
-  }
+      else
+        {
+          success = save_write (info, &info->header, sizeof (GeglBufferHeader));
+        }
+    }
+
+  if (success)
+    {
+      /* make sure the data is on disk before the file replaces the old
+       * one, so that a crash can't leave a truncated file at path.
+       */
+      if (fsync (info->o) == -1)
+        {
+          g_warning ("%s: Could not sync '%s': %s",
+                     G_STRFUNC, info->tmp_path, g_strerror (errno));
+          close (info->o);
+          success = FALSE;
+        }
+      else if (close (info->o) == -1)
+        {
+          g_warning ("%s: Could not write to '%s': %s",
+                     G_STRFUNC, info->tmp_path, g_strerror (errno));
+          success = FALSE;
+        }
+      else if (g_rename (info->tmp_path, info->path) == -1)
+        {
+          g_warning ("%s: Could not replace '%s': %s",
+                     G_STRFUNC, info->path, g_strerror (errno));
+          success = FALSE;
+        }
+
+      if (! success)
+        g_unlink (info->tmp_path);
+
+      info->o = -1;
+    }
+
   save_info_destroy (info);
 }
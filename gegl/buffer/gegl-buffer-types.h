@@ -42,6 +42,11 @@ struct _GeglTileBackendPrivate
   gpointer               storage;
   gboolean               shared;
 
+  /* the highest mipmap level the backend stores tiles for, as loaded from
+   * a file; these have to be voided when the levels below change.
+   */
+  gint                   max_z;
+
   GeglTileSourceCommand  command;
 };
 
@@ -43,6 +43,8 @@
 #include "gegl-buffer-private.h"
 #include "gegl-rectangle.h"
 #include "gegl-tile-storage.h"
+#include "gegl-tile-handler-chain.h"
+#include "gegl-tile-handler-zoom.h"
 #include "gegl-tile-backend-file.h"
 #include "gegl-tile-backend-swap.h"
 #include "gegl-tile-backend-ram.h"
@@ -386,6 +388,16 @@ gegl_buffer_dispose (GObject *object)
 
   _gegl_buffer_drop_hot_tile (buffer);
 
+  if (buffer->tile_table)
+    {
+      GeglTileTable *table = buffer->tile_table;
+
+      g_atomic_pointer_set (&buffer->tile_table, NULL);
+      gegl_tile_table_free (table);
+
+      buffer->freeze_count = 0;
+    }
+
   if (buffer->backend)
     {
       g_object_unref (buffer->backend);
@@ -1201,9 +1213,24 @@ gegl_buffer_get_tile (GeglBuffer *buffer,
                       gint        z)
 {
   GeglTileSource  *source  = (GeglTileSource*)buffer;
+  GeglTileTable   *table;
   GeglTile *tile;
 
   g_assert (source);
+
+  /* if the buffer is frozen, look the tile up without locking first */
+  table = gegl_tile_table_acquire (&buffer->tile_table);
+
+  if (table)
+    {
+      tile = gegl_tile_table_lookup (table, x, y, z);
+
+      gegl_tile_table_release (table);
+
+      if (tile)
+        return tile;
+    }
+
   {
   GeglTileStorage *tile_storage = buffer->tile_storage;
   g_assert (tile_storage);
@@ -1216,9 +1243,183 @@ gegl_buffer_get_tile (GeglBuffer *buffer,
   g_rec_mutex_unlock (&tile_storage->mutex);
   }
 
+  /* the table is released while fetching the tile, since the tile may come
+   * from another buffer, which would need to acquire its own table.
+   */
+  if (table && tile)
+    {
+      table = gegl_tile_table_acquire (&buffer->tile_table);
+
+      if (table)
+        {
+          gegl_tile_table_insert (table, tile);
+
+          gegl_tile_table_release (table);
+        }
+    }
+
   return tile;
 }
 
+void
+gegl_buffer_freeze (GeglBuffer *buffer)
+{
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+
+  g_rec_mutex_lock (&buffer->tile_storage->mutex);
+
+  if (buffer->freeze_count++ == 0)
+    {
+      const GeglRectangle *abyss    = &buffer->abyss;
+      gint                 n_tiles  = 0;
+      gint                 max_n_tiles;
+
+      if (! gegl_rectangle_is_empty (abyss) &&
+          ! gegl_rectangle_is_infinite_plane (abyss))
+        {
+          gint64 n = (gint64) (abyss->width  / buffer->tile_width  + 2) *
+                     (gint64) (abyss->height / buffer->tile_height + 2);
+
+          /* leave room for the pyramid levels */
+          n_tiles = MIN (n + n / 3, G_MAXINT / 2);
+        }
+
+      /* the table keeps its tiles in the cache, so don't let it hold more
+       * than half of it.
+       */
+      max_n_tiles = MIN (gegl_buffer_config ()->tile_cache_size / 2 /
+                         buffer->tile_storage->tile_size,
+                         GEGL_BUFFER_MAX_FROZEN_TILES);
+
+      if (n_tiles > 0)
+        max_n_tiles = MIN (max_n_tiles, n_tiles);
+
+      if (max_n_tiles > 0)
+        {
+          g_atomic_pointer_set (&buffer->tile_table,
+                                gegl_tile_table_new (2 * max_n_tiles,
+                                                     max_n_tiles));
+        }
+    }
+
+  g_rec_mutex_unlock (&buffer->tile_storage->mutex);
+}
+
+void
+gegl_buffer_thaw (GeglBuffer *buffer)
+{
+  GeglTileTable *table = NULL;
+
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+  g_return_if_fail (buffer->freeze_count > 0);
+
+  g_rec_mutex_lock (&buffer->tile_storage->mutex);
+
+  if (--buffer->freeze_count == 0)
+    {
+      table = buffer->tile_table;
+
+      g_atomic_pointer_set (&buffer->tile_table, NULL);
+    }
+
+  g_rec_mutex_unlock (&buffer->tile_storage->mutex);
+
+  gegl_tile_table_free (table);
+}
+
+/* hints the buffer that the tiles intersecting @rect, at @level, are going to
+ * be accessed soon, so that their data can be fetched ahead of time.  only
+ * the swap backend currently makes use of the hint.
+ */
+void
+gegl_buffer_prefetch (GeglBuffer          *buffer,
+                      const GeglRectangle *rect,
+                      gint                 level)
+{
+  GeglTileStorage *tile_storage = buffer->tile_storage;
+  GeglTileBackend *backend      = gegl_buffer_backend (buffer);
+  gint             tile_width   = buffer->tile_width;
+  gint             tile_height  = buffer->tile_height;
+  gint             x1, y1;
+  gint             x2, y2;
+  gint             x,  y;
+
+  if (! backend || ! GEGL_IS_TILE_BACKEND_SWAP (backend) ||
+      gegl_rectangle_is_empty (rect))
+    {
+      return;
+    }
+
+  x1 = gegl_tile_indice (rect->x + buffer->shift_x, tile_width);
+  y1 = gegl_tile_indice (rect->y + buffer->shift_y, tile_height);
+  x2 = gegl_tile_indice (rect->x + rect->width  - 1 + buffer->shift_x, tile_width);
+  y2 = gegl_tile_indice (rect->y + rect->height - 1 + buffer->shift_y, tile_height);
+
+  g_rec_mutex_lock (&tile_storage->mutex);
+
+  for (y = y1; y <= y2; y++)
+    {
+      for (x = x1; x <= x2; x++)
+        {
+          gegl_tile_source_command (GEGL_TILE_SOURCE (buffer),
+                                    GEGL_TILE_PREFETCH,
+                                    x, y, level, NULL);
+        }
+    }
+
+  g_rec_mutex_unlock (&tile_storage->mutex);
+}
+
+void
+gegl_buffer_build_pyramid (GeglBuffer          *buffer,
+                           const GeglRectangle *rect,
+                           gint                 max_level)
+{
+  GeglTileHandlerZoom *zoom;
+  GeglRectangle        roi;
+  gint                 tile_width;
+  gint                 tile_height;
+  gint                 z;
+
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+
+  if (! rect)
+    rect = gegl_buffer_get_extent (buffer);
+
+  if (! gegl_rectangle_intersect (&roi, rect, &buffer->abyss))
+    return;
+
+  zoom = (GeglTileHandlerZoom *) gegl_tile_handler_chain_get_first (
+    GEGL_TILE_HANDLER_CHAIN (buffer->tile_storage),
+    GEGL_TYPE_TILE_HANDLER_ZOOM);
+
+  if (! zoom)
+    return;
+
+  tile_width  = buffer->tile_width;
+  tile_height = buffer->tile_height;
+
+  roi.x += buffer->shift_x;
+  roi.y += buffer->shift_y;
+
+  /* build the levels bottom-up, so that each level is downscaled from
+   * already-built tiles.
+   */
+  for (z = 1; z <= (max_level < 0 ? GEGL_BUFFER_MAX_PYRAMID_LEVEL : max_level);
+       z++)
+    {
+      gint x1 = gegl_tile_indice (roi.x,                  tile_width  << z);
+      gint y1 = gegl_tile_indice (roi.y,                  tile_height << z);
+      gint x2 = gegl_tile_indice (roi.x + roi.width  - 1, tile_width  << z);
+      gint y2 = gegl_tile_indice (roi.y + roi.height - 1, tile_height << z);
+
+      gegl_tile_handler_zoom_build (zoom, x1, y1, x2, y2, z);
+
+      if (max_level < 0 && x1 == x2 && y1 == y2)
+        break;
+    }
+}
+
 void (*gegl_tile_handler_cache_ext_flush) (void *cache, const GeglRectangle *rect)=NULL;
 void (*gegl_buffer_ext_flush) (GeglBuffer *buffer, const GeglRectangle *rect)=NULL;
 void (*gegl_buffer_ext_invalidate) (GeglBuffer *buffer, const GeglRectangle *rect)=NULL;
@@ -122,6 +122,15 @@ GeglBuffer *    gegl_buffer_open              (const gchar         *path);
  * written to disk.
  *
  * Write a GeglBuffer to a file.
+ *
+ * Along with the tiles of @roi, the file stores the downscaled mipmap
+ * levels of @roi, used for zoomed-out views of the loaded buffer.  The
+ * tiles are compressed using the algorithm named by the "file-compression"
+ * property of gegl_config(), if set.
+ *
+ * The buffer is written to a temporary file next to @path, which then
+ * replaces @path, so buffers mapped from the old file by
+ * gegl_buffer_load_mapped() keep their data.
  */
 void            gegl_buffer_save              (GeglBuffer          *buffer,
                                                const gchar         *path,
@@ -135,10 +144,30 @@ void            gegl_buffer_save              (GeglBuffer          *buffer,
  * gegl_buffer_save it should be possible to open through any GIO transport, buffers
  * that have been used as swap needs random access to be opened.
  *
+ * The tiles are read into memory when loading the file, so the file can be
+ * modified, or replaced, afterwards.
+ *
  * Returns: (transfer full): a #GeglBuffer object.
  */
 GeglBuffer *     gegl_buffer_load             (const gchar         *path);
 
+/**
+ * gegl_buffer_load_mapped:
+ * @path: the path to a gegl buffer on disk.
+ *
+ * Loads an existing GeglBuffer from disk, like gegl_buffer_load(), but
+ * memory-maps the file when possible, using its tiles in place rather than
+ * reading them into memory up front.  The file must not be modified, or
+ * truncated, for as long as the buffer exists; replacing it, as
+ * gegl_buffer_save() does, is fine.  Changes made to the returned buffer are
+ * never written back to the file.
+ *
+ * Files that can't be mapped are loaded with gegl_buffer_load().
+ *
+ * Returns: (transfer full): a #GeglBuffer object.
+ */
+GeglBuffer *     gegl_buffer_load_mapped      (const gchar         *path);
+
 /**
  * gegl_buffer_flush:
  * @buffer: a #GeglBuffer
@@ -148,6 +177,50 @@ GeglBuffer *     gegl_buffer_load             (const gchar         *path);
  */
 void            gegl_buffer_flush             (GeglBuffer          *buffer);
 
+/**
+ * gegl_buffer_freeze:
+ * @buffer: a #GeglBuffer
+ *
+ * Marks @buffer as immutable, until a matching call to gegl_buffer_thaw().
+ * While the buffer is frozen, its tiles are looked up without locking, so
+ * that many threads can read from it concurrently, for example while
+ * sampling it, without contending over the buffer's locks.
+ *
+ * The buffer, and any other buffer sharing its storage, must not be modified
+ * while it's frozen, and all reads that may have started while it's frozen
+ * must be done before the last matching gegl_buffer_thaw().  Calls to
+ * gegl_buffer_freeze() may be nested.
+ */
+void            gegl_buffer_freeze            (GeglBuffer          *buffer);
+
+/**
+ * gegl_buffer_thaw:
+ * @buffer: a #GeglBuffer
+ *
+ * Undoes a previous call to gegl_buffer_freeze().  Once the buffer is no
+ * longer frozen, it may be modified again.
+ */
+void            gegl_buffer_thaw              (GeglBuffer          *buffer);
+
+/**
+ * gegl_buffer_build_pyramid:
+ * @buffer: a #GeglBuffer
+ * @rect: (allow-none): the area to build the levels of, or %NULL for the
+ *        whole extent
+ * @max_level: the highest level to build, or -1 to build all levels, up to
+ *             the one where @rect fits in a single tile
+ *
+ * Builds the mipmap levels of @buffer covering @rect, downscaling the tiles of
+ * each level in parallel.  Levels are otherwise built tile by tile, when
+ * first accessed, so calling this once writes to @buffer have settled, from
+ * an idle handler or a worker thread, makes subsequent zoomed-out reads of
+ * @buffer cheaper.  The buffer is only locked intermittently, and other
+ * threads may keep accessing it while the levels are being built.
+ */
+void            gegl_buffer_build_pyramid     (GeglBuffer          *buffer,
+                                               const GeglRectangle *rect,
+                                               gint                 max_level);
+
 
 /**
  * gegl_buffer_create_sub_buffer:
@@ -260,7 +333,13 @@ gboolean          gegl_buffer_set_abyss      (GeglBuffer          *buffer,
  * this argument also takes a GEGL_BUFFER_FILTER value or'ed into it, allowing
  * to specify trade-off of performance/quality, valid values are:
  * GEGL_BUFFER_FILTER_NEAREST, GEGL_BUFFER_FILTER_BILINEAR,
- * GEGL_BUFFER_FILTER_BOX and GEGL_BUFFER_FILTER_AUTO.
+ * GEGL_BUFFER_FILTER_BOX, GEGL_BUFFER_FILTER_LANCZOS,
+ * GEGL_BUFFER_FILTER_MITCHELL and GEGL_BUFFER_FILTER_AUTO.  The Lanczos and
+ * Mitchell filters resample in premultiplied linear light, and are also
+ * used for scales above 1.0.  Since their addition, the filter occupies
+ * bits 4 to 6 of @repeat_mode, and GEGL_BUFFER_FILTER_ALL is 112 rather
+ * than 48; code masking @repeat_mode with a hard-coded value, or built
+ * against older headers, has to be updated.
  *
  * Fetch a rectangular linear buffer of pixel data from the GeglBuffer, the
  * data is converted to the desired BablFormat, if the BablFormat stored and
@@ -580,6 +659,38 @@ void              gegl_sampler_get            (GeglSampler       *sampler,
                                                void              *output,
                                                GeglAbyssPolicy   repeat_mode);
 
+/**
+ * gegl_sampler_get_span: (skip)
+ * @sampler: a GeglSampler gotten from gegl_buffer_sampler_new
+ * @x: x coordinate of the first sample
+ * @y: y coordinate of the first sample
+ * @dx: x coordinate increment between consecutive samples
+ * @dy: y coordinate increment between consecutive samples
+ * @scale: matrix representing extent of sampling area in source buffer,
+ * shared by all samples.
+ * @output: memory location for @n consecutive output pixels.
+ * @n: number of samples
+ * @repeat_mode: how requests outside the buffer extent are handled.
+ *
+ * Performs @n samplings with the provided @sampler, along a line starting at
+ * (@x, @y), and advancing by (@dx, @dy) between samples, such as a row of
+ * an affinely-transformed image.  This is equivalent to calling the function
+ * returned by gegl_sampler_get_fun() for each sample, but converts the
+ * samples to the output format in batches.  The linear and cubic samplers
+ * also fetch the source pixels for runs of samples at once, rather than per
+ * sample, and the nearest sampler copies them straight from the tiles; the
+ * other samplers still interpolate each sample separately.
+ */
+void              gegl_sampler_get_span       (GeglSampler       *sampler,
+                                               gdouble            x,
+                                               gdouble            y,
+                                               gdouble            dx,
+                                               gdouble            dy,
+                                               GeglBufferMatrix2 *scale,
+                                               void              *output,
+                                               gint               n,
+                                               GeglAbyssPolicy    repeat_mode);
+
 /* code template utility, updates the jacobian matrix using
  * a user defined mapping function for displacement, example
  * with an identity transform (note that for the identity
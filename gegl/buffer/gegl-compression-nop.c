@@ -0,0 +1,93 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "gegl-compression.h"
+#include "gegl-compression-nop.h"
+
+
+static gboolean   gegl_compression_nop_compress   (const GeglCompression *compression,
+                                                   gint                   bpp,
+                                                   gconstpointer          data,
+                                                   gint                   n,
+                                                   gpointer               compressed,
+                                                   gint                  *compressed_size,
+                                                   gint                   max_compressed_size);
+static gboolean   gegl_compression_nop_decompress (const GeglCompression *compression,
+                                                   gint                   bpp,
+                                                   gpointer               data,
+                                                   gint                   n,
+                                                   gconstpointer          compressed,
+                                                   gint                   compressed_size);
+
+
+static const GeglCompression compression_nop =
+{
+  .compress   = gegl_compression_nop_compress,
+  .decompress = gegl_compression_nop_decompress
+};
+
+
+static gboolean
+gegl_compression_nop_compress (const GeglCompression *compression,
+                               gint                   bpp,
+                               gconstpointer          data,
+                               gint                   n,
+                               gpointer               compressed,
+                               gint                  *compressed_size,
+                               gint                   max_compressed_size)
+{
+  gint size = bpp * n;
+
+  if (size > max_compressed_size)
+    return FALSE;
+
+  memcpy (compressed, data, size);
+
+  *compressed_size = size;
+
+  return TRUE;
+}
+
+static gboolean
+gegl_compression_nop_decompress (const GeglCompression *compression,
+                                 gint                   bpp,
+                                 gpointer               data,
+                                 gint                   n,
+                                 gconstpointer          compressed,
+                                 gint                   compressed_size)
+{
+  gint size = bpp * n;
+
+  if (compressed_size != size)
+    return FALSE;
+
+  memcpy (data, compressed, size);
+
+  return TRUE;
+}
+
+
+void
+gegl_compression_nop_init (void)
+{
+  gegl_compression_register ("nop", &compression_nop);
+}
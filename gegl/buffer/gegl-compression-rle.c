@@ -0,0 +1,264 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "gegl-compression.h"
+#include "gegl-compression-rle.h"
+
+
+/* the compressed data starts with a single byte, specifying its layout:
+ *
+ *   UNIFORM:  all the pixels are identical.  followed by a single pixel.
+ *
+ *   PLANAR:   followed by each of the bpp byte-planes of the data, in order,
+ *             encoded as a sequence of packets.  each packet starts with a
+ *             header byte h; if h < 128, it's followed by h + 1 literal
+ *             bytes; otherwise, it's followed by a single byte, repeated
+ *             h - 126 times.
+ *
+ * splitting the data into byte-planes lets us catch runs in the individual
+ * components, in particular, in the exponent and upper mantissa bytes of
+ * smooth float data, and in the alpha channel.
+ */
+#define LAYOUT_UNIFORM 0
+#define LAYOUT_PLANAR  1
+
+#define MAX_LITERAL    128
+#define MIN_RUN        2
+#define MAX_RUN        (255 - 126)
+
+
+static gboolean   gegl_compression_rle_compress   (const GeglCompression *compression,
+                                                   gint                   bpp,
+                                                   gconstpointer          data,
+                                                   gint                   n,
+                                                   gpointer               compressed,
+                                                   gint                  *compressed_size,
+                                                   gint                   max_compressed_size);
+static gboolean   gegl_compression_rle_decompress (const GeglCompression *compression,
+                                                   gint                   bpp,
+                                                   gpointer               data,
+                                                   gint                   n,
+                                                   gconstpointer          compressed,
+                                                   gint                   compressed_size);
+
+
+static const GeglCompression compression_rle =
+{
+  .compress   = gegl_compression_rle_compress,
+  .decompress = gegl_compression_rle_decompress
+};
+
+
+static gboolean
+gegl_compression_rle_is_uniform (gint          bpp,
+                                 const guchar *data,
+                                 gint          n)
+{
+  const guchar *p = data + bpp;
+  gint          i;
+
+  for (i = 1; i < n; i++, p += bpp)
+    {
+      if (memcmp (p, data, bpp))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gegl_compression_rle_compress (const GeglCompression *compression,
+                               gint                   bpp,
+                               gconstpointer          data,
+                               gint                   n,
+                               gpointer               compressed,
+                               gint                  *compressed_size,
+                               gint                   max_compressed_size)
+{
+  const guchar *src     = data;
+  guchar       *dst     = compressed;
+  guchar       *dst_end = dst + max_compressed_size;
+  gint          p;
+
+  if (max_compressed_size < 1 + bpp)
+    return FALSE;
+
+  if (n > 0 && gegl_compression_rle_is_uniform (bpp, src, n))
+    {
+      *dst++ = LAYOUT_UNIFORM;
+
+      memcpy (dst, src, bpp);
+      dst += bpp;
+
+      *compressed_size = dst - (guchar *) compressed;
+
+      return TRUE;
+    }
+
+  *dst++ = LAYOUT_PLANAR;
+
+  for (p = 0; p < bpp; p++)
+    {
+      const guchar *s = src + p;
+      gint          i = 0;
+
+      while (i < n)
+        {
+          guchar value = s[i * bpp];
+          gint   run   = 1;
+
+          while (i + run < n && run < MAX_RUN && s[(i + run) * bpp] == value)
+            run++;
+
+          if (run >= MIN_RUN)
+            {
+              if (dst_end - dst < 2)
+                return FALSE;
+
+              *dst++ = run + 126;
+              *dst++ = value;
+
+              i += run;
+            }
+          else
+            {
+              gint start = i;
+              gint length;
+              gint j;
+
+              /* extend the literal up to the start of the next run */
+              for (i++;
+                   i < n                   &&
+                   i - start < MAX_LITERAL &&
+                   ! (i + 1 < n && s[i * bpp] == s[(i + 1) * bpp]);
+                   i++);
+
+              length = i - start;
+
+              if (dst_end - dst < 1 + length)
+                return FALSE;
+
+              *dst++ = length - 1;
+
+              for (j = start; j < i; j++)
+                *dst++ = s[j * bpp];
+            }
+        }
+    }
+
+  *compressed_size = dst - (guchar *) compressed;
+
+  return TRUE;
+}
+
+static gboolean
+gegl_compression_rle_decompress (const GeglCompression *compression,
+                                 gint                   bpp,
+                                 gpointer               data,
+                                 gint                   n,
+                                 gconstpointer          compressed,
+                                 gint                   compressed_size)
+{
+  const guchar *src     = compressed;
+  const guchar *src_end = src + compressed_size;
+  guchar       *dst     = data;
+  gint          p;
+
+  if (compressed_size < 1)
+    return FALSE;
+
+  switch (*src++)
+    {
+    case LAYOUT_UNIFORM:
+      {
+        gint i;
+
+        if (src_end - src != bpp)
+          return FALSE;
+
+        for (i = 0; i < n; i++, dst += bpp)
+          memcpy (dst, src, bpp);
+
+        return TRUE;
+      }
+
+    case LAYOUT_PLANAR:
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  for (p = 0; p < bpp; p++)
+    {
+      guchar *d = dst + p;
+      gint    i = 0;
+
+      while (i < n)
+        {
+          gint header;
+          gint j;
+
+          if (src == src_end)
+            return FALSE;
+
+          header = *src++;
+
+          if (header < MAX_LITERAL)
+            {
+              gint length = header + 1;
+
+              if (i + length > n || src_end - src < length)
+                return FALSE;
+
+              for (j = 0; j < length; j++)
+                d[(i + j) * bpp] = *src++;
+
+              i += length;
+            }
+          else
+            {
+              gint   run = header - 126;
+              guchar value;
+
+              if (i + run > n || src == src_end)
+                return FALSE;
+
+              value = *src++;
+
+              for (j = 0; j < run; j++)
+                d[(i + j) * bpp] = value;
+
+              i += run;
+            }
+        }
+    }
+
+  return src == src_end;
+}
+
+
+void
+gegl_compression_rle_init (void)
+{
+  gegl_compression_register ("rle", &compression_rle);
+}
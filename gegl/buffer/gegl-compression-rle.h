@@ -0,0 +1,30 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GEGL_COMPRESSION_RLE_H__
+#define __GEGL_COMPRESSION_RLE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+
+void   gegl_compression_rle_init (void);
+
+
+G_END_DECLS
+
+#endif /* __GEGL_COMPRESSION_RLE_H__ */
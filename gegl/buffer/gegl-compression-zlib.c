@@ -0,0 +1,129 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "gegl-compression.h"
+#include "gegl-compression-zlib.h"
+
+
+#ifdef HAVE_ZLIB
+
+
+typedef struct
+{
+  GeglCompression compression;
+  gint            level;
+} GeglCompressionZlib;
+
+
+static gboolean   gegl_compression_zlib_compress   (const GeglCompression *compression,
+                                                    gint                   bpp,
+                                                    gconstpointer          data,
+                                                    gint                   n,
+                                                    gpointer               compressed,
+                                                    gint                  *compressed_size,
+                                                    gint                   max_compressed_size);
+static gboolean   gegl_compression_zlib_decompress (const GeglCompression *compression,
+                                                    gint                   bpp,
+                                                    gpointer               data,
+                                                    gint                   n,
+                                                    gconstpointer          compressed,
+                                                    gint                   compressed_size);
+
+
+static GeglCompressionZlib compression_zlib[9];
+
+
+static gboolean
+gegl_compression_zlib_compress (const GeglCompression *compression,
+                                gint                   bpp,
+                                gconstpointer          data,
+                                gint                   n,
+                                gpointer               compressed,
+                                gint                  *compressed_size,
+                                gint                   max_compressed_size)
+{
+  const GeglCompressionZlib *zlib = (const GeglCompressionZlib *) compression;
+  uLongf                     size = max_compressed_size;
+
+  if (compress2 (compressed, &size,
+                 data, (uLong) bpp * n,
+                 zlib->level) != Z_OK)
+    {
+      return FALSE;
+    }
+
+  *compressed_size = size;
+
+  return TRUE;
+}
+
+static gboolean
+gegl_compression_zlib_decompress (const GeglCompression *compression,
+                                  gint                   bpp,
+                                  gpointer               data,
+                                  gint                   n,
+                                  gconstpointer          compressed,
+                                  gint                   compressed_size)
+{
+  uLongf size = (uLongf) bpp * n;
+
+  return uncompress (data, &size, compressed, compressed_size) == Z_OK &&
+         size == (uLongf) bpp * n;
+}
+
+
+void
+gegl_compression_zlib_init (void)
+{
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (compression_zlib); i++)
+    {
+      gchar name[16];
+
+      compression_zlib[i].compression.compress   = gegl_compression_zlib_compress;
+      compression_zlib[i].compression.decompress = gegl_compression_zlib_decompress;
+      compression_zlib[i].level                  = i + 1;
+
+      g_snprintf (name, sizeof (name), "zlib%d", i + 1);
+
+      gegl_compression_register (name, &compression_zlib[i].compression);
+    }
+
+  gegl_compression_register_alias ("zlib",
+                                   "zlib6",
+                                   NULL);
+}
+
+
+#else /* ! HAVE_ZLIB */
+
+
+void
+gegl_compression_zlib_init (void)
+{
+}
+
+
+#endif /* ! HAVE_ZLIB */
@@ -0,0 +1,221 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "gegl-compression.h"
+#include "gegl-compression-nop.h"
+#include "gegl-compression-rle.h"
+#include "gegl-compression-zlib.h"
+
+
+static GHashTable *algorithms = NULL;
+static GHashTable *names      = NULL;
+
+
+void
+gegl_compression_init (void)
+{
+  g_return_if_fail (algorithms == NULL);
+
+  algorithms = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                      g_free, NULL);
+  names      = g_hash_table_new_full (NULL, NULL,
+                                      NULL, g_free);
+
+  gegl_compression_nop_init ();
+  gegl_compression_rle_init ();
+  gegl_compression_zlib_init ();
+
+  /* generic names, resolving to the best available algorithm for a given
+   * speed/ratio trade-off
+   */
+  gegl_compression_register_alias ("fast",
+                                   "rle",
+                                   NULL);
+  gegl_compression_register_alias ("balanced",
+                                   "zlib1",
+                                   "rle",
+                                   NULL);
+  gegl_compression_register_alias ("best",
+                                   "zlib9",
+                                   "rle",
+                                   NULL);
+}
+
+void
+gegl_compression_cleanup (void)
+{
+  if (algorithms)
+    {
+      g_hash_table_unref (algorithms);
+
+      algorithms = NULL;
+    }
+
+  if (names)
+    {
+      g_hash_table_unref (names);
+
+      names = NULL;
+    }
+}
+
+void
+gegl_compression_register (const gchar           *name,
+                           const GeglCompression *compression)
+{
+  g_return_if_fail (name != NULL);
+  g_return_if_fail (compression != NULL);
+
+  g_hash_table_insert (algorithms, g_strdup (name), (gpointer) compression);
+
+  /* remember the name the algorithm was first registered under, so that
+   * aliases map back to it
+   */
+  if (! g_hash_table_contains (names, compression))
+    g_hash_table_insert (names, (gpointer) compression, g_strdup (name));
+}
+
+/* registers @name as an alias to the first registered algorithm out of the
+ * NULL-terminated list of names following it.
+ */
+void
+gegl_compression_register_alias (const gchar *name,
+                                 ...)
+{
+  const gchar *to;
+  va_list      args;
+
+  g_return_if_fail (name != NULL);
+
+  va_start (args, name);
+
+  while ((to = va_arg (args, const gchar *)))
+    {
+      const GeglCompression *compression = gegl_compression (to);
+
+      if (compression)
+        {
+          gegl_compression_register (name, compression);
+
+          break;
+        }
+    }
+
+  va_end (args);
+}
+
+static gint
+gegl_compression_list_compare (gconstpointer a,
+                               gconstpointer b)
+{
+  return strcmp (*(const gchar **) a, *(const gchar **) b);
+}
+
+/* returns a sorted, NULL-terminated array of the registered algorithm names.
+ * the array should be freed with g_free(), but not its elements.
+ */
+const gchar **
+gegl_compression_list (void)
+{
+  const gchar    **names;
+  GHashTableIter   iter;
+  gpointer         key;
+  gint             i = 0;
+
+  names = g_new (const gchar *, g_hash_table_size (algorithms) + 1);
+
+  g_hash_table_iter_init (&iter, algorithms);
+
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    names[i++] = key;
+
+  names[i] = NULL;
+
+  qsort (names, i, sizeof (const gchar *), gegl_compression_list_compare);
+
+  return names;
+}
+
+const GeglCompression *
+gegl_compression (const gchar *name)
+{
+  g_return_val_if_fail (name != NULL, NULL);
+
+  return g_hash_table_lookup (algorithms, name);
+}
+
+/* returns the name @compression was registered under, which, unlike the
+ * generic names, resolves to the same algorithm regardless of which
+ * algorithms are available.
+ */
+const gchar *
+gegl_compression_get_name (const GeglCompression *compression)
+{
+  g_return_val_if_fail (compression != NULL, NULL);
+
+  return g_hash_table_lookup (names, compression);
+}
+
+gboolean
+gegl_compression_compress (const GeglCompression *compression,
+                           gint                   bpp,
+                           gconstpointer          data,
+                           gint                   n,
+                           gpointer               compressed,
+                           gint                  *compressed_size,
+                           gint                   max_compressed_size)
+{
+  g_return_val_if_fail (compression != NULL, FALSE);
+  g_return_val_if_fail (bpp > 0, FALSE);
+  g_return_val_if_fail (data != NULL || n == 0, FALSE);
+  g_return_val_if_fail (n >= 0, FALSE);
+  g_return_val_if_fail (compressed != NULL || max_compressed_size == 0, FALSE);
+  g_return_val_if_fail (compressed_size != NULL, FALSE);
+  g_return_val_if_fail (max_compressed_size >= 0, FALSE);
+
+  return compression->compress (compression,
+                                bpp, data, n,
+                                compressed, compressed_size,
+                                max_compressed_size);
+}
+
+gboolean
+gegl_compression_decompress (const GeglCompression *compression,
+                             gint                   bpp,
+                             gpointer               data,
+                             gint                   n,
+                             gconstpointer          compressed,
+                             gint                   compressed_size)
+{
+  g_return_val_if_fail (compression != NULL, FALSE);
+  g_return_val_if_fail (bpp > 0, FALSE);
+  g_return_val_if_fail (data != NULL || n == 0, FALSE);
+  g_return_val_if_fail (n >= 0, FALSE);
+  g_return_val_if_fail (compressed != NULL || compressed_size == 0, FALSE);
+  g_return_val_if_fail (compressed_size >= 0, FALSE);
+
+  return compression->decompress (compression,
+                                  bpp, data, n,
+                                  compressed, compressed_size);
+}
@@ -0,0 +1,81 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GEGL_COMPRESSION_H__
+#define __GEGL_COMPRESSION_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+
+typedef struct _GeglCompression GeglCompression;
+
+/* a compression algorithm, used to compress tile data.
+ *
+ * both functions operate on @n pixels, of @bpp bytes each.  compress()
+ * returns FALSE if the compressed data doesn't fit in @max_compressed_size
+ * bytes, in which case the data should be stored uncompressed.
+ */
+struct _GeglCompression
+{
+  gboolean (* compress)   (const GeglCompression *compression,
+                           gint                   bpp,
+                           gconstpointer          data,
+                           gint                   n,
+                           gpointer               compressed,
+                           gint                  *compressed_size,
+                           gint                   max_compressed_size);
+  gboolean (* decompress) (const GeglCompression *compression,
+                           gint                   bpp,
+                           gpointer               data,
+                           gint                   n,
+                           gconstpointer          compressed,
+                           gint                   compressed_size);
+};
+
+
+void                    gegl_compression_init           (void);
+void                    gegl_compression_cleanup        (void);
+
+void                    gegl_compression_register       (const gchar           *name,
+                                                         const GeglCompression *compression);
+void                    gegl_compression_register_alias (const gchar           *name,
+                                                         /* const gchar *to */ ...) G_GNUC_NULL_TERMINATED;
+
+const gchar          ** gegl_compression_list           (void);
+
+const GeglCompression * gegl_compression                (const gchar           *name);
+const gchar           * gegl_compression_get_name       (const GeglCompression *compression);
+
+gboolean                gegl_compression_compress       (const GeglCompression *compression,
+                                                         gint                   bpp,
+                                                         gconstpointer          data,
+                                                         gint                   n,
+                                                         gpointer               compressed,
+                                                         gint                  *compressed_size,
+                                                         gint                   max_compressed_size);
+gboolean                gegl_compression_decompress     (const GeglCompression *compression,
+                                                         gint                   bpp,
+                                                         gpointer               data,
+                                                         gint                   n,
+                                                         gconstpointer          compressed,
+                                                         gint                   compressed_size);
+
+
+G_END_DECLS
+
+#endif /* __GEGL_COMPRESSION_H__ */
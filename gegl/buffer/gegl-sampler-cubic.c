@@ -42,6 +42,15 @@ static void gegl_sampler_cubic_get      (      GeglSampler     *sampler,
                                                GeglBufferMatrix2*scale,
                                                void            *output,
                                                GeglAbyssPolicy  repeat_mode);
+static void gegl_sampler_cubic_get_span (      GeglSampler     *sampler,
+                                               gdouble          absolute_x,
+                                               gdouble          absolute_y,
+                                               gdouble          dx,
+                                               gdouble          dy,
+                                               GeglBufferMatrix2*scale,
+                                               void            *output,
+                                               gint             n,
+                                               GeglAbyssPolicy  repeat_mode);
 static void get_property                (      GObject         *gobject,
                                                guint            prop_id,
                                                GValue          *value,
@@ -67,7 +76,8 @@ gegl_sampler_cubic_class_init (GeglSamplerCubicClass *klass)
   object_class->get_property = get_property;
   object_class->finalize     = gegl_sampler_cubic_finalize;
 
-  sampler_class->get     = gegl_sampler_cubic_get;
+  sampler_class->get      = gegl_sampler_cubic_get;
+  sampler_class->get_span = gegl_sampler_cubic_get_span;
 
   g_object_class_install_property ( object_class, PROP_B,
     g_param_spec_double ("b",
@@ -152,6 +162,107 @@ gegl_sampler_cubic_init (GeglSamplerCubic *self)
     }
 }
 
+/*
+ * Locates a sample: computes the anchor pixel of the sample, as passed to
+ * gegl_sampler_get_ptr(), and its position relative to it.
+ */
+static inline void
+gegl_sampler_cubic_locate (const gdouble  absolute_x,
+                           const gdouble  absolute_y,
+                                 gint    *ix,
+                                 gint    *iy,
+                                 gfloat  *x,
+                                 gfloat  *y)
+{
+  /*
+   * The "-1/2"s are there because we want the index of the pixel
+   * center to the left and top of the location, and with GIMP's
+   * convention the top left of the top left pixel is located at
+   * (0,0), and its center is at (1/2,1/2), so that anything less than
+   * 1/2 needs to go negative. Another way to look at this is that we
+   * are converting from a coordinate system in which the origin is at
+   * the top left corner of the pixel with index (0,0), to a
+   * coordinate system in which the origin is at the center of the
+   * same pixel.
+   */
+  const double iabsolute_x = (double) absolute_x - 0.5;
+  const double iabsolute_y = (double) absolute_y - 0.5;
+
+  *ix = floorf (iabsolute_x);
+  *iy = floorf (iabsolute_y);
+
+  /*
+   * x is the x-coordinate of the sampling point relative to the
+   * position of the center of the top left pixel. Similarly for
+   * y. Range of values: [0,1].
+   */
+  *x = iabsolute_x - *ix;
+  *y = iabsolute_y - *iy;
+}
+
+/*
+ * Interpolates a sample located at (x, y) relative to the pixel
+ * sampler_bptr points to, in the sampler's buffer.
+ */
+static inline void
+gegl_sampler_cubic_kernel (      GeglSamplerCubic *cubic,
+                           const gfloat           *sampler_bptr,
+                           const gfloat            x,
+                           const gfloat            y,
+                                 gfloat           *newval,
+                           const gint              components)
+{
+  gfloat cubic_b = cubic->b;
+  gfloat cubic_c = cubic->c;
+  gfloat factor_i[4];
+  gint   c;
+  gint   i;
+  gint   j;
+
+  sampler_bptr -= (GEGL_SAMPLER_MAXIMUM_WIDTH + 1) * components;
+
+  for (c = 0; c < components; c++)
+    newval[c] = 0.0f;
+
+  for (i = 0; i < 4; i++)
+    factor_i[i] = cubicKernel (x - (i - 1), cubic_b, cubic_c);
+
+  for (j = 0; j < 4; j++)
+    {
+      gfloat factor_j = cubicKernel (y - (j - 1), cubic_b, cubic_c);
+
+      for (i = 0; i < 4; i++)
+        {
+          const gfloat factor = factor_j * factor_i[i];
+
+          for (c = 0; c < components; c++)
+            newval[c] += factor * sampler_bptr[c];
+
+          sampler_bptr += components;
+        }
+
+      sampler_bptr += (GEGL_SAMPLER_MAXIMUM_WIDTH - 4) * components;
+    }
+}
+
+static inline void
+gegl_sampler_cubic_interpolate (      GeglSampler     *self,
+                                const gdouble          absolute_x,
+                                const gdouble          absolute_y,
+                                      gfloat          *newval,
+                                const gint             components,
+                                      GeglAbyssPolicy  repeat_mode)
+{
+  gint   ix, iy;
+  gfloat x, y;
+
+  gegl_sampler_cubic_locate (absolute_x, absolute_y, &ix, &iy, &x, &y);
+
+  gegl_sampler_cubic_kernel ((GeglSamplerCubic *) self,
+                             gegl_sampler_get_ptr (self, ix, iy, repeat_mode),
+                             x, y, newval, components);
+}
+
 void
 gegl_sampler_cubic_get (      GeglSampler       *self,
                         const gdouble            absolute_x,
@@ -163,72 +274,105 @@ gegl_sampler_cubic_get (      GeglSampler       *self,
   if (! _gegl_sampler_box_get (self, absolute_x, absolute_y, scale,
                                output, repeat_mode, 5))
   {
-    GeglSamplerCubic *cubic      = (GeglSamplerCubic*)(self);
-    gint              components = self->interpolate_components;
-    gfloat            cubic_b    = cubic->b;
-    gfloat            cubic_c    = cubic->c;
-    gfloat           *sampler_bptr;
-    gfloat            factor_i[4];
-    gfloat            newval[components];
-    gint              c;
-    gint              i;
-    gint              j;
-
-    /*
-     * The "-1/2"s are there because we want the index of the pixel
-     * center to the left and top of the location, and with GIMP's
-     * convention the top left of the top left pixel is located at
-     * (0,0), and its center is at (1/2,1/2), so that anything less than
-     * 1/2 needs to go negative. Another way to look at this is that we
-     * are converting from a coordinate system in which the origin is at
-     * the top left corner of the pixel with index (0,0), to a
-     * coordinate system in which the origin is at the center of the
-     * same pixel.
-     */
-    const double iabsolute_x = (double) absolute_x - 0.5;
-    const double iabsolute_y = (double) absolute_y - 0.5;
-
-    const gint ix = floorf (iabsolute_x);
-    const gint iy = floorf (iabsolute_y);
-
-    /*
-     * x is the x-coordinate of the sampling point relative to the
-     * position of the center of the top left pixel. Similarly for
-     * y. Range of values: [0,1].
-     */
-    const gfloat x = iabsolute_x - ix;
-    const gfloat y = iabsolute_y - iy;
-
-    sampler_bptr = gegl_sampler_get_ptr (self, ix, iy, repeat_mode) -
-                   (GEGL_SAMPLER_MAXIMUM_WIDTH + 1) * components;
-
-    for (c = 0; c < components; c++)
-      newval[c] = 0.0f;
-
-    for (i = 0; i < 4; i++)
-      factor_i[i] = cubicKernel (x - (i - 1), cubic_b, cubic_c);
-
-    for (j = 0; j < 4; j++)
-      {
-        gfloat factor_j = cubicKernel (y - (j - 1), cubic_b, cubic_c);
-
-        for (i = 0; i < 4; i++)
-          {
-            const gfloat factor = factor_j * factor_i[i];
-
-            for (c = 0; c < components; c++)
-              newval[c] += factor * sampler_bptr[c];
-
-            sampler_bptr += components;
-          }
-
-        sampler_bptr += (GEGL_SAMPLER_MAXIMUM_WIDTH - 4) * components;
-      }
-
-    babl_process (self->fish, newval, output, 1);
+    gfloat newval[GEGL_SAMPLER_MAX_COMPONENTS];
+
+    gegl_sampler_cubic_interpolate (self, absolute_x, absolute_y, newval,
+                                    self->interpolate_components,
+                                    repeat_mode);
+
+    _gegl_sampler_process_pixel (self, newval, output);
   }
 }
 
+static void
+gegl_sampler_cubic_get_span (GeglSampler       *self,
+                             gdouble            absolute_x,
+                             gdouble            absolute_y,
+                             gdouble            dx,
+                             gdouble            dy,
+                             GeglBufferMatrix2 *scale,
+                             void              *output,
+                             gint               n,
+                             GeglAbyssPolicy    repeat_mode)
+{
+  GeglSamplerCubic *cubic = (GeglSamplerCubic *) self;
+  gint              nc    = self->interpolate_components;
+  gint              bpp   = babl_format_get_bytes_per_pixel (self->format);
+  guchar           *out   = output;
+  gfloat            buf[GEGL_SAMPLER_SPAN_CHUNK_SIZE * GEGL_SAMPLER_MAX_COMPONENTS];
+  gint              ix[GEGL_SAMPLER_SPAN_CHUNK_SIZE];
+  gint              iy[GEGL_SAMPLER_SPAN_CHUNK_SIZE];
+  gfloat            x[GEGL_SAMPLER_SPAN_CHUNK_SIZE];
+  gfloat            y[GEGL_SAMPLER_SPAN_CHUNK_SIZE];
+
+  if (_gegl_sampler_box_needed (scale))
+    {
+      GEGL_SAMPLER_CLASS (gegl_sampler_cubic_parent_class)->get_span (
+        self, absolute_x, absolute_y, dx, dy, scale, output, n, repeat_mode);
+
+      return;
+    }
+
+  while (n > 0)
+    {
+      gint m = MIN (n, GEGL_SAMPLER_SPAN_CHUNK_SIZE);
+      gint i;
+      gint j;
+
+      for (i = 0; i < m; i++)
+        {
+          gegl_sampler_cubic_locate (absolute_x, absolute_y,
+                                     &ix[i], &iy[i], &x[i], &y[i]);
+
+          absolute_x += dx;
+          absolute_y += dy;
+        }
+
+      /* fetch the context of the samples a run at a time, and interpolate
+       * them straight from it.
+       */
+      for (i = 0; i < m; i = j)
+        {
+          gfloat *ptr;
+          gint    k;
+
+          j = _gegl_sampler_get_span_run (self, ix, iy, i, m, &ptr,
+                                          repeat_mode);
+
+          /* specialize the common case, so that the channel loop is
+           * unrolled
+           */
+          if (nc == 4)
+            {
+              for (k = i; k < j; k++)
+                {
+                  gint offset = (ix[k] - ix[i]) +
+                                (iy[k] - iy[i]) * GEGL_SAMPLER_MAXIMUM_WIDTH;
+
+                  gegl_sampler_cubic_kernel (cubic, ptr + offset * 4,
+                                             x[k], y[k], buf + k * 4, 4);
+                }
+            }
+          else
+            {
+              for (k = i; k < j; k++)
+                {
+                  gint offset = (ix[k] - ix[i]) +
+                                (iy[k] - iy[i]) * GEGL_SAMPLER_MAXIMUM_WIDTH;
+
+                  gegl_sampler_cubic_kernel (cubic, ptr + offset * nc,
+                                             x[k], y[k], buf + k * nc, nc);
+                }
+            }
+        }
+
+      babl_process (self->fish, buf, out, m);
+
+      out += m * bpp;
+      n   -= m;
+    }
+}
+
 static void
 get_property (GObject    *object,
               guint       prop_id,
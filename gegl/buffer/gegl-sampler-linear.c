@@ -37,6 +37,15 @@ static void gegl_sampler_linear_get (      GeglSampler* restrict  self,
                                            GeglBufferMatrix2     *scale,
                                            void*        restrict  output,
                                            GeglAbyssPolicy        repeat_mode);
+static void gegl_sampler_linear_get_span (GeglSampler       *self,
+                                          gdouble            absolute_x,
+                                          gdouble            absolute_y,
+                                          gdouble            dx,
+                                          gdouble            dy,
+                                          GeglBufferMatrix2 *scale,
+                                          void              *output,
+                                          gint               n,
+                                          GeglAbyssPolicy    repeat_mode);
 
 G_DEFINE_TYPE (GeglSamplerLinear, gegl_sampler_linear, GEGL_TYPE_SAMPLER)
 
@@ -45,7 +54,8 @@ gegl_sampler_linear_class_init (GeglSamplerLinearClass *klass)
 {
   GeglSamplerClass *sampler_class = GEGL_SAMPLER_CLASS (klass);
 
-  sampler_class->get = gegl_sampler_linear_get;
+  sampler_class->get      = gegl_sampler_linear_get;
+  sampler_class->get_span = gegl_sampler_linear_get_span;
 }
 
 /*
@@ -72,6 +82,102 @@ gegl_sampler_linear_init (GeglSamplerLinear *self)
   GEGL_SAMPLER (self)->level[0].context_rect.height =  3 + 2*LINEAR_EXTRA_ELBOW_ROOM;
 }
 
+/*
+ * Locates a sample: computes the anchor pixel of the sample, as passed to
+ * gegl_sampler_get_ptr(), and its position relative to it.
+ */
+static inline void
+gegl_sampler_linear_locate (const gdouble           absolute_x,
+                            const gdouble           absolute_y,
+                                  gint*   restrict  ix,
+                                  gint*   restrict  iy,
+                                  gfloat* restrict  x,
+                                  gfloat* restrict  y)
+{
+  /*
+   * The "-1/2"s are there because we want the index of the pixel to
+   * the left and top of the location, and with GIMP's convention the
+   * top left of the top left pixel is located at
+   * (1/2,1/2). Basically, we are converting from a coordinate system
+   * in which the origin is at the top left pixel of the pixel with
+   * index (0,0), to a coordinate system in which the origin is at the
+   * center of the same pixel.
+   */
+  const float iabsolute_x = (float) absolute_x - 0.5;
+  const float iabsolute_y = (float) absolute_y - 0.5;
+
+  *ix = floorf (iabsolute_x);
+  *iy = floorf (iabsolute_y);
+
+  /*
+   * x is the x-coordinate of the sampling point relative to the
+   * position of the center of the top left pixel. Similarly for
+   * y. Range of values: [0,1].
+   */
+  *x = iabsolute_x - *ix;
+  *y = iabsolute_y - *iy;
+}
+
+/*
+ * Interpolates a sample located at (x, y) relative to the pixel in_bptr
+ * points to, in the sampler's buffer.
+ */
+static inline void
+gegl_sampler_linear_kernel (const gfloat* restrict in_bptr,
+                            const gfloat           x,
+                            const gfloat           y,
+                                  gfloat* restrict newval,
+                            const gint             nc)
+{
+  const gint pixels_per_buffer_row = GEGL_SAMPLER_MAXIMUM_WIDTH;
+
+  /*
+   * Bilinear weights:
+   *
+   * (Note: w = 1-x and z = 1-y.)
+   */
+  const gfloat x_times_y = x * y;
+  const gfloat w_times_y = y - x_times_y;
+  const gfloat x_times_z = x - x_times_y;
+  const gfloat w_times_z = (gfloat) 1. - ( x + w_times_y );
+
+  const gfloat* restrict top_left = in_bptr;
+  const gfloat* restrict top_rite = in_bptr + nc;
+  const gfloat* restrict bot_left = in_bptr + pixels_per_buffer_row * nc;
+  const gfloat* restrict bot_rite = bot_left + nc;
+
+  for (gint c = 0; c < nc; c++)
+    newval[c] =
+      x_times_y * bot_rite[c]
+      +
+      w_times_y * bot_left[c]
+      +
+      x_times_z * top_rite[c]
+      +
+      w_times_z * top_left[c];
+}
+
+static inline void
+gegl_sampler_linear_interpolate (      GeglSampler* restrict  self,
+                                 const gdouble                absolute_x,
+                                 const gdouble                absolute_y,
+                                       gfloat*      restrict  newval,
+                                 const gint                   nc,
+                                       GeglAbyssPolicy        repeat_mode)
+{
+  gint   ix, iy;
+  gfloat x, y;
+
+  gegl_sampler_linear_locate (absolute_x, absolute_y, &ix, &iy, &x, &y);
+
+  /*
+   * Point the data tile pointer to the first channel of the top_left
+   * pixel value:
+   */
+  gegl_sampler_linear_kernel (gegl_sampler_get_ptr (self, ix, iy, repeat_mode),
+                              x, y, newval, nc);
+}
+
 void
 gegl_sampler_linear_get (     GeglSampler       *self,
                         const gdouble            absolute_x,
@@ -80,100 +186,103 @@ gegl_sampler_linear_get (     GeglSampler       *self,
                               void              *output,
                               GeglAbyssPolicy    repeat_mode)
 {
-  gint nc = self->interpolate_components;
   if (! _gegl_sampler_box_get (self, absolute_x, absolute_y, scale,
                                output, repeat_mode, 4))
   {
-    const gint pixels_per_buffer_row = GEGL_SAMPLER_MAXIMUM_WIDTH;
-
-    /*
-     * The "-1/2"s are there because we want the index of the pixel to
-     * the left and top of the location, and with GIMP's convention the
-     * top left of the top left pixel is located at
-     * (1/2,1/2). Basically, we are converting from a coordinate system
-     * in which the origin is at the top left pixel of the pixel with
-     * index (0,0), to a coordinate system in which the origin is at the
-     * center of the same pixel.
-     */
-    const float iabsolute_x = (float) absolute_x - 0.5;
-    const float iabsolute_y = (float) absolute_y - 0.5;
-
-    const gint ix = floorf (iabsolute_x);
-    const gint iy = floorf (iabsolute_y);
-
-    /*
-     * Point the data tile pointer to the first channel of the top_left
-     * pixel value:
-     */
-    const gfloat* restrict in_bptr =
-      gegl_sampler_get_ptr (self, ix, iy, repeat_mode);
-
-    /*
-     * x is the x-coordinate of the sampling point relative to the
-     * position of the center of the top left pixel. Similarly for
-     * y. Range of values: [0,1].
-     */
-    const gfloat x = iabsolute_x - ix;
-    const gfloat y = iabsolute_y - iy;
-
-    /*
-     * First bilinear weight:
-     */
-    const gfloat x_times_y = x * y;
-
-    /*
-     * Load top row:
-     */
-    gfloat top_left[nc];
-    gfloat top_rite[nc];
-
-    for (gint c = 0; c < nc; c++)
-      top_left[c] = *in_bptr++;
-
-    for (gint c = 0; c < nc; c++)
-      top_rite[c] = *in_bptr++;
-
-    in_bptr += ( pixels_per_buffer_row - 2 ) * nc;
+    gfloat newval[GEGL_SAMPLER_MAX_COMPONENTS];
+
+    gegl_sampler_linear_interpolate (self, absolute_x, absolute_y, newval,
+                                     self->interpolate_components,
+                                     repeat_mode);
 
+    _gegl_sampler_process_pixel (self, newval, output);
+  }
+}
+
+static void
+gegl_sampler_linear_get_span (GeglSampler       *self,
+                              gdouble            absolute_x,
+                              gdouble            absolute_y,
+                              gdouble            dx,
+                              gdouble            dy,
+                              GeglBufferMatrix2 *scale,
+                              void              *output,
+                              gint               n,
+                              GeglAbyssPolicy    repeat_mode)
+{
+  gint    nc  = self->interpolate_components;
+  gint    bpp = babl_format_get_bytes_per_pixel (self->format);
+  guchar *out = output;
+  gfloat  buf[GEGL_SAMPLER_SPAN_CHUNK_SIZE * GEGL_SAMPLER_MAX_COMPONENTS];
+  gint    ix[GEGL_SAMPLER_SPAN_CHUNK_SIZE];
+  gint    iy[GEGL_SAMPLER_SPAN_CHUNK_SIZE];
+  gfloat  x[GEGL_SAMPLER_SPAN_CHUNK_SIZE];
+  gfloat  y[GEGL_SAMPLER_SPAN_CHUNK_SIZE];
+
+  if (_gegl_sampler_box_needed (scale))
     {
-    /*
-     * More bilinear weights:
-     *
-     * (Note: w = 1-x and z = 1-y.)
-     */
-    const gfloat w_times_y = y - x_times_y;
-    const gfloat x_times_z = x - x_times_y;
-
-    /*
-     * Load bottom row:
-     */
-    gfloat bot_left[5];
-    gfloat bot_rite[5];
-    for (gint c = 0; c < nc; c++)
-      bot_left[c] = *in_bptr++;
-    for (gint c = 0; c < nc; c++)
-      bot_rite[c] = *in_bptr++;
-
-    /*
-     * Last bilinear weight:
-     */
+      GEGL_SAMPLER_CLASS (gegl_sampler_linear_parent_class)->get_span (
+        self, absolute_x, absolute_y, dx, dy, scale, output, n, repeat_mode);
+
+      return;
+    }
+
+  while (n > 0)
     {
-    const gfloat w_times_z = (gfloat) 1. - ( x + w_times_y );
+      gint m = MIN (n, GEGL_SAMPLER_SPAN_CHUNK_SIZE);
+      gint i;
+      gint j;
 
-    gfloat newval[5];
+      for (i = 0; i < m; i++)
+        {
+          gegl_sampler_linear_locate (absolute_x, absolute_y,
+                                      &ix[i], &iy[i], &x[i], &y[i]);
 
-      for (gint c = 0; c < nc; c++)
-        newval[c] =
-        x_times_y * bot_rite[c]
-        +
-        w_times_y * bot_left[c]
-        +
-        x_times_z * top_rite[c]
-        +
-        w_times_z * top_left[c];
+          absolute_x += dx;
+          absolute_y += dy;
+        }
 
-      babl_process (self->fish, newval, output, 1);
-    }
+      /* fetch the context of the samples a run at a time, and interpolate
+       * them straight from it.
+       */
+      for (i = 0; i < m; i = j)
+        {
+          gfloat *ptr;
+          gint    k;
+
+          j = _gegl_sampler_get_span_run (self, ix, iy, i, m, &ptr,
+                                          repeat_mode);
+
+          /* specialize the common case, so that the channel loop is
+           * unrolled
+           */
+          if (nc == 4)
+            {
+              for (k = i; k < j; k++)
+                {
+                  gint offset = (ix[k] - ix[i]) +
+                                (iy[k] - iy[i]) * GEGL_SAMPLER_MAXIMUM_WIDTH;
+
+                  gegl_sampler_linear_kernel (ptr + offset * 4, x[k], y[k],
+                                              buf + k * 4, 4);
+                }
+            }
+          else
+            {
+              for (k = i; k < j; k++)
+                {
+                  gint offset = (ix[k] - ix[i]) +
+                                (iy[k] - iy[i]) * GEGL_SAMPLER_MAXIMUM_WIDTH;
+
+                  gegl_sampler_linear_kernel (ptr + offset * nc, x[k], y[k],
+                                              buf + k * nc, nc);
+                }
+            }
+        }
+
+      babl_process (self->fish, buf, out, m);
+
+      out += m * bpp;
+      n   -= m;
     }
-  }
 }
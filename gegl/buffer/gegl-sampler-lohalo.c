@@ -998,7 +998,7 @@ gegl_sampler_lohalo_get (      GeglSampler*    restrict  self,
     /*
      * Ship out the result:
      */
-    babl_process (self->fish, newval, output, 1);
+    _gegl_sampler_process_pixel (self, newval, output);
     return;
   }
 }
@@ -45,6 +45,17 @@ gegl_sampler_nearest_get (GeglSampler*    restrict self,
                           void*           restrict output,
                           GeglAbyssPolicy          repeat_mode);
 
+static void
+gegl_sampler_nearest_get_span (GeglSampler             *self,
+                               gdouble                  absolute_x,
+                               gdouble                  absolute_y,
+                               gdouble                  dx,
+                               gdouble                  dy,
+                               GeglBufferMatrix2       *scale,
+                               void                    *output,
+                               gint                     n,
+                               GeglAbyssPolicy          repeat_mode);
+
 static void
 gegl_sampler_nearest_prepare (GeglSampler*    restrict self);
 
@@ -59,6 +70,7 @@ gegl_sampler_nearest_class_init (GeglSamplerNearestClass *klass)
   object_class->dispose = gegl_sampler_nearest_dispose;
 
   sampler_class->get = gegl_sampler_nearest_get;
+  sampler_class->get_span = gegl_sampler_nearest_get_span;
   sampler_class->prepare = gegl_sampler_nearest_prepare;
 }
 
@@ -164,8 +176,6 @@ gegl_sampler_get_pixel (GeglSampler    *sampler,
           tile->x == indice_x &&
           tile->y == indice_y))
       {
-        g_rec_mutex_lock (&buffer->tile_storage->mutex);
-
         if (tile)
           {
             gegl_tile_read_unlock (tile);
@@ -173,14 +183,10 @@ gegl_sampler_get_pixel (GeglSampler    *sampler,
             gegl_tile_unref (tile);
           }
 
-        tile = gegl_tile_source_get_tile ((GeglTileSource *) (buffer),
-                                          indice_x, indice_y,
-                                          0);
+        tile = gegl_buffer_get_tile (buffer, indice_x, indice_y, 0);
         nearest_sampler->hot_tile = tile;
 
         gegl_tile_read_lock (tile);
-
-        g_rec_mutex_unlock (&buffer->tile_storage->mutex);
       }
 
     if (tile)
@@ -216,6 +222,35 @@ gegl_sampler_nearest_get (      GeglSampler*    restrict  sampler,
 }
 
 
+/* the pixels are converted straight from the buffer format, so there's
+ * nothing to batch; just avoid the per-pixel call overhead.
+ */
+static void
+gegl_sampler_nearest_get_span (GeglSampler       *sampler,
+                               gdouble            absolute_x,
+                               gdouble            absolute_y,
+                               gdouble            dx,
+                               gdouble            dy,
+                               GeglBufferMatrix2 *scale,
+                               void              *output,
+                               gint               n,
+                               GeglAbyssPolicy    repeat_mode)
+{
+  gint    bpp = babl_format_get_bytes_per_pixel (sampler->format);
+  guchar *out = output;
+
+  while (n--)
+    {
+      gegl_sampler_get_pixel (sampler,
+               floorf(absolute_x), floorf(absolute_y),
+               out, repeat_mode);
+
+      out        += bpp;
+      absolute_x += dx;
+      absolute_y += dy;
+    }
+}
+
 static void
 gegl_sampler_nearest_prepare (GeglSampler* restrict sampler)
 {
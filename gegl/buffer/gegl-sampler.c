@@ -67,6 +67,16 @@ static void set_property            (GObject             *gobject,
 static void set_buffer              (GeglSampler         *self,
                                      GeglBuffer          *buffer);
 
+static void get_span                (GeglSampler         *self,
+                                     gdouble              x,
+                                     gdouble              y,
+                                     gdouble              dx,
+                                     gdouble              dy,
+                                     GeglBufferMatrix2   *scale,
+                                     void                *output,
+                                     gint                 n,
+                                     GeglAbyssPolicy      repeat_mode);
+
 static void buffer_contents_changed (GeglBuffer          *buffer,
                                      const GeglRectangle *changed_rect,
                                      gpointer             userdata);
@@ -89,6 +99,7 @@ gegl_sampler_class_init (GeglSamplerClass *klass)
   klass->prepare    = NULL;
   klass->get        = NULL;
   klass->set_buffer = set_buffer;
+  klass->get_span   = get_span;
 
   object_class->set_property = set_property;
   object_class->get_property = get_property;
@@ -175,6 +186,97 @@ gegl_sampler_get (GeglSampler       *self,
   self->get (self, x, y, scale, output, repeat_mode);
 }
 
+void
+gegl_sampler_get_span (GeglSampler       *self,
+                       gdouble            x,
+                       gdouble            y,
+                       gdouble            dx,
+                       gdouble            dy,
+                       GeglBufferMatrix2 *scale,
+                       void              *output,
+                       gint               n,
+                       GeglAbyssPolicy    repeat_mode)
+{
+  if (n <= 0)
+    return;
+
+  if (gegl_buffer_ext_flush)
+    {
+      gdouble       x2   = x + dx * (n - 1);
+      gdouble       y2   = y + dy * (n - 1);
+      GeglRectangle rect;
+
+      rect.x      = floor (MIN (x, x2));
+      rect.y      = floor (MIN (y, y2));
+      rect.width  = ceil (MAX (x, x2)) - rect.x + 1;
+      rect.height = ceil (MAX (y, y2)) - rect.y + 1;
+
+      gegl_buffer_ext_flush (self->buffer, &rect);
+    }
+
+  GEGL_SAMPLER_GET_CLASS (self)->get_span (self, x, y, dx, dy, scale,
+                                           output, n, repeat_mode);
+}
+
+static void
+get_span (GeglSampler       *self,
+          gdouble            x,
+          gdouble            y,
+          gdouble            dx,
+          gdouble            dy,
+          GeglBufferMatrix2 *scale,
+          void              *output,
+          gint               n,
+          GeglAbyssPolicy    repeat_mode)
+{
+  const Babl *fish = self->fish;
+  gint        bpp  = babl_format_get_bytes_per_pixel (self->format);
+  gint        nc   = self->interpolate_components;
+  guchar     *out  = output;
+  gfloat      buf[GEGL_SAMPLER_SPAN_CHUNK_SIZE * GEGL_SAMPLER_MAX_COMPONENTS];
+
+  /* box-filtered samples are converted by _gegl_sampler_box_get() itself */
+  if (_gegl_sampler_box_needed (scale))
+    {
+      while (n--)
+        {
+          self->get (self, x, y, scale, out, repeat_mode);
+
+          out += bpp;
+          x   += dx;
+          y   += dy;
+        }
+
+      return;
+    }
+
+  /* let get() output the interpolated pixels as is, and convert them to the
+   * output format a chunk at a time.
+   */
+  self->fish = NULL;
+
+  while (n > 0)
+    {
+      gint m = MIN (n, GEGL_SAMPLER_SPAN_CHUNK_SIZE);
+      gint i;
+
+      for (i = 0; i < m; i++)
+        {
+          self->get (self, x, y, scale, buf + i * nc, repeat_mode);
+
+          x += dx;
+          y += dy;
+        }
+
+      babl_process (fish, buf, out, m);
+
+      out += m * bpp;
+      n   -= m;
+    }
+
+  self->fish = fish;
+}
+
 void
 gegl_sampler_prepare (GeglSampler *self)
 {
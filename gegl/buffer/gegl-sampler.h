@@ -21,6 +21,7 @@
 #include <glib-object.h>
 #include <babl/babl.h>
 #include <stdio.h>
+#include <string.h>
 
 G_BEGIN_DECLS
 
@@ -56,6 +57,14 @@ G_BEGIN_DECLS
 #define GEGL_SAMPLER_MAXIMUM_HEIGHT 64
 #define GEGL_SAMPLER_MAXIMUM_WIDTH (GEGL_SAMPLER_MAXIMUM_HEIGHT)
 
+/*
+ * The number of pixels gegl_sampler_get_span() interpolates before converting
+ * them to the output format, and the maximal number of components of the
+ * interpolation formats.
+ */
+#define GEGL_SAMPLER_SPAN_CHUNK_SIZE 64
+#define GEGL_SAMPLER_MAX_COMPONENTS  5
+
 typedef struct _GeglSamplerClass GeglSamplerClass;
 
 typedef struct GeglSamplerLevel
@@ -94,6 +103,20 @@ struct _GeglSamplerClass
   GeglSamplerGetFun   get;
   void  (*set_buffer) (GeglSampler     *self,
                        GeglBuffer      *buffer);
+  /* the default implementation calls get() for each pixel, and requires it
+   * to output the pixels through _gegl_sampler_process_pixel(); it only
+   * saves the per-pixel conversion.  samplers overriding it can fetch their
+   * context for runs of pixels using _gegl_sampler_get_span_run().
+   */
+  void  (*get_span)   (GeglSampler       *self,
+                       gdouble            x,
+                       gdouble            y,
+                       gdouble            dx,
+                       gdouble            dy,
+                       GeglBufferMatrix2 *scale,
+                       void              *output,
+                       gint               n,
+                       GeglAbyssPolicy    repeat_mode);
 };
 
 GType gegl_sampler_get_type    (void) G_GNUC_CONST;
@@ -229,6 +252,117 @@ gegl_sampler_get_ptr (GeglSampler    *sampler,
   return (gfloat *) (buffer_ptr + sof);
 }
 
+/*
+ * Fetches the context of a run of samples of a span at once, rather than
+ * letting gegl_sampler_get_ptr() check it for every sample.  @ix and @iy
+ * are the anchors of the samples, as passed to gegl_sampler_get_ptr(); the
+ * run starts at sample @start, and extends, up to sample @n, for as long as
+ * the context of its samples fits in the sampler's buffer.  Returns the end
+ * of the run, and sets @ptr to the pointer gegl_sampler_get_ptr() would
+ * return for the first sample; the other samples are at the same rowstride.
+ */
+static inline gint
+_gegl_sampler_get_span_run (GeglSampler     *sampler,
+                            const gint      *ix,
+                            const gint      *iy,
+                            gint             start,
+                            gint             n,
+                            gfloat         **ptr,
+                            GeglAbyssPolicy  repeat_mode)
+{
+  GeglSamplerLevel *level      = &sampler->level[0];
+  gint              max_width  = GEGL_SAMPLER_MAXIMUM_WIDTH  -
+                                 level->context_rect.width;
+  gint              max_height = GEGL_SAMPLER_MAXIMUM_HEIGHT -
+                                 level->context_rect.height;
+  gint              x0         = ix[start];
+  gint              y0         = iy[start];
+  gint              x1         = x0;
+  gint              y1         = y0;
+  gint              end;
+  GeglRectangle     rectangle;
+  gint              sof;
+
+  for (end = start + 1; end < n; end++)
+    {
+      if (MAX (x1, ix[end]) - MIN (x0, ix[end]) > max_width ||
+          MAX (y1, iy[end]) - MIN (y0, iy[end]) > max_height)
+        {
+          break;
+        }
+
+      x0 = MIN (x0, ix[end]);
+      y0 = MIN (y0, iy[end]);
+      x1 = MAX (x1, ix[end]);
+      y1 = MAX (y1, iy[end]);
+    }
+
+  rectangle.x      = x0 + level->context_rect.x;
+  rectangle.y      = y0 + level->context_rect.y;
+  rectangle.width  = x1 - x0 + level->context_rect.width;
+  rectangle.height = y1 - y0 + level->context_rect.height;
+
+  if (! gegl_rectangle_contains (&level->sampler_rectangle, &rectangle))
+    {
+      level->sampler_rectangle = rectangle;
+
+      gegl_buffer_get (sampler->buffer,
+                       &level->sampler_rectangle,
+                       1.0,
+                       sampler->interpolate_format,
+                       level->sampler_buffer,
+                       GEGL_SAMPLER_MAXIMUM_WIDTH * sampler->interpolate_bpp,
+                       repeat_mode);
+      level->last_x  = ix[end - 1];
+      level->last_y  = iy[end - 1];
+      level->delta_x = 0;
+      level->delta_y = 0;
+    }
+
+  sof  = ((ix[start] - level->sampler_rectangle.x) +
+          (iy[start] - level->sampler_rectangle.y) * GEGL_SAMPLER_MAXIMUM_WIDTH) *
+         sampler->interpolate_bpp;
+  *ptr = (gfloat *) ((guchar *) level->sampler_buffer + sof);
+
+  return end;
+}
+
+/*
+ * Converts an interpolated pixel to the output format.  While a span is
+ * sampled, the sampler's fish is NULL, and the pixel is output as is, to be
+ * converted together with the rest of the span.
+ */
+static inline void
+_gegl_sampler_process_pixel (GeglSampler  *sampler,
+                             const gfloat *pixel,
+                             void         *output)
+{
+  if (sampler->fish)
+    babl_process (sampler->fish, pixel, output, 1);
+  else
+    memcpy (output, pixel, sampler->interpolate_bpp);
+}
+
+/*
+ * Whether _gegl_sampler_box_get() box-filters samples taken with the given
+ * @scale, rather than leaving them to the sampler.
+ */
+static inline gboolean
+_gegl_sampler_box_needed (GeglBufferMatrix2 *scale)
+{
+  if (scale)
+    {
+      const gdouble u_norm2 = scale->coeff[0][0] * scale->coeff[0][0] +
+                              scale->coeff[1][0] * scale->coeff[1][0];
+      const gdouble v_norm2 = scale->coeff[0][1] * scale->coeff[0][1] +
+                              scale->coeff[1][1] * scale->coeff[1][1];
+
+      return u_norm2 >= 4.0 || v_norm2 >= 4.0;
+    }
+
+  return FALSE;
+}
+
 #include <stdio.h>
 
 static inline gboolean
@@ -0,0 +1,520 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include <glib-object.h>
+
+#include "gegl-buffer.h"
+#include "gegl-buffer-config.h"
+#include "gegl-tile-alloc.h"
+
+
+/* tile data is allocated from per-size pools.  each pool carves pieces of a
+ * single size out of large slabs, so that the tiles of a buffer share a few
+ * big mappings, instead of each being a separate heap block.  sizes above
+ * GEGL_TILE_ALLOC_MAX_SIZE are allocated directly.
+ */
+#define GEGL_TILE_ALLOC_SLAB_SIZE      (2 << 20) /* target slab size          */
+#define GEGL_TILE_ALLOC_MAX_SIZE       (GEGL_TILE_ALLOC_SLAB_SIZE / 4)
+#define GEGL_TILE_ALLOC_MAX_POOLS      64
+#define GEGL_TILE_ALLOC_MAX_NODES      8
+#define GEGL_TILE_ALLOC_MAX_FREE_SLABS 2         /* per pool, between trims  */
+
+#if defined (HAVE_MMAP) && defined (HAVE_SYS_MMAN_H) && defined (MAP_ANONYMOUS)
+#define GEGL_TILE_ALLOC_MMAP 1
+#endif
+
+#if defined (GEGL_TILE_ALLOC_MMAP) && defined (__linux__) && \
+    defined (SYS_getcpu) && defined (SYS_mbind)
+#define GEGL_TILE_ALLOC_NUMA 1
+
+#define GEGL_TILE_ALLOC_MPOL_PREFERRED 1 /* from <numaif.h> */
+#endif
+
+
+typedef struct _GeglTileAllocPool GeglTileAllocPool;
+typedef struct _GeglTileAllocSlab GeglTileAllocSlab;
+
+/* each piece is preceded by its header, padded to the alignment.  pieces
+ * handed out by a slab record the slab, while directly-allocated pieces have
+ * a NULL slab, and record their size instead.  while a piece is free, its
+ * data holds the link to the next free piece of the slab.
+ */
+typedef struct
+{
+  GeglTileAllocSlab *slab;
+  gsize              size;
+} GeglTileAllocPiece;
+
+G_STATIC_ASSERT (sizeof (GeglTileAllocPiece) <= GEGL_TILE_ALLOC_ALIGNMENT);
+
+#define PIECE_DATA(piece) \
+  ((gpointer) ((guchar *) (piece) + GEGL_TILE_ALLOC_ALIGNMENT))
+#define DATA_PIECE(data) \
+  ((GeglTileAllocPiece *) ((guchar *) (data) - GEGL_TILE_ALLOC_ALIGNMENT))
+#define PIECE_NEXT(piece) \
+  (*(GeglTileAllocPiece **) PIECE_DATA (piece))
+
+struct _GeglTileAllocSlab
+{
+  GeglTileAllocPool  *pool;
+  gpointer            mem;
+  gsize               mem_size;
+  gboolean            mapped;
+
+  GeglTileAllocPiece *free_pieces;
+  gint                n_free;  /* including the untouched pieces */
+  gint                n_fresh; /* pieces at the end of the slab that were
+                                * never handed out
+                                */
+
+  GList               link;
+};
+
+struct _GeglTileAllocPool
+{
+  GMutex  mutex;
+
+  gsize   size;
+  gsize   stride;
+  gint    n_pieces;
+  gint    node;
+
+  /* the slabs that have free pieces.  partially-used slabs come first, most
+   * recently filled first, so that allocations are packed into as few slabs
+   * as possible; completely free slabs come last.
+   */
+  GQueue  slabs;
+  gint    n_slabs;
+  gint    n_free_slabs;
+};
+
+
+static GeglTileAllocPool * volatile pools[GEGL_TILE_ALLOC_MAX_POOLS];
+static gint                         n_pools;
+static GMutex                       pools_mutex;
+
+static volatile guintptr            tile_alloc_total      = 0; /* bytes obtained from the system     */
+static volatile guintptr            tile_alloc_slab_total = 0; /* bytes of slabs                     */
+static volatile guintptr            tile_alloc_slab_used  = 0; /* bytes of slabs used by live pieces */
+static gint                         tile_alloc_free_slabs = 0;
+
+
+/*  private functions  */
+
+static gint
+gegl_tile_alloc_get_node (void)
+{
+#ifdef GEGL_TILE_ALLOC_NUMA
+  unsigned cpu;
+  unsigned node;
+
+  if (! gegl_buffer_config ()->tile_alloc_numa)
+    return -1;
+
+  if (syscall (SYS_getcpu, &cpu, &node, NULL) == 0 &&
+      node < GEGL_TILE_ALLOC_MAX_NODES)
+    {
+      return node;
+    }
+#endif
+
+  return -1;
+}
+
+static GeglTileAllocPool *
+gegl_tile_alloc_get_pool (gsize size,
+                          gint  node)
+{
+  GeglTileAllocPool *pool;
+  gint               n;
+  gint               i;
+
+  n = g_atomic_int_get (&n_pools);
+
+  for (i = 0; i < n; i++)
+    {
+      pool = pools[i];
+
+      if (pool->size == size && pool->node == node)
+        return pool;
+    }
+
+  g_mutex_lock (&pools_mutex);
+
+  for (; i < n_pools; i++)
+    {
+      pool = pools[i];
+
+      if (pool->size == size && pool->node == node)
+        {
+          g_mutex_unlock (&pools_mutex);
+
+          return pool;
+        }
+    }
+
+  if (n_pools == GEGL_TILE_ALLOC_MAX_POOLS)
+    {
+      g_mutex_unlock (&pools_mutex);
+
+      return NULL;
+    }
+
+  pool = g_slice_new0 (GeglTileAllocPool);
+
+  g_mutex_init (&pool->mutex);
+
+  pool->size     = size;
+  pool->stride   = GEGL_TILE_ALLOC_ALIGNMENT +
+                   ((MAX (size, sizeof (gpointer)) +
+                     GEGL_TILE_ALLOC_ALIGNMENT - 1) &
+                    ~(gsize) (GEGL_TILE_ALLOC_ALIGNMENT - 1));
+  pool->n_pieces = MAX (GEGL_TILE_ALLOC_SLAB_SIZE / pool->stride, 1);
+  pool->node     = node;
+
+  pools[n_pools] = pool;
+  g_atomic_int_set (&n_pools, n_pools + 1);
+
+  g_mutex_unlock (&pools_mutex);
+
+  return pool;
+}
+
+static GeglTileAllocSlab *
+gegl_tile_alloc_slab_new (GeglTileAllocPool *pool)
+{
+  GeglTileAllocSlab *slab = g_slice_new0 (GeglTileAllocSlab);
+
+  slab->pool     = pool;
+  slab->mem_size = pool->n_pieces * pool->stride;
+
+#ifdef GEGL_TILE_ALLOC_MMAP
+  /* slabs are mapped directly, so that trimming them actually returns the
+   * memory to the system.  the pages are only committed when the pieces are
+   * first written to, which, without binding, places them on the node of the
+   * thread that first uses them.
+   */
+  slab->mem = mmap (NULL, slab->mem_size,
+                    PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                    -1, 0);
+
+  if (slab->mem != MAP_FAILED)
+    {
+      slab->mapped = TRUE;
+
+#ifdef GEGL_TILE_ALLOC_NUMA
+      if (pool->node >= 0)
+        {
+          unsigned long nodemask = 1ul << pool->node;
+
+          /* this is only a preference, so don't bother about failures */
+          syscall (SYS_mbind, slab->mem, slab->mem_size,
+                   GEGL_TILE_ALLOC_MPOL_PREFERRED,
+                   &nodemask, GEGL_TILE_ALLOC_MAX_NODES + 1, 0);
+        }
+#endif
+    }
+  else
+#endif
+    {
+      slab->mem    = gegl_malloc (slab->mem_size);
+      slab->mapped = FALSE;
+    }
+
+  slab->n_free    = pool->n_pieces;
+  slab->n_fresh   = pool->n_pieces;
+  slab->link.data = slab;
+
+  pool->n_slabs++;
+
+  g_atomic_pointer_add (&tile_alloc_total,      (gssize) slab->mem_size);
+  g_atomic_pointer_add (&tile_alloc_slab_total, (gssize) slab->mem_size);
+
+  return slab;
+}
+
+static void
+gegl_tile_alloc_slab_free (GeglTileAllocSlab *slab)
+{
+  slab->pool->n_slabs--;
+
+  g_atomic_pointer_add (&tile_alloc_total,      -(gssize) slab->mem_size);
+  g_atomic_pointer_add (&tile_alloc_slab_total, -(gssize) slab->mem_size);
+
+#ifdef GEGL_TILE_ALLOC_MMAP
+  if (slab->mapped)
+    munmap (slab->mem, slab->mem_size);
+  else
+#endif
+    gegl_free (slab->mem);
+
+  g_slice_free (GeglTileAllocSlab, slab);
+}
+
+static gint
+gegl_tile_alloc_pool_trim (GeglTileAllocPool *pool,
+                           gint               n_keep)
+{
+  gint n = 0;
+
+  g_mutex_lock (&pool->mutex);
+
+  while (pool->n_free_slabs > n_keep)
+    {
+      GeglTileAllocSlab *slab = pool->slabs.tail->data;
+
+      g_queue_unlink (&pool->slabs, &slab->link);
+      pool->n_free_slabs--;
+      n++;
+
+      gegl_tile_alloc_slab_free (slab);
+    }
+
+  g_mutex_unlock (&pool->mutex);
+
+  return n;
+}
+
+static gpointer
+gegl_tile_alloc_direct (gsize size)
+{
+  GeglTileAllocPiece *piece;
+
+  piece       = gegl_malloc (GEGL_TILE_ALLOC_ALIGNMENT + size);
+  piece->slab = NULL;
+  piece->size = size;
+
+  g_atomic_pointer_add (&tile_alloc_total, (gssize) size);
+
+  return PIECE_DATA (piece);
+}
+
+
+/*  public functions  */
+
+gpointer
+gegl_tile_alloc (gsize size)
+{
+  GeglTileAllocPool  *pool;
+  GeglTileAllocSlab  *slab;
+  GeglTileAllocPiece *piece;
+
+  if (size > GEGL_TILE_ALLOC_MAX_SIZE)
+    return gegl_tile_alloc_direct (size);
+
+  pool = gegl_tile_alloc_get_pool (size, gegl_tile_alloc_get_node ());
+
+  if (! pool)
+    return gegl_tile_alloc_direct (size);
+
+  g_mutex_lock (&pool->mutex);
+
+  if (pool->slabs.head)
+    {
+      slab = pool->slabs.head->data;
+
+      if (slab->n_free == pool->n_pieces)
+        {
+          pool->n_free_slabs--;
+          g_atomic_int_add (&tile_alloc_free_slabs, -1);
+        }
+    }
+  else
+    {
+      slab = gegl_tile_alloc_slab_new (pool);
+
+      g_queue_push_head_link (&pool->slabs, &slab->link);
+    }
+
+  if (slab->free_pieces)
+    {
+      piece             = slab->free_pieces;
+      slab->free_pieces = PIECE_NEXT (piece);
+    }
+  else
+    {
+      piece = (GeglTileAllocPiece *) (
+        (guchar *) slab->mem +
+        (pool->n_pieces - slab->n_fresh) * pool->stride);
+
+      piece->slab = slab;
+      piece->size = size;
+
+      slab->n_fresh--;
+    }
+
+  if (--slab->n_free == 0)
+    g_queue_unlink (&pool->slabs, &slab->link);
+
+  g_mutex_unlock (&pool->mutex);
+
+  g_atomic_pointer_add (&tile_alloc_slab_used, (gssize) pool->stride);
+
+  return PIECE_DATA (piece);
+}
+
+gpointer
+gegl_tile_alloc0 (gsize size)
+{
+  gpointer ptr = gegl_tile_alloc (size);
+
+  memset (ptr, 0, size);
+
+  return ptr;
+}
+
+void
+gegl_tile_free (gpointer ptr)
+{
+  GeglTileAllocPiece *piece;
+  GeglTileAllocSlab  *slab;
+  GeglTileAllocPool  *pool;
+
+  if (! ptr)
+    return;
+
+  piece = DATA_PIECE (ptr);
+  slab  = piece->slab;
+
+  if (! slab)
+    {
+      g_atomic_pointer_add (&tile_alloc_total, -(gssize) piece->size);
+
+      gegl_free (piece);
+
+      return;
+    }
+
+  pool = slab->pool;
+
+  g_atomic_pointer_add (&tile_alloc_slab_used, -(gssize) pool->stride);
+
+  g_mutex_lock (&pool->mutex);
+
+  PIECE_NEXT (piece) = slab->free_pieces;
+  slab->free_pieces  = piece;
+
+  /* the slab was full, and is now the most recently filled partial slab */
+  if (slab->n_free++ == 0)
+    g_queue_push_head_link (&pool->slabs, &slab->link);
+
+  if (slab->n_free == pool->n_pieces)
+    {
+      g_queue_unlink (&pool->slabs, &slab->link);
+
+      if (pool->n_free_slabs < GEGL_TILE_ALLOC_MAX_FREE_SLABS)
+        {
+          g_queue_push_tail_link (&pool->slabs, &slab->link);
+          pool->n_free_slabs++;
+          g_atomic_int_inc (&tile_alloc_free_slabs);
+        }
+      else
+        {
+          gegl_tile_alloc_slab_free (slab);
+        }
+    }
+
+  g_mutex_unlock (&pool->mutex);
+}
+
+
+/*  private functions, used by the rest of GEGL  */
+
+void
+gegl_tile_alloc_trim (void)
+{
+  gint n = g_atomic_int_get (&n_pools);
+  gint i;
+
+  for (i = 0; i < n; i++)
+    {
+      g_atomic_int_add (&tile_alloc_free_slabs,
+                        -gegl_tile_alloc_pool_trim (pools[i], 0));
+    }
+}
+
+void
+gegl_tile_alloc_cleanup (void)
+{
+  gint i;
+
+  gegl_tile_alloc_trim ();
+
+  g_mutex_lock (&pools_mutex);
+
+  /* pools with live pieces, i.e. leaked tiles, have to stay around, so we
+   * only free the pools if all of them are empty.
+   */
+  for (i = 0; i < n_pools; i++)
+    {
+      if (pools[i]->n_slabs)
+        break;
+    }
+
+  if (i == n_pools)
+    {
+      for (i = 0; i < n_pools; i++)
+        {
+          g_mutex_clear (&pools[i]->mutex);
+
+          g_slice_free (GeglTileAllocPool, pools[i]);
+
+          pools[i] = NULL;
+        }
+
+      g_atomic_int_set (&n_pools, 0);
+    }
+
+  g_mutex_unlock (&pools_mutex);
+}
+
+guint64
+gegl_tile_alloc_get_total (void)
+{
+  return (guintptr) g_atomic_pointer_get (&tile_alloc_total);
+}
+
+gint
+gegl_tile_alloc_get_free_slabs (void)
+{
+  return g_atomic_int_get (&tile_alloc_free_slabs);
+}
+
+gdouble
+gegl_tile_alloc_get_fragmentation (void)
+{
+  guintptr total = (guintptr) g_atomic_pointer_get (&tile_alloc_slab_total);
+  guintptr used  = (guintptr) g_atomic_pointer_get (&tile_alloc_slab_used);
+
+  if (! total || used >= total)
+    return 0.0;
+
+  return (gdouble) (total - used) / total;
+}
@@ -50,6 +50,7 @@
 #include "gegl-tile-backend-file.h"
 #include "gegl-buffer-index.h"
 #include "gegl-buffer-types.h"
+#include "gegl-tile-storage.h"
 #include "gegl-debug.h"
 #include "gegl-buffer-config.h"
 
@@ -311,12 +312,26 @@ gegl_tile_backend_file_entry_read (GeglTileBackendFile  *self,
                                    GeglFileBackendEntry *entry,
                                    guchar               *dest)
 {
-  gint    tile_size  = gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self));
-  gint    to_be_read = tile_size;
-  goffset offset     = entry->tile->offset;
+  GeglTileBackend *backend   = GEGL_TILE_BACKEND (self);
+  gint             tile_size = gegl_tile_backend_get_tile_size (backend);
+  gint             size      = tile_size;
+  gint             to_be_read;
+  goffset          offset    = entry->tile->offset;
+  guchar          *buffer    = dest;
 
   gegl_tile_backend_file_ensure_exist (self);
 
+  /* compressed data is never in the queue, since rewriting the tile moves
+   * it to an uncompressed slot
+   */
+  if (entry->compression)
+    {
+      size   = entry->size;
+      buffer = g_malloc (size);
+    }
+
+  to_be_read = size;
+
   if (entry->tile_link || in_progress)
     {
       GeglFileBackendThreadParams *queued_op = NULL;
@@ -346,6 +361,8 @@ gegl_tile_backend_file_entry_read (GeglTileBackendFile  *self,
       if (lseek (self->i, offset, SEEK_SET) < 0)
         {
           g_warning ("unable to seek to tile in buffer: %s", g_strerror (errno));
+          if (buffer != dest)
+            g_free (buffer);
           return;
         }
       self->in_offset = offset;
@@ -356,18 +373,35 @@ gegl_tile_backend_file_entry_read (GeglTileBackendFile  *self,
       GError *error = NULL;
       gint    byte_read;
 
-      byte_read = read (self->i, dest + tile_size - to_be_read, to_be_read);
+      byte_read = read (self->i, buffer + size - to_be_read, to_be_read);
       if (byte_read <= 0)
         {
           g_message ("unable to read tile data from self: "
                      "%s (%d/%d bytes read) %s",
                      g_strerror (errno), byte_read, to_be_read, error?error->message:"--");
+          if (buffer != dest)
+            g_free (buffer);
           return;
         }
       to_be_read      -= byte_read;
       self->in_offset += byte_read;
     }
 
+  if (buffer != dest)
+    {
+      if (! gegl_compression_decompress (entry->compression,
+                                         backend->priv->px_size,
+                                         dest,
+                                         tile_size / backend->priv->px_size,
+                                         buffer, size))
+        {
+          g_warning ("unable to decompress tile %i,%i,%i",
+                     entry->tile->x, entry->tile->y, entry->tile->z);
+        }
+
+      g_free (buffer);
+    }
+
   GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "read entry %i,%i,%i at %i", entry->tile->x, entry->tile->y, entry->tile->z, (gint)offset);
 }
 
@@ -430,30 +464,30 @@ gegl_tile_backend_file_file_entry_create (gint x,
   return entry;
 }
 
-static inline GeglFileBackendEntry *
-gegl_tile_backend_file_file_entry_new (GeglTileBackendFile *self)
+/* returns the offset of a free slot for the data of a tile */
+static guint64
+gegl_tile_backend_file_allocate (GeglTileBackendFile *self)
 {
-  GeglFileBackendEntry *entry = gegl_tile_backend_file_file_entry_create (0,0,0);
-
-  GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "Creating new entry");
+  guint64 offset;
 
   gegl_tile_backend_file_ensure_exist (self);
 
   if (self->free_list)
     {
-      guint64 offset = *(guint64*)self->free_list->data;
+      guint64 *free_offset = self->free_list->data;
 
-      entry->tile->offset = offset;
-      self->free_list = g_slist_remove (self->free_list, self->free_list->data);
+      offset = *free_offset;
+      self->free_list = g_slist_remove (self->free_list, free_offset);
+      g_free (free_offset);
 
-      GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "  set offset %i from free list", ((gint)entry->tile->offset));
+      GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "  set offset %i from free list", (gint)offset);
     }
   else
     {
       gint tile_size = gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self));
 
-      entry->tile->offset = self->next_pre_alloc;
-      GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "  set offset %i (next allocation)", (gint)entry->tile->offset);
+      offset = self->next_pre_alloc;
+      GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "  set offset %i (next allocation)", (gint)offset);
       self->next_pre_alloc += tile_size;
 
       if (self->next_pre_alloc >= self->total) /* automatic growing ensuring that
@@ -475,15 +509,55 @@ gegl_tile_backend_file_file_entry_new (GeglTileBackendFile *self)
         }
     }
   gegl_tile_backend_file_dbg_alloc (gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self)));
+  return offset;
+}
+
+static inline GeglFileBackendEntry *
+gegl_tile_backend_file_file_entry_new (GeglTileBackendFile *self)
+{
+  GeglFileBackendEntry *entry = gegl_tile_backend_file_file_entry_create (0,0,0);
+
+  GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "Creating new entry");
+
+  entry->tile->offset = gegl_tile_backend_file_allocate (self);
+
   return entry;
 }
 
+/* moves the data of an entry loaded from a revision 1 file, that is stored
+ * compressed, to a regular slot.
+ */
+static void
+gegl_tile_backend_file_expand_entry (GeglTileBackendFile  *self,
+                                     GeglFileBackendEntry *entry)
+{
+  gint    tile_size = gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self));
+  guchar *data      = g_malloc (tile_size);
+
+  gegl_tile_backend_file_entry_read (self, entry, data);
+
+  entry->tile->offset = gegl_tile_backend_file_allocate (self);
+  entry->compression  = NULL;
+
+  gegl_tile_backend_file_entry_write (self, entry, data);
+
+  g_free (data);
+}
+
 static void
 gegl_tile_backend_file_file_entry_destroy (GeglTileBackendFile  *self,
                                            GeglFileBackendEntry *entry)
 {
-  guint64 *offset = g_new (guint64, 1);
-  *offset = entry->tile->offset;
+  guint64 *offset = NULL;
+
+  /* the slots of compressed data are shorter than a tile, and can't be
+   * reused
+   */
+  if (! entry->compression)
+    {
+      offset  = g_new (guint64, 1);
+      *offset = entry->tile->offset;
+    }
 
   if (entry->tile_link || entry->block_link)
     {
@@ -509,7 +583,8 @@ gegl_tile_backend_file_file_entry_destroy (GeglTileBackendFile  *self,
       g_mutex_unlock (&mutex);
     }
 
-  self->free_list = g_slist_prepend (self->free_list, offset);
+  if (offset)
+    self->free_list = g_slist_prepend (self->free_list, offset);
   g_hash_table_remove (self->index, entry);
 
   gegl_tile_backend_file_dbg_dealloc (gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self)));
@@ -518,6 +593,23 @@ gegl_tile_backend_file_file_entry_destroy (GeglTileBackendFile  *self,
   g_free (entry);
 }
 
+/* the index is updated in place as a linked list of blocks, which is
+ * described by revision 0 of the header.  the tiles are rewritten
+ * uncompressed before, so the file gets the plain magic back.
+ */
+static void
+gegl_tile_backend_file_header_set_linked (GeglBufferHeader *header)
+{
+  memcpy (header->magic, "GEGL", 4);
+  gegl_buffer_header_set_rev (header, GEGL_FILE_SPEC_REV_LINKED);
+
+  header->index_offset   = 0;
+  header->n_entries      = 0;
+  header->index_checksum = 0;
+  header->n_levels       = 0;
+  memset (header->codecs, 0, sizeof (header->codecs));
+}
+
 static gboolean
 gegl_tile_backend_file_write_header (GeglTileBackendFile *self)
 {
@@ -732,6 +824,14 @@ gegl_tile_backend_file_set_tile (GeglTileSource *self,
       entry->tile->z = z;
       g_hash_table_insert (tile_backend_file->index, entry, entry);
     }
+  else if (entry->compression)
+    {
+      /* the slot of compressed data is too short to be rewritten in place,
+       * store the tile in a regular one.
+       */
+      entry->tile->offset = gegl_tile_backend_file_allocate (tile_backend_file);
+      entry->compression  = NULL;
+    }
   entry->tile->rev = gegl_tile_get_rev (tile);
 
   gegl_tile_backend_file_entry_write (tile_backend_file, entry, gegl_tile_get_data (tile));
@@ -798,11 +898,28 @@ gegl_tile_backend_file_flush (GeglTileSource *source,
 
   GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "flushing %s", self->path);
 
+  tiles = g_hash_table_get_keys (self->index);
+
+  /* the linked index can't describe compressed data, store the tiles that
+   * are still compressed, as loaded from a revision 1 file, uncompressed.
+   */
+  {
+    GList *iter;
+    for (iter = tiles; iter; iter = iter->next)
+      {
+        GeglFileBackendEntry *item = iter->data;
+
+        if (item->compression)
+          gegl_tile_backend_file_expand_entry (self, item);
+      }
+  }
+
+  gegl_tile_backend_file_header_set_linked (&self->header);
+
   self->header.rev ++;
   self->header.next = self->next_pre_alloc; /* this is the offset
                                                we start handing
                                                out headers from*/
-  tiles = g_hash_table_get_keys (self->index);
 
   if (tiles == NULL)
     self->header.next = 0;
@@ -1025,6 +1142,84 @@ gegl_tile_backend_file_equalfunc (gconstpointer a,
 }
 
 
+/* reads the linked index of a revision 0 file */
+static GList *
+gegl_tile_backend_file_read_linked_index (GeglTileBackendFile *self)
+{
+  GList   *tiles;
+  GList   *iter;
+  goffset  offset = self->header.next;
+
+  tiles = gegl_buffer_read_index (self->i, &offset);
+
+  for (iter = tiles; iter; iter = iter->next)
+    {
+      GeglFileBackendEntry *entry = g_new0 (GeglFileBackendEntry, 1);
+
+      entry->tile = iter->data;
+      iter->data  = entry;
+    }
+
+  return tiles;
+}
+
+/* reads the flat index of a revision 1 file */
+static GList *
+gegl_tile_backend_file_read_flat_index (GeglTileBackendFile *self)
+{
+  const GeglCompression *codecs[GEGL_FILE_N_CODECS] = { NULL, };
+  GeglBufferIndexEntry  *entries;
+  GList                 *tiles     = NULL;
+  gint                   tile_size = gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self));
+  gint                   i;
+
+  entries = gegl_buffer_read_flat_index (self->i, &self->header);
+
+  if (! entries)
+    return NULL;
+
+  for (i = 0; i < GEGL_FILE_N_CODECS; i++)
+    {
+      gchar name[sizeof (self->header.codecs[i]) + 1] = "";
+
+      memcpy (name, self->header.codecs[i], sizeof (self->header.codecs[i]));
+
+      if (*name)
+        codecs[i] = gegl_compression (name);
+    }
+
+  for (i = 0; i < (gint) self->header.n_entries; i++)
+    {
+      const GeglBufferIndexEntry *stored = &entries[i];
+      GeglFileBackendEntry       *entry;
+      gint                        codec  = stored->flags & GEGL_ENTRY_CODEC_MASK;
+
+      if (codec > GEGL_FILE_N_CODECS           ||
+          (codec && ! codecs[codec - 1])       ||
+          (! codec && stored->size != tile_size))
+        {
+          g_warning ("skipping unreadable tile %i,%i,%i in %s",
+                     stored->x, stored->y, stored->z, self->path);
+          continue;
+        }
+
+      entry = gegl_tile_backend_file_file_entry_create (stored->x,
+                                                        stored->y,
+                                                        stored->z);
+
+      entry->tile->offset = stored->offset;
+      entry->tile->rev    = stored->rev;
+      entry->compression  = codec ? codecs[codec - 1] : NULL;
+      entry->size         = stored->size;
+
+      tiles = g_list_prepend (tiles, entry);
+    }
+
+  g_free (entries);
+
+  return g_list_reverse (tiles);
+}
+
 static void
 gegl_tile_backend_file_load_index (GeglTileBackendFile *self,
                                    gboolean             block)
@@ -1032,6 +1227,7 @@ gegl_tile_backend_file_load_index (GeglTileBackendFile *self,
   GeglBufferHeader  new_header;
   GList            *iter;
   GeglTileBackend  *backend;
+  GeglTileStorage  *tile_storage;
   goffset           offset = 0;
   goffset           max    = 0;
   gint              tile_size;
@@ -1060,28 +1256,49 @@ gegl_tile_backend_file_load_index (GeglTileBackendFile *self,
     }
 
   tile_size       = gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self));
-  offset          = self->header.next;
-  self->tiles     = gegl_buffer_read_index (self->i, &offset);
   self->in_offset = self->out_offset = -1;
   backend         = GEGL_TILE_BACKEND (self);
 
+  if (gegl_buffer_header_get_rev (&self->header) == GEGL_FILE_SPEC_REV)
+    {
+      self->tiles = gegl_tile_backend_file_read_flat_index (self);
+
+      /* don't allocate tiles over the index, which the header points to
+       * until the next flush
+       */
+      max = self->header.index_offset +
+            self->header.n_entries * sizeof (GeglBufferIndexEntry);
+    }
+  else
+    {
+      self->tiles = gegl_tile_backend_file_read_linked_index (self);
+    }
+
   for (iter = self->tiles; iter; iter=iter->next)
     {
-      GeglBufferItem       *item     = iter->data;
-      GeglFileBackendEntry *new;
+      GeglFileBackendEntry *new      = iter->data;
+      GeglBufferTile       *item     = new->tile;
       GeglFileBackendEntry *existing =
-        gegl_tile_backend_file_lookup_entry (self, item->tile.x, item->tile.y, item->tile.z);
+        gegl_tile_backend_file_lookup_entry (self, item->x, item->y, item->z);
+      goffset               end;
 
-      if (item->tile.offset > max)
-        max = item->tile.offset + tile_size;
+      end = item->offset + (new->compression ? new->size : tile_size);
+      if (end > max)
+        max = end;
+
+      if (item->z > backend->priv->max_z)
+        backend->priv->max_z = item->z;
 
       if (existing)
         {
-          if (existing->tile->rev == item->tile.rev)
+          if (existing->tile->rev == item->rev)
             {
-              g_assert (existing->tile->offset == item->tile.offset);
-              *existing->tile = item->tile;
+              g_assert (existing->tile->offset == item->offset);
+              *existing->tile       = *item;
+              existing->compression = new->compression;
+              existing->size        = new->size;
               g_free (item);
+              g_free (new);
               continue;
             }
           else
@@ -1109,8 +1326,6 @@ gegl_tile_backend_file_load_index (GeglTileBackendFile *self,
               g_signal_emit_by_name (storage, "changed", &rect, NULL);
             }
         }
-      new = gegl_tile_backend_file_file_entry_create (0, 0, 0);
-      new->tile = iter->data;
       g_hash_table_insert (self->index, new, new);
     }
   g_list_free (self->tiles);
@@ -1118,6 +1333,11 @@ gegl_tile_backend_file_load_index (GeglTileBackendFile *self,
   self->next_pre_alloc = max; /* if bigger than own? */
   self->total          = max;
   self->tiles          = NULL;
+
+  /* stored levels above 0 have to be voided when the levels below change */
+  tile_storage = (void*)gegl_tile_backend_peek_storage (backend);
+  if (tile_storage && tile_storage->seen_zoom < backend->priv->max_z)
+    tile_storage->seen_zoom = backend->priv->max_z;
 }
 
 static void
@@ -1244,6 +1464,7 @@ gegl_tile_backend_file_ensure_exist (GeglTileBackendFile *self)
                                backend->priv->tile_height,
                                backend->priv->px_size,
                                backend->priv->format);
+      gegl_tile_backend_file_header_set_linked (&self->header);
       gegl_tile_backend_file_write_header (self);
       self->i = g_open (self->path, O_RDONLY, 0);
 
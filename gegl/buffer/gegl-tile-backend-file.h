@@ -21,6 +21,7 @@
 
 #include "gegl-tile-backend.h"
 #include "gegl-buffer-index.h"
+#include "gegl-compression.h"
 
 /***
  * GeglTileBackendFile is a GeglTileBackend that store tiles in a unique file.
@@ -54,6 +55,10 @@ typedef struct
      tile data or a GeglBufferBlock*/
   GList          *tile_link;
   GList          *block_link;
+  /* the compression of the data, for tiles loaded from a revision 1 file,
+     whose slot is then only size bytes long; NULL for uncompressed data */
+  const GeglCompression *compression;
+  guint32         size;
 } GeglFileBackendEntry;
 
 typedef struct
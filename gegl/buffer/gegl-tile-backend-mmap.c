@@ -0,0 +1,858 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* GeglTileBackendMmap serves the tiles of a GeglBuffer file straight out
+ * of a read-only memory mapping of the file.  Opening a revision 1 file only
+ * verifies its index, which is then searched in place; tile data is never
+ * read nor copied up front, and the pages of the file are shared, through
+ * the page cache, by all the processes mapping it.
+ *
+ * For each uncompressed tile in the file, the backend lazily creates a
+ * "mapped" tile, whose data points into the mapping, and hands out
+ * duplicates of it.  Since the mapped tile holds one of the clones, locking
+ * a duplicate for writing unclones it first, giving copy-on-write semantics.
+ * Compressed tiles are decompressed into private tiles on each access.
+ * Modified tiles are stored in memory, in place of the file data, and are
+ * never written back to the file.
+ *
+ * The file is expected to be immutable while it's mapped; truncating it
+ * from under the mapping results in SIGBUS when accessing the missing data.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib-object.h>
+
+#include "gegl-buffer.h"
+#include "gegl-buffer-backend.h"
+#include "gegl-tile-backend.h"
+#include "gegl-tile-backend-mmap.h"
+#include "gegl-buffer-index.h"
+#include "gegl-buffer-types.h"
+#include "gegl-debug.h"
+
+/* we need the private header to access the fields of tiles */
+#include "gegl-buffer-private.h"
+
+
+/* the alignment tile data needs to have in the mapping in order to be used
+ * in place, matching the alignment of gegl_malloc()
+ */
+#define TILE_DATA_ALIGNMENT 16
+
+
+typedef struct _MmapEntry MmapEntry;
+
+struct _MmapEntry
+{
+  gint                        x;
+  gint                        y;
+  gint                        z;
+
+  guint32                     rev;
+
+  /* the entry of the tile in the file's index, or NULL if the tile is not
+   * in the file, or has been voided
+   */
+  const GeglBufferIndexEntry *stored;
+
+  /* tile pointing into the mapping, created on demand */
+  GeglTile                   *mapped;
+
+  /* modified tile, replacing the file data */
+  GeglTile                   *tile;
+};
+
+
+G_DEFINE_TYPE (GeglTileBackendMmap, gegl_tile_backend_mmap, GEGL_TYPE_TILE_BACKEND)
+#define parent_class gegl_tile_backend_mmap_parent_class
+
+enum
+{
+  PROP_0,
+  PROP_PATH
+};
+
+
+static inline MmapEntry *
+gegl_tile_backend_mmap_lookup_entry (GeglTileBackendMmap *self,
+                                     gint                 x,
+                                     gint                 y,
+                                     gint                 z)
+{
+  MmapEntry key;
+
+  key.x = x;
+  key.y = y;
+  key.z = z;
+
+  return g_hash_table_lookup (self->index, &key);
+}
+
+static MmapEntry *
+gegl_tile_backend_mmap_add_entry (GeglTileBackendMmap *self,
+                                  gint                 x,
+                                  gint                 y,
+                                  gint                 z)
+{
+  MmapEntry *entry = g_slice_new0 (MmapEntry);
+
+  entry->x = x;
+  entry->y = y;
+  entry->z = z;
+
+  g_hash_table_replace (self->index, entry, entry);
+
+  return entry;
+}
+
+/* returns the entry of tile x, y, z, adding it from the file's index when
+ * it's first accessed, or NULL if there is no such tile.
+ */
+static MmapEntry *
+gegl_tile_backend_mmap_get_entry (GeglTileBackendMmap *self,
+                                  gint                 x,
+                                  gint                 y,
+                                  gint                 z)
+{
+  MmapEntry                  *entry;
+  const GeglBufferIndexEntry *stored;
+
+  entry = gegl_tile_backend_mmap_lookup_entry (self, x, y, z);
+
+  if (entry)
+    return entry;
+
+  stored = gegl_buffer_index_lookup (self->entries, self->n_entries, x, y, z);
+
+  if (! stored)
+    return NULL;
+
+  entry         = gegl_tile_backend_mmap_add_entry (self, x, y, z);
+  entry->stored = stored;
+  entry->rev    = stored->rev;
+
+  return entry;
+}
+
+static void
+gegl_tile_backend_mmap_entry_clear (MmapEntry *entry)
+{
+  if (entry->tile)
+    {
+      /* mark as stored to prevent an attempt to store by tile_unref */
+      gegl_tile_mark_as_stored (entry->tile);
+      g_clear_pointer (&entry->tile, gegl_tile_unref);
+    }
+
+  if (entry->mapped)
+    g_clear_pointer (&entry->mapped, gegl_tile_unref);
+}
+
+static gboolean
+gegl_tile_backend_mmap_verify (GeglTileBackendMmap        *self,
+                               const GeglBufferIndexEntry *stored,
+                               const guchar               *data)
+{
+  if ((stored->flags & GEGL_ENTRY_FLAG_CHECKSUM) &&
+      gegl_buffer_checksum (data, stored->size) != stored->checksum)
+    {
+      static gboolean warned = FALSE;
+
+      if (! warned)
+        {
+          g_warning ("%s: tile %d, %d, %d has a bad checksum, skipping it",
+                     self->path, stored->x, stored->y, stored->z);
+          warned = TRUE;
+        }
+
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static GeglTile *
+gegl_tile_backend_mmap_map_tile (GeglTileBackendMmap *self,
+                                 MmapEntry           *entry)
+{
+  gint      tile_size = gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self));
+  guchar   *data;
+  GeglTile *tile;
+
+  data = (guchar *) g_mapped_file_get_contents (self->mapped_file) +
+         entry->stored->offset;
+
+  if (! gegl_tile_backend_mmap_verify (self, entry->stored, data))
+    return NULL;
+
+  tile = gegl_tile_new_bare ();
+  gegl_tile_set_data_full (tile, data, tile_size,
+                           (GDestroyNotify) g_mapped_file_unref,
+                           g_mapped_file_ref (self->mapped_file));
+
+  return tile;
+}
+
+/* returns a private copy of the data of the tile, decompressing it if
+ * necessary, or NULL if it's corrupt.
+ */
+static GeglTile *
+gegl_tile_backend_mmap_read_tile (GeglTileBackendMmap *self,
+                                  MmapEntry           *entry)
+{
+  GeglTileBackend *backend   = GEGL_TILE_BACKEND (self);
+  gint             tile_size = gegl_tile_backend_get_tile_size (backend);
+  gint             codec     = entry->stored->flags & GEGL_ENTRY_CODEC_MASK;
+  const guchar    *data;
+  GeglTile        *tile;
+
+  data = (const guchar *) g_mapped_file_get_contents (self->mapped_file) +
+         entry->stored->offset;
+
+  if (! gegl_tile_backend_mmap_verify (self, entry->stored, data))
+    return NULL;
+
+  tile = gegl_tile_new (tile_size);
+
+  if (codec == GEGL_ENTRY_CODEC_NONE)
+    {
+      memcpy (gegl_tile_get_data (tile), data, tile_size);
+    }
+  else if (! gegl_compression_decompress (self->codecs[GEGL_ENTRY_CODEC_INDEX (codec)],
+                                          backend->priv->px_size,
+                                          gegl_tile_get_data (tile),
+                                          tile_size / backend->priv->px_size,
+                                          data, entry->stored->size))
+    {
+      g_warning ("%s: failed to decompress tile %d, %d, %d",
+                 self->path, entry->x, entry->y, entry->z);
+
+      gegl_tile_unref (tile);
+
+      return NULL;
+    }
+
+  return tile;
+}
+
+static GeglTile *
+gegl_tile_backend_mmap_get_tile (GeglTileSource *source,
+                                 gint            x,
+                                 gint            y,
+                                 gint            z)
+{
+  GeglTileBackendMmap *self = GEGL_TILE_BACKEND_MMAP (source);
+  MmapEntry           *entry;
+  GeglTile            *tile;
+
+  entry = gegl_tile_backend_mmap_get_entry (self, x, y, z);
+
+  if (! entry)
+    return NULL;
+
+  if (entry->tile)
+    return gegl_tile_ref (entry->tile);
+
+  if (! entry->stored)
+    return NULL;
+
+  if ((entry->stored->flags & GEGL_ENTRY_CODEC_MASK) == GEGL_ENTRY_CODEC_NONE &&
+      entry->stored->offset % TILE_DATA_ALIGNMENT == 0)
+    {
+      if (! entry->mapped)
+        entry->mapped = gegl_tile_backend_mmap_map_tile (self, entry);
+
+      tile = entry->mapped ? gegl_tile_dup (entry->mapped) : NULL;
+    }
+  else
+    {
+      /* the data is compressed, or misaligned in the file; copy it out of
+       * the mapping instead.
+       */
+      tile = gegl_tile_backend_mmap_read_tile (self, entry);
+    }
+
+  if (! tile)
+    {
+      /* treat corrupt tiles as missing */
+      entry->stored = NULL;
+
+      return NULL;
+    }
+
+  gegl_tile_set_rev (tile, entry->rev);
+  gegl_tile_mark_as_stored (tile);
+
+  return tile;
+}
+
+static gpointer
+gegl_tile_backend_mmap_set_tile (GeglTileSource *source,
+                                 GeglTile       *tile,
+                                 gint            x,
+                                 gint            y,
+                                 gint            z)
+{
+  GeglTileBackendMmap *self = GEGL_TILE_BACKEND_MMAP (source);
+  MmapEntry           *entry;
+
+  entry = gegl_tile_backend_mmap_get_entry (self, x, y, z);
+
+  if (! entry)
+    entry = gegl_tile_backend_mmap_add_entry (self, x, y, z);
+
+  if (entry->tile == tile)
+    {
+      gegl_tile_mark_as_stored (tile);
+
+      return NULL;
+    }
+
+  if (tile->ref_count == 0)
+    {
+      /* we've been handed a dead tile from within gegl_tile_unref(); it's
+       * still safe to duplicate it, which keeps its data alive.
+       */
+      tile = gegl_tile_dup (tile);
+
+      tile->x = x;
+      tile->y = y;
+      tile->z = z;
+    }
+  else
+    {
+      gegl_tile_ref (tile);
+    }
+
+  if (entry->tile)
+    {
+      /* mark as stored to prevent a recursive attempt to store the tile */
+      gegl_tile_mark_as_stored (entry->tile);
+      gegl_tile_unref (entry->tile);
+    }
+
+  entry->tile = tile;
+  entry->rev  = gegl_tile_get_rev (tile);
+
+  gegl_tile_mark_as_stored (tile);
+
+  return NULL;
+}
+
+static gpointer
+gegl_tile_backend_mmap_void_tile (GeglTileSource *source,
+                                  GeglTile       *tile,
+                                  gint            x,
+                                  gint            y,
+                                  gint            z)
+{
+  GeglTileBackendMmap *self = GEGL_TILE_BACKEND_MMAP (source);
+  MmapEntry           *entry;
+
+  entry = gegl_tile_backend_mmap_get_entry (self, x, y, z);
+
+  if (entry)
+    {
+      /* keep entries of tiles in the file, so that they're not looked up in
+       * the index again
+       */
+      if (entry->stored)
+        {
+          gegl_tile_backend_mmap_entry_clear (entry);
+          entry->stored = NULL;
+        }
+      else
+        {
+          g_hash_table_remove (self->index, entry);
+        }
+    }
+
+  return NULL;
+}
+
+static gpointer
+gegl_tile_backend_mmap_exist_tile (GeglTileSource *source,
+                                   GeglTile       *tile,
+                                   gint            x,
+                                   gint            y,
+                                   gint            z)
+{
+  GeglTileBackendMmap *self = GEGL_TILE_BACKEND_MMAP (source);
+  MmapEntry           *entry;
+
+  entry = gegl_tile_backend_mmap_lookup_entry (self, x, y, z);
+
+  if (entry)
+    return GINT_TO_POINTER (entry->tile || entry->stored);
+
+  return GINT_TO_POINTER (
+    gegl_buffer_index_lookup (self->entries, self->n_entries,
+                              x, y, z) != NULL);
+}
+
+static gpointer
+gegl_tile_backend_mmap_command (GeglTileSource  *source,
+                                GeglTileCommand  command,
+                                gint             x,
+                                gint             y,
+                                gint             z,
+                                gpointer         data)
+{
+  switch (command)
+    {
+      case GEGL_TILE_GET:
+        return gegl_tile_backend_mmap_get_tile (source, x, y, z);
+
+      case GEGL_TILE_SET:
+        return gegl_tile_backend_mmap_set_tile (source, data, x, y, z);
+
+      case GEGL_TILE_IDLE:
+        return NULL;
+
+      case GEGL_TILE_VOID:
+        return gegl_tile_backend_mmap_void_tile (source, data, x, y, z);
+
+      case GEGL_TILE_EXIST:
+        return gegl_tile_backend_mmap_exist_tile (source, data, x, y, z);
+
+      case GEGL_TILE_FLUSH:
+        /* the file is never written to */
+        return NULL;
+
+      default:
+        break;
+    }
+
+  return gegl_tile_backend_command (GEGL_TILE_BACKEND (source),
+                                    command, x, y, z, data);
+}
+
+/* walks the linked index of a revision 0 file, as described in
+ * gegl-buffer-index.h, converting it to a sorted array of entries.  since
+ * the file is untrusted, each block is checked to lie within the mapping.
+ */
+static gboolean
+gegl_tile_backend_mmap_load_linked_index (GeglTileBackendMmap *self)
+{
+  const gchar *contents  = g_mapped_file_get_contents (self->mapped_file);
+  gsize        length    = g_mapped_file_get_length (self->mapped_file);
+  gint         tile_size = gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self));
+  guint64      offset    = self->header.next;
+  gsize        max_count = length / sizeof (GeglBufferBlock);
+  gsize        count     = 0;
+  GArray      *entries;
+
+  if (tile_size > length)
+    return FALSE;
+
+  entries = g_array_new (FALSE, FALSE, sizeof (GeglBufferIndexEntry));
+
+  while (offset)
+    {
+      GeglBufferTile item;
+
+      if (offset > length - sizeof (GeglBufferBlock) || ++count > max_count)
+        break;
+
+      memcpy (&item.block, contents + offset, sizeof (GeglBufferBlock));
+
+      if (item.block.length < sizeof (GeglBufferBlock) ||
+          item.block.length > length - offset)
+        {
+          break;
+        }
+
+      if (item.block.flags == GEGL_FLAG_TILE)
+        {
+          GeglBufferIndexEntry entry = { 0, };
+
+          if (item.block.length < sizeof (GeglBufferTile))
+            break;
+
+          memcpy (&item, contents + offset, sizeof (GeglBufferTile));
+
+          if (item.offset < sizeof (GeglBufferHeader) ||
+              item.offset > length - tile_size)
+            {
+              break;
+            }
+
+          entry.x      = item.x;
+          entry.y      = item.y;
+          entry.z      = item.z;
+          entry.offset = item.offset;
+          entry.size   = tile_size;
+          entry.rev    = item.rev;
+
+          g_array_append_val (entries, entry);
+        }
+
+      offset = item.block.next;
+    }
+
+  if (offset)
+    {
+      g_array_free (entries, TRUE);
+
+      return FALSE;
+    }
+
+  g_array_sort (entries, gegl_buffer_index_entry_compare);
+
+  self->n_entries         = entries->len;
+  self->converted_entries = (GeglBufferIndexEntry *) g_array_free (entries,
+                                                                   FALSE);
+  self->entries           = self->converted_entries;
+
+  return TRUE;
+}
+
+/* checks the flat index of a revision 1 file, which is then searched in
+ * place.
+ */
+static gboolean
+gegl_tile_backend_mmap_load_flat_index (GeglTileBackendMmap *self)
+{
+  const gchar                *contents  = g_mapped_file_get_contents (self->mapped_file);
+  gsize                       length    = g_mapped_file_get_length (self->mapped_file);
+  gint                        tile_size = gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self));
+  const GeglBufferHeader     *header    = &self->header;
+  const GeglBufferIndexEntry *entries;
+  gsize                       size;
+  gint                        i;
+
+  if (header->n_entries > length / sizeof (GeglBufferIndexEntry))
+    return FALSE;
+
+  size = header->n_entries * sizeof (GeglBufferIndexEntry);
+
+  if (header->index_offset > length - size)
+    return FALSE;
+
+  if (gegl_buffer_checksum (contents + header->index_offset, size) !=
+      header->index_checksum)
+    {
+      return FALSE;
+    }
+
+  for (i = 0; i < GEGL_FILE_N_CODECS; i++)
+    {
+      gchar name[sizeof (header->codecs[i]) + 1] = "";
+
+      memcpy (name, header->codecs[i], sizeof (header->codecs[i]));
+
+      if (! *name)
+        continue;
+
+      self->codecs[i] = gegl_compression (name);
+
+      if (! self->codecs[i])
+        {
+          g_warning ("%s: unknown compression algorithm '%s'",
+                     self->path, name);
+        }
+    }
+
+  if (header->index_offset % sizeof (guint64))
+    {
+      /* the entries are misaligned in the file; copy them out of the
+       * mapping instead.
+       */
+      self->converted_entries = g_malloc (MAX (size, 1));
+      memcpy (self->converted_entries, contents + header->index_offset, size);
+
+      entries = self->converted_entries;
+    }
+  else
+    {
+      entries = (const GeglBufferIndexEntry *) (contents +
+                                                header->index_offset);
+    }
+
+  for (i = 0; i < (gint) header->n_entries; i++)
+    {
+      const GeglBufferIndexEntry *entry = &entries[i];
+      gint                        codec = entry->flags & GEGL_ENTRY_CODEC_MASK;
+
+      if (codec > GEGL_FILE_N_CODECS                                   ||
+          (codec != GEGL_ENTRY_CODEC_NONE &&
+           ! self->codecs[GEGL_ENTRY_CODEC_INDEX (codec)])              ||
+          (codec == GEGL_ENTRY_CODEC_NONE && entry->size != tile_size) ||
+          entry->offset < sizeof (GeglBufferHeader)                    ||
+          entry->offset > length                                       ||
+          entry->size > length - entry->offset)
+        {
+          return FALSE;
+        }
+    }
+
+  self->entries   = entries;
+  self->n_entries = header->n_entries;
+
+  return TRUE;
+}
+
+static gboolean
+gegl_tile_backend_mmap_load_index (GeglTileBackendMmap *self)
+{
+  GeglTileBackend *backend = GEGL_TILE_BACKEND (self);
+  gboolean         success;
+
+  if (gegl_buffer_header_get_rev (&self->header) == GEGL_FILE_SPEC_REV)
+    success = gegl_tile_backend_mmap_load_flat_index (self);
+  else
+    success = gegl_tile_backend_mmap_load_linked_index (self);
+
+  if (! success)
+    return FALSE;
+
+  /* the entries are sorted by z first */
+  if (self->n_entries > 0)
+    backend->priv->max_z = MAX (self->entries[self->n_entries - 1].z, 0);
+
+  GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "mapped %s, %d tiles, %d levels",
+             self->path, self->n_entries, backend->priv->max_z + 1);
+
+  return TRUE;
+}
+
+static void
+gegl_tile_backend_mmap_set_property (GObject      *object,
+                                     guint         property_id,
+                                     const GValue *value,
+                                     GParamSpec   *pspec)
+{
+  GeglTileBackendMmap *self = GEGL_TILE_BACKEND_MMAP (object);
+
+  switch (property_id)
+    {
+      case PROP_PATH:
+        g_free (self->path);
+        self->path = g_value_dup_string (value);
+        break;
+
+      default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+        break;
+    }
+}
+
+static void
+gegl_tile_backend_mmap_get_property (GObject    *object,
+                                     guint       property_id,
+                                     GValue     *value,
+                                     GParamSpec *pspec)
+{
+  GeglTileBackendMmap *self = GEGL_TILE_BACKEND_MMAP (object);
+
+  switch (property_id)
+    {
+      case PROP_PATH:
+        g_value_set_string (value, self->path);
+        break;
+
+      default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+        break;
+    }
+}
+
+static void
+gegl_tile_backend_mmap_finalize (GObject *object)
+{
+  GeglTileBackendMmap *self = GEGL_TILE_BACKEND_MMAP (object);
+
+  g_hash_table_unref (self->index);
+
+  g_free (self->converted_entries);
+
+  /* the tiles still pointing into the mapping keep it alive */
+  if (self->mapped_file)
+    g_mapped_file_unref (self->mapped_file);
+
+  g_free (self->path);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static guint
+gegl_tile_backend_mmap_hashfunc (gconstpointer key)
+{
+  const MmapEntry *e    = key;
+  guint            hash;
+  gint             i;
+  gint             srcA = e->x;
+  gint             srcB = e->y;
+  gint             srcC = e->z;
+
+  /* interleave the 10 least significant bits of all coordinates,
+   * this gives us Z-order / morton order of the space and should
+   * work well as a hash
+   */
+  hash = 0;
+  for (i = 9; i >= 0; i--)
+    {
+#define ADD_BIT(bit)    do { hash |= (((bit) != 0) ? 1 : 0); hash <<= 1; } while (0)
+      ADD_BIT (srcA & (1 << i));
+      ADD_BIT (srcB & (1 << i));
+      ADD_BIT (srcC & (1 << i));
+#undef ADD_BIT
+    }
+  return hash;
+}
+
+static gboolean
+gegl_tile_backend_mmap_equalfunc (gconstpointer a,
+                                  gconstpointer b)
+{
+  const MmapEntry *ea = a;
+  const MmapEntry *eb = b;
+
+  return ea->x == eb->x &&
+         ea->y == eb->y &&
+         ea->z == eb->z;
+}
+
+static void
+gegl_tile_backend_mmap_entry_free (gpointer data)
+{
+  MmapEntry *entry = data;
+
+  gegl_tile_backend_mmap_entry_clear (entry);
+
+  g_slice_free (MmapEntry, entry);
+}
+
+static void
+gegl_tile_backend_mmap_constructed (GObject *object)
+{
+  G_OBJECT_CLASS (parent_class)->constructed (object);
+
+  gegl_tile_backend_set_flush_on_destroy (GEGL_TILE_BACKEND (object), FALSE);
+}
+
+static void
+gegl_tile_backend_mmap_class_init (GeglTileBackendMmapClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->get_property = gegl_tile_backend_mmap_get_property;
+  gobject_class->set_property = gegl_tile_backend_mmap_set_property;
+  gobject_class->constructed  = gegl_tile_backend_mmap_constructed;
+  gobject_class->finalize     = gegl_tile_backend_mmap_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_PATH,
+                                   g_param_spec_string ("path",
+                                                        "path",
+                                                        "The path of the mapped buffer file",
+                                                        NULL,
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_READWRITE));
+}
+
+static void
+gegl_tile_backend_mmap_init (GeglTileBackendMmap *self)
+{
+  GEGL_TILE_SOURCE (self)->command = gegl_tile_backend_mmap_command;
+
+  self->index = g_hash_table_new_full (gegl_tile_backend_mmap_hashfunc,
+                                       gegl_tile_backend_mmap_equalfunc,
+                                       NULL,
+                                       gegl_tile_backend_mmap_entry_free);
+}
+
+GeglTileBackend *
+gegl_tile_backend_mmap_new (const gchar *path)
+{
+  GeglTileBackendMmap *self;
+  GMappedFile         *mapped_file;
+  GeglBufferHeader     header;
+  const Babl          *format;
+  GError              *error = NULL;
+
+  g_return_val_if_fail (path != NULL, NULL);
+
+  mapped_file = g_mapped_file_new (path, FALSE, &error);
+
+  if (! mapped_file)
+    {
+      GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "failed to map %s: %s",
+                 path, error->message);
+      g_error_free (error);
+
+      return NULL;
+    }
+
+  if (g_mapped_file_get_length (mapped_file) < sizeof (GeglBufferHeader))
+    goto fail;
+
+  memcpy (&header, g_mapped_file_get_contents (mapped_file),
+          sizeof (GeglBufferHeader));
+
+  if (! gegl_buffer_header_check_magic (&header)                        ||
+      (gegl_buffer_header_get_rev (&header) != GEGL_FILE_SPEC_REV &&
+       gegl_buffer_header_get_rev (&header) != GEGL_FILE_SPEC_REV_LINKED) ||
+      (header.flags & GEGL_FLAG_LOCKED)                                 ||
+      ! memchr (header.description, '\0', sizeof (header.description)) ||
+      header.tile_width == 0 || header.tile_height == 0)
+    {
+      goto fail;
+    }
+
+  format = babl_format (header.description);
+
+  /* the pixel data is used as is, so it has to be laid out as the format
+   * says.
+   */
+  if (! format ||
+      babl_format_get_bytes_per_pixel (format) != header.bytes_per_pixel)
+    {
+      goto fail;
+    }
+
+  self = g_object_new (GEGL_TYPE_TILE_BACKEND_MMAP,
+                       "tile-width",  (gint) header.tile_width,
+                       "tile-height", (gint) header.tile_height,
+                       "format",      format,
+                       "path",        path,
+                       NULL);
+
+  self->mapped_file = mapped_file;
+  self->header      = header;
+
+  if (! gegl_tile_backend_mmap_load_index (self))
+    {
+      g_warning ("%s: '%s' has a corrupt index", G_STRFUNC, path);
+      g_object_unref (self);
+
+      return NULL;
+    }
+
+  gegl_tile_backend_set_extent (GEGL_TILE_BACKEND (self),
+                                GEGL_RECTANGLE (header.x, header.y,
+                                                header.width, header.height));
+
+  return GEGL_TILE_BACKEND (self);
+
+fail:
+  GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "can't map %s", path);
+  g_mapped_file_unref (mapped_file);
+
+  return NULL;
+}
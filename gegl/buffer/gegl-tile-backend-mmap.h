@@ -0,0 +1,88 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GEGL_TILE_BACKEND_MMAP_H__
+#define __GEGL_TILE_BACKEND_MMAP_H__
+
+#include "gegl-tile-backend.h"
+#include "gegl-buffer-index.h"
+#include "gegl-compression.h"
+
+/***
+ * GeglTileBackendMmap is a GeglTileBackend that serves the tiles of a
+ * GeglBuffer file directly out of a read-only memory mapping of the file.
+ * Tiles that are modified are kept in memory, and are never written back
+ * to the file.
+ */
+
+G_BEGIN_DECLS
+
+#define GEGL_TYPE_TILE_BACKEND_MMAP            (gegl_tile_backend_mmap_get_type ())
+#define GEGL_TILE_BACKEND_MMAP(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GEGL_TYPE_TILE_BACKEND_MMAP, GeglTileBackendMmap))
+#define GEGL_TILE_BACKEND_MMAP_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  GEGL_TYPE_TILE_BACKEND_MMAP, GeglTileBackendMmapClass))
+#define GEGL_IS_TILE_BACKEND_MMAP(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GEGL_TYPE_TILE_BACKEND_MMAP))
+#define GEGL_IS_TILE_BACKEND_MMAP_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  GEGL_TYPE_TILE_BACKEND_MMAP))
+#define GEGL_TILE_BACKEND_MMAP_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  GEGL_TYPE_TILE_BACKEND_MMAP, GeglTileBackendMmapClass))
+
+
+typedef struct _GeglTileBackendMmap      GeglTileBackendMmap;
+typedef struct _GeglTileBackendMmapClass GeglTileBackendMmapClass;
+
+struct _GeglTileBackendMmap
+{
+  GeglTileBackend             parent_instance;
+
+  gchar                      *path;
+
+  /* the mapping of the whole file.  each tile pointing into the mapping
+   * holds a reference to it, so that it outlives the backend if needed.
+   */
+  GMappedFile                *mapped_file;
+
+  GeglBufferHeader            header;
+
+  /* the index of the file, sorted by z, y and x.  for revision 1 files it
+   * points into the mapping, for revision 0 files it's converted from the
+   * linked list of blocks.
+   */
+  const GeglBufferIndexEntry *entries;
+  gint                        n_entries;
+  GeglBufferIndexEntry       *converted_entries;
+
+  /* the compression algorithms named in the header */
+  const GeglCompression      *codecs[GEGL_FILE_N_CODECS];
+
+  /* hashtable of MmapEntry's, containing the tiles accessed so far, as well
+   * as the tiles modified or voided since the file was mapped
+   */
+  GHashTable                 *index;
+};
+
+struct _GeglTileBackendMmapClass
+{
+  GeglTileBackendClass parent_class;
+};
+
+GType             gegl_tile_backend_mmap_get_type (void) G_GNUC_CONST;
+
+/* returns a new backend for the GeglBuffer file at @path, or NULL if the
+ * file can't be mapped, or isn't a valid GeglBuffer file.
+ */
+GeglTileBackend * gegl_tile_backend_mmap_new      (const gchar *path);
+
+G_END_DECLS
+
+#endif
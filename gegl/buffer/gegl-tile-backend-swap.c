@@ -43,6 +43,7 @@
 #include "gegl-tile-backend-swap.h"
 #include "gegl-debug.h"
 #include "gegl-buffer-config.h"
+#include "gegl-compression.h"
 
 
 #ifndef HAVE_FSYNC
@@ -61,6 +62,24 @@
  */
 #define QUEUED_MAX_RATIO 0.1
 
+/* maximal size of data read ahead of time from the swap, and not consumed
+ * yet, as a factor of the maximal cache size.
+ */
+#define PREFETCH_MAX_RATIO 0.05
+
+/* maximal number of threads writing to the swap, and reading from it ahead
+ * of time.  the actual number depends on the number of processors.
+ */
+#define MAX_WRITER_THREADS 4
+#define MAX_READER_THREADS 2
+
+/* maximal number of reads served by a reader thread at once.  the reads of
+ * a batch are sorted by offset, and reads of adjacent data are coalesced,
+ * up to READ_COALESCE_MAX bytes.
+ */
+#define READ_BATCH_SIZE   16
+#define READ_COALESCE_MAX (1 << 20)
+
 
 G_DEFINE_TYPE (GeglTileBackendSwap, gegl_tile_backend_swap, GEGL_TYPE_TILE_BACKEND)
 
@@ -73,11 +92,38 @@ typedef enum
   OP_DESTROY,
 } ThreadOp;
 
+typedef enum
+{
+  READ_QUEUED,
+  READ_IN_PROGRESS,
+  READ_DONE
+} ReadState;
+
+typedef struct _ThreadParams ThreadParams;
+typedef struct _ReadParams   ReadParams;
+
 typedef struct
 {
-  gint    ref_count;
-  gint64  offset;
-  GList  *link;
+  gint                   ref_count;
+  gint64                 offset;
+  gint                   size;        /* size of the stored data, which is
+                                       * smaller than the tile size when the
+                                       * data is compressed
+                                       */
+  const GeglCompression *compression; /* compression algorithm of the stored
+                                       * data, or NULL if uncompressed
+                                       */
+  GList                 *link;
+
+  /* compressed copy of the data, kept in the in-memory pool */
+  guchar                *pool_data;
+  gint                   pool_size;
+  gint                   pool_length;
+  const GeglCompression *pool_compression;
+  GList                  pool_link;
+
+  ThreadParams          *in_progress; /* write op currently being served */
+  ReadParams            *read;        /* pending or completed prefetch */
 } SwapBlock;
 
 typedef struct
@@ -88,14 +134,39 @@ typedef struct
   SwapBlock *block;
 } SwapEntry;
 
-typedef struct
+struct _ThreadParams
 {
-  SwapBlock *block;
-  gint       length;
-  gint       cost;
-  GeglTile  *tile;
-  ThreadOp   operation;
-} ThreadParams;
+  SwapBlock             *block;
+  gint                   length;
+  gint                   cost;
+  gint                   px_size;
+  GeglTile              *tile;
+  guchar                *data;        /* already-compressed data, written
+                                       * instead of the tile's data, when
+                                       * evicted from the pool
+                                       */
+  gint                   size;
+  const GeglCompression *compression;
+  ThreadOp               operation;
+  gint64                 time;        /* time the op was queued */
+};
+
+/* a read of a block's stored data ahead of time, served by a reader thread */
+struct _ReadParams
+{
+  SwapBlock             *block;       /* NULL if the read was cancelled while
+                                       * in progress
+                                       */
+  gint64                 offset;
+  gint                   size;
+  const GeglCompression *compression;
+  ReadState              state;
+  guchar                *data;        /* the stored data, once done */
+  gint64                 time;        /* time the read was queued */
+  GList                  link;        /* link in read_queue, or in
+                                       * prefetch_queue once done
+                                       */
+};
 
 typedef struct
 {
@@ -110,9 +181,19 @@ static void        gegl_tile_backend_swap_resize                 (gint64
 static SwapGap *   gegl_tile_backend_swap_gap_new                (gint64                    start,
                                                                   gint64                    end);
 static gint64      gegl_tile_backend_swap_find_offset            (gint                      tile_size);
-static void        gegl_tile_backend_swap_write                  (ThreadParams             *params);
+static void        gegl_tile_backend_swap_free_data              (gint64                    start,
+                                                                  gint64                    end);
+static void        gegl_tile_backend_swap_write                  (ThreadParams             *params,
+                                                                  guchar                  **buffer,
+                                                                  gint                     *buffer_size);
 static void        gegl_tile_backend_swap_destroy                (ThreadParams             *params);
+static gboolean    gegl_tile_backend_swap_pool_add               (ThreadParams             *params,
+                                                                  const guchar             *data,
+                                                                  gint                      size,
+                                                                  const GeglCompression    *data_compression);
 static gpointer    gegl_tile_backend_swap_writer_thread          (gpointer ignored);
+static gpointer    gegl_tile_backend_swap_reader_thread          (gpointer ignored);
+static void        gegl_tile_backend_swap_read_cancel            (ReadParams               *read);
 static GeglTile   *gegl_tile_backend_swap_entry_read             (GeglTileBackendSwap      *self,
                                                                   SwapEntry                *entry);
 static void        gegl_tile_backend_swap_entry_write            (GeglTileBackendSwap      *self,
@@ -157,6 +238,10 @@ static gpointer    gegl_tile_backend_swap_exist_tile             (GeglTileSource
                                                                   gint                      x,
                                                                   gint                      y,
                                                                   gint                      z);
+static gpointer    gegl_tile_backend_swap_prefetch_tile          (GeglTileSource           *self,
+                                                                  gint                      x,
+                                                                  gint                      y,
+                                                                  gint                      z);
 static gpointer    gegl_tile_backend_swap_copy_tile              (GeglTileSource           *self,
                                                                   gint                      x,
                                                                   gint                      y,
@@ -178,6 +263,12 @@ static void        gegl_tile_backend_swap_class_init             (GeglTileBacken
 static void        gegl_tile_backend_swap_tile_cache_size_notify (GObject                  *config,
                                                                   GParamSpec               *pspec,
                                                                   gpointer                  data);
+static void        gegl_tile_backend_swap_compression_notify     (GObject                  *config,
+                                                                  GParamSpec               *pspec,
+                                                                  gpointer                  data);
+static void        gegl_tile_backend_swap_pool_size_notify       (GObject                  *config,
+                                                                  GParamSpec               *pspec,
+                                                                  gpointer                  data);
 static void        gegl_tile_backend_swap_init                   (GeglTileBackendSwap      *self);
 void               gegl_tile_backend_swap_cleanup                (void);
 
@@ -185,39 +276,83 @@ void               gegl_tile_backend_swap_cleanup                (void);
 static gchar    *path         = NULL;
 static gint      in_fd        = -1;
 static gint      out_fd       = -1;
-static gint64    in_offset    = 0;
-static gint64    out_offset   = 0;
 static GList    *gap_list     = NULL;
 static gint64    file_size    = 0;
 static gint64    total        = 0;
 static guintptr  cloned_total = 0;
 static gboolean  busy         = FALSE;
-static gboolean  reading      = FALSE;
+static gint      reading      = 0;
 static gint64    read_total   = 0;
-static gboolean  writing      = FALSE;
+static gint      writing      = 0;
 static gint64    write_total  = 0;
 static gint64    queued_total = 0;
 static gint64    queued_cost  = 0;
 static gint64    queued_max   = 0;
 static gint      queue_stalls = 0;
 
-static GThread      *writer_thread = NULL;
-static GQueue       *queue         = NULL;
-static ThreadParams *in_progress   = NULL;
-static gboolean      exit_thread   = FALSE;
-static GMutex        read_mutex;
-static GMutex        queue_mutex;
-static GCond         queue_cond;
-static GCond         push_cond;
+static gint64    read_latency  = 0; /* microseconds, summed over all reads */
+static gint      read_count    = 0;
+static gint64    write_latency = 0; /* microseconds, summed over all writes */
+static gint      write_count   = 0;
+
+static const GeglCompression *compression             = NULL;
+static gint64                 total_uncompressed      = 0;
+static gint64                 compression_time        = 0; /* microseconds */
+static gint64                 decompression_time      = 0; /* microseconds */
+
+/* the pool is an in-memory tier, holding compressed tile data, which absorbs
+ * writes before they reach the swap file.  blocks are kept in LRU order, and
+ * are only written to the swap file when evicted from the pool.  all pool
+ * state is protected by queue_mutex.
+ */
+static GQueue    pool_queue              = G_QUEUE_INIT;
+static gint64    pool_total              = 0;
+static gint64    pool_total_uncompressed = 0;
+static gint64    pool_max                = 0;
+static gint      pool_hits               = 0;
+static gint      pool_misses             = 0;
+
+/* reads ahead of time, requested through GEGL_TILE_PREFETCH, are queued in
+ * read_queue, and served in batches by the reader threads.  completed reads
+ * are kept in prefetch_queue, oldest first, until the tile is read, or until
+ * they're dropped to make room for newer ones.  all prefetch state is
+ * protected by queue_mutex.
+ */
+static GQueue    read_queue          = G_QUEUE_INIT;
+static GQueue    prefetch_queue      = G_QUEUE_INIT;
+static gint      n_reads_in_progress = 0;
+static gint64    prefetch_total      = 0;
+static gint64    prefetch_max        = 0;
+static gint      prefetch_hits       = 0;
+
+static GThread  *writer_threads[MAX_WRITER_THREADS];
+static gint      n_writer_threads    = 0;
+static GThread  *reader_threads[MAX_READER_THREADS];
+static gint      n_reader_threads    = 0;
+static GQueue   *queue               = NULL;
+static gint      n_in_progress       = 0;
+static gboolean  exit_thread         = FALSE;
+static GMutex    alloc_mutex;        /* protects the swap file allocation */
+static GMutex    queue_mutex;
+static GCond     queue_cond;
+static GCond     push_cond;
+static GCond     read_cond;          /* signaled when reads are queued */
+static GCond     read_done_cond;     /* broadcast when reads complete */
+#if ! defined (HAVE_PREAD) || ! defined (HAVE_PWRITE)
+static GMutex    seek_mutex;
+#endif
 
 
 static void
 gegl_tile_backend_swap_push_queue (ThreadParams *params,
                                    gboolean      head)
 {
-  if (params->tile)
+  if (params->tile || params->data)
     {
-      if (queued_cost > queued_max)
+      /* data evicted from the pool is mostly pushed by the writer threads,
+       * which are the ones draining the queue, so it never waits for room.
+       */
+      if (params->tile && queued_cost > queued_max)
         {
           queue_stalls++;
 
@@ -231,18 +366,136 @@ gegl_tile_backend_swap_push_queue (ThreadParams *params,
 
   busy = TRUE;
 
+  params->time = g_get_monotonic_time ();
+
   if (head)
     g_queue_push_head (queue, params);
   else
     g_queue_push_tail (queue, params);
 
   if (params->block)
-    params->block->link = g_queue_peek_tail_link (queue);
+    {
+      params->block->link = head ? g_queue_peek_head_link (queue) :
+                                   g_queue_peek_tail_link (queue);
+    }
 
-  /* wake up the writer thread */
+  /* wake up a writer thread */
   g_cond_signal (&queue_cond);
 }
 
+/* pops the first op that can be served, skipping ops of blocks currently
+ * being written by another thread, which must be served in order.  should be
+ * called with queue_mutex locked.
+ */
+static ThreadParams *
+gegl_tile_backend_swap_pop_queue (void)
+{
+  GList *link;
+
+  for (link = g_queue_peek_head_link (queue); link; link = g_list_next (link))
+    {
+      ThreadParams *params = link->data;
+
+      if (params->block->in_progress)
+        continue;
+
+      g_queue_delete_link (queue, link);
+
+      params->block->link = NULL;
+
+      /* a destroy op frees the block, so it's only marked for writes */
+      if (params->operation == OP_WRITE)
+        params->block->in_progress = params;
+
+      n_in_progress++;
+
+      return params;
+    }
+
+  return NULL;
+}
+
+static gssize
+gegl_tile_backend_swap_pread (gint     fd,
+                              gpointer data,
+                              gsize    size,
+                              gint64   offset)
+{
+#ifdef HAVE_PREAD
+  return pread (fd, data, size, offset);
+#else
+  gssize result = -1;
+
+  g_mutex_lock (&seek_mutex);
+
+  if (lseek (fd, offset, SEEK_SET) >= 0)
+    result = read (fd, data, size);
+
+  g_mutex_unlock (&seek_mutex);
+
+  return result;
+#endif
+}
+
+static gssize
+gegl_tile_backend_swap_pwrite (gint          fd,
+                               gconstpointer data,
+                               gsize         size,
+                               gint64        offset)
+{
+#ifdef HAVE_PWRITE
+  return pwrite (fd, data, size, offset);
+#else
+  gssize result = -1;
+
+  g_mutex_lock (&seek_mutex);
+
+  if (lseek (fd, offset, SEEK_SET) >= 0)
+    result = write (fd, data, size);
+
+  g_mutex_unlock (&seek_mutex);
+
+  return result;
+#endif
+}
+
+/* reads @size bytes at @offset of the swap file into @data.  reads don't
+ * need to be serialized, and may be performed concurrently by several
+ * threads.
+ */
+static gboolean
+gegl_tile_backend_swap_read_data (gpointer data,
+                                  gint     size,
+                                  gint64   offset)
+{
+  gint to_be_read = size;
+
+  g_atomic_int_inc (&reading);
+
+  while (to_be_read > 0)
+    {
+      gssize byte_read;
+
+      byte_read = gegl_tile_backend_swap_pread (in_fd,
+                                                (guchar *) data + size - to_be_read,
+                                                to_be_read,
+                                                offset + size - to_be_read);
+      if (byte_read <= 0)
+        {
+          g_message ("unable to read tile data from swap: "
+                     "%s (%d/%d bytes read)",
+                     g_strerror (errno), (gint) byte_read, to_be_read);
+          break;
+        }
+
+      to_be_read -= byte_read;
+    }
+
+  g_atomic_int_add (&reading, -1);
+
+  return to_be_read == 0;
+}
+
 static void
 gegl_tile_backend_swap_resize (gint64 size)
 {
@@ -318,56 +571,155 @@ gegl_tile_backend_swap_find_offset (gint tile_size)
   return offset;
 }
 
+/* compresses the tile data of a write op, using the current compression
+ * algorithm.  returns the data to be written, and its size, which is either
+ * the compressed data, or the original data if it can't be compressed.
+ * data evicted from the pool is returned as is.
+ *
+ * @buffer is the calling writer thread's compression buffer, grown as
+ * necessary.
+ */
+static const guchar *
+gegl_tile_backend_swap_compress (ThreadParams           *params,
+                                 gint                   *size,
+                                 const GeglCompression **data_compression,
+                                 guchar                **buffer,
+                                 gint                   *buffer_size)
+{
+  const GeglCompression *algorithm = g_atomic_pointer_get (&compression);
+  const guchar          *data;
+  gint64                 time;
+
+  if (params->data)
+    {
+      /* the data was already compressed when it was added to the pool */
+      *size             = params->size;
+      *data_compression = params->compression;
+
+      return params->data;
+    }
+
+  data              = gegl_tile_get_data (params->tile);
+  *size             = params->length;
+  *data_compression = NULL;
+
+  if (! algorithm)
+    return data;
+
+  time = g_get_monotonic_time ();
+
+  if (*buffer_size < params->length)
+    {
+      g_free (*buffer);
+
+      *buffer_size = params->length;
+      *buffer      = g_malloc (*buffer_size);
+    }
+
+  /* only use the compressed data if it's actually smaller */
+  if (gegl_compression_compress (algorithm, params->px_size,
+                                 data, params->length / params->px_size,
+                                 *buffer, size,
+                                 params->length - 1))
+    {
+      data              = *buffer;
+      *data_compression = algorithm;
+    }
+  else
+    {
+      *size = params->length;
+    }
+
+  /* compression_time is updated by all the writer threads */
+  g_mutex_lock (&queue_mutex);
+  compression_time += g_get_monotonic_time () - time;
+  g_mutex_unlock (&queue_mutex);
+
+  return data;
+}
+
 static void
-gegl_tile_backend_swap_write (ThreadParams *params)
+gegl_tile_backend_swap_write (ThreadParams  *params,
+                              guchar       **buffer,
+                              gint          *buffer_size)
 {
-  gint   to_be_written = params->length;
-  gint64 offset        = params->block->offset;
+  const GeglCompression *data_compression;
+  const guchar          *data;
+  gint                   size;
+  gint                   to_be_written;
+  gint64                 offset        = params->block->offset;
+
+  data          = gegl_tile_backend_swap_compress (params,
+                                                   &size, &data_compression,
+                                                   buffer, buffer_size);
+  to_be_written = size;
+
+  if (gegl_tile_backend_swap_pool_add (params, data, size, data_compression))
+    {
+      GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "writer thread added data to pool");
+
+      return;
+    }
+
+  /* the swap file is allocated by all the writer threads */
+  g_mutex_lock (&alloc_mutex);
 
   gegl_tile_backend_swap_ensure_exist ();
 
-  if (offset < 0)
+  if (offset >= 0 && size != params->block->size)
     {
-      /* storage for entry not allocated yet.  allocate now. */
-      offset = gegl_tile_backend_swap_find_offset (to_be_written);
+      /* the size of the stored data changed.  free the old storage, and
+       * reallocate it below.
+       */
+      gegl_tile_backend_swap_free_data (offset, offset + params->block->size);
 
-      params->block->offset = offset;
+      offset = -1;
+    }
+  else if (offset < 0)
+    {
+      total_uncompressed += params->length;
     }
 
-  if (out_offset != offset)
+  if (offset < 0)
     {
-      if (lseek (out_fd, offset, SEEK_SET) < 0)
-        {
-          g_warning ("unable to seek to tile in buffer: %s", g_strerror (errno));
-          return;
-        }
-      out_offset = offset;
+      /* storage for entry not allocated yet.  allocate now. */
+      offset = gegl_tile_backend_swap_find_offset (size);
     }
 
-  writing = TRUE;
+  g_mutex_unlock (&alloc_mutex);
+
+  /* the block is only accessed by readers when it's not in the queue, or
+   * being written, so it's safe to modify it here.
+   */
+  params->block->offset      = offset;
+  params->block->size        = size;
+  params->block->compression = data_compression;
+
+  g_atomic_int_inc (&writing);
 
   while (to_be_written > 0)
     {
-      gint wrote;
-      wrote = write (out_fd,
-                     gegl_tile_get_data (params->tile) + params->length
-                     - to_be_written,
-                     to_be_written);
+      gssize wrote;
+      wrote = gegl_tile_backend_swap_pwrite (out_fd,
+                                             data + size - to_be_written,
+                                             to_be_written,
+                                             offset + size - to_be_written);
       if (wrote <= 0)
         {
           g_message ("unable to write tile data to self: "
                      "%s (%d/%d bytes written)",
-                     g_strerror (errno), wrote, to_be_written);
+                     g_strerror (errno), (gint) wrote, to_be_written);
           break;
         }
 
       to_be_written -= wrote;
-      out_offset    += wrote;
-
-      write_total   += wrote;
     }
 
-  writing = FALSE;
+  g_atomic_int_add (&writing, -1);
+
+  g_mutex_lock (&queue_mutex);
+  write_total += size - to_be_written;
+  g_mutex_unlock (&queue_mutex);
 
   GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "writer thread wrote at %i", (gint)offset);
 }
@@ -375,11 +727,10 @@ gegl_tile_backend_swap_write (ThreadParams *params)
 static void
 gegl_tile_backend_swap_destroy (ThreadParams *params)
 {
-  gint64  start, end;
-  GList  *hlink;
+  gint64 start, end;
 
   start = params->block->offset;
-  end   = start + params->length;
+  end   = start + params->block->size;
 
   gegl_tile_backend_swap_block_free (params->block);
 
@@ -387,6 +738,24 @@ gegl_tile_backend_swap_destroy (ThreadParams *params)
   if (start < 0)
     return;
 
+  g_mutex_lock (&alloc_mutex);
+
+  total_uncompressed -= params->length;
+
+  gegl_tile_backend_swap_free_data (start, end);
+
+  g_mutex_unlock (&alloc_mutex);
+}
+
+/* returns the [start, end) range of the swap file to the gap list.  should be
+ * called with alloc_mutex locked.
+ */
+static void
+gegl_tile_backend_swap_free_data (gint64 start,
+                                  gint64 end)
+{
+  GList *hlink;
+
   if ((hlink = gap_list))
     while (hlink)
       {
@@ -461,168 +830,648 @@ gegl_tile_backend_swap_destroy (ThreadParams *params)
     gap_list = g_list_prepend (NULL,
                                gegl_tile_backend_swap_gap_new (start, end));
 
-  total -= end - start;
-}
+  total -= end - start;
+}
+
+static gpointer
+gegl_tile_backend_swap_writer_thread (gpointer ignored)
+{
+  guchar *compression_buffer      = NULL;
+  gint    compression_buffer_size = 0;
+
+  g_mutex_lock (&queue_mutex);
+
+  while (TRUE)
+    {
+      ThreadParams *params = NULL;
+
+      while (! exit_thread &&
+             ! (params = gegl_tile_backend_swap_pop_queue ()))
+        {
+          if (n_in_progress == 0)
+            busy = FALSE;
+
+          g_cond_wait (&queue_cond, &queue_mutex);
+        }
+
+      if (exit_thread)
+        break;
+
+      g_mutex_unlock (&queue_mutex);
+
+      switch (params->operation)
+        {
+        case OP_WRITE:
+          gegl_tile_backend_swap_write (params,
+                                        &compression_buffer,
+                                        &compression_buffer_size);
+          break;
+        case OP_DESTROY:
+          gegl_tile_backend_swap_destroy (params);
+          break;
+        }
+
+      g_mutex_lock (&queue_mutex);
+
+      n_in_progress--;
+
+      if (params->operation == OP_WRITE)
+        {
+          params->block->in_progress = NULL;
+
+          write_latency += g_get_monotonic_time () - params->time;
+          write_count++;
+        }
+
+      /* ops skipped while the block was being written can be served now */
+      if (! g_queue_is_empty (queue))
+        g_cond_signal (&queue_cond);
+
+      if (params->tile || params->data)
+        {
+          if (params->tile)
+            gegl_tile_unref (params->tile);
+          else
+            g_free (params->data);
+
+          queued_total -= params->length;
+          queued_cost  -= params->cost;
+
+          if (queued_cost <= queued_max &&
+              queued_cost + params->cost > queued_max)
+            {
+              g_cond_broadcast (&push_cond);
+            }
+        }
+
+      g_slice_free (ThreadParams, params);
+    }
+
+  g_mutex_unlock (&queue_mutex);
+
+  g_free (compression_buffer);
+
+  GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "exiting writer thread");
+  return NULL;
+}
+
+/* removes the block's data from the pool, if it's there.  should be called
+ * with queue_mutex locked.
+ */
+static void
+gegl_tile_backend_swap_pool_remove (SwapBlock *block)
+{
+  if (! block->pool_data)
+    return;
+
+  g_queue_unlink (&pool_queue, &block->pool_link);
+
+  pool_total              -= block->pool_size;
+  pool_total_uncompressed -= block->pool_length;
+
+  g_clear_pointer (&block->pool_data, g_free);
+}
+
+/* evicts the least-recently used blocks from the pool, until it fits within
+ * its budget.  evicted blocks are pushed to the writer threads' queue, along
+ * with their compressed data.  should be called with queue_mutex locked.
+ */
+static void
+gegl_tile_backend_swap_pool_trim (void)
+{
+  while (pool_total > pool_max && ! g_queue_is_empty (&pool_queue))
+    {
+      SwapBlock    *block = g_queue_peek_tail (&pool_queue);
+      ThreadParams *params;
+
+      params              = g_slice_new0 (ThreadParams);
+      params->operation   = OP_WRITE;
+      params->length      = block->pool_length;
+      params->cost        = block->pool_size;
+      params->block       = block;
+      params->data        = block->pool_data;
+      params->size        = block->pool_size;
+      params->compression = block->pool_compression;
+
+      /* the data is now owned by the write op, where readers still find it */
+      g_queue_unlink (&pool_queue, &block->pool_link);
+
+      pool_total              -= block->pool_size;
+      pool_total_uncompressed -= block->pool_length;
+
+      block->pool_data = NULL;
+
+      gegl_tile_backend_swap_push_queue (params, /* head = */ FALSE);
+    }
+}
+
+/* adds the data of a write op, as compressed by the calling writer thread,
+ * to the pool, instead of writing it to the swap file.  returns FALSE if the
+ * pool is disabled, if the data couldn't be compressed, or if it was evicted
+ * from the pool, in which case it should be written to the swap file.
+ */
+static gboolean
+gegl_tile_backend_swap_pool_add (ThreadParams          *params,
+                                 const guchar          *data,
+                                 gint                   size,
+                                 const GeglCompression *data_compression)
+{
+  SwapBlock *block = params->block;
+
+  if (params->data || ! data_compression)
+    return FALSE;
+
+  g_mutex_lock (&queue_mutex);
+
+  if (pool_max <= 0)
+    {
+      g_mutex_unlock (&queue_mutex);
+
+      return FALSE;
+    }
+
+  if (block->link)
+    {
+      /* newer data was queued for the block while this data was being
+       * compressed, or the block was destroyed.  the queued op supersedes
+       * this one, so there's nothing to store.
+       */
+      g_mutex_unlock (&queue_mutex);
+
+      return TRUE;
+    }
+
+  /* any data read ahead of time is stale now */
+  if (block->read)
+    gegl_tile_backend_swap_read_cancel (block->read);
+
+  gegl_tile_backend_swap_pool_remove (block);
+
+  block->pool_data        = g_memdup (data, size);
+  block->pool_size        = size;
+  block->pool_length      = params->length;
+  block->pool_compression = data_compression;
+
+  g_queue_push_head_link (&pool_queue, &block->pool_link);
+
+  pool_total              += size;
+  pool_total_uncompressed += params->length;
+
+  gegl_tile_backend_swap_pool_trim ();
+
+  g_mutex_unlock (&queue_mutex);
+
+  return TRUE;
+}
+
+/* returns a new tile holding the stored data, decompressing it if
+ * necessary.  consumes @data.
+ */
+static GeglTile *
+gegl_tile_backend_swap_decode (GeglTileBackendSwap   *self,
+                               guchar                *data,
+                               gint                   size,
+                               const GeglCompression *data_compression)
+{
+  gint      tile_size = gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self));
+  gint      px_size   = GEGL_TILE_BACKEND (self)->priv->px_size;
+  GeglTile *tile;
+  gint64    time;
+
+  tile = gegl_tile_new (tile_size);
+  gegl_tile_mark_as_stored (tile);
+
+  if (! data_compression)
+    {
+      memcpy (gegl_tile_get_data (tile), data, MIN (size, tile_size));
+
+      g_free (data);
+
+      return tile;
+    }
+
+  time = g_get_monotonic_time ();
+
+  if (! gegl_compression_decompress (data_compression, px_size,
+                                     gegl_tile_get_data (tile),
+                                     tile_size / px_size,
+                                     data, size))
+    {
+      g_warning ("failed to decompress tile data from swap");
+    }
+
+  g_free (data);
+
+  time = g_get_monotonic_time () - time;
+
+  g_mutex_lock (&queue_mutex);
+  decompression_time += time;
+  g_mutex_unlock (&queue_mutex);
+
+  return tile;
+}
+
+static GeglTile *
+gegl_tile_backend_swap_entry_read (GeglTileBackendSwap *self,
+                                   SwapEntry           *entry)
+{
+  gint                   tile_size  = gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self));
+  gint                   size;
+  gint64                 offset;
+  gint64                 time;
+  const GeglCompression *data_compression;
+  GeglTile              *tile;
+  guchar                *dest;
+  guchar                *stored     = NULL;
+  const gchar           *source     = NULL;
+  SwapBlock             *block      = entry->block;
+
+  g_mutex_lock (&queue_mutex);
+
+  /* the newest data is, in order, that of a queued write, that of a write
+   * in progress, and that of the pool: writing a tile drops its pooled data,
+   * and the writer threads add it back once compressed, so pooled data
+   * present during a write is the write's own.
+   */
+  if (block->link || (block->in_progress && ! block->pool_data))
+    {
+      ThreadParams *queued_op;
+
+      /* the queued op holds newer data than the one being written */
+      if (block->link)
+        queued_op = block->link->data;
+      else
+        queued_op = block->in_progress;
+
+      if (queued_op->tile)
+        {
+          tile = gegl_tile_dup (queued_op->tile);
+
+          g_mutex_unlock (&queue_mutex);
+
+          gegl_tile_mark_as_stored (tile);
+
+          GEGL_NOTE(GEGL_DEBUG_TILE_BACKEND, "read entry %i, %i, %i from queue", entry->x, entry->y, entry->z);
+
+          return tile;
+        }
+      else
+        {
+          /* data evicted from the pool, which is pending a write */
+          size             = queued_op->size;
+          data_compression = queued_op->compression;
+          stored           = g_memdup (queued_op->data, size);
+          source           = "queue";
+        }
+    }
+
+  if (! stored && block->pool_data)
+    {
+      /* promote the block to the head of the pool */
+      g_queue_unlink (&pool_queue, &block->pool_link);
+      g_queue_push_head_link (&pool_queue, &block->pool_link);
+
+      size             = block->pool_size;
+      data_compression = block->pool_compression;
+      stored           = g_memdup (block->pool_data, size);
+      source           = "pool";
+
+      pool_hits++;
+    }
+  else if (! stored)
+    {
+      pool_misses++;
+    }
+
+  if (! stored && block->read)
+    {
+      ReadParams *read = block->read;
+
+      if (read->state == READ_QUEUED)
+        {
+          /* reading the data now is faster than waiting for it */
+          gegl_tile_backend_swap_read_cancel (read);
+        }
+      else
+        {
+          while (read->state == READ_IN_PROGRESS)
+            g_cond_wait (&read_done_cond, &queue_mutex);
+
+          /* the read is only cancelled while in progress if the block is
+           * written or destroyed, which can't happen while it's being read.
+           */
+          if (block->read == read && read->data)
+            {
+              size             = read->size;
+              data_compression = read->compression;
+              stored           = read->data;
+              source           = "prefetched data";
+
+              read->data = NULL;
+
+              gegl_tile_backend_swap_read_cancel (read);
+
+              prefetch_hits++;
+            }
+        }
+    }
+
+  offset = block->offset;
+
+  if (! stored)
+    {
+      size             = block->size;
+      data_compression = block->compression;
+    }
+
+  g_mutex_unlock (&queue_mutex);
+
+  if (stored)
+    {
+      tile = gegl_tile_backend_swap_decode (self, stored, size,
+                                            data_compression);
+
+      GEGL_NOTE(GEGL_DEBUG_TILE_BACKEND, "read entry %i, %i, %i from %s", entry->x, entry->y, entry->z, source);
+
+      return tile;
+    }
+
+  if (offset < 0 || in_fd < 0)
+    {
+      g_warning ("no swap storage allocated for tile");
+      return NULL;
+    }
+
+  if (data_compression)
+    {
+      tile = NULL;
+      dest = g_malloc (size);
+    }
+  else
+    {
+      tile = gegl_tile_new (tile_size);
+      gegl_tile_mark_as_stored (tile);
+
+      dest = gegl_tile_get_data (tile);
+    }
+
+  time = g_get_monotonic_time ();
+
+  gegl_tile_backend_swap_read_data (dest, size, offset);
+
+  time = g_get_monotonic_time () - time;
+
+  g_mutex_lock (&queue_mutex);
+  read_total   += size;
+  read_latency += time;
+  read_count++;
+  g_mutex_unlock (&queue_mutex);
+
+  if (data_compression)
+    tile = gegl_tile_backend_swap_decode (self, dest, size, data_compression);
+
+  GEGL_NOTE(GEGL_DEBUG_TILE_BACKEND, "read entry %i, %i, %i from %i", entry->x, entry->y, entry->z, (gint)offset);
+
+  return tile;
+}
+
+/* queues a read of the entry's stored data ahead of time, if it's only
+ * available in the swap file.
+ */
+static gpointer
+gegl_tile_backend_swap_prefetch_tile (GeglTileSource *self,
+                                      gint            x,
+                                      gint            y,
+                                      gint            z)
+{
+  GeglTileBackendSwap *swap;
+  SwapEntry           *entry;
+  SwapBlock           *block;
+  ReadParams          *read;
+
+  swap  = GEGL_TILE_BACKEND_SWAP (self);
+  entry = gegl_tile_backend_swap_lookup_entry (swap, x, y, z);
+
+  if (! entry || n_reader_threads == 0)
+    return NULL;
+
+  block = entry->block;
+
+  g_mutex_lock (&queue_mutex);
+
+  if (block->link || block->in_progress || block->pool_data || block->read ||
+      block->offset < 0 || in_fd < 0)
+    {
+      g_mutex_unlock (&queue_mutex);
+
+      return NULL;
+    }
 
-static gpointer
-gegl_tile_backend_swap_writer_thread (gpointer ignored)
-{
-  g_mutex_lock (&queue_mutex);
+  /* make room for the data by dropping the oldest unused prefetched data */
+  while (prefetch_total + block->size > prefetch_max &&
+         ! g_queue_is_empty (&prefetch_queue))
+    {
+      gegl_tile_backend_swap_read_cancel (g_queue_peek_head (&prefetch_queue));
+    }
 
-  while (TRUE)
+  if (prefetch_total + block->size > prefetch_max)
     {
-      ThreadParams *params;
+      g_mutex_unlock (&queue_mutex);
 
-      while (g_queue_is_empty (queue) && !exit_thread)
-        {
-          busy = FALSE;
+      return NULL;
+    }
 
-          g_cond_wait (&queue_cond, &queue_mutex);
-        }
+  read              = g_slice_new0 (ReadParams);
+  read->block       = block;
+  read->offset      = block->offset;
+  read->size        = block->size;
+  read->compression = block->compression;
+  read->state       = READ_QUEUED;
+  read->time        = g_get_monotonic_time ();
+  read->link.data   = read;
 
-      if (exit_thread)
-        break;
+  block->read = read;
 
-      params = (ThreadParams *)g_queue_pop_head (queue);
-      if (params->block)
-        {
-          in_progress = params;
-          params->block->link = NULL;
-        }
+  prefetch_total += read->size;
 
-      g_mutex_unlock (&queue_mutex);
+  g_queue_push_tail_link (&read_queue, &read->link);
 
-      switch (params->operation)
-        {
-        case OP_WRITE:
-          gegl_tile_backend_swap_write (params);
-          break;
-        case OP_DESTROY:
-          gegl_tile_backend_swap_destroy (params);
-          break;
-        }
+  g_cond_signal (&read_cond);
 
-      g_mutex_lock (&queue_mutex);
+  g_mutex_unlock (&queue_mutex);
 
-      in_progress = NULL;
+  GEGL_NOTE(GEGL_DEBUG_TILE_BACKEND, "queued prefetch of entry %i, %i, %i", x, y, z);
 
-      if (params->tile)
-        {
-          gegl_tile_unref (params->tile);
+  return NULL;
+}
 
-          queued_total -= params->length;
-          queued_cost  -= params->cost;
+/* drops a queued or completed read.  a read in progress is only detached
+ * from its block, and is dropped by the reader thread once done.  should be
+ * called with queue_mutex locked.
+ */
+static void
+gegl_tile_backend_swap_read_cancel (ReadParams *read)
+{
+  if (read->block)
+    {
+      read->block->read = NULL;
+      read->block       = NULL;
+    }
 
-          if (queued_cost <= queued_max &&
-              queued_cost + params->cost > queued_max)
-            {
-              g_cond_broadcast (&push_cond);
-            }
-        }
+  switch (read->state)
+    {
+    case READ_QUEUED:
+      g_queue_unlink (&read_queue, &read->link);
+      break;
 
-      g_slice_free (ThreadParams, params);
+    case READ_IN_PROGRESS:
+      return;
+
+    case READ_DONE:
+      g_queue_unlink (&prefetch_queue, &read->link);
+      break;
     }
 
-  g_mutex_unlock (&queue_mutex);
-  GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "exiting writer thread");
-  return NULL;
+  prefetch_total -= read->size;
+
+  g_free (read->data);
+  g_slice_free (ReadParams, read);
 }
 
-static GeglTile *
-gegl_tile_backend_swap_entry_read (GeglTileBackendSwap *self,
-                                   SwapEntry           *entry)
+static gint
+gegl_tile_backend_swap_read_compare (gconstpointer a,
+                                     gconstpointer b)
 {
-  gint      tile_size  = gegl_tile_backend_get_tile_size (GEGL_TILE_BACKEND (self));
-  gint      to_be_read = tile_size;
-  gint64    offset;
-  GeglTile *tile;
-  guchar   *dest;
+  const ReadParams *read_a = *(const ReadParams **) a;
+  const ReadParams *read_b = *(const ReadParams **) b;
+
+  if (read_a->offset < read_b->offset)
+    return -1;
+  else if (read_a->offset > read_b->offset)
+    return +1;
+  else
+    return 0;
+}
 
+static gpointer
+gegl_tile_backend_swap_reader_thread (gpointer ignored)
+{
   g_mutex_lock (&queue_mutex);
 
-  if (entry->block->link || in_progress)
+  while (TRUE)
     {
-      ThreadParams *queued_op = NULL;
+      ReadParams *batch[READ_BATCH_SIZE];
+      gint        n_batch = 0;
+      gint64      time;
+      gint        i;
 
-      if (entry->block->link)
-        queued_op = entry->block->link->data;
-      else if (in_progress->block == entry->block)
-        queued_op = in_progress;
+      while (g_queue_is_empty (&read_queue) && ! exit_thread)
+        g_cond_wait (&read_cond, &queue_mutex);
 
-      if (queued_op)
-        {
-          tile = gegl_tile_dup (queued_op->tile);
+      if (exit_thread)
+        break;
 
-          g_mutex_unlock (&queue_mutex);
+      while (n_batch < READ_BATCH_SIZE && ! g_queue_is_empty (&read_queue))
+        {
+          ReadParams *read = g_queue_peek_head (&read_queue);
 
-          gegl_tile_mark_as_stored (tile);
+          g_queue_unlink (&read_queue, &read->link);
 
-          GEGL_NOTE(GEGL_DEBUG_TILE_BACKEND, "read entry %i, %i, %i from queue", entry->x, entry->y, entry->z);
+          read->state = READ_IN_PROGRESS;
 
-          return tile;
+          batch[n_batch++] = read;
         }
-    }
 
-  offset = entry->block->offset;
+      n_reads_in_progress += n_batch;
 
-  g_mutex_unlock (&queue_mutex);
+      g_mutex_unlock (&queue_mutex);
 
-  if (offset < 0 || in_fd < 0)
-    {
-      g_warning ("no swap storage allocated for tile");
-      return NULL;
-    }
+      /* read the batch in file order, coalescing reads of adjacent data */
+      qsort (batch, n_batch, sizeof (ReadParams *),
+             gegl_tile_backend_swap_read_compare);
 
-  tile = gegl_tile_new (tile_size);
-  dest = gegl_tile_get_data (tile);
-  gegl_tile_mark_as_stored (tile);
+      for (i = 0; i < n_batch;)
+        {
+          gint64  start = batch[i]->offset;
+          gint64  end   = start + batch[i]->size;
+          guchar *data;
+          gint    j;
+
+          for (j = i + 1;
+               j < n_batch                             &&
+               batch[j]->offset == end                 &&
+               end + batch[j]->size - start <= READ_COALESCE_MAX;
+               j++)
+            {
+              end += batch[j]->size;
+            }
 
-  g_mutex_lock (&read_mutex);
+          data = g_malloc (end - start);
 
-  if (in_offset != offset)
-    {
-      if (lseek (in_fd, offset, SEEK_SET) < 0)
-        {
-          g_mutex_unlock (&read_mutex);
+          if (gegl_tile_backend_swap_read_data (data, end - start, start))
+            {
+              if (j == i + 1)
+                {
+                  batch[i]->data = data;
+                  data           = NULL;
+                }
+              else
+                {
+                  gint k;
 
-          g_warning ("unable to seek to tile in buffer: %s", g_strerror (errno));
-          return tile;
+                  for (k = i; k < j; k++)
+                    {
+                      batch[k]->data = g_memdup (data + batch[k]->offset - start,
+                                                 batch[k]->size);
+                    }
+                }
+            }
+
+          g_free (data);
+
+          i = j;
         }
-      in_offset = offset;
-    }
 
-  reading = TRUE;
+      time = g_get_monotonic_time ();
 
-  while (to_be_read > 0)
-    {
-      GError *error = NULL;
-      gint    byte_read;
+      g_mutex_lock (&queue_mutex);
 
-      byte_read = read (in_fd, dest + tile_size - to_be_read, to_be_read);
-      if (byte_read <= 0)
+      n_reads_in_progress -= n_batch;
+
+      for (i = 0; i < n_batch; i++)
         {
-          reading = FALSE;
+          ReadParams *read = batch[i];
 
-          g_mutex_unlock (&read_mutex);
+          read->state = READ_DONE;
 
-          g_message ("unable to read tile data from swap: "
-                     "%s (%d/%d bytes read) %s",
-                     g_strerror (errno), byte_read, to_be_read, error?error->message:"--");
-          return tile;
-        }
-      to_be_read -= byte_read;
-      in_offset  += byte_read;
+          if (read->block && read->data)
+            {
+              g_queue_push_tail_link (&prefetch_queue, &read->link);
 
-      read_total += byte_read;
-    }
+              read_total   += read->size;
+              read_latency += time - read->time;
+              read_count++;
+            }
+          else
+            {
+              /* the read was cancelled, or failed */
+              if (read->block)
+                read->block->read = NULL;
 
-  reading = FALSE;
+              prefetch_total -= read->size;
 
-  g_mutex_unlock (&read_mutex);
+              g_free (read->data);
+              g_slice_free (ReadParams, read);
+            }
+        }
 
-  GEGL_NOTE(GEGL_DEBUG_TILE_BACKEND, "read entry %i, %i, %i from %i", entry->x, entry->y, entry->z, (gint)offset);
+      g_cond_broadcast (&read_done_cond);
+    }
 
-  return tile;
+  g_mutex_unlock (&queue_mutex);
+
+  GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "exiting reader thread");
+  return NULL;
 }
 
 static void
@@ -641,11 +1490,34 @@ gegl_tile_backend_swap_entry_write (GeglTileBackendSwap *self,
 
   g_mutex_lock (&queue_mutex);
 
+  /* drop any pooled copy of older data, or data read ahead of time.  the
+   * writer threads compress the tile, and add it to the pool.
+   */
+  gegl_tile_backend_swap_pool_remove (entry->block);
+
+  if (entry->block->read)
+    gegl_tile_backend_swap_read_cancel (entry->block->read);
+
   if (entry->block->link)
     {
       params = entry->block->link->data;
       g_assert (params->operation == OP_WRITE);
-      gegl_tile_unref (params->tile);
+      if (params->tile)
+        {
+          gegl_tile_unref (params->tile);
+        }
+      else
+        {
+          /* replace the pool data of the queued op with the tile */
+          g_clear_pointer (&params->data, g_free);
+
+          queued_total += length - params->length;
+          queued_cost  += cost   - params->cost;
+
+          params->length  = length;
+          params->cost    = cost;
+          params->px_size = GEGL_TILE_BACKEND (self)->priv->px_size;
+        }
       params->tile = gegl_tile_dup (tile);
       g_mutex_unlock (&queue_mutex);
 
@@ -658,6 +1530,7 @@ gegl_tile_backend_swap_entry_write (GeglTileBackendSwap *self,
   params->operation = OP_WRITE;
   params->length    = length;
   params->cost      = cost;
+  params->px_size   = GEGL_TILE_BACKEND (self)->priv->px_size;
   params->tile      = gegl_tile_dup (tile);
   params->block     = entry->block;
 
@@ -673,9 +1546,22 @@ gegl_tile_backend_swap_block_create (GeglTileBackendSwap *self)
 {
   SwapBlock *block = g_slice_new (SwapBlock);
 
-  block->ref_count = 1;
-  block->link      = NULL;
-  block->offset    = -1;
+  block->ref_count   = 1;
+  block->link        = NULL;
+  block->offset      = -1;
+  block->size        = 0;
+  block->compression = NULL;
+
+  block->pool_data        = NULL;
+  block->pool_size        = 0;
+  block->pool_length      = 0;
+  block->pool_compression = NULL;
+  block->pool_link.data   = block;
+  block->pool_link.prev   = NULL;
+  block->pool_link.next   = NULL;
+
+  block->in_progress      = NULL;
+  block->read             = NULL;
 
   return block;
 }
@@ -711,15 +1597,25 @@ gegl_tile_backend_swap_block_unref (GeglTileBackendSwap *self,
       if (lock)
         g_mutex_lock (&queue_mutex);
 
+      gegl_tile_backend_swap_pool_remove (block);
+
+      if (block->read)
+        gegl_tile_backend_swap_read_cancel (block->read);
+
       if (block->link)
         {
           GList        *link      = block->link;
           ThreadParams *queued_op = link->data;
 
-          if (queued_op->tile)
+          if (queued_op->tile || queued_op->data)
             {
-              gegl_tile_unref (queued_op->tile);
+              if (queued_op->tile)
+                gegl_tile_unref (queued_op->tile);
+              else
+                g_free (queued_op->data);
+
               queued_op->tile = NULL;
+              queued_op->data = NULL;
 
               queued_total -= queued_op->length;
               queued_cost  -= queued_op->cost;
@@ -1005,6 +1901,8 @@ gegl_tile_backend_swap_command (GeglTileSource  *self,
         return NULL;
       case GEGL_TILE_COPY:
         return gegl_tile_backend_swap_copy_tile (self, x, y, z, data);
+      case GEGL_TILE_PREFETCH:
+        return gegl_tile_backend_swap_prefetch_tile (self, x, y, z);
 
       default:
         break;
@@ -1128,27 +2026,91 @@ gegl_tile_backend_swap_tile_cache_size_notify (GObject    *config,
                 "tile-cache-size", &queued_max,
                 NULL);
 
-  queued_max *= QUEUED_MAX_RATIO;
+  prefetch_max  = queued_max * PREFETCH_MAX_RATIO;
+  queued_max   *= QUEUED_MAX_RATIO;
 
   g_cond_broadcast (&push_cond);
 
   g_mutex_unlock (&queue_mutex);
 }
 
+static void
+gegl_tile_backend_swap_compression_notify (GObject    *config,
+                                           GParamSpec *pspec,
+                                           gpointer    data)
+{
+  gchar                 *name;
+  const GeglCompression *algorithm = NULL;
+
+  g_object_get (config,
+                "swap-compression", &name,
+                NULL);
+
+  if (name)
+    {
+      algorithm = gegl_compression (name);
+
+      if (! algorithm)
+        g_warning ("unknown swap compression algorithm '%s'", name);
+    }
+
+  g_atomic_pointer_set (&compression, algorithm);
+
+  g_free (name);
+}
+
+static void
+gegl_tile_backend_swap_pool_size_notify (GObject    *config,
+                                         GParamSpec *pspec,
+                                         gpointer    data)
+{
+  guint64 size;
+
+  g_object_get (config,
+                "swap-pool-size", &size,
+                NULL);
+
+  g_mutex_lock (&queue_mutex);
+
+  pool_max = MIN (size, G_MAXINT64);
+
+  gegl_tile_backend_swap_pool_trim ();
+
+  g_mutex_unlock (&queue_mutex);
+}
+
 static void
 gegl_tile_backend_swap_class_init (GeglTileBackendSwapClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  gint          i;
 
   parent_class = g_type_class_peek_parent (klass);
 
   gobject_class->constructed  = gegl_tile_backend_swap_constructed;
   gobject_class->finalize     = gegl_tile_backend_swap_finalize;
 
-  queue         = g_queue_new ();
-  writer_thread = g_thread_new ("swap writer",
-                                gegl_tile_backend_swap_writer_thread,
-                                NULL);
+  queue = g_queue_new ();
+
+  /* several writers keep the disk busy, and compress in parallel.  ops of
+   * the same block are still served in order.
+   */
+  n_writer_threads = CLAMP (g_get_num_processors () / 2, 1, MAX_WRITER_THREADS);
+  n_reader_threads = CLAMP (g_get_num_processors () / 2, 1, MAX_READER_THREADS);
+
+  for (i = 0; i < n_writer_threads; i++)
+    {
+      writer_threads[i] = g_thread_new ("swap writer",
+                                        gegl_tile_backend_swap_writer_thread,
+                                        NULL);
+    }
+
+  for (i = 0; i < n_reader_threads; i++)
+    {
+      reader_threads[i] = g_thread_new ("swap reader",
+                                        gegl_tile_backend_swap_reader_thread,
+                                        NULL);
+    }
 
   g_signal_connect (gegl_buffer_config (), "notify::tile-cache-size",
                     G_CALLBACK (gegl_tile_backend_swap_tile_cache_size_notify),
@@ -1156,12 +2118,28 @@ gegl_tile_backend_swap_class_init (GeglTileBackendSwapClass *klass)
 
   gegl_tile_backend_swap_tile_cache_size_notify (G_OBJECT (gegl_buffer_config ()),
                                                  NULL, NULL);
+
+  g_signal_connect (gegl_buffer_config (), "notify::swap-compression",
+                    G_CALLBACK (gegl_tile_backend_swap_compression_notify),
+                    NULL);
+
+  gegl_tile_backend_swap_compression_notify (G_OBJECT (gegl_buffer_config ()),
+                                             NULL, NULL);
+
+  g_signal_connect (gegl_buffer_config (), "notify::swap-pool-size",
+                    G_CALLBACK (gegl_tile_backend_swap_pool_size_notify),
+                    NULL);
+
+  gegl_tile_backend_swap_pool_size_notify (G_OBJECT (gegl_buffer_config ()),
+                                           NULL, NULL);
 }
 
 void
 gegl_tile_backend_swap_cleanup (void)
 {
-  if (! writer_thread)
+  gint i;
+
+  if (! n_writer_threads)
     return;
 
   g_signal_handlers_disconnect_by_func (
@@ -1169,16 +2147,45 @@ gegl_tile_backend_swap_cleanup (void)
     gegl_tile_backend_swap_tile_cache_size_notify,
     NULL);
 
+  g_signal_handlers_disconnect_by_func (
+    gegl_buffer_config (),
+    gegl_tile_backend_swap_compression_notify,
+    NULL);
+
+  g_signal_handlers_disconnect_by_func (
+    gegl_buffer_config (),
+    gegl_tile_backend_swap_pool_size_notify,
+    NULL);
+
   g_mutex_lock (&queue_mutex);
   exit_thread = TRUE;
-  g_cond_signal (&queue_cond);
+  g_cond_broadcast (&queue_cond);
+  g_cond_broadcast (&read_cond);
   g_mutex_unlock (&queue_mutex);
-  g_thread_join (writer_thread);
-  writer_thread = NULL;
+
+  for (i = 0; i < n_writer_threads; i++)
+    {
+      g_thread_join (writer_threads[i]);
+      writer_threads[i] = NULL;
+    }
+  n_writer_threads = 0;
+
+  for (i = 0; i < n_reader_threads; i++)
+    {
+      g_thread_join (reader_threads[i]);
+      reader_threads[i] = NULL;
+    }
+  n_reader_threads = 0;
 
   if (g_queue_get_length (queue) != 0)
     g_warning ("tile-backend-swap writer queue wasn't empty before freeing\n");
 
+  if (! g_queue_is_empty (&read_queue) || ! g_queue_is_empty (&prefetch_queue))
+    g_warning ("tile-backend-swap prefetch queues weren't empty before freeing\n");
+
+  if (! g_queue_is_empty (&pool_queue))
+    g_warning ("tile-backend-swap pool wasn't empty before freeing\n");
+
   g_queue_free (queue);
   queue = NULL;
 
@@ -1274,7 +2281,7 @@ gegl_tile_backend_swap_get_queue_stalls (void)
 gboolean
 gegl_tile_backend_swap_get_reading (void)
 {
-  return reading;
+  return g_atomic_int_get (&reading) > 0;
 }
 
 guint64
@@ -1286,7 +2293,7 @@ gegl_tile_backend_swap_get_read_total (void)
 gboolean
 gegl_tile_backend_swap_get_writing (void)
 {
-  return writing;
+  return g_atomic_int_get (&writing) > 0;
 }
 
 guint64
@@ -1295,6 +2302,99 @@ gegl_tile_backend_swap_get_write_total (void)
   return write_total;
 }
 
+guint64
+gegl_tile_backend_swap_get_total_uncompressed (void)
+{
+  return total_uncompressed;
+}
+
+gdouble
+gegl_tile_backend_swap_get_compression_ratio (void)
+{
+  if (total > 0)
+    return (gdouble) total_uncompressed / total;
+  else
+    return 1.0;
+}
+
+gdouble
+gegl_tile_backend_swap_get_compression_time (void)
+{
+  return compression_time / (gdouble) G_USEC_PER_SEC;
+}
+
+gdouble
+gegl_tile_backend_swap_get_decompression_time (void)
+{
+  return decompression_time / (gdouble) G_USEC_PER_SEC;
+}
+
+guint64
+gegl_tile_backend_swap_get_pool_total (void)
+{
+  return pool_total;
+}
+
+guint64
+gegl_tile_backend_swap_get_pool_total_uncompressed (void)
+{
+  return pool_total_uncompressed;
+}
+
+gint
+gegl_tile_backend_swap_get_pool_hits (void)
+{
+  return pool_hits;
+}
+
+gint
+gegl_tile_backend_swap_get_pool_misses (void)
+{
+  return pool_misses;
+}
+
+gint
+gegl_tile_backend_swap_get_queue_depth (void)
+{
+  gint depth;
+
+  if (! queue)
+    return 0;
+
+  g_mutex_lock (&queue_mutex);
+
+  depth = g_queue_get_length (queue)      + n_in_progress +
+          g_queue_get_length (&read_queue) + n_reads_in_progress;
+
+  g_mutex_unlock (&queue_mutex);
+
+  return depth;
+}
+
+gdouble
+gegl_tile_backend_swap_get_read_latency (void)
+{
+  if (read_count > 0)
+    return read_latency / (gdouble) read_count / G_USEC_PER_SEC;
+  else
+    return 0.0;
+}
+
+gdouble
+gegl_tile_backend_swap_get_write_latency (void)
+{
+  if (write_count > 0)
+    return write_latency / (gdouble) write_count / G_USEC_PER_SEC;
+  else
+    return 0.0;
+}
+
+gint
+gegl_tile_backend_swap_get_prefetch_hits (void)
+{
+  return prefetch_hits;
+}
+
 void
 gegl_tile_backend_swap_reset_stats (void)
 {
@@ -1302,4 +2402,17 @@ gegl_tile_backend_swap_reset_stats (void)
   write_total = 0;
 
   queue_stalls = 0;
+
+  compression_time   = 0;
+  decompression_time = 0;
+
+  pool_hits   = 0;
+  pool_misses = 0;
+
+  read_latency  = 0;
+  read_count    = 0;
+  write_latency = 0;
+  write_count   = 0;
+
+  prefetch_hits = 0;
 }
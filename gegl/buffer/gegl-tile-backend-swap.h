@@ -46,21 +46,33 @@ struct _GeglTileBackendSwap
   GHashTable      *index;
 };
 
-GType      gegl_tile_backend_swap_get_type           (void) G_GNUC_CONST;
+GType      gegl_tile_backend_swap_get_type                    (void) G_GNUC_CONST;
 
-guint64    gegl_tile_backend_swap_get_total          (void);
-guint64    gegl_tile_backend_swap_get_total_uncloned (void);
-guint64    gegl_tile_backend_swap_get_file_size      (void);
-gboolean   gegl_tile_backend_swap_get_busy           (void);
-guint64    gegl_tile_backend_swap_get_queued_total   (void);
-gboolean   gegl_tile_backend_swap_get_queue_full     (void);
-gint       gegl_tile_backend_swap_get_queue_stalls   (void);
-gboolean   gegl_tile_backend_swap_get_reading        (void);
-guint64    gegl_tile_backend_swap_get_read_total     (void);
-gboolean   gegl_tile_backend_swap_get_writing        (void);
-guint64    gegl_tile_backend_swap_get_write_total    (void);
+guint64    gegl_tile_backend_swap_get_total                   (void);
+guint64    gegl_tile_backend_swap_get_total_uncloned          (void);
+guint64    gegl_tile_backend_swap_get_file_size               (void);
+gboolean   gegl_tile_backend_swap_get_busy                    (void);
+guint64    gegl_tile_backend_swap_get_queued_total            (void);
+gboolean   gegl_tile_backend_swap_get_queue_full              (void);
+gint       gegl_tile_backend_swap_get_queue_stalls            (void);
+gboolean   gegl_tile_backend_swap_get_reading                 (void);
+guint64    gegl_tile_backend_swap_get_read_total              (void);
+gboolean   gegl_tile_backend_swap_get_writing                 (void);
+guint64    gegl_tile_backend_swap_get_write_total             (void);
+guint64    gegl_tile_backend_swap_get_total_uncompressed      (void);
+gdouble    gegl_tile_backend_swap_get_compression_ratio       (void);
+gdouble    gegl_tile_backend_swap_get_compression_time        (void);
+gdouble    gegl_tile_backend_swap_get_decompression_time      (void);
+guint64    gegl_tile_backend_swap_get_pool_total              (void);
+guint64    gegl_tile_backend_swap_get_pool_total_uncompressed (void);
+gint       gegl_tile_backend_swap_get_pool_hits               (void);
+gint       gegl_tile_backend_swap_get_pool_misses             (void);
+gint       gegl_tile_backend_swap_get_queue_depth             (void);
+gdouble    gegl_tile_backend_swap_get_read_latency            (void);
+gdouble    gegl_tile_backend_swap_get_write_latency           (void);
+gint       gegl_tile_backend_swap_get_prefetch_hits           (void);
 
-void       gegl_tile_backend_swap_reset_stats        (void);
+void       gegl_tile_backend_swap_reset_stats                 (void);
 
 G_END_DECLS
 
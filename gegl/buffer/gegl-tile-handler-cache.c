@@ -18,6 +18,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 #include <glib-object.h>
 
@@ -25,6 +27,7 @@
 #include "gegl-buffer.h"
 #include "gegl-buffer-private.h"
 #include "gegl-tile.h"
+#include "gegl-tile-alloc.h"
 #include "gegl-tile-handler-cache.h"
 #include "gegl-tile-storage.h"
 #include "gegl-debug.h"
@@ -37,16 +40,46 @@
 #define GEGL_CACHE_TRIM_RATIO_MIN  0.01
 #define GEGL_CACHE_TRIM_RATIO_MAX  0.50
 #define GEGL_CACHE_TRIM_RATIO_RATE 2.0
+#define GEGL_CACHE_TRIM_WAIT_RATIO 1.10 /* overshoot past which inserting
+                                         * threads wait for an ongoing trim
+                                         */
+
+#define GEGL_CACHE_PROBATION_RATIO 0.25 /* portion of the cache reserved for
+                                         * the probationary queue of the 2Q
+                                         * policy
+                                         */
+
+#define GEGL_CACHE_N_POLICIES      (GEGL_TILE_CACHE_POLICY_2Q + 1)
+#define GEGL_CACHE_N_STATS_SHARDS  16
+#define GEGL_CACHE_LINE_SIZE       64
+
+/* cache_{hits,misses} are updated on every tile access, by all threads.  to
+ * avoid bouncing a single cache line between all cores, the counters are
+ * striped across a number of cache-line-sized shards, and each thread only
+ * updates its own shard.  the counters are kept separately for each policy,
+ * so that policies can be compared over a session.
+ */
+typedef struct CacheStats
+{
+  gint  hits[GEGL_CACHE_N_POLICIES];
+  gint  misses[GEGL_CACHE_N_POLICIES];
+
+  gchar padding[GEGL_CACHE_LINE_SIZE - 2 * GEGL_CACHE_N_POLICIES * sizeof (gint)];
+} CacheStats;
 
 typedef struct CacheItem
 {
-  GeglTile *tile; /* The tile */
-  GList     link; /*  Link in the cache queue, to avoid
-                   *  queue lookups involving g_list_find() */
+  GeglTile *tile;      /* The tile */
+  GList     link;      /*  Link in the cache queue, to avoid
+                        *  queue lookups involving g_list_find() */
 
-  gint      x;    /* The coordinates this tile was cached for */
+  gint      x;         /* The coordinates this tile was cached for */
   gint      y;
   gint      z;
+
+  gboolean  probation; /* Whether the tile is in the probationary queue, iow,
+                        * whether it hasn't been accessed since it was
+                        * inserted to the cache */
 } CacheItem;
 
 #define LINK_GET_CACHE(l) \
@@ -101,9 +134,11 @@ static gint               cache_wash_percentage = 20;
 static volatile guintptr  cache_total           = 0; /* approximate amount of bytes stored */
 static guintptr           cache_total_max       = 0; /* maximal value of cache_total */
 static volatile guintptr  cache_total_uncloned  = 0; /* approximate amount of uncloned bytes stored */
-static gint               cache_hits            = 0;
-static gint               cache_misses          = 0;
+static volatile guintptr  cache_total_probation = 0; /* amount of uncloned bytes in probationary queues */
+static CacheStats         cache_stats[GEGL_CACHE_N_STATS_SHARDS];
 static guintptr           cache_time            = 0;
+static GPrivate           cache_stats_shard;
+static gint               cache_stats_n_threads = 0;
 
 
 G_DEFINE_TYPE (GeglTileHandlerCache, gegl_tile_handler_cache, GEGL_TYPE_TILE_HANDLER)
@@ -123,10 +158,42 @@ gegl_tile_handler_cache_init (GeglTileHandlerCache *cache)
   ((GeglTileSource*)cache)->command = gegl_tile_handler_cache_command;
   cache->items = g_hash_table_new (gegl_tile_handler_cache_hashfunc, gegl_tile_handler_cache_equalfunc);
   g_queue_init (&cache->queue);
+  g_queue_init (&cache->probation);
 
   gegl_tile_handler_cache_connect (cache);
 }
 
+static inline gboolean
+cache_is_empty (GeglTileHandlerCache *cache)
+{
+  return g_queue_is_empty (&cache->queue) &&
+         g_queue_is_empty (&cache->probation);
+}
+
+static inline GQueue *
+cache_item_queue (GeglTileHandlerCache *cache,
+                  CacheItem            *item)
+{
+  return item->probation ? &cache->probation : &cache->queue;
+}
+
+/* removes the item from the cache's queue and hash table, without releasing
+ * the tile.
+ */
+static void
+cache_unlink_item (GeglTileHandlerCache *cache,
+                   CacheItem            *item)
+{
+  g_queue_unlink (cache_item_queue (cache, item), &item->link);
+  g_hash_table_remove (cache->items, item);
+
+  if (item->probation)
+    g_atomic_pointer_add (&cache_total_probation, -item->tile->size);
+
+  if (cache_is_empty (cache))
+    cache->time = cache->stamp = 0;
+}
+
 static void
 drop_hot_tile (GeglTile *tile)
 {
@@ -157,11 +224,14 @@ gegl_tile_handler_cache_reinit (GeglTileHandlerCache *cache)
 
   g_hash_table_remove_all (cache->items);
 
-  while ((link = g_queue_pop_head_link (&cache->queue)))
+  while ((link = g_queue_pop_head_link (&cache->probation)) ||
+         (link = g_queue_pop_head_link (&cache->queue)))
     {
       item = LINK_GET_ITEM (link);
       if (item->tile)
         {
+          if (item->probation)
+            g_atomic_pointer_add (&cache_total_probation, -item->tile->size);
           if (g_atomic_int_dec_and_test (gegl_tile_n_cached_clones (item->tile)))
             g_atomic_pointer_add (&cache_total, -item->tile->size);
           g_atomic_pointer_add (&cache_total_uncloned, -item->tile->size);
@@ -187,6 +257,28 @@ gegl_tile_handler_cache_dispose (GObject *object)
   G_OBJECT_CLASS (gegl_tile_handler_cache_parent_class)->dispose (object);
 }
 
+static inline GeglTileCachePolicy
+cache_policy (void)
+{
+  return gegl_buffer_config ()->tile_cache_policy;
+}
+
+static inline CacheStats *
+gegl_tile_handler_cache_get_stats (void)
+{
+  gint shard = GPOINTER_TO_INT (g_private_get (&cache_stats_shard));
+
+  if (G_UNLIKELY (! shard))
+    {
+      shard = g_atomic_int_add (&cache_stats_n_threads, 1) %
+              GEGL_CACHE_N_STATS_SHARDS + 1;
+
+      g_private_set (&cache_stats_shard, GINT_TO_POINTER (shard));
+    }
+
+  return &cache_stats[shard - 1];
+}
+
 static GeglTile *
 gegl_tile_handler_cache_get_tile_command (GeglTileSource *tile_store,
                                           gint        x,
@@ -206,10 +298,10 @@ gegl_tile_handler_cache_get_tile_command (GeglTileSource *tile_store,
       /* we don't bother making cache_{hits,misses} atomic, since they're only
        * needed for GeglStats.
        */
-      cache_hits++;
+      gegl_tile_handler_cache_get_stats ()->hits[cache_policy ()]++;
       return tile;
     }
-  cache_misses++;
+  gegl_tile_handler_cache_get_stats ()->misses[cache_policy ()]++;
 
   if (source)
     tile = gegl_tile_source_get_tile (source, x, y, z);
@@ -237,17 +329,23 @@ gegl_tile_handler_cache_command (GeglTileSource  *tile_store,
         {
           GList *link;
 
+          GQueue *queues[] = {&cache->queue, &cache->probation};
+          gint    i;
+
           if (gegl_tile_handler_cache_ext_flush)
             gegl_tile_handler_cache_ext_flush (cache, NULL);
 
-          for (link = g_queue_peek_head_link (&cache->queue);
-               link;
-               link = g_list_next (link))
+          for (i = 0; i < G_N_ELEMENTS (queues); i++)
             {
-              CacheItem *item = LINK_GET_ITEM (link);
+              for (link = g_queue_peek_head_link (queues[i]);
+                   link;
+                   link = g_list_next (link))
+                {
+                  CacheItem *item = LINK_GET_ITEM (link);
 
-              if (item->tile)
-                gegl_tile_store (item->tile);
+                  if (item->tile)
+                    gegl_tile_store (item->tile);
+                }
             }
         }
         break;
@@ -285,6 +383,11 @@ gegl_tile_handler_cache_command (GeglTileSource  *tile_store,
       case GEGL_TILE_REINIT:
         gegl_tile_handler_cache_reinit (cache);
         break;
+      case GEGL_TILE_PREFETCH:
+        /* cached tiles don't need to be fetched */
+        if (gegl_tile_handler_cache_has_tile (cache, x, y, z))
+          return NULL;
+        break;
       case GEGL_TILE_COPY:
         /* we potentially chain up in gegl_tile_handler_cache_copy(), because
          * its logic is interleaved with that of the backend.
@@ -404,7 +507,9 @@ gegl_tile_handler_cache_wash (GeglTileHandlerCache *cache)
 
   while (size < wash_size)
     {
-      GList *link;
+      GQueue *queues[2];
+      GList  *link;
+      gint    i;
 
       cache = gegl_tile_handler_cache_find_oldest_cache (cache);
 
@@ -416,24 +521,31 @@ gegl_tile_handler_cache_wash (GeglTileHandlerCache *cache)
           continue;
         }
 
-      for (link = g_queue_peek_tail_link (&cache->queue);
-           link && size < wash_size;
-           link = g_list_previous (link))
-        {
-          CacheItem *item = LINK_GET_ITEM (link);
-          GeglTile  *tile = item->tile;
+      /* probationary tiles are trimmed first, so wash them first */
+      queues[0] = &cache->probation;
+      queues[1] = &cache->queue;
 
-          if (tile->tile_storage && ! gegl_tile_is_stored (tile))
+      for (i = 0; i < G_N_ELEMENTS (queues) && size < wash_size; i++)
+        {
+          for (link = g_queue_peek_tail_link (queues[i]);
+               link && size < wash_size;
+               link = g_list_previous (link))
             {
-              last_dirty = tile;
-              g_object_ref (last_dirty->tile_storage);
-              gegl_tile_ref (last_dirty);
+              CacheItem *item = LINK_GET_ITEM (link);
+              GeglTile  *tile = item->tile;
 
-              size = wash_size;
-              break;
-            }
+              if (tile->tile_storage && ! gegl_tile_is_stored (tile))
+                {
+                  last_dirty = tile;
+                  g_object_ref (last_dirty->tile_storage);
+                  gegl_tile_ref (last_dirty);
+
+                  size = wash_size;
+                  break;
+                }
 
-          size += tile->size;
+              size += tile->size;
+            }
         }
 
       g_rec_mutex_unlock (&cache->tile_storage->mutex);
@@ -467,6 +579,12 @@ cache_lookup (GeglTileHandlerCache *cache,
 }
 
 /* returns the requested Tile if it is in the cache, NULL otherwize.
+ *
+ * accessing a tile moves it to the head of the cache's main queue.  in
+ * particular, a tile in the probationary queue is promoted to the main queue
+ * once it's accessed again after having been inserted, so that under the 2Q
+ * policy, tiles that are only accessed once, as during a full-buffer scan,
+ * never evict tiles that are being reused.
  */
 static GeglTile *
 gegl_tile_handler_cache_get_tile (GeglTileHandlerCache *cache,
@@ -476,15 +594,25 @@ gegl_tile_handler_cache_get_tile (GeglTileHandlerCache *cache,
 {
   CacheItem *result;
 
-  if (g_queue_is_empty (&cache->queue))
+  if (cache_is_empty (cache))
     return NULL;
 
   result = cache_lookup (cache, x, y, z);
   if (result)
     {
-      g_queue_unlink (&cache->queue, &result->link);
+      g_queue_unlink (cache_item_queue (cache, result), &result->link);
       g_queue_push_head_link (&cache->queue, &result->link);
-      cache->time = ++cache_time;
+      if (result->probation)
+        {
+          result->probation = FALSE;
+          g_atomic_pointer_add (&cache_total_probation, -result->tile->size);
+        }
+      /* only bump the global clock if another cache has been accessed since,
+       * so that threads hitting the same cache don't keep writing to the
+       * shared counter.
+       */
+      if (cache->time != cache_time)
+        cache->time = ++cache_time;
       while (result->tile == NULL)
       {
         g_printerr ("NULL tile in %s %p %i %i %i %p\n", __FUNCTION__, result, result->x, result->y, result->z,
@@ -497,37 +625,50 @@ gegl_tile_handler_cache_get_tile (GeglTileHandlerCache *cache,
   return NULL;
 }
 
+/* unlike gegl_tile_handler_cache_get_tile(), doesn't count as an access of
+ * the tile, and doesn't affect its position in the cache.
+ */
 static gboolean
 gegl_tile_handler_cache_has_tile (GeglTileHandlerCache *cache,
                                   gint                  x,
                                   gint                  y,
                                   gint                  z)
 {
-  GeglTile *tile = gegl_tile_handler_cache_get_tile (cache, x, y, z);
+  CacheItem *item = cache_lookup (cache, x, y, z);
 
-  if (tile)
-    {
-      gegl_tile_unref (tile);
-      return TRUE;
-    }
-
-  return FALSE;
+  return item && item->tile;
 }
 
+/* trims the cache down to its target size.  if @wait is FALSE, and another
+ * thread is already trimming the cache, returns immediately, letting the
+ * other thread do the work.
+ *
+ * tiles are trimmed from the probationary queues first, as long as they take
+ * more than their reserved portion of the cache (which is zero for the LRU
+ * policy), and from the main queues otherwise.  if there's nothing left to
+ * trim in the preferred queues, we fall back to the other ones.
+ */
 static gboolean
-gegl_tile_handler_cache_trim (GeglTileHandlerCache *cache)
+gegl_tile_handler_cache_trim (GeglTileHandlerCache *cache,
+                              gboolean              wait)
 {
   GList          *link;
   gint64          time;
   static gint64   last_time;
   static gdouble  ratio  = GEGL_CACHE_TRIM_RATIO_MIN;
   guint64         target_size;
+  guint64         probation_size;
+  gboolean        probation;
+  gboolean        fallback = FALSE;
   static guint    counter;
 
   cache = NULL;
   link  = NULL;
 
-  g_mutex_lock (&mutex);
+  if (wait)
+    g_mutex_lock (&mutex);
+  else if (! g_mutex_trylock (&mutex))
+    return FALSE;
 
   target_size = gegl_buffer_config ()->tile_cache_size;
 
@@ -552,6 +693,14 @@ gegl_tile_handler_cache_trim (GeglTileHandlerCache *cache)
 
   target_size -= target_size * ratio;
 
+  if (cache_policy () == GEGL_TILE_CACHE_POLICY_2Q)
+    probation_size = target_size * GEGL_CACHE_PROBATION_RATIO;
+  else
+    probation_size = 0;
+
+  probation = (guintptr) g_atomic_pointer_get (&cache_total_probation) >
+              probation_size;
+
   while ((guintptr) g_atomic_pointer_get (&cache_total) > target_size)
     {
       CacheItem *last_writable;
@@ -560,7 +709,13 @@ gegl_tile_handler_cache_trim (GeglTileHandlerCache *cache)
 
 #ifdef GEGL_DEBUG_CACHE_HITS
       GEGL_NOTE(GEGL_DEBUG_CACHE, "cache_total:"G_GUINT64_FORMAT" > cache_size:"G_GUINT64_FORMAT, cache_total, gegl_buffer_config()->tile_cache_size);
-      GEGL_NOTE(GEGL_DEBUG_CACHE, "%f%% hit:%i miss:%i  %i]", cache_hits*100.0/(cache_hits+cache_misses), cache_hits, cache_misses, g_queue_get_length (&cache_queue));
+      GEGL_NOTE(GEGL_DEBUG_CACHE, "%f%% hit:%i miss:%i  %i]",
+                gegl_tile_handler_cache_get_hits () * 100.0 /
+                (gegl_tile_handler_cache_get_hits () +
+                 gegl_tile_handler_cache_get_misses ()),
+                gegl_tile_handler_cache_get_hits (),
+                gegl_tile_handler_cache_get_misses (),
+                g_queue_get_length (&cache_queue));
 #endif
 
       if (! link)
@@ -584,9 +739,30 @@ gegl_tile_handler_cache_trim (GeglTileHandlerCache *cache)
                  ! g_rec_mutex_trylock (&cache->tile_storage->mutex));
 
           if (! cache)
-            break;
+            {
+              if (! fallback)
+                {
+                  /* we went through all the caches without trimming enough
+                   * from the preferred queues.  start over, trimming from the
+                   * other ones.
+                   */
+                  fallback  = TRUE;
+                  probation = ! probation;
+
+                  continue;
+                }
 
-          link = g_queue_peek_tail_link (&cache->queue);
+              break;
+            }
+
+          if (! fallback)
+            {
+              probation = (guintptr) g_atomic_pointer_get (&cache_total_probation) >
+                          probation_size;
+            }
+
+          link = g_queue_peek_tail_link (probation ? &cache->probation :
+                                                     &cache->queue);
         }
 
       for (; link; link = g_list_previous (link))
@@ -624,10 +800,7 @@ gegl_tile_handler_cache_trim (GeglTileHandlerCache *cache)
         continue;
 
       prev_link = g_list_previous (link);
-      g_queue_unlink (&cache->queue, link);
-      g_hash_table_remove (cache->items, last_writable);
-      if (g_queue_is_empty (&cache->queue))
-        cache->time = cache->stamp = 0;
+      cache_unlink_item (cache, last_writable);
       if (g_atomic_int_dec_and_test (gegl_tile_n_cached_clones (tile)))
         g_atomic_pointer_add (&cache_total, -tile->size);
       g_atomic_pointer_add (&cache_total_uncloned, -tile->size);
@@ -669,11 +842,7 @@ gegl_tile_handler_cache_invalidate (GeglTileHandlerCache *cache,
         g_atomic_pointer_add (&cache_total, -item->tile->size);
       g_atomic_pointer_add (&cache_total_uncloned, -item->tile->size);
 
-      g_queue_unlink (&cache->queue, &item->link);
-      g_hash_table_remove (cache->items, item);
-
-      if (g_queue_is_empty (&cache->queue))
-        cache->time = cache->stamp = 0;
+      cache_unlink_item (cache, item);
 
       drop_hot_tile (item->tile);
       gegl_tile_mark_as_stored (item->tile); /* to cheat it out of being stored */
@@ -797,11 +966,7 @@ gegl_tile_handler_cache_remove_item (GeglTileHandlerCache *cache,
     g_atomic_pointer_add (&cache_total, -item->tile->size);
   g_atomic_pointer_add (&cache_total_uncloned, -item->tile->size);
 
-  g_queue_unlink (&cache->queue, &item->link);
-  g_hash_table_remove (cache->items, item);
-
-  if (g_queue_is_empty (&cache->queue))
-    cache->time = cache->stamp = 0;
+  cache_unlink_item (cache, item);
 
   item->tile->tile_storage = NULL;
   gegl_tile_unref (item->tile);
@@ -851,6 +1016,25 @@ gegl_tile_handler_cache_void (GeglTileHandlerCache *cache,
     }
 }
 
+/* trims the cache if @total exceeds the cache size.  as long as the cache
+ * doesn't overshoot its target size by too much, only a single thread trims
+ * the cache at any given time, while the rest carry on without waiting on the
+ * global mutex.
+ */
+static inline void
+gegl_tile_handler_cache_maybe_trim (GeglTileHandlerCache *cache,
+                                    guintptr              total)
+{
+  guint64 target_size = gegl_buffer_config ()->tile_cache_size;
+
+  if (total > target_size)
+    {
+      gegl_tile_handler_cache_trim (
+        cache,
+        total > target_size * GEGL_CACHE_TRIM_WAIT_RATIO);
+    }
+}
+
 void
 gegl_tile_handler_cache_insert (GeglTileHandlerCache *cache,
                                 GeglTile             *tile,
@@ -868,6 +1052,7 @@ gegl_tile_handler_cache_insert (GeglTileHandlerCache *cache,
   item->x         = x;
   item->y         = y;
   item->z         = z;
+  item->probation = cache_policy () == GEGL_TILE_CACHE_POLICY_2Q;
 
   // XXX : remove entry if it already exists
   gegl_tile_handler_cache_remove (cache, x, y, z);
@@ -886,11 +1071,12 @@ gegl_tile_handler_cache_insert (GeglTileHandlerCache *cache,
   else
     total = (guintptr) g_atomic_pointer_get (&cache_total);
   g_atomic_pointer_add (&cache_total_uncloned, tile->size);
+  if (item->probation)
+    g_atomic_pointer_add (&cache_total_probation, tile->size);
   g_hash_table_insert (cache->items, item, item);
-  g_queue_push_head_link (&cache->queue, &item->link);
+  g_queue_push_head_link (cache_item_queue (cache, item), &item->link);
 
-  if (total > gegl_buffer_config ()->tile_cache_size)
-    gegl_tile_handler_cache_trim (cache);
+  gegl_tile_handler_cache_maybe_trim (cache, total);
 
   /* there's a race between this assignment, and the one at the bottom of
    * gegl_tile_handler_cache_tile_uncloned().  this is acceptable, though,
@@ -909,8 +1095,7 @@ gegl_tile_handler_cache_tile_uncloned (GeglTileHandlerCache *cache,
   total = (guintptr) g_atomic_pointer_add (&cache_total, tile->size) +
           tile->size;
 
-  if (total > gegl_buffer_config ()->tile_cache_size)
-    gegl_tile_handler_cache_trim (cache);
+  gegl_tile_handler_cache_maybe_trim (cache, total);
 
   cache_total_max = MAX (cache_total_max, total);
 }
@@ -967,24 +1152,66 @@ gegl_tile_handler_cache_get_total_uncloned (void)
   return cache_total_uncloned;
 }
 
+gsize
+gegl_tile_handler_cache_get_total_probation (void)
+{
+  return cache_total_probation;
+}
+
 gint
 gegl_tile_handler_cache_get_hits (void)
 {
-  return cache_hits;
+  gint hits = 0;
+  gint i;
+
+  for (i = 0; i < GEGL_CACHE_N_POLICIES; i++)
+    hits += gegl_tile_handler_cache_get_policy_hits (i);
+
+  return hits;
 }
 
 gint
 gegl_tile_handler_cache_get_misses (void)
 {
-  return cache_misses;
+  gint misses = 0;
+  gint i;
+
+  for (i = 0; i < GEGL_CACHE_N_POLICIES; i++)
+    misses += gegl_tile_handler_cache_get_policy_misses (i);
+
+  return misses;
+}
+
+gint
+gegl_tile_handler_cache_get_policy_hits (GeglTileCachePolicy policy)
+{
+  gint hits = 0;
+  gint i;
+
+  for (i = 0; i < GEGL_CACHE_N_STATS_SHARDS; i++)
+    hits += cache_stats[i].hits[policy];
+
+  return hits;
+}
+
+gint
+gegl_tile_handler_cache_get_policy_misses (GeglTileCachePolicy policy)
+{
+  gint misses = 0;
+  gint i;
+
+  for (i = 0; i < GEGL_CACHE_N_STATS_SHARDS; i++)
+    misses += cache_stats[i].misses[policy];
+
+  return misses;
 }
 
 void
 gegl_tile_handler_cache_reset_stats (void)
 {
   cache_total_max = cache_total;
-  cache_hits      = 0;
-  cache_misses    = 0;
+
+  memset (cache_stats, 0, sizeof (cache_stats));
 }
 
 
@@ -1036,7 +1263,12 @@ gegl_buffer_config_tile_cache_size_notify (GObject    *gobject,
   if ((guintptr) g_atomic_pointer_get (&cache_total) >
       gegl_buffer_config () ->tile_cache_size)
     {
-      gegl_tile_handler_cache_trim (NULL);
+      gegl_tile_handler_cache_trim (NULL, TRUE);
+
+      /* return the slabs freed up by the trimmed tiles to the system, rather
+       * than keeping them around for a cache that's now smaller.
+       */
+      gegl_tile_alloc_trim ();
     }
 }
 
@@ -1056,4 +1288,6 @@ gegl_tile_cache_destroy (void)
 
   g_warn_if_fail (g_queue_is_empty (&cache_queue));
   g_queue_clear (&cache_queue);
+
+  gegl_tile_alloc_cleanup ();
 }
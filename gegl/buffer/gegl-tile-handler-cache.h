@@ -43,6 +43,7 @@ struct _GeglTileHandlerCache
   GList            link;
   GHashTable      *items;
   GQueue           queue;
+  GQueue           probation;
   guintptr         time;
   guintptr         stamp;
 };
@@ -74,8 +75,11 @@ void              gegl_tile_handler_cache_tile_uncloned      (GeglTileHandlerCac
 gsize             gegl_tile_handler_cache_get_total          (void);
 gsize             gegl_tile_handler_cache_get_total_max      (void);
 gsize             gegl_tile_handler_cache_get_total_uncloned (void);
+gsize             gegl_tile_handler_cache_get_total_probation (void);
 gint              gegl_tile_handler_cache_get_hits           (void);
 gint              gegl_tile_handler_cache_get_misses         (void);
+gint              gegl_tile_handler_cache_get_policy_hits    (GeglTileCachePolicy   policy);
+gint              gegl_tile_handler_cache_get_policy_misses  (GeglTileCachePolicy   policy);
 
 void              gegl_tile_handler_cache_reset_stats        (void);
 
@@ -32,14 +32,43 @@
 #include "gegl-tile-storage.h"
 #include "gegl-buffer-private.h"
 #include "gegl-algorithms.h"
+#include "gegl-types.h"
+#include "gegl-parallel.h"
 
 
 G_DEFINE_TYPE (GeglTileHandlerZoom, gegl_tile_handler_zoom,
                GEGL_TYPE_TILE_HANDLER)
 
+/* the maximal number of tiles gegl_tile_handler_zoom_build() downscales at
+ * once, while holding the storage lock.
+ */
+#define BUILD_BATCH_SIZE  64
+/* the cost of using each additional thread, relative to the cost of
+ * downscaling a single tile
+ */
+#define BUILD_THREAD_COST 0.5
+
+typedef struct
+{
+  GeglTile *tile;
+  GeglTile *source_tile[2][2];
+  guint64   damage;
+  guint64   size;
+} BuildJob;
+
+typedef struct
+{
+  GeglTileHandlerZoom *zoom;
+  const Babl          *format;
+  gint                 tile_width;
+  gint                 tile_height;
+  BuildJob            *jobs;
+} BuildData;
+
 static guint64 total_size = 0;
 
-static void
+/* returns the number of bytes written to @dest */
+static guint64
 downscale (GeglTileHandlerZoom *zoom,
            const Babl          *format,
            gint                 bpp,
@@ -53,16 +82,14 @@ downscale (GeglTileHandlerZoom *zoom,
            guint                damage,
            gint                 i)
 {
-  gint  n    = 1 << i;
-  guint mask = (1 << n) - 1;
+  gint    n    = 1 << i;
+  guint   mask = (1 << n) - 1;
+  guint64 size = 0;
 
   if ((damage & mask) == mask)
     {
       if (src)
         {
-          if (!zoom->downscale_2x2)
-            zoom->downscale_2x2 = gegl_downscale_2x2_get_fun (format);
-
           zoom->downscale_2x2 (format,
                                width, height,
                                src +   y      * stride +  x      * bpp, stride,
@@ -83,7 +110,7 @@ downscale (GeglTileHandlerZoom *zoom,
             }
         }
 
-      total_size += (width / 2) * (height / 2) * bpp;
+      size += (width / 2) * (height / 2) * bpp;
     }
   else
     {
@@ -95,19 +122,19 @@ downscale (GeglTileHandlerZoom *zoom,
         {
           if (i & 1)
             {
-              downscale (zoom,
-                         format, bpp, src, dest, stride,
-                         x, y,
-                         width, height / 2,
-                         damage, i);
+              size += downscale (zoom,
+                                 format, bpp, src, dest, stride,
+                                 x, y,
+                                 width, height / 2,
+                                 damage, i);
             }
           else
             {
-              downscale (zoom,
-                         format, bpp, src, dest, stride,
-                         x, y,
-                         width / 2, height,
-                         damage, i);
+              size += downscale (zoom,
+                                 format, bpp, src, dest, stride,
+                                 x, y,
+                                 width / 2, height,
+                                 damage, i);
 
             }
         }
@@ -118,22 +145,157 @@ downscale (GeglTileHandlerZoom *zoom,
         {
           if (i & 1)
             {
-              downscale (zoom,
-                         format, bpp, src, dest, stride,
-                         x, y + height / 2,
-                         width, height / 2,
-                         damage, i);
+              size += downscale (zoom,
+                                 format, bpp, src, dest, stride,
+                                 x, y + height / 2,
+                                 width, height / 2,
+                                 damage, i);
             }
           else
             {
-              downscale (zoom,
-                         format, bpp, src, dest, stride,
-                         x + width / 2, y,
-                         width / 2, height,
-                         damage, i);
+              size += downscale (zoom,
+                                 format, bpp, src, dest, stride,
+                                 x + width / 2, y,
+                                 width / 2, height,
+                                 damage, i);
             }
         }
     }
+
+  return size;
+}
+
+/* fetches the level-(z-1) tiles covering the damaged quarters of @tile, or of
+ * the tile at @x, @y, @z if @tile is NULL.  returns TRUE if there's no data
+ * in the level below, in which case there's nothing to downscale.
+ */
+static gboolean
+get_source_tiles (GeglTileHandlerZoom *zoom,
+                  GeglTile            *tile,
+                  gint                 x,
+                  gint                 y,
+                  gint                 z,
+                  guint64              damage,
+                  GeglTile            *source_tile[2][2])
+{
+  gboolean empty = TRUE;
+  gint     i, j;
+
+  for (i = 0; i < 2; i++)
+    for (j = 0; j < 2; j++)
+      {
+        source_tile[i][j] = NULL;
+
+        if ((damage >> (32 * j + 16 * i)) & 0xffff)
+          {
+            /* clear the tile damage region before fetching each lower-level
+             * tile, so that if this results in the corresponding portion of
+             * the pyramid being voided, our damage region never covers the
+             * entire tile, and we're not getting dropped from the cache.
+             *
+             * note that our damage region is cleared at the end of the
+             * process by gegl_tile_unlock() anyway, so clearing it here is
+             * harmless.
+             */
+            if (tile)
+              tile->damage = 0;
+
+            /* we get the tile from ourselves, to make successive rescales
+             * work correctly */
+            source_tile[i][j] = gegl_tile_source_get_tile (
+              (GeglTileSource *) zoom, x * 2 + i, y * 2 + j, z - 1);
+
+            if (source_tile[i][j])
+              {
+                if (source_tile[i][j]->is_zero_tile)
+                  {
+                    gegl_tile_unref (source_tile[i][j]);
+
+                    source_tile[i][j] = NULL;
+                  }
+                else
+                  {
+                    empty = FALSE;
+                  }
+              }
+          }
+        else
+          {
+            empty = FALSE;
+          }
+      }
+
+  return empty;
+}
+
+/* downscales the damaged quarters of the locked @tile from @source_tile.
+ * doesn't touch the tile chain, and can be called concurrently for different
+ * tiles.  returns the number of bytes written.
+ */
+static guint64
+downscale_tile (GeglTileHandlerZoom *zoom,
+                const Babl          *format,
+                gint                 tile_width,
+                gint                 tile_height,
+                GeglTile            *tile,
+                GeglTile            *source_tile[2][2],
+                guint64              damage)
+{
+  gint    bpp    = babl_format_get_bytes_per_pixel (format);
+  gint    stride = tile_width * bpp;
+  guint64 size   = 0;
+  gint    i, j;
+
+  for (i = 0; i < 2; i++)
+    for (j = 0; j < 2; j++)
+      {
+        guint dmg = (damage >> (32 * j + 16 * i)) & 0xffff;
+
+        if (dmg)
+          {
+            gint x = i * tile_width / 2;
+            gint y = j * tile_height / 2;
+            guchar *src;
+            guchar *dest;
+
+            if (source_tile[i][j])
+              {
+                gegl_tile_read_lock (source_tile[i][j]);
+
+                src = gegl_tile_get_data (source_tile[i][j]);
+              }
+            else
+              {
+                src = NULL;
+              }
+
+            dest = gegl_tile_get_data (tile) + y * stride + x * bpp;
+
+            size += downscale (zoom,
+                               format, bpp, src, dest, stride,
+                               0, 0,
+                               tile_width, tile_height,
+                               dmg, 4);
+
+            if (source_tile[i][j])
+              gegl_tile_read_unlock (source_tile[i][j]);
+          }
+      }
+
+  return size;
+}
+
+static void
+unref_source_tiles (GeglTile *source_tile[2][2])
+{
+  gint i, j;
+
+  for (i = 0; i < 2; i++)
+    for (j = 0; j < 2; j++)
+      {
+        if (source_tile[i][j])
+          gegl_tile_unref (source_tile[i][j]);
+      }
 }
 
 static GeglTile *
@@ -146,142 +308,103 @@ get_tile (GeglTileSource *gegl_tile_source,
   GeglTileHandlerZoom *zoom   = (GeglTileHandlerZoom *) gegl_tile_source;
   GeglTile            *tile   = NULL;
   GeglTileStorage     *tile_storage;
-  gint                 tile_width;
-  gint                 tile_height;
+  const Babl          *format;
+  guint64              damage;
+  GeglTile            *source_tile[2][2];
 
   if (source)
     tile = gegl_tile_source_get_tile (source, x, y, z);
 
-  if (z == 0 || (tile && ! tile->damage))
+  if (z == 0)
     return tile;
 
   tile_storage = _gegl_tile_handler_get_tile_storage ((GeglTileHandler *) zoom);
 
+  /* update seen_zoom even if the backend provided the tile, so that it's
+   * voided when the level below is damaged.
+   */
   if (z > tile_storage->seen_zoom)
     tile_storage->seen_zoom = z;
 
-  tile_width = tile_storage->tile_width;
-  tile_height = tile_storage->tile_height;
-
-  {
-    gint        i, j;
-    const Babl *format;
-    gint        bpp;
-    gint        stride;
-    guint64     damage;
-    GeglTile   *source_tile[2][2] = { { NULL, NULL }, { NULL, NULL } };
-    gboolean    empty             = TRUE;
-
-    if (tile)
-      damage = tile->damage;
-    else
-      damage = ~(guint64) 0;
-
-    for (i = 0; i < 2; i++)
-      for (j = 0; j < 2; j++)
-        {
-          if ((damage >> (32 * j + 16 * i)) & 0xffff)
-            {
-              /* clear the tile damage region before fetching each lower-level
-               * tile, so that if this results in the corresponding portion of
-               * the pyramid being voided, our damage region never covers the
-               * entire tile, and we're not getting dropped from the cache.
-               *
-               * note that our damage region is cleared at the end of the
-               * process by gegl_tile_unlock() anyway, so clearing it here is
-               * harmless.
-               */
-              if (tile)
-                tile->damage = 0;
-
-              /* we get the tile from ourselves, to make successive rescales
-               * work correctly */
-              source_tile[i][j] = gegl_tile_source_get_tile (
-                gegl_tile_source, x * 2 + i, y * 2 + j, z - 1);
-
-              if (source_tile[i][j])
-                {
-                  if (source_tile[i][j]->is_zero_tile)
-                    {
-                      gegl_tile_unref (source_tile[i][j]);
-
-                      source_tile[i][j] = NULL;
-                    }
-                  else
-                    {
-                      empty = FALSE;
-                    }
-                }
-            }
-          else
-            {
-              empty = FALSE;
-            }
-        }
+  if (tile && ! tile->damage)
+    return tile;
 
-    if (empty)
-      {
-        if (tile)
-          gegl_tile_unref (tile);
+  if (tile)
+    damage = tile->damage;
+  else
+    damage = ~(guint64) 0;
 
-        return NULL;   /* no data from level below, return NULL and let GeglTileHandlerEmpty
-                          fill in the shared empty tile */
-      }
+  if (get_source_tiles (zoom, tile, x, y, z, damage, source_tile))
+    {
+      if (tile)
+        gegl_tile_unref (tile);
 
-    format = gegl_tile_backend_get_format (zoom->backend);
-    bpp    = babl_format_get_bytes_per_pixel (format);
-    stride = tile_width * bpp;
+      return NULL;   /* no data from level below, return NULL and let GeglTileHandlerEmpty
+                        fill in the shared empty tile */
+    }
 
-    if (! tile)
-      tile = gegl_tile_handler_create_tile (GEGL_TILE_HANDLER (zoom), x, y, z);
+  format = gegl_tile_backend_get_format (zoom->backend);
 
-    gegl_tile_lock (tile);
+  if (!zoom->downscale_2x2)
+    zoom->downscale_2x2 = gegl_downscale_2x2_get_fun (format);
 
-    for (i = 0; i < 2; i++)
-      for (j = 0; j < 2; j++)
-        {
-          guint dmg = (damage >> (32 * j + 16 * i)) & 0xffff;
+  if (! tile)
+    tile = gegl_tile_handler_create_tile (GEGL_TILE_HANDLER (zoom), x, y, z);
 
-          if (dmg)
-            {
-              gint x = i * tile_width / 2;
-              gint y = j * tile_height / 2;
-              guchar *src;
-              guchar *dest;
-
-              if (source_tile[i][j])
-                {
-                  gegl_tile_read_lock (source_tile[i][j]);
-
-                  src = gegl_tile_get_data (source_tile[i][j]);
-                }
-              else
-                {
-                  src = NULL;
-                }
-
-              dest = gegl_tile_get_data (tile) + y * stride + x * bpp;
-
-              downscale (zoom,
-                         format, bpp, src, dest, stride,
-                         0, 0,
-                         tile_width, tile_height,
-                         dmg, 4);
-
-              if (source_tile[i][j])
-                {
-                  gegl_tile_read_unlock (source_tile[i][j]);
-
-                  gegl_tile_unref (source_tile[i][j]);
-                }
-            }
-        }
-    gegl_tile_unlock (tile);
-  }
+  gegl_tile_lock (tile);
+
+  total_size += downscale_tile (zoom, format,
+                                tile_storage->tile_width,
+                                tile_storage->tile_height,
+                                tile, source_tile, damage);
+
+  gegl_tile_unlock (tile);
+
+  unref_source_tiles (source_tile);
 
   return tile;
 }
 
+static void
+build_range (gsize    offset,
+             gsize    size,
+             gpointer user_data)
+{
+  BuildData *data = user_data;
+  gsize      i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      BuildJob *job = &data->jobs[i];
+
+      job->size = downscale_tile (data->zoom, data->format,
+                                  data->tile_width, data->tile_height,
+                                  job->tile, job->source_tile, job->damage);
+    }
+}
+
+static void
+build_batch (BuildData *data,
+             gint       n_jobs)
+{
+  gint i;
+
+  gegl_parallel_distribute_range (n_jobs, BUILD_THREAD_COST,
+                                  build_range, data);
+
+  for (i = 0; i < n_jobs; i++)
+    {
+      BuildJob *job = &data->jobs[i];
+
+      gegl_tile_unlock (job->tile);
+      gegl_tile_unref (job->tile);
+
+      unref_source_tiles (job->source_tile);
+
+      total_size += job->size;
+    }
+}
+
 static gpointer
 gegl_tile_handler_zoom_command (GeglTileSource  *tile_store,
                                 GeglTileCommand  command,
@@ -330,3 +453,95 @@ gegl_tile_handler_zoom_reset_stats (void)
 {
   total_size = 0;
 }
+
+void
+gegl_tile_handler_zoom_build (GeglTileHandlerZoom *zoom,
+                              gint                 x1,
+                              gint                 y1,
+                              gint                 x2,
+                              gint                 y2,
+                              gint                 z)
+{
+  GeglTileSource  *source       = GEGL_TILE_HANDLER (zoom)->source;
+  GeglTileStorage *tile_storage;
+  BuildData        data;
+  BuildJob         jobs[BUILD_BATCH_SIZE];
+  gint             n_jobs       = 0;
+  gint             x, y;
+
+  g_return_if_fail (GEGL_IS_TILE_HANDLER_ZOOM (zoom));
+  g_return_if_fail (z > 0);
+
+  tile_storage = _gegl_tile_handler_get_tile_storage ((GeglTileHandler *) zoom);
+
+  data.zoom        = zoom;
+  data.format      = gegl_tile_backend_get_format (zoom->backend);
+  data.tile_width  = tile_storage->tile_width;
+  data.tile_height = tile_storage->tile_height;
+  data.jobs        = jobs;
+
+  if (!zoom->downscale_2x2)
+    zoom->downscale_2x2 = gegl_downscale_2x2_get_fun (data.format);
+
+  /* the storage is only locked while fetching the tiles of each batch, and
+   * while downscaling them, so that other threads get a chance to access the
+   * buffer in between.
+   */
+  g_rec_mutex_lock (&tile_storage->mutex);
+
+  if (z > tile_storage->seen_zoom)
+    tile_storage->seen_zoom = z;
+
+  for (y = y1; y <= y2; y++)
+    for (x = x1; x <= x2; x++)
+      {
+        BuildJob *job  = &jobs[n_jobs];
+        GeglTile *tile = NULL;
+
+        if (source)
+          tile = gegl_tile_source_get_tile (source, x, y, z);
+
+        if (tile && ! tile->damage)
+          {
+            gegl_tile_unref (tile);
+
+            continue;
+          }
+
+        if (tile)
+          job->damage = tile->damage;
+        else
+          job->damage = ~(guint64) 0;
+
+        if (get_source_tiles (zoom, tile, x, y, z,
+                              job->damage, job->source_tile))
+          {
+            if (tile)
+              gegl_tile_unref (tile);
+
+            continue;
+          }
+
+        if (! tile)
+          tile = gegl_tile_handler_create_tile (GEGL_TILE_HANDLER (zoom),
+                                                x, y, z);
+
+        gegl_tile_lock (tile);
+
+        job->tile = tile;
+
+        if (++n_jobs == BUILD_BATCH_SIZE)
+          {
+            build_batch (&data, n_jobs);
+            n_jobs = 0;
+
+            g_rec_mutex_unlock (&tile_storage->mutex);
+            g_rec_mutex_lock (&tile_storage->mutex);
+          }
+      }
+
+  if (n_jobs)
+    build_batch (&data, n_jobs);
+
+  g_rec_mutex_unlock (&tile_storage->mutex);
+}
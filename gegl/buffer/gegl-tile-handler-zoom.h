@@ -64,6 +64,17 @@ GType             gegl_tile_handler_zoom_get_type (void) G_GNUC_CONST;
 
 GeglTileHandler * gegl_tile_handler_zoom_new      (GeglTileBackend *backend);
 
+/* builds the damaged or missing tiles at level @z in the range [@x1,@x2] x
+ * [@y1,@y2], downscaling them from level @z - 1 in parallel.  the levels
+ * below should be built first, lest they get built on demand, serially.
+ */
+void              gegl_tile_handler_zoom_build    (GeglTileHandlerZoom *zoom,
+                                                   gint                 x1,
+                                                   gint                 y1,
+                                                   gint                 x2,
+                                                   gint                 y2,
+                                                   gint                 z);
+
 guint64           gegl_tile_handler_zoom_get_total   (void);
 void              gegl_tile_handler_zoom_reset_stats (void);
 
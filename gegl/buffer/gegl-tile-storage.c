@@ -59,6 +59,7 @@ gegl_tile_storage_new (GeglTileBackend *backend)
   tile_storage->px_size     = backend->priv->px_size;
   tile_storage->format      = gegl_tile_backend_get_format (backend);
   tile_storage->tile_size   = gegl_tile_backend_get_tile_size (backend);
+  tile_storage->seen_zoom   = backend->priv->max_z;
 
   gegl_tile_handler_set_source (handler, GEGL_TILE_SOURCE (backend));
 
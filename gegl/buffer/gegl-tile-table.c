@@ -0,0 +1,270 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <glib-object.h>
+
+#include "gegl-buffer.h"
+#include "gegl-buffer-private.h"
+#include "gegl-tile.h"
+#include "gegl-tile-table.h"
+
+
+/* a tile table maps tile coordinates to tiles, without locking.  it's used
+ * to look up the tiles of immutable buffers, which are read concurrently by
+ * many threads.
+ *
+ * the table is an open-addressed hash table, whose slots only ever go from
+ * empty to holding a tile, and hold a reference to their tile for as long as
+ * the table exists.  a reader can therefore grab a tile and ref it without
+ * any synchronization, as long as the table itself is alive.
+ *
+ * the lifetime of the table is guarded by per-thread hazard pointers: a
+ * reader announces the table it's using before using it, and
+ * gegl_tile_table_free() waits until no reader announces the table before
+ * freeing it.  the table pointer must be unpublished, i.e., set to NULL,
+ * before the table is freed, so that no new readers can acquire it.
+ */
+
+#define GEGL_TILE_TABLE_MAX_PROBES      8
+#define GEGL_TILE_TABLE_CACHE_LINE_SIZE 64
+
+
+struct _GeglTileTable
+{
+  gint       mask;
+  gint       max_n_tiles;
+  gint       n_tiles;
+
+  GeglTile  *slots[];
+};
+
+typedef struct
+{
+  GeglTileTable *table;
+
+  gchar          padding[GEGL_TILE_TABLE_CACHE_LINE_SIZE - sizeof (gpointer)];
+} GeglTileTableReader;
+
+
+static void   gegl_tile_table_reader_free (GeglTileTableReader *reader);
+
+
+static GPrivate  gegl_tile_table_reader_private = G_PRIVATE_INIT (
+  (GDestroyNotify) gegl_tile_table_reader_free);
+static GMutex    gegl_tile_table_readers_mutex;
+static GSList   *gegl_tile_table_readers;
+
+
+/*  private functions  */
+
+static void
+gegl_tile_table_reader_free (GeglTileTableReader *reader)
+{
+  g_mutex_lock (&gegl_tile_table_readers_mutex);
+
+  gegl_tile_table_readers = g_slist_remove (gegl_tile_table_readers, reader);
+
+  g_mutex_unlock (&gegl_tile_table_readers_mutex);
+
+  gegl_free (reader);
+}
+
+static inline GeglTileTableReader *
+gegl_tile_table_get_reader (void)
+{
+  GeglTileTableReader *reader = g_private_get (&gegl_tile_table_reader_private);
+
+  if (G_UNLIKELY (! reader))
+    {
+      reader         = gegl_malloc (sizeof (GeglTileTableReader));
+      reader->table  = NULL;
+
+      g_mutex_lock (&gegl_tile_table_readers_mutex);
+
+      gegl_tile_table_readers = g_slist_prepend (gegl_tile_table_readers,
+                                                 reader);
+
+      g_mutex_unlock (&gegl_tile_table_readers_mutex);
+
+      g_private_set (&gegl_tile_table_reader_private, reader);
+    }
+
+  return reader;
+}
+
+static inline guint
+gegl_tile_table_hash (gint x,
+                      gint y,
+                      gint z)
+{
+  return (guint) x * 73856093u ^ (guint) y * 19349663u ^ (guint) z * 83492791u;
+}
+
+
+/*  public functions  */
+
+GeglTileTable *
+gegl_tile_table_new (gint n_slots,
+                     gint max_n_tiles)
+{
+  GeglTileTable *table;
+
+  n_slots = 1 << g_bit_storage (MAX (n_slots, 2) - 1);
+
+  table = g_malloc0 (sizeof (GeglTileTable) + n_slots * sizeof (GeglTile *));
+
+  table->mask        = n_slots - 1;
+  table->max_n_tiles = MIN (max_n_tiles, n_slots);
+
+  return table;
+}
+
+void
+gegl_tile_table_free (GeglTileTable *table)
+{
+  GSList *iter;
+  gint    i;
+
+  if (! table)
+    return;
+
+  /* wait for the readers still using the table */
+  g_mutex_lock (&gegl_tile_table_readers_mutex);
+
+  for (iter = gegl_tile_table_readers; iter; iter = g_slist_next (iter))
+    {
+      GeglTileTableReader *reader = iter->data;
+
+      while (g_atomic_pointer_get (&reader->table) == table)
+        g_thread_yield ();
+    }
+
+  g_mutex_unlock (&gegl_tile_table_readers_mutex);
+
+  for (i = 0; i <= table->mask; i++)
+    {
+      if (table->slots[i])
+        gegl_tile_unref (table->slots[i]);
+    }
+
+  g_free (table);
+}
+
+/* returns the table pointed to by @table_ptr, guaranteeing it's not freed
+ * until it's released using gegl_tile_table_release(), or NULL if there's no
+ * table.  a thread may only hold a single table at a time.
+ */
+GeglTileTable *
+gegl_tile_table_acquire (GeglTileTable **table_ptr)
+{
+  GeglTileTableReader *reader;
+  GeglTileTable       *table;
+
+  if (! g_atomic_pointer_get (table_ptr))
+    return NULL;
+
+  reader = gegl_tile_table_get_reader ();
+
+  do
+    {
+      table = g_atomic_pointer_get (table_ptr);
+
+      g_atomic_pointer_set (&reader->table, table);
+    }
+  while (table && g_atomic_pointer_get (table_ptr) != table);
+
+  return table;
+}
+
+void
+gegl_tile_table_release (GeglTileTable *table)
+{
+  GeglTileTableReader *reader = g_private_get (&gegl_tile_table_reader_private);
+
+  g_atomic_pointer_set (&reader->table, NULL);
+}
+
+/* returns a new reference to the tile at (@x, @y, @z), or NULL if the table
+ * doesn't have it.
+ */
+GeglTile *
+gegl_tile_table_lookup (GeglTileTable *table,
+                        gint           x,
+                        gint           y,
+                        gint           z)
+{
+  guint hash = gegl_tile_table_hash (x, y, z);
+  gint  i;
+
+  for (i = 0; i < GEGL_TILE_TABLE_MAX_PROBES; i++)
+    {
+      GeglTile *tile;
+
+      tile = g_atomic_pointer_get (&table->slots[(hash + i) & table->mask]);
+
+      if (! tile)
+        return NULL;
+
+      if (tile->x == x && tile->y == y && tile->z == z)
+        return gegl_tile_ref (tile);
+    }
+
+  return NULL;
+}
+
+/* adds @tile to the table, at the tile's coordinates, unless the table is
+ * full, or already has a tile at the same coordinates.
+ */
+void
+gegl_tile_table_insert (GeglTileTable *table,
+                        GeglTile      *tile)
+{
+  guint hash = gegl_tile_table_hash (tile->x, tile->y, tile->z);
+  gint  i;
+
+  if (g_atomic_int_get (&table->n_tiles) >= table->max_n_tiles)
+    return;
+
+  for (i = 0; i < GEGL_TILE_TABLE_MAX_PROBES; i++)
+    {
+      GeglTile **slot = &table->slots[(hash + i) & table->mask];
+      GeglTile  *other;
+
+      other = g_atomic_pointer_get (slot);
+
+      if (! other)
+        {
+          gegl_tile_ref (tile);
+
+          if (g_atomic_pointer_compare_and_exchange (slot, NULL, tile))
+            {
+              g_atomic_int_inc (&table->n_tiles);
+
+              return;
+            }
+
+          /* we still hold the caller's reference */
+          gegl_tile_unref (tile);
+
+          other = g_atomic_pointer_get (slot);
+        }
+
+      if (other->x == tile->x && other->y == tile->y && other->z == tile->z)
+        return;
+    }
+}
@@ -0,0 +1,43 @@
+/* This file is part of GEGL
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GEGL_TILE_TABLE_H__
+#define __GEGL_TILE_TABLE_H__
+
+
+#include "gegl-buffer-types.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GeglTileTable GeglTileTable;
+
+GeglTileTable * gegl_tile_table_new     (gint            n_slots,
+                                         gint            max_n_tiles);
+void            gegl_tile_table_free    (GeglTileTable  *table);
+
+GeglTileTable * gegl_tile_table_acquire (GeglTileTable **table_ptr);
+void            gegl_tile_table_release (GeglTileTable  *table);
+
+GeglTile      * gegl_tile_table_lookup  (GeglTileTable  *table,
+                                         gint            x,
+                                         gint            y,
+                                         gint            z);
+void            gegl_tile_table_insert  (GeglTileTable  *table,
+                                         GeglTile       *tile);
+
+G_END_DECLS
+
+#endif
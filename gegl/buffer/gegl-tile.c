@@ -28,14 +28,15 @@
 
 #include "gegl-buffer.h"
 #include "gegl-tile.h"
+#include "gegl-tile-alloc.h"
 #include "gegl-buffer-private.h"
 #include "gegl-tile-storage.h"
 
 /* the offset at which the tile data begins, when it shares the same buffer as
- * n_clones.  use 16 bytes, which is the alignment we use for gegl_malloc(), so
- * that the tile data is similarly aligned.
+ * n_clones.  use the alignment of gegl_tile_alloc(), so that the tile data is
+ * similarly aligned.
  */
-#define INLINE_N_ELEMENTS_DATA_OFFSET 16
+#define INLINE_N_ELEMENTS_DATA_OFFSET GEGL_TILE_ALLOC_ALIGNMENT
 G_STATIC_ASSERT (INLINE_N_ELEMENTS_DATA_OFFSET >= 2 * sizeof (gint));
 
 enum
@@ -73,7 +74,7 @@ void gegl_tile_unref (GeglTile *tile)
            * with tile->n_clones at the front, so free the buffer
            * through it.
            */
-          gegl_free (tile->n_clones);
+          gegl_tile_free (tile->n_clones);
         }
       else
         {
@@ -162,7 +163,7 @@ gegl_tile_new (gint size)
   GeglTile *tile = gegl_tile_new_bare_internal ();
 
   /* allocate a single buffer for both tile->n_clones and tile->data */
-  tile->n_clones                    = gegl_malloc (INLINE_N_ELEMENTS_DATA_OFFSET + size);
+  tile->n_clones                    = gegl_tile_alloc (INLINE_N_ELEMENTS_DATA_OFFSET + size);
   *gegl_tile_n_clones (tile)        = 1;
   *gegl_tile_n_cached_clones (tile) = 0;
 
@@ -219,15 +220,14 @@ gegl_tile_unclone (GeglTile *tile)
 
               goto end;
             }
-          // XXX : should not use aligned calloc
-          tile->n_clones     = gegl_calloc (INLINE_N_ELEMENTS_DATA_OFFSET +
-                                            tile->size, 1);
+          tile->n_clones     = gegl_tile_alloc0 (INLINE_N_ELEMENTS_DATA_OFFSET +
+                                                 tile->size);
         }
       else
         {
           guchar *buf;
 
-          buf = gegl_malloc (INLINE_N_ELEMENTS_DATA_OFFSET + tile->size);
+          buf = gegl_tile_alloc (INLINE_N_ELEMENTS_DATA_OFFSET + tile->size);
           memcpy (buf + INLINE_N_ELEMENTS_DATA_OFFSET, tile->data, tile->size);
 
           if (g_atomic_int_dec_and_test (gegl_tile_n_clones (tile)))
@@ -235,7 +235,7 @@ gegl_tile_unclone (GeglTile *tile)
               /* someone else uncloned the tile in the meantime, and we're now
                * the last copy; bail.
                */
-              gegl_free (buf);
+              gegl_tile_free (buf);
               *gegl_tile_n_clones (tile)        = 1;
               *gegl_tile_n_cached_clones (tile) = cached;
 
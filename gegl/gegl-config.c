@@ -39,11 +39,17 @@ enum
   PROP_0,
   PROP_QUALITY,
   PROP_TILE_CACHE_SIZE,
+  PROP_TILE_CACHE_POLICY,
   PROP_CHUNK_SIZE,
   PROP_SWAP,
+  PROP_SWAP_COMPRESSION,
+  PROP_SWAP_POOL_SIZE,
+  PROP_FILE_COMPRESSION,
+  PROP_TILE_ALLOC_NUMA,
   PROP_TILE_WIDTH,
   PROP_TILE_HEIGHT,
   PROP_THREADS,
+  PROP_THREAD_AFFINITY,
   PROP_USE_OPENCL,
   PROP_QUEUE_SIZE,
   PROP_APPLICATION_LICENSE
@@ -65,6 +71,10 @@ gegl_config_get_property (GObject    *gobject,
         g_value_set_uint64 (value, config->tile_cache_size);
         break;
 
+      case PROP_TILE_CACHE_POLICY:
+        g_value_set_enum (value, config->tile_cache_policy);
+        break;
+
       case PROP_CHUNK_SIZE:
         g_value_set_int (value, config->chunk_size);
         break;
@@ -85,10 +95,30 @@ gegl_config_get_property (GObject    *gobject,
         g_value_set_string (value, config->swap);
         break;
 
+      case PROP_SWAP_COMPRESSION:
+        g_value_set_string (value, config->swap_compression);
+        break;
+
+      case PROP_SWAP_POOL_SIZE:
+        g_value_set_uint64 (value, config->swap_pool_size);
+        break;
+
+      case PROP_FILE_COMPRESSION:
+        g_value_set_string (value, config->file_compression);
+        break;
+
+      case PROP_TILE_ALLOC_NUMA:
+        g_value_set_boolean (value, config->tile_alloc_numa);
+        break;
+
       case PROP_THREADS:
         g_value_set_int (value, _gegl_threads);
         break;
 
+      case PROP_THREAD_AFFINITY:
+        g_value_set_boolean (value, config->thread_affinity);
+        break;
+
       case PROP_USE_OPENCL:
         g_value_set_boolean (value, gegl_cl_is_accelerated());
         break;
@@ -120,6 +150,9 @@ gegl_config_set_property (GObject      *gobject,
       case PROP_TILE_CACHE_SIZE:
         config->tile_cache_size = g_value_get_uint64 (value);
         break;
+      case PROP_TILE_CACHE_POLICY:
+        config->tile_cache_policy = g_value_get_enum (value);
+        break;
       case PROP_CHUNK_SIZE:
         config->chunk_size = g_value_get_int (value);
         break;
@@ -136,9 +169,26 @@ gegl_config_set_property (GObject      *gobject,
         g_free (config->swap);
         config->swap = g_value_dup_string (value);
         break;
+      case PROP_SWAP_COMPRESSION:
+        g_free (config->swap_compression);
+        config->swap_compression = g_value_dup_string (value);
+        break;
+      case PROP_SWAP_POOL_SIZE:
+        config->swap_pool_size = g_value_get_uint64 (value);
+        break;
+      case PROP_FILE_COMPRESSION:
+        g_free (config->file_compression);
+        config->file_compression = g_value_dup_string (value);
+        break;
+      case PROP_TILE_ALLOC_NUMA:
+        config->tile_alloc_numa = g_value_get_boolean (value);
+        break;
       case PROP_THREADS:
         _gegl_threads = g_value_get_int (value);
         return;
+      case PROP_THREAD_AFFINITY:
+        config->thread_affinity = g_value_get_boolean (value);
+        break;
       case PROP_USE_OPENCL:
         config->use_opencl = g_value_get_boolean (value);
         break;
@@ -161,6 +211,8 @@ gegl_config_finalize (GObject *gobject)
   GeglConfig *config = GEGL_CONFIG (gobject);
 
   g_free (config->swap);
+  g_free (config->swap_compression);
+  g_free (config->file_compression);
   g_free (config->application_license);
 
   G_OBJECT_CLASS (gegl_config_parent_class)->finalize (gobject);
@@ -199,6 +251,14 @@ gegl_config_class_init (GeglConfigClass *klass)
                                                         0, G_MAXUINT64, 512 * 1024 * 1024,
                                                         G_PARAM_READWRITE));
 
+  g_object_class_install_property (gobject_class, PROP_TILE_CACHE_POLICY,
+                                   g_param_spec_enum ("tile-cache-policy",
+                                                      "Tile Cache policy",
+                                                      "eviction policy of the tile cache",
+                                                      GEGL_TYPE_TILE_CACHE_POLICY,
+                                                      GEGL_TILE_CACHE_POLICY_LRU,
+                                                      G_PARAM_READWRITE));
+
   g_object_class_install_property (gobject_class, PROP_CHUNK_SIZE,
                                    g_param_spec_int ("chunk-size",
                                                      "Chunk size",
@@ -222,8 +282,37 @@ gegl_config_class_init (GeglConfigClass *klass)
                                                         NULL,
                                                         G_PARAM_READWRITE));
 
+  g_object_class_install_property (gobject_class, PROP_SWAP_COMPRESSION,
+                                   g_param_spec_string ("swap-compression",
+                                                        "Swap compression",
+                                                        "compression algorithm used for data stored in the swap",
+                                                        NULL,
+                                                        G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_SWAP_POOL_SIZE,
+                                   g_param_spec_uint64 ("swap-pool-size",
+                                                        "Swap pool size",
+                                                        "size of the in-memory pool of compressed swap data in bytes",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_FILE_COMPRESSION,
+                                   g_param_spec_string ("file-compression",
+                                                        "File compression",
+                                                        "compression algorithm used for tiles written by gegl_buffer_save(), or NULL to store them uncompressed",
+                                                        NULL,
+                                                        G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_TILE_ALLOC_NUMA,
+                                   g_param_spec_boolean ("tile-alloc-numa",
+                                                         "Tile allocation NUMA",
+                                                         "allocate tile data from pools bound to the NUMA node of the allocating thread",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE));
+
   _gegl_threads = g_get_num_processors ();
   _gegl_threads = MIN (_gegl_threads, GEGL_MAX_THREADS);
+
   g_object_class_install_property (gobject_class, PROP_THREADS,
                                    g_param_spec_int ("threads",
                                                      "Number of threads",
@@ -233,6 +322,14 @@ gegl_config_class_init (GeglConfigClass *klass)
                                                      G_PARAM_READWRITE |
                                                      G_PARAM_CONSTRUCT));
 
+  g_object_class_install_property (gobject_class, PROP_THREAD_AFFINITY,
+                                   g_param_spec_boolean ("thread-affinity",
+                                                         "Thread affinity",
+                                                         "Pin the worker threads to cpus, and process the same tiles on the same threads across operations",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_CONSTRUCT));
+
   g_object_class_install_property (gobject_class, PROP_USE_OPENCL,
                                    g_param_spec_boolean ("use-opencl",
                                                          "Use OpenCL",
@@ -261,10 +358,15 @@ static void
 gegl_config_init (GeglConfig *self)
 {
   char *forward_props[]={"swap",
+                         "swap-compression",
+                         "swap-pool-size",
+                         "file-compression",
+                         "tile-alloc-numa",
                          "queue-size",
                          "tile-width",
                          "tile-height",
                          "tile-cache-size",
+                         "tile-cache-policy",
                          NULL};
   GeglBufferConfig *bconf = gegl_buffer_config ();
   for (int i = 0; forward_props[i]; i++)
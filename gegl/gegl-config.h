@@ -35,15 +35,21 @@ struct _GeglConfig
 {
   GObject  parent_instance;
 
-  gchar   *swap;
-  guint64  tile_cache_size;
-  gint     chunk_size; /* The size of elements being processed at once */
-  gdouble  quality;
-  gint     tile_width;
-  gint     tile_height;
-  gboolean use_opencl;
-  gint     queue_size;
-  gchar   *application_license;
+  gchar               *swap;
+  gchar               *swap_compression;
+  guint64              swap_pool_size;
+  gchar               *file_compression;
+  gboolean             tile_alloc_numa;
+  guint64              tile_cache_size;
+  GeglTileCachePolicy  tile_cache_policy;
+  gint                 chunk_size; /* The size of elements being processed at once */
+  gdouble              quality;
+  gint                 tile_width;
+  gint                 tile_height;
+  gboolean             use_opencl;
+  gboolean             thread_affinity;
+  gint                 queue_size;
+  gchar               *application_license;
 };
 
 struct _GeglConfigClass
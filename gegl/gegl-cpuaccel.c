@@ -115,7 +115,28 @@ enum
 
 enum
 {
-  ARCH_X86_INTEL_FEATURE_PNI      = 1 << 0
+  ARCH_X86_INTEL_FEATURE_PNI      = 1 << 0,
+  ARCH_X86_INTEL_FEATURE_FMA      = 1 << 12,
+  ARCH_X86_INTEL_FEATURE_SSE4_1   = 1 << 19,
+  ARCH_X86_INTEL_FEATURE_OSXSAVE  = 1 << 27,
+  ARCH_X86_INTEL_FEATURE_AVX      = 1 << 28
+};
+
+/* structured extended features, leaf 7, in ebx */
+enum
+{
+  ARCH_X86_INTEL_FEATURE_AVX2     = 1 << 5,
+  ARCH_X86_INTEL_FEATURE_AVX512F  = 1 << 16
+};
+
+/* the register states enabled by the os in XCR0 */
+enum
+{
+  ARCH_X86_XCR0_SSE               = 1 << 1,
+  ARCH_X86_XCR0_AVX               = 1 << 2,
+  ARCH_X86_XCR0_OPMASK            = 1 << 5,
+  ARCH_X86_XCR0_ZMM_HI256         = 1 << 6,
+  ARCH_X86_XCR0_HI16_ZMM          = 1 << 7
 };
 
 #if !defined(ARCH_X86_64) && (defined(PIC) || defined(__PIC__))
@@ -128,6 +149,16 @@ enum
              "=c" (ecx),           \
              "=d" (edx)            \
            : "0" (op))
+#define cpuid_count(op,count,eax,ebx,ecx,edx) \
+  __asm__ ("movl %%ebx, %%esi\n\t"            \
+           "cpuid\n\t"                        \
+           "xchgl %%ebx,%%esi"                \
+           : "=a" (eax),                      \
+             "=S" (ebx),                      \
+             "=c" (ecx),                      \
+             "=d" (edx)                       \
+           : "0" (op),                        \
+             "2" (count))
 #else
 #define cpuid(op,eax,ebx,ecx,edx)  \
   __asm__ ("cpuid"                 \
@@ -136,8 +167,23 @@ enum
              "=c" (ecx),           \
              "=d" (edx)            \
            : "0" (op))
+#define cpuid_count(op,count,eax,ebx,ecx,edx) \
+  __asm__ ("cpuid"                            \
+           : "=a" (eax),                      \
+             "=b" (ebx),                      \
+             "=c" (ecx),                      \
+             "=d" (edx)                       \
+           : "0" (op),                        \
+             "2" (count))
 #endif
 
+/* xgetbv, spelled out for assemblers that don't know it */
+#define xgetbv(op,eax,edx)               \
+  __asm__ (".byte 0x0f, 0x01, 0xd0"      \
+           : "=a" (eax),                 \
+             "=d" (edx)                  \
+           : "c" (op))
+
 
 static X86Vendor
 arch_get_vendor (void)
@@ -235,6 +281,53 @@ arch_accel_intel (void)
 
     if (ecx & ARCH_X86_INTEL_FEATURE_PNI)
       caps |= GEGL_CPU_ACCEL_X86_SSE3;
+
+    if (ecx & ARCH_X86_INTEL_FEATURE_SSE4_1)
+      caps |= GEGL_CPU_ACCEL_X86_SSE4_1;
+
+    /* the avx family needs the os to save the wider registers, too */
+    if ((ecx & ARCH_X86_INTEL_FEATURE_OSXSAVE) &&
+        (ecx & ARCH_X86_INTEL_FEATURE_AVX))
+      {
+        guint32 xcr0;
+        guint32 max_leaf;
+
+        xgetbv (0, xcr0, edx);
+
+        if ((xcr0 & (ARCH_X86_XCR0_SSE | ARCH_X86_XCR0_AVX)) ==
+            (ARCH_X86_XCR0_SSE | ARCH_X86_XCR0_AVX))
+          {
+            caps |= GEGL_CPU_ACCEL_X86_AVX;
+
+            if (ecx & ARCH_X86_INTEL_FEATURE_FMA)
+              caps |= GEGL_CPU_ACCEL_X86_FMA;
+
+            cpuid (0, max_leaf, ebx, ecx, edx);
+
+            if (max_leaf >= 7)
+              {
+                cpuid_count (7, 0, eax, ebx, ecx, edx);
+
+                if (ebx & ARCH_X86_INTEL_FEATURE_AVX2)
+                  caps |= GEGL_CPU_ACCEL_X86_AVX2;
+
+                /* every avx-512 cpu has avx2, and code using avx-512 may
+                 * assume it; never report the former without the latter.
+                 */
+                if ((caps & GEGL_CPU_ACCEL_X86_AVX2)       &&
+                    (ebx & ARCH_X86_INTEL_FEATURE_AVX512F) &&
+                    (xcr0 & (ARCH_X86_XCR0_OPMASK    |
+                             ARCH_X86_XCR0_ZMM_HI256 |
+                             ARCH_X86_XCR0_HI16_ZMM)) ==
+                            (ARCH_X86_XCR0_OPMASK    |
+                             ARCH_X86_XCR0_ZMM_HI256 |
+                             ARCH_X86_XCR0_HI16_ZMM))
+                  {
+                    caps |= GEGL_CPU_ACCEL_X86_AVX512F;
+                  }
+              }
+          }
+      }
 #endif /* USE_SSE */
   }
 #endif /* USE_MMX */
@@ -400,7 +493,10 @@ arch_accel (void)
 
 #ifdef USE_SSE
   if ((caps & GEGL_CPU_ACCEL_X86_SSE) && !arch_accel_sse_os_support ())
-    caps &= ~(GEGL_CPU_ACCEL_X86_SSE | GEGL_CPU_ACCEL_X86_SSE2);
+    caps &= ~(GEGL_CPU_ACCEL_X86_SSE    | GEGL_CPU_ACCEL_X86_SSE2   |
+              GEGL_CPU_ACCEL_X86_SSE3   | GEGL_CPU_ACCEL_X86_SSE4_1 |
+              GEGL_CPU_ACCEL_X86_AVX    | GEGL_CPU_ACCEL_X86_AVX2   |
+              GEGL_CPU_ACCEL_X86_FMA    | GEGL_CPU_ACCEL_X86_AVX512F);
 #endif
 
   return caps;
@@ -480,6 +576,22 @@ arch_accel (void)
 #endif /* ARCH_PPC && USE_ALTIVEC */
 
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#define HAVE_ACCEL 1
+
+/* neon is either part of the baseline of the targeted architecture, as on
+ * aarch64, or was explicitly enabled when compiling
+ */
+static guint32
+arch_accel (void)
+{
+  return GEGL_CPU_ACCEL_ARM_NEON;
+}
+
+#endif /* __ARM_NEON || __ARM_NEON__ */
+
+
 static GeglCpuAccelFlags
 cpu_accel (void)
 {
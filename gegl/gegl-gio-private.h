@@ -33,6 +33,12 @@ gegl_gio_open_output_stream(const gchar *uri, const gchar *path, GFile **out_fil
 gboolean
 gegl_gio_uri_is_datauri(const gchar *uri);
 
+gchar *
+gegl_gio_get_etag(GFile *file);
+
+gchar *
+gegl_gio_get_stream_etag(GInputStream *stream);
+
 gchar *
 gegl_gio_datauri_get_content_type(const gchar *uri);
 
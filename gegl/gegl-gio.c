@@ -111,6 +111,66 @@ gegl_gio_uri_is_datauri(const gchar *uri)
     return g_str_has_prefix(uri, "data:");
 }
 
+/**
+ * gegl_gio_get_etag:
+ * @file: the file to query
+ *
+ * Return value: (transfer full): the entity tag of @file, which changes
+ * whenever the file is modified, or %NULL if it isn't available; free with
+ * g_free()
+ *
+ * Note: currently private API
+ */
+gchar *
+gegl_gio_get_etag(GFile *file)
+{
+  GFileInfo *info;
+  gchar *etag = NULL;
+  g_return_val_if_fail(G_IS_FILE(file), NULL);
+
+  info = g_file_query_info(file, G_FILE_ATTRIBUTE_ETAG_VALUE,
+                           G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  if (info)
+    {
+      etag = g_strdup(g_file_info_get_etag(info));
+      g_object_unref(info);
+    }
+
+  return etag;
+}
+
+/**
+ * gegl_gio_get_stream_etag:
+ * @stream: a stream returned by gegl_gio_open_input_stream()
+ *
+ * Return value: (transfer full): the entity tag of the file @stream reads,
+ * as of when it was opened, or %NULL if @stream isn't reading a file or the
+ * tag isn't available; free with g_free()
+ *
+ * Note: currently private API
+ */
+gchar *
+gegl_gio_get_stream_etag(GInputStream *stream)
+{
+  GFileInfo *info;
+  gchar *etag = NULL;
+  g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+
+  if (!G_IS_FILE_INPUT_STREAM(stream))
+    return NULL;
+
+  info = g_file_input_stream_query_info(G_FILE_INPUT_STREAM(stream),
+                                        G_FILE_ATTRIBUTE_ETAG_VALUE,
+                                        NULL, NULL);
+  if (info)
+    {
+      etag = g_strdup(g_file_info_get_etag(info));
+      g_object_unref(info);
+    }
+
+  return etag;
+}
+
 /**
  * gegl_gio_open_input_stream:
  * @uri: (allow none) URI to open. @uri is preferred over @path if both are set
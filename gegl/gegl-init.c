@@ -77,6 +77,7 @@ guint gegl_debug_flags = 0;
 #include "buffer/gegl-buffer-private.h"
 #include "buffer/gegl-buffer-iterator-private.h"
 #include "buffer/gegl-buffer-swap-private.h"
+#include "buffer/gegl-compression.h"
 #include "buffer/gegl-tile-backend-ram.h"
 #include "buffer/gegl-tile-backend-file.h"
 #include "gegl-config.h"
@@ -84,6 +85,7 @@ guint gegl_debug_flags = 0;
 #include "graph/gegl-node-private.h"
 #include "gegl-random-private.h"
 #include "gegl-parallel-private.h"
+#include "gegl-scratch-private.h"
 
 static gboolean  gegl_post_parse_hook (GOptionContext *context,
                                        GOptionGroup   *group,
@@ -284,6 +286,18 @@ static void gegl_config_parse_env (GeglConfig *config)
                     NULL);
     }
 
+  if (g_getenv ("GEGL_CACHE_POLICY"))
+    {
+      const gchar *policy = g_getenv ("GEGL_CACHE_POLICY");
+
+      if (g_ascii_strcasecmp (policy, "lru") == 0)
+        g_object_set (config, "tile-cache-policy", GEGL_TILE_CACHE_POLICY_LRU, NULL);
+      else if (g_ascii_strcasecmp (policy, "2q") == 0)
+        g_object_set (config, "tile-cache-policy", GEGL_TILE_CACHE_POLICY_2Q, NULL);
+      else
+        g_warning ("Unknown value for GEGL_CACHE_POLICY: %s", policy);
+    }
+
   if (g_getenv ("GEGL_CHUNK_SIZE"))
     config->chunk_size = atoi(g_getenv("GEGL_CHUNK_SIZE"));
 
@@ -314,6 +328,13 @@ static void gegl_config_parse_env (GeglConfig *config)
         }
     }
 
+  if (g_getenv ("GEGL_THREAD_AFFINITY"))
+    {
+      g_object_set (config,
+                    "thread-affinity", atoi (g_getenv ("GEGL_THREAD_AFFINITY")) != 0,
+                    NULL);
+    }
+
   if (g_getenv ("GEGL_USE_OPENCL"))
     {
       const char *opencl_env = g_getenv ("GEGL_USE_OPENCL");
@@ -334,6 +355,35 @@ static void gegl_config_parse_env (GeglConfig *config)
 
   if (g_getenv ("GEGL_SWAP"))
     g_object_set (config, "swap", g_getenv ("GEGL_SWAP"), NULL);
+
+  if (g_getenv ("GEGL_SWAP_POOL_SIZE"))
+    {
+      g_object_set (config,
+                    "swap-pool-size",
+                    (guint64) atoll (g_getenv ("GEGL_SWAP_POOL_SIZE")) * 1024 * 1024,
+                    NULL);
+    }
+
+  if (g_getenv ("GEGL_SWAP_COMPRESSION"))
+    {
+      g_object_set (config,
+                    "swap-compression", g_getenv ("GEGL_SWAP_COMPRESSION"),
+                    NULL);
+    }
+
+  if (g_getenv ("GEGL_FILE_COMPRESSION"))
+    {
+      g_object_set (config,
+                    "file-compression", g_getenv ("GEGL_FILE_COMPRESSION"),
+                    NULL);
+    }
+
+  if (g_getenv ("GEGL_TILE_ALLOC_NUMA"))
+    {
+      g_object_set (config,
+                    "tile-alloc-numa", atoi (g_getenv ("GEGL_TILE_ALLOC_NUMA")) != 0,
+                    NULL);
+    }
 }
 
 GeglConfig *gegl_config (void)
@@ -376,7 +426,9 @@ gegl_exit (void)
   gegl_operation_handlers_cleanup ();
   gegl_random_cleanup ();
   gegl_parallel_cleanup ();
+  gegl_scratch_cleanup ();
   gegl_buffer_swap_cleanup ();
+  gegl_compression_cleanup ();
   gegl_cl_cleanup ();
 
   gegl_temp_buffer_free ();
@@ -565,6 +617,7 @@ gegl_post_parse_hook (GOptionContext *context,
 
   GEGL_INSTRUMENT_START();
 
+  gegl_compression_init ();
   gegl_buffer_swap_init ();
   gegl_parallel_init ();
   gegl_operation_gtype_init ();
@@ -127,6 +127,26 @@ type_name##_register_type (GTypeModule *type_module)                    \
 
 #define GEGL_PROPERTIES(op) ((GeglProperties *) (((GeglOp*)(op))->properties))
 
+/* function multiversioning: prefixing the definition of a function, such as
+ * the process() function of a point filter, with GEGL_OP_SIMD_CLONES makes
+ * the compiler build it once for each of the instruction sets listed below,
+ * in addition to the baseline, and pick the best one the cpu supports when
+ * the operation is loaded.  fma is left out on purpose, so that the results
+ * don't depend on the cpu.  where the compiler or platform doesn't support
+ * it, or if GEGL_OP_NO_SIMD_CLONES is defined, it expands to nothing.
+ */
+#ifndef GEGL_OP_SIMD_CLONES
+#if ! defined (GEGL_OP_NO_SIMD_CLONES)                         && \
+    defined (__GNUC__) && ! defined (__clang__) && __GNUC__ >= 6 && \
+    (defined (__x86_64__) || defined (__i386__))               && \
+    defined (__gnu_linux__)
+#define GEGL_OP_SIMD_CLONES \
+  __attribute__ ((target_clones ("default", "sse4.1", "avx2", "avx512f")))
+#else
+#define GEGL_OP_SIMD_CLONES
+#endif
+#endif
+
 #define MKCLASS(a)  MKCLASS2(a)
 #define MKCLASS2(a) a##Class
 
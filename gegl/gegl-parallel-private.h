@@ -23,8 +23,20 @@
 G_BEGIN_DECLS
 
 
-void   gegl_parallel_init    (void);
-void   gegl_parallel_cleanup (void);
+void   gegl_parallel_init                   (void);
+void   gegl_parallel_cleanup                (void);
+
+/* like gegl_parallel_distribute_area(), but aligns the cells of
+ * GEGL_SPLIT_STRATEGY_AFFINITY to the tiles of @buffer at @level, rather
+ * than to the default tile size.
+ */
+void   gegl_parallel_distribute_buffer_area (GeglBuffer                     *buffer,
+                                             gint                            level,
+                                             const GeglRectangle            *area,
+                                             gdouble                         thread_cost,
+                                             GeglSplitStrategy               split_strategy,
+                                             GeglParallelDistributeAreaFunc  func,
+                                             gpointer                        user_data);
 
 
 G_END_DECLS
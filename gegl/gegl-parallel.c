@@ -18,6 +18,11 @@
 
 #include "config.h"
 
+#ifdef HAVE_SCHED_SETAFFINITY
+#define _GNU_SOURCE
+#include <sched.h>
+#endif
+
 #include <math.h>
 
 #include <glib.h>
@@ -26,43 +31,95 @@
 #include "gegl-config.h"
 #include "gegl-parallel.h"
 #include "gegl-parallel-private.h"
+#include "gegl-scratch.h"
+#include "buffer/gegl-buffer-private.h"
 
 
 #define GEGL_PARALLEL_DISTRIBUTE_MAX_THREADS GEGL_MAX_THREADS
 
+/* the number of work items each thread is assigned by
+ * gegl_parallel_distribute_range() and gegl_parallel_distribute_area().
+ * splitting the work into more items than threads allows idle threads to
+ * steal work from busy threads, when the cost of the items is uneven.
+ */
+#define GEGL_PARALLEL_DISTRIBUTE_ITEMS_PER_THREAD 8
+
+/* the size of the cells an area is split into by
+ * GEGL_SPLIT_STRATEGY_AFFINITY, in tiles.
+ */
+#define GEGL_PARALLEL_AFFINITY_CELL_WIDTH         4
+#define GEGL_PARALLEL_AFFINITY_CELL_HEIGHT        1
+
+
+/* a contiguous range of unclaimed work items.  the owning thread claims items
+ * from the front of the range, while other threads steal items from its
+ * back.
+ */
+typedef struct
+{
+  GMutex        mutex;
+  volatile gint begin;
+  volatile gint end;
+
+  /* protected by gegl_parallel_distribute_mutex */
+  gboolean      joined;
+} GeglParallelDistributeSlot;
 
 typedef struct
 {
   GeglParallelDistributeFunc func;
   gint                       n;
   gpointer                   user_data;
+
+  GeglParallelDistributeSlot slots[GEGL_PARALLEL_DISTRIBUTE_MAX_THREADS];
+  gint                       n_slots;
+  /* whether each slot is owned by the thread of the same index */
+  gboolean                   affinity;
+
+  /* protected by gegl_parallel_distribute_mutex */
+  gint                       n_joined;
+  gint                       n_active;
+  GList                      link;
+
+  volatile gint              n_unclaimed;
 } GeglParallelDistributeTask;
 
 typedef struct
 {
   GThread                    *thread;
-  GMutex                      mutex;
-  GCond                       cond;
 
   gboolean                    quit;
-
-  GeglParallelDistributeTask *volatile task;
-  volatile gint               i;
 } GeglParallelDistributeThread;
 
 
 /*  local function prototypes  */
 
 static void          gegl_parallel_notify_threads                   (GeglConfig                   *config);
+static void          gegl_parallel_notify_thread_affinity           (GeglConfig                   *config);
 
 static void          gegl_parallel_set_n_threads                    (gint                          n_threads,
                                                                      gboolean                      finish_tasks);
 
+static void          gegl_parallel_distribute_run                   (gint                          n_threads,
+                                                                     gint                          n,
+                                                                     const gint                   *slot_ends,
+                                                                     GeglParallelDistributeFunc    func,
+                                                                     gpointer                      user_data);
+static gint          gegl_parallel_distribute_task_join             (GeglParallelDistributeTask   *task);
+static void          gegl_parallel_distribute_task_run              (GeglParallelDistributeTask   *task,
+                                                                     gint                          slot_index);
+static GeglParallelDistributeTask *
+                     gegl_parallel_distribute_find_task             (void);
+
 static void          gegl_parallel_distribute_set_n_threads         (gint                          n_threads);
 static gpointer      gegl_parallel_distribute_thread_func           (GeglParallelDistributeThread *thread);
+static void          gegl_parallel_distribute_thread_pin            (gint                          index);
 
 static inline gint   gegl_parallel_distribute_get_optimal_n_threads (gdouble                       n_elements,
                                                                      gdouble                       thread_cost);
+static inline gint   gegl_parallel_distribute_get_n_items           (gdouble                       n_elements,
+                                                                     gdouble                       thread_cost,
+                                                                     gint                          n_threads);
 
 
 /*  local variables  */
@@ -70,10 +127,19 @@ static inline gint   gegl_parallel_distribute_get_optimal_n_threads (gdouble
 static gint                         gegl_parallel_distribute_n_threads = 1;
 static GeglParallelDistributeThread gegl_parallel_distribute_threads[GEGL_PARALLEL_DISTRIBUTE_MAX_THREADS - 1];
 
-static GMutex                       gegl_parallel_distribute_completion_mutex;
+/* the tasks currently being distributed, most-recent first, so that nested
+ * tasks, which the outer tasks are waiting on, are served first.
+ */
+static GQueue                       gegl_parallel_distribute_tasks = G_QUEUE_INIT;
+
+static GMutex                       gegl_parallel_distribute_mutex;
+static GCond                        gegl_parallel_distribute_cond;
 static GCond                        gegl_parallel_distribute_completion_cond;
-static volatile gint                gegl_parallel_distribute_completion_counter;
-static volatile gint                gegl_parallel_distribute_busy;
+
+/* the index of the current thread: worker threads are numbered from 1, while
+ * all other threads have an index of 0.
+ */
+static GPrivate                     gegl_parallel_distribute_thread_index;
 
 
 /*  public functions  */
@@ -85,6 +151,9 @@ gegl_parallel_init (void)
   g_signal_connect (gegl_config (), "notify::threads",
                     G_CALLBACK (gegl_parallel_notify_threads),
                     NULL);
+  g_signal_connect (gegl_config (), "notify::thread-affinity",
+                    G_CALLBACK (gegl_parallel_notify_thread_affinity),
+                    NULL);
 
   gegl_parallel_notify_threads (gegl_config ());
 }
@@ -95,6 +164,9 @@ gegl_parallel_cleanup (void)
   g_signal_handlers_disconnect_by_func (gegl_config (),
                                         gegl_parallel_notify_threads,
                                         NULL);
+  g_signal_handlers_disconnect_by_func (gegl_config (),
+                                        gegl_parallel_notify_thread_affinity,
+                                        NULL);
 
   /* stop all threads */
   gegl_parallel_set_n_threads (0, /* finish_tasks = */ FALSE);
@@ -105,65 +177,28 @@ gegl_parallel_distribute (gint                       max_n,
                           GeglParallelDistributeFunc func,
                           gpointer                   user_data)
 {
-  GeglParallelDistributeTask task;
-  gint                       i;
+  gint n_threads;
 
   g_return_if_fail (func != NULL);
 
   if (max_n == 0)
     return;
 
+  n_threads = g_atomic_int_get (&gegl_parallel_distribute_n_threads);
+
   if (max_n < 0)
-    max_n = gegl_parallel_distribute_n_threads;
+    max_n = n_threads;
   else
-    max_n = MIN (max_n, gegl_parallel_distribute_n_threads);
+    max_n = MIN (max_n, n_threads);
 
-  if (max_n == 1 ||
-      ! g_atomic_int_compare_and_exchange (&gegl_parallel_distribute_busy,
-                                           0, 1))
+  if (max_n == 1)
     {
       func (0, 1, user_data);
 
       return;
     }
 
-  task.n         = max_n;
-  task.func      = func;
-  task.user_data = user_data;
-
-  g_atomic_int_set (&gegl_parallel_distribute_completion_counter, task.n - 1);
-
-  for (i = 0; i < task.n - 1; i++)
-    {
-      GeglParallelDistributeThread *thread =
-        &gegl_parallel_distribute_threads[i];
-
-      g_mutex_lock (&thread->mutex);
-
-      thread->task = &task;
-      thread->i    = i;
-
-      g_cond_signal (&thread->cond);
-
-      g_mutex_unlock (&thread->mutex);
-    }
-
-  func (i, task.n, user_data);
-
-  if (g_atomic_int_get (&gegl_parallel_distribute_completion_counter))
-    {
-      g_mutex_lock (&gegl_parallel_distribute_completion_mutex);
-
-      while (g_atomic_int_get (&gegl_parallel_distribute_completion_counter))
-        {
-          g_cond_wait (&gegl_parallel_distribute_completion_cond,
-                       &gegl_parallel_distribute_completion_mutex);
-        }
-
-      g_mutex_unlock (&gegl_parallel_distribute_completion_mutex);
-    }
-
-  g_atomic_int_set (&gegl_parallel_distribute_busy, 0);
+  gegl_parallel_distribute_run (max_n, max_n, NULL, func, user_data);
 }
 
 typedef struct
@@ -195,6 +230,7 @@ gegl_parallel_distribute_range (gsize                           size,
 {
   GeglParallelDistributeRangeData data;
   gint                            n_threads;
+  gint                            n_items;
 
   g_return_if_fail (func != NULL);
 
@@ -212,12 +248,15 @@ gegl_parallel_distribute_range (gsize                           size,
       return;
     }
 
+  n_items = gegl_parallel_distribute_get_n_items (size, thread_cost,
+                                                  n_threads);
+
   data.size      = size;
   data.func      = func;
   data.user_data = user_data;
 
-  gegl_parallel_distribute (
-    n_threads,
+  gegl_parallel_distribute_run (
+    n_threads, n_items, NULL,
     (GeglParallelDistributeFunc) gegl_parallel_distribute_range_func,
     &data);
 }
@@ -270,18 +309,158 @@ gegl_parallel_distribute_area_func (gint                            i,
   data->func (&sub_area, data->user_data);
 }
 
-void
-gegl_parallel_distribute_area (const GeglRectangle            *area,
-                               gdouble                         thread_cost,
-                               GeglSplitStrategy               split_strategy,
-                               GeglParallelDistributeAreaFunc  func,
-                               gpointer                        user_data)
+typedef struct
+{
+  const GeglRectangle            *cells;
+  GeglParallelDistributeAreaFunc  func;
+  gpointer                        user_data;
+} GeglParallelDistributeAffinityData;
+
+static void
+gegl_parallel_distribute_affinity_func (gint                                i,
+                                        gint                                n,
+                                        GeglParallelDistributeAffinityData *data)
+{
+  data->func (&data->cells[i], data->user_data);
+}
+
+static inline gint
+gegl_parallel_floor_div (gint a,
+                         gint b)
+{
+  return a >= 0 ? a / b : -((b - 1 - a) / b);
+}
+
+/* returns the thread owning the cell at (@cx, @cy).  the cells are scattered
+ * across the threads, so that any large-enough area is split evenly, no
+ * matter where it is.
+ */
+static inline gint
+gegl_parallel_affinity_get_owner (gint cx,
+                                  gint cy,
+                                  gint n_threads)
+{
+  guint32 hash = (guint32) cx * 0x9e3779b1u ^ (guint32) cy * 0x85ebca77u;
+
+  hash ^= hash >> 15;
+  hash *= 0x2c1b3c6du;
+  hash ^= hash >> 12;
+
+  return hash % n_threads;
+}
+
+/* distributes @area by splitting it into tile-aligned cells, and assigning
+ * each cell to a fixed thread, which processes it unless it's stolen by an
+ * idle thread.  @tile_grid is any one of the tiles of the grid.  the owner
+ * of each cell depends only on the cell's position, and on the total number
+ * of threads, so consecutive operations processing the same tiles do so on
+ * the same threads.
+ *
+ * returns FALSE, without processing anything, if the area has too few cells
+ * to keep @n_threads threads busy.
+ */
+static gboolean
+gegl_parallel_distribute_area_affinity (const GeglRectangle            *area,
+                                        const GeglRectangle            *tile_grid,
+                                        gint                            n_threads,
+                                        GeglParallelDistributeAreaFunc  func,
+                                        gpointer                        user_data)
+{
+  GeglParallelDistributeAffinityData data;
+  GeglRectangle                     *cells;
+  gint                               slot_ends[GEGL_PARALLEL_DISTRIBUTE_MAX_THREADS];
+  gint                               positions[GEGL_PARALLEL_DISTRIBUTE_MAX_THREADS];
+  gint                               n_owners;
+  gint                               cell_width;
+  gint                               cell_height;
+  gint                               x0;
+  gint                               y0;
+  gint                               cx0, cx1;
+  gint                               cy0, cy1;
+  gint                               n_cells;
+  gint                               cx;
+  gint                               cy;
+  gint                               i;
+
+  cell_width  = tile_grid->width  * GEGL_PARALLEL_AFFINITY_CELL_WIDTH;
+  cell_height = tile_grid->height * GEGL_PARALLEL_AFFINITY_CELL_HEIGHT;
+
+  x0 = area->x - tile_grid->x;
+  y0 = area->y - tile_grid->y;
+
+  cx0 = gegl_parallel_floor_div (x0,                    cell_width);
+  cx1 = gegl_parallel_floor_div (x0 + area->width  - 1, cell_width);
+  cy0 = gegl_parallel_floor_div (y0,                    cell_height);
+  cy1 = gegl_parallel_floor_div (y0 + area->height - 1, cell_height);
+
+  n_cells = (cx1 - cx0 + 1) * (cy1 - cy0 + 1);
+
+  if (n_cells < n_threads)
+    return FALSE;
+
+  n_owners = g_atomic_int_get (&gegl_parallel_distribute_n_threads);
+
+  for (i = 0; i < n_owners; i++)
+    slot_ends[i] = 0;
+
+  for (cy = cy0; cy <= cy1; cy++)
+    {
+      for (cx = cx0; cx <= cx1; cx++)
+        slot_ends[gegl_parallel_affinity_get_owner (cx, cy, n_owners)]++;
+    }
+
+  for (i = 0; i < n_owners; i++)
+    {
+      positions[i] = i > 0 ? slot_ends[i - 1] : 0;
+      slot_ends[i] += positions[i];
+    }
+
+  /* sort the cells by owner, so that the cells of each thread form the
+   * thread's slot.
+   */
+  cells = gegl_scratch_new (GeglRectangle, n_cells);
+
+  for (cy = cy0; cy <= cy1; cy++)
+    {
+      for (cx = cx0; cx <= cx1; cx++)
+        {
+          GeglRectangle cell = {tile_grid->x + cx * cell_width,
+                                tile_grid->y + cy * cell_height,
+                                cell_width,
+                                cell_height};
+
+          gegl_rectangle_intersect (
+            &cells[positions[gegl_parallel_affinity_get_owner (cx, cy,
+                                                               n_owners)]++],
+            &cell, area);
+        }
+    }
+
+  data.cells     = cells;
+  data.func      = func;
+  data.user_data = user_data;
+
+  gegl_parallel_distribute_run (
+    n_owners, n_cells, slot_ends,
+    (GeglParallelDistributeFunc) gegl_parallel_distribute_affinity_func,
+    &data);
+
+  gegl_scratch_free (cells);
+
+  return TRUE;
+}
+
+static void
+gegl_parallel_distribute_area_on_grid (const GeglRectangle            *area,
+                                       const GeglRectangle            *tile_grid,
+                                       gdouble                         thread_cost,
+                                       GeglSplitStrategy               split_strategy,
+                                       GeglParallelDistributeAreaFunc  func,
+                                       gpointer                        user_data)
 {
   GeglParallelDistributeAreaData data;
   gint                           n_threads;
-
-  g_return_if_fail (area != NULL);
-  g_return_if_fail (func != NULL);
+  gint                           n_items;
 
   if (area->width <= 0 || area->height <= 0)
     return;
@@ -297,6 +476,23 @@ gegl_parallel_distribute_area (const GeglRectangle            *area,
       return;
     }
 
+  if (split_strategy == GEGL_SPLIT_STRATEGY_AUTO &&
+      gegl_config ()->thread_affinity)
+    {
+      split_strategy = GEGL_SPLIT_STRATEGY_AFFINITY;
+    }
+
+  if (split_strategy == GEGL_SPLIT_STRATEGY_AFFINITY)
+    {
+      if (gegl_parallel_distribute_area_affinity (area, tile_grid, n_threads,
+                                                  func, user_data))
+        {
+          return;
+        }
+
+      split_strategy = GEGL_SPLIT_STRATEGY_AUTO;
+    }
+
   if (split_strategy == GEGL_SPLIT_STRATEGY_AUTO)
     {
       if (area->width > area->height)
@@ -305,17 +501,74 @@ gegl_parallel_distribute_area (const GeglRectangle            *area,
         split_strategy = GEGL_SPLIT_STRATEGY_HORIZONTAL;
     }
 
+  n_items = gegl_parallel_distribute_get_n_items (
+    (gdouble) area->width * (gdouble) area->height,
+    thread_cost,
+    n_threads);
+
+  if (split_strategy == GEGL_SPLIT_STRATEGY_HORIZONTAL)
+    n_items = MIN (n_items, area->height);
+  else
+    n_items = MIN (n_items, area->width);
+
   data.area           = area;
   data.split_strategy = split_strategy;
   data.func           = func;
   data.user_data      = user_data;
 
-  gegl_parallel_distribute (
-    n_threads,
+  gegl_parallel_distribute_run (
+    n_threads, n_items, NULL,
     (GeglParallelDistributeFunc) gegl_parallel_distribute_area_func,
     &data);
 }
 
+void
+gegl_parallel_distribute_area (const GeglRectangle            *area,
+                               gdouble                         thread_cost,
+                               GeglSplitStrategy               split_strategy,
+                               GeglParallelDistributeAreaFunc  func,
+                               gpointer                        user_data)
+{
+  GeglRectangle tile_grid = {0, 0,
+                             gegl_config ()->tile_width,
+                             gegl_config ()->tile_height};
+
+  g_return_if_fail (area != NULL);
+  g_return_if_fail (func != NULL);
+
+  gegl_parallel_distribute_area_on_grid (area, &tile_grid,
+                                         thread_cost, split_strategy,
+                                         func, user_data);
+}
+
+void
+gegl_parallel_distribute_buffer_area (GeglBuffer                     *buffer,
+                                      gint                            level,
+                                      const GeglRectangle            *area,
+                                      gdouble                         thread_cost,
+                                      GeglSplitStrategy               split_strategy,
+                                      GeglParallelDistributeAreaFunc  func,
+                                      gpointer                        user_data)
+{
+  GeglRectangle tile_grid;
+
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+  g_return_if_fail (area != NULL);
+  g_return_if_fail (func != NULL);
+
+  /* the tiles of @buffer at @level are offset by the buffer's shift, and
+   * have the same size at all levels.
+   */
+  tile_grid.x      = -(buffer->shift_x / (1 << level));
+  tile_grid.y      = -(buffer->shift_y / (1 << level));
+  tile_grid.width  = buffer->tile_width;
+  tile_grid.height = buffer->tile_height;
+
+  gegl_parallel_distribute_area_on_grid (area, &tile_grid,
+                                         thread_cost, split_strategy,
+                                         func, user_data);
+}
+
 
 /*  private functions  */
 
@@ -333,6 +586,18 @@ gegl_parallel_notify_threads (GeglConfig *config)
                                /* finish_tasks = */ TRUE);
 }
 
+static void
+gegl_parallel_notify_thread_affinity (GeglConfig *config)
+{
+  gint n_threads = g_atomic_int_get (&gegl_parallel_distribute_n_threads);
+
+  /* restart the worker threads, so that they're pinned, or unpinned,
+   * according to the new setting.
+   */
+  gegl_parallel_set_n_threads (1,         /* finish_tasks = */ TRUE);
+  gegl_parallel_set_n_threads (n_threads, /* finish_tasks = */ TRUE);
+}
+
 static void
 gegl_parallel_set_n_threads (gint     n_threads,
                              gboolean finish_tasks)
@@ -340,14 +605,227 @@ gegl_parallel_set_n_threads (gint     n_threads,
   gegl_parallel_distribute_set_n_threads (n_threads);
 }
 
+/* distributes @n work items across up to @n_threads threads, including the
+ * calling thread.  the items are initially split evenly between the threads,
+ * and threads that run out of items steal items from the busiest threads.
+ *
+ * if @slot_ends is not NULL, the items are instead split into @n_threads
+ * slots, each ending at the corresponding element of @slot_ends, and owned
+ * by the thread of the same index: each thread starts with its own slot,
+ * if it's not taken yet.
+ *
+ * the function may be called from within a distributed function, in which
+ * case the nested task is served by the existing worker threads as they
+ * become available, without creating additional threads.
+ */
+static void
+gegl_parallel_distribute_run (gint                       n_threads,
+                              gint                       n,
+                              const gint                *slot_ends,
+                              GeglParallelDistributeFunc func,
+                              gpointer                   user_data)
+{
+  GeglParallelDistributeTask task;
+  gint                       slot_index;
+  gint                       i;
+
+  task.func        = func;
+  task.n           = n;
+  task.user_data   = user_data;
+  task.n_slots     = slot_ends ? n_threads : MIN (n_threads, n);
+  task.affinity    = slot_ends != NULL;
+  task.n_joined    = 0;
+  task.n_active    = 0;
+  task.n_unclaimed = n;
+  task.link.data   = &task;
+  task.link.prev   = NULL;
+  task.link.next   = NULL;
+
+  for (i = 0; i < task.n_slots; i++)
+    {
+      GeglParallelDistributeSlot *slot = &task.slots[i];
+
+      g_mutex_init (&slot->mutex);
+
+      if (slot_ends)
+        {
+          slot->begin = i > 0 ? slot_ends[i - 1] : 0;
+          slot->end   = slot_ends[i];
+        }
+      else
+        {
+          slot->begin = (2 * i       * n + task.n_slots) / (2 * task.n_slots);
+          slot->end   = (2 * (i + 1) * n + task.n_slots) / (2 * task.n_slots);
+        }
+
+      slot->joined = FALSE;
+    }
+
+  g_mutex_lock (&gegl_parallel_distribute_mutex);
+
+  slot_index = gegl_parallel_distribute_task_join (&task);
+
+  g_queue_push_head_link (&gegl_parallel_distribute_tasks, &task.link);
+
+  g_cond_broadcast (&gegl_parallel_distribute_cond);
+
+  g_mutex_unlock (&gegl_parallel_distribute_mutex);
+
+  gegl_parallel_distribute_task_run (&task, slot_index);
+
+  g_mutex_lock (&gegl_parallel_distribute_mutex);
+
+  /* all the items have been claimed at this point; stop other threads from
+   * joining, and wait for the threads that already joined to finish their
+   * items.
+   */
+  g_queue_unlink (&gegl_parallel_distribute_tasks, &task.link);
+
+  while (task.n_active > 0)
+    {
+      g_cond_wait (&gegl_parallel_distribute_completion_cond,
+                   &gegl_parallel_distribute_mutex);
+    }
+
+  g_mutex_unlock (&gegl_parallel_distribute_mutex);
+
+  for (i = 0; i < task.n_slots; i++)
+    g_mutex_clear (&task.slots[i].mutex);
+}
+
+/* joins @task, returning the index of the slot the current thread should
+ * start with: the thread's own slot, for affinity tasks, if it's not taken
+ * yet, or the first free slot otherwise.  should be called with
+ * gegl_parallel_distribute_mutex locked, while the task has free slots.
+ */
+static gint
+gegl_parallel_distribute_task_join (GeglParallelDistributeTask *task)
+{
+  gint i = 0;
+
+  if (task->affinity)
+    {
+      i = GPOINTER_TO_INT (
+        g_private_get (&gegl_parallel_distribute_thread_index));
+
+      if (i >= task->n_slots)
+        i = 0;
+    }
+
+  if (task->slots[i].joined)
+    {
+      for (i = 0; task->slots[i].joined; i++);
+    }
+
+  task->slots[i].joined = TRUE;
+  task->n_joined++;
+
+  return i;
+}
+
+/* processes the items of @task, starting with the items of the slot at
+ * @slot_index, until all the items of the task have been claimed.
+ */
+static void
+gegl_parallel_distribute_task_run (GeglParallelDistributeTask *task,
+                                   gint                        slot_index)
+{
+  GeglParallelDistributeSlot *slot = &task->slots[slot_index];
+
+  while (TRUE)
+    {
+      GeglParallelDistributeSlot *victim      = NULL;
+      gint                        max_n_items = 0;
+      gint                        begin;
+      gint                        end;
+      gint                        i;
+
+      g_mutex_lock (&slot->mutex);
+
+      if (slot->begin < slot->end)
+        {
+          i = slot->begin++;
+
+          g_mutex_unlock (&slot->mutex);
+
+          g_atomic_int_add (&task->n_unclaimed, -1);
+
+          task->func (i, task->n, task->user_data);
+
+          continue;
+        }
+
+      g_mutex_unlock (&slot->mutex);
+
+      if (g_atomic_int_get (&task->n_unclaimed) == 0)
+        break;
+
+      /* our slot is empty.  find the slot with the most unclaimed items, and
+       * steal the back half of its items.
+       */
+      for (i = 0; i < task->n_slots; i++)
+        {
+          gint n_items = g_atomic_int_get (&task->slots[i].end) -
+                         g_atomic_int_get (&task->slots[i].begin);
+
+          if (n_items > max_n_items)
+            {
+              victim      = &task->slots[i];
+              max_n_items = n_items;
+            }
+        }
+
+      if (! victim)
+        break;
+
+      g_mutex_lock (&victim->mutex);
+
+      end   = victim->end;
+      begin = end - (end - victim->begin + 1) / 2;
+
+      victim->end = begin;
+
+      g_mutex_unlock (&victim->mutex);
+
+      if (begin < end)
+        {
+          g_mutex_lock (&slot->mutex);
+
+          slot->begin = begin;
+          slot->end   = end;
+
+          g_mutex_unlock (&slot->mutex);
+        }
+    }
+}
+
+/* returns the most recent task which can be joined, or NULL if there is no
+ * such task.  should be called with gegl_parallel_distribute_mutex locked.
+ */
+static GeglParallelDistributeTask *
+gegl_parallel_distribute_find_task (void)
+{
+  GList *link;
+
+  for (link = gegl_parallel_distribute_tasks.head; link; link = link->next)
+    {
+      GeglParallelDistributeTask *task = link->data;
+
+      if (task->n_joined < task->n_slots &&
+          g_atomic_int_get (&task->n_unclaimed) > 0)
+        {
+          return task;
+        }
+    }
+
+  return NULL;
+}
+
 static void
 gegl_parallel_distribute_set_n_threads (gint n_threads)
 {
   gint i;
 
-  while (! g_atomic_int_compare_and_exchange (&gegl_parallel_distribute_busy,
-                                              0, 1));
-
   n_threads = CLAMP (n_threads, 1, GEGL_PARALLEL_DISTRIBUTE_MAX_THREADS);
 
   if (n_threads > gegl_parallel_distribute_n_threads) /* need more threads */
@@ -358,7 +836,6 @@ gegl_parallel_distribute_set_n_threads (gint n_threads)
             &gegl_parallel_distribute_threads[i];
 
           thread->quit = FALSE;
-          thread->task = NULL;
 
           thread->thread = g_thread_new (
             "worker",
@@ -368,19 +845,23 @@ gegl_parallel_distribute_set_n_threads (gint n_threads)
     }
   else if (n_threads < gegl_parallel_distribute_n_threads) /* need less threads */
     {
+      g_mutex_lock (&gegl_parallel_distribute_mutex);
+
       for (i = n_threads - 1; i < gegl_parallel_distribute_n_threads - 1; i++)
         {
           GeglParallelDistributeThread *thread =
             &gegl_parallel_distribute_threads[i];
 
-          g_mutex_lock (&thread->mutex);
-
           thread->quit = TRUE;
-          g_cond_signal (&thread->cond);
-
-          g_mutex_unlock (&thread->mutex);
         }
 
+      g_cond_broadcast (&gegl_parallel_distribute_cond);
+
+      g_mutex_unlock (&gegl_parallel_distribute_mutex);
+
+      /* threads finish the task they're working on, if any, before quitting,
+       * so tasks in progress are not affected.
+       */
       for (i = n_threads - 1; i < gegl_parallel_distribute_n_threads - 1; i++)
         {
           GeglParallelDistributeThread *thread =
@@ -390,48 +871,94 @@ gegl_parallel_distribute_set_n_threads (gint n_threads)
         }
     }
 
-  gegl_parallel_distribute_n_threads = n_threads;
-
-  g_atomic_int_set (&gegl_parallel_distribute_busy, 0);
+  g_atomic_int_set (&gegl_parallel_distribute_n_threads, n_threads);
 }
 
 static gpointer
 gegl_parallel_distribute_thread_func (GeglParallelDistributeThread *thread)
 {
-  g_mutex_lock (&thread->mutex);
+  gint index = thread - gegl_parallel_distribute_threads + 1;
 
-  while (TRUE)
+  g_private_set (&gegl_parallel_distribute_thread_index,
+                 GINT_TO_POINTER (index));
+
+  if (gegl_config ()->thread_affinity)
+    gegl_parallel_distribute_thread_pin (index);
+
+  g_mutex_lock (&gegl_parallel_distribute_mutex);
+
+  while (! thread->quit)
     {
-      if (thread->quit)
+      GeglParallelDistributeTask *task;
+      gint                        slot_index;
+
+      task = gegl_parallel_distribute_find_task ();
+
+      if (! task)
         {
-          break;
+          g_cond_wait (&gegl_parallel_distribute_cond,
+                       &gegl_parallel_distribute_mutex);
+
+          continue;
         }
-      else if (thread->task)
-        {
-          thread->task->func (thread->i, thread->task->n,
-                              thread->task->user_data);
 
-          if (g_atomic_int_dec_and_test (
-                &gegl_parallel_distribute_completion_counter))
-            {
-              g_mutex_lock (&gegl_parallel_distribute_completion_mutex);
+      slot_index = gegl_parallel_distribute_task_join (task);
+      task->n_active++;
 
-              g_cond_signal (&gegl_parallel_distribute_completion_cond);
+      g_mutex_unlock (&gegl_parallel_distribute_mutex);
 
-              g_mutex_unlock (&gegl_parallel_distribute_completion_mutex);
-            }
+      gegl_parallel_distribute_task_run (task, slot_index);
 
-          thread->task = NULL;
-        }
+      g_mutex_lock (&gegl_parallel_distribute_mutex);
 
-      g_cond_wait (&thread->cond, &thread->mutex);
+      if (--task->n_active == 0)
+        g_cond_broadcast (&gegl_parallel_distribute_completion_cond);
     }
 
-  g_mutex_unlock (&thread->mutex);
+  g_mutex_unlock (&gegl_parallel_distribute_mutex);
 
   return NULL;
 }
 
+/* pins the current thread, the worker thread of the given index, to a single
+ * cpu, out of the cpus the process may run on, so that the data it leaves in
+ * the cache is still there when it processes the same tiles again.
+ */
+static void
+gegl_parallel_distribute_thread_pin (gint index)
+{
+#ifdef HAVE_SCHED_SETAFFINITY
+  cpu_set_t allowed;
+  gint      n_allowed;
+  gint      cpu;
+
+  if (sched_getaffinity (0, sizeof (allowed), &allowed) != 0)
+    return;
+
+  n_allowed = CPU_COUNT (&allowed);
+
+  if (n_allowed <= 1)
+    return;
+
+  index %= n_allowed;
+
+  for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+      if (CPU_ISSET (cpu, &allowed) && index-- == 0)
+        {
+          cpu_set_t set;
+
+          CPU_ZERO (&set);
+          CPU_SET (cpu, &set);
+
+          sched_setaffinity (0, sizeof (set), &set);
+
+          break;
+        }
+    }
+#endif
+}
+
 /* calculates the optimal number of threads, n_threads, to process n_elements
  * elements, assuming the cost of processing the elements is proportional to
  * the number of elements to be processed by each thread, and assuming that
@@ -465,3 +992,23 @@ gegl_parallel_distribute_get_optimal_n_threads (gdouble n_elements,
 
   return n_threads;
 }
+
+/* calculates the number of work items to split n_elements elements into, when
+ * distributing them across n_threads threads.  each item should incur at
+ * least the fixed per-thread cost, thread_cost, worth of work, so that
+ * splitting the work into more items doesn't outweigh the benefit.
+ */
+static inline gint
+gegl_parallel_distribute_get_n_items (gdouble n_elements,
+                                      gdouble thread_cost,
+                                      gint    n_threads)
+{
+  gdouble n_items = n_threads * GEGL_PARALLEL_DISTRIBUTE_ITEMS_PER_THREAD;
+
+  if (thread_cost > 1.0)
+    n_items = MIN (n_items, n_elements / thread_cost);
+  else
+    n_items = MIN (n_items, n_elements);
+
+  return MAX (n_items, n_threads);
+}
@@ -25,8 +25,8 @@ G_BEGIN_DECLS
 
 /**
  * GeglParallelDistributeFunc:
- * @i: the current thread index, in the range [0,@n)
- * @n: the number of threads execution is distributed across
+ * @i: the current part index, in the range [0,@n)
+ * @n: the number of parts execution is distributed across
  * @user_data: user data pointer
  *
  * Specifies the type of function passed to gegl_parallel_distribute().
@@ -34,6 +34,9 @@ G_BEGIN_DECLS
  * The function should process the @i-th part of the data, out of @n
  * equal parts.  @n may be less-than or equal-to the @max_n argument
  * passed to gegl_parallel_distribute().
+ *
+ * Each part is processed exactly once, but different parts are not
+ * guaranteed to be processed by different threads, or concurrently.
  */
 typedef void (* GeglParallelDistributeFunc)      (gint                 i,
                                                   gint                 n,
@@ -77,7 +80,12 @@ typedef void (* GeglParallelDistributeAreaFunc)  (const GeglRectangle *area,
  * @user_data: user data to pass to the function
  *
  * Distributes the execution of a function across multiple threads,
- * by calling it with a different index on each thread.
+ * by calling it with a different index for each part.
+ *
+ * This function, as well as gegl_parallel_distribute_range() and
+ * gegl_parallel_distribute_area(), may be called from within a
+ * distributed function.  The nested work is then distributed across
+ * the threads that become idle, without creating additional threads.
  */
 void   gegl_parallel_distribute       (gint                             max_n,
                                        GeglParallelDistributeFunc       func,
@@ -94,6 +102,10 @@ void   gegl_parallel_distribute       (gint                             max_n,
  * Distributes the processing of a linear data-structure across
  * multiple threads, by calling the given function with different
  * sub-ranges on different threads.
+ *
+ * The data may be split into more sub-ranges than threads, so that
+ * threads that finish their sub-ranges early can take over the
+ * remaining sub-ranges of other threads.
  */
 void   gegl_parallel_distribute_range (gsize                            size,
                                        gdouble                          thread_cost,
@@ -112,6 +124,18 @@ void   gegl_parallel_distribute_range (gsize                            size,
  * Distributes the processing of a planar data-structure across
  * multiple threads, by calling the given function with different
  * sub-areas on different threads.
+ *
+ * The area may be split into more sub-areas than threads, so that
+ * threads that finish their sub-areas early can take over the
+ * remaining sub-areas of other threads.
+ *
+ * With %GEGL_SPLIT_STRATEGY_AFFINITY, the area is split into
+ * tile-aligned cells, and each cell is preferably processed by the
+ * same thread every time, regardless of the extent of @area, so that
+ * successive operations processing the same tiles find them in the
+ * caches of the same core.  %GEGL_SPLIT_STRATEGY_AUTO behaves like
+ * %GEGL_SPLIT_STRATEGY_AFFINITY when the "thread-affinity" property of
+ * #GeglConfig is set.
  */
 void   gegl_parallel_distribute_area  (const GeglRectangle             *area,
                                        gdouble                          thread_cost,
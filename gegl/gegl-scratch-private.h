@@ -0,0 +1,36 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GEGL_SCRATCH_PRIVATE_H__
+#define __GEGL_SCRATCH_PRIVATE_H__
+
+
+G_BEGIN_DECLS
+
+
+void      gegl_scratch_cleanup      (void);
+
+guint64   gegl_scratch_get_total    (void);
+guint64   gegl_scratch_get_allocs   (void);
+guint64   gegl_scratch_get_misses   (void);
+
+void      gegl_scratch_reset_stats  (void);
+
+
+G_END_DECLS
+
+
+#endif /* __GEGL_SCRATCH_PRIVATE_H__ */
@@ -0,0 +1,295 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib-object.h>
+
+#include "gegl-scratch.h"
+#include "gegl-scratch-private.h"
+
+
+#define GEGL_SCRATCH_ALIGNMENT          32
+#define GEGL_SCRATCH_MIN_SIZE_LOG2      6  /* 64 bytes  */
+#define GEGL_SCRATCH_MAX_SIZE_LOG2      24 /* 16 mb     */
+#define GEGL_SCRATCH_N_SIZE_CLASSES     (GEGL_SCRATCH_MAX_SIZE_LOG2 - \
+                                         GEGL_SCRATCH_MIN_SIZE_LOG2 + 1)
+#define GEGL_SCRATCH_MAX_CACHED_BLOCKS  8  /* per size class          */
+#define GEGL_SCRATCH_MAX_CACHED_TOTAL   (32 << 20) /* per thread      */
+#define GEGL_SCRATCH_N_STATS_SHARDS     16
+#define GEGL_SCRATCH_CACHE_LINE_SIZE    64
+
+
+/* each block is preceded by its header.  blocks larger than the largest size
+ * class are allocated and freed directly, and have a size class of -1.
+ */
+typedef struct
+{
+  gpointer mem;
+  gsize    size;
+  gint     size_class;
+} GeglScratchBlock;
+
+G_STATIC_ASSERT (sizeof (GeglScratchBlock) <= GEGL_SCRATCH_ALIGNMENT);
+
+typedef struct
+{
+  gint              n_blocks[GEGL_SCRATCH_N_SIZE_CLASSES];
+  GeglScratchBlock *blocks[GEGL_SCRATCH_N_SIZE_CLASSES]
+                          [GEGL_SCRATCH_MAX_CACHED_BLOCKS];
+  gsize             cached_total;
+  gint              shard;
+} GeglScratchContext;
+
+/* the allocation counters are updated by all threads, on every allocation.
+ * like the tile-cache counters, they're striped across cache-line-sized
+ * shards, so that threads don't contend over a single cache line.
+ */
+typedef struct
+{
+  guint64 allocs;
+  guint64 misses;
+
+  gchar   padding[GEGL_SCRATCH_CACHE_LINE_SIZE - 2 * sizeof (guint64)];
+} GeglScratchStats;
+
+
+static void   gegl_scratch_context_free (GeglScratchContext *context);
+
+
+static GPrivate          scratch_context = G_PRIVATE_INIT (
+  (GDestroyNotify) gegl_scratch_context_free);
+static volatile guintptr scratch_total   = 0;
+static GeglScratchStats  scratch_stats[GEGL_SCRATCH_N_STATS_SHARDS];
+static gint              scratch_n_threads = 0;
+
+
+/*  private functions  */
+
+static inline gint
+gegl_scratch_get_size_class (gsize size)
+{
+  if (size <= (1 << GEGL_SCRATCH_MIN_SIZE_LOG2))
+    return 0;
+  else if (size > (1 << GEGL_SCRATCH_MAX_SIZE_LOG2))
+    return -1;
+  else
+    return g_bit_storage (size - 1) - GEGL_SCRATCH_MIN_SIZE_LOG2;
+}
+
+static inline GeglScratchBlock *
+gegl_scratch_block_new (gsize size,
+                        gint  size_class)
+{
+  GeglScratchBlock *block;
+  gpointer          mem;
+  guintptr          data;
+
+  if (size_class >= 0)
+    size = (gsize) 1 << (size_class + GEGL_SCRATCH_MIN_SIZE_LOG2);
+
+  mem  = g_malloc (sizeof (GeglScratchBlock) + GEGL_SCRATCH_ALIGNMENT + size);
+  data = ((guintptr) mem + sizeof (GeglScratchBlock) +
+          GEGL_SCRATCH_ALIGNMENT - 1) & ~(guintptr) (GEGL_SCRATCH_ALIGNMENT - 1);
+
+  block             = (GeglScratchBlock *) data - 1;
+  block->mem        = mem;
+  block->size       = size;
+  block->size_class = size_class;
+
+  g_atomic_pointer_add (&scratch_total, (gssize) size);
+
+  return block;
+}
+
+static inline void
+gegl_scratch_block_free (GeglScratchBlock *block)
+{
+  g_atomic_pointer_add (&scratch_total, -(gssize) block->size);
+
+  g_free (block->mem);
+}
+
+static inline gpointer
+gegl_scratch_block_get_data (GeglScratchBlock *block)
+{
+  return block + 1;
+}
+
+static void
+gegl_scratch_context_free (GeglScratchContext *context)
+{
+  gint size_class;
+
+  for (size_class = 0; size_class < GEGL_SCRATCH_N_SIZE_CLASSES; size_class++)
+    {
+      while (context->n_blocks[size_class])
+        {
+          gegl_scratch_block_free (
+            context->blocks[size_class][--context->n_blocks[size_class]]);
+        }
+    }
+
+  g_slice_free (GeglScratchContext, context);
+}
+
+static inline GeglScratchContext *
+gegl_scratch_get_context (void)
+{
+  GeglScratchContext *context = g_private_get (&scratch_context);
+
+  if (G_UNLIKELY (! context))
+    {
+      context = g_slice_new0 (GeglScratchContext);
+
+      context->shard = g_atomic_int_add (&scratch_n_threads, 1) %
+                       GEGL_SCRATCH_N_STATS_SHARDS;
+
+      g_private_set (&scratch_context, context);
+    }
+
+  return context;
+}
+
+
+/*  public functions  */
+
+gpointer
+gegl_scratch_alloc (gsize size)
+{
+  GeglScratchContext *context    = gegl_scratch_get_context ();
+  GeglScratchStats   *stats      = &scratch_stats[context->shard];
+  gint                size_class = gegl_scratch_get_size_class (size);
+  GeglScratchBlock   *block;
+
+  /* we don't bother making the counters atomic, since they're only needed
+   * for GeglStats.
+   */
+  stats->allocs++;
+
+  if (size_class >= 0 && context->n_blocks[size_class])
+    {
+      block = context->blocks[size_class][--context->n_blocks[size_class]];
+
+      context->cached_total -= block->size;
+    }
+  else
+    {
+      stats->misses++;
+
+      block = gegl_scratch_block_new (size, size_class);
+    }
+
+  return gegl_scratch_block_get_data (block);
+}
+
+gpointer
+gegl_scratch_alloc0 (gsize size)
+{
+  gpointer ptr = gegl_scratch_alloc (size);
+
+  memset (ptr, 0, size);
+
+  return ptr;
+}
+
+void
+gegl_scratch_free (gpointer ptr)
+{
+  GeglScratchContext *context;
+  GeglScratchBlock   *block;
+  gint                size_class;
+
+  if (! ptr)
+    return;
+
+  block      = (GeglScratchBlock *) ptr - 1;
+  size_class = block->size_class;
+
+  if (size_class < 0)
+    {
+      gegl_scratch_block_free (block);
+
+      return;
+    }
+
+  /* the block goes to the freeing thread's context, which is usually also
+   * the allocating thread's context.
+   */
+  context = gegl_scratch_get_context ();
+
+  if (context->n_blocks[size_class] < GEGL_SCRATCH_MAX_CACHED_BLOCKS &&
+      context->cached_total + block->size <= GEGL_SCRATCH_MAX_CACHED_TOTAL)
+    {
+      context->blocks[size_class][context->n_blocks[size_class]++] = block;
+
+      context->cached_total += block->size;
+    }
+  else
+    {
+      gegl_scratch_block_free (block);
+    }
+}
+
+
+/*  private functions, used by the rest of GEGL  */
+
+void
+gegl_scratch_cleanup (void)
+{
+  /* free the blocks cached by the calling thread.  the blocks cached by
+   * other threads are freed when the threads exit.
+   */
+  g_private_replace (&scratch_context, NULL);
+}
+
+guint64
+gegl_scratch_get_total (void)
+{
+  return (guintptr) g_atomic_pointer_get (&scratch_total);
+}
+
+guint64
+gegl_scratch_get_allocs (void)
+{
+  guint64 allocs = 0;
+  gint    i;
+
+  for (i = 0; i < GEGL_SCRATCH_N_STATS_SHARDS; i++)
+    allocs += scratch_stats[i].allocs;
+
+  return allocs;
+}
+
+guint64
+gegl_scratch_get_misses (void)
+{
+  guint64 misses = 0;
+  gint    i;
+
+  for (i = 0; i < GEGL_SCRATCH_N_STATS_SHARDS; i++)
+    misses += scratch_stats[i].misses;
+
+  return misses;
+}
+
+void
+gegl_scratch_reset_stats (void)
+{
+  memset (scratch_stats, 0, sizeof (scratch_stats));
+}
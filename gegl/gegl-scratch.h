@@ -0,0 +1,80 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GEGL_SCRATCH_H__
+#define __GEGL_SCRATCH_H__
+
+
+G_BEGIN_DECLS
+
+
+/***
+ * Scratch memory:
+ *
+ * GEGL provides a per-thread arena for short-lived temporary buffers, such
+ * as the row buffers and histograms used by operations while processing a
+ * chunk.  Freed buffers are kept by the thread, in size classes, and are
+ * handed out again, last-freed first, by subsequent allocations of a similar
+ * size, avoiding the general-purpose allocator, and touching memory that is
+ * likely to still be in the cache.
+ *
+ * Scratch buffers are aligned like the buffers returned by gegl_malloc(),
+ * and are meant to be freed shortly after being allocated, in the reverse
+ * order of allocation.  They may be freed by a different thread than the
+ * one that allocated them.
+ */
+
+/**
+ * gegl_scratch_alloc: (skip)
+ * @size: the number of bytes to allocate
+ *
+ * Allocates @size bytes of scratch memory.
+ *
+ * Returns: a pointer to the allocated memory, to be freed using
+ * gegl_scratch_free().
+ */
+gpointer   gegl_scratch_alloc  (gsize    size) G_GNUC_MALLOC;
+
+/**
+ * gegl_scratch_alloc0: (skip)
+ * @size: the number of bytes to allocate
+ *
+ * Allocates @size bytes of scratch memory, initialized to zero.
+ *
+ * Returns: a pointer to the allocated memory, to be freed using
+ * gegl_scratch_free().
+ */
+gpointer   gegl_scratch_alloc0 (gsize    size) G_GNUC_MALLOC;
+
+/**
+ * gegl_scratch_free: (skip)
+ * @ptr: the memory to free, or %NULL
+ *
+ * Frees scratch memory allocated using gegl_scratch_alloc(), or
+ * gegl_scratch_alloc0().
+ */
+void       gegl_scratch_free   (gpointer ptr);
+
+#define gegl_scratch_new(type, n)  \
+  ((type *) gegl_scratch_alloc  (sizeof (type) * (n)))
+#define gegl_scratch_new0(type, n) \
+  ((type *) gegl_scratch_alloc0 (sizeof (type) * (n)))
+
+
+G_END_DECLS
+
+
+#endif /* __GEGL_SCRATCH_H__ */
@@ -23,9 +23,12 @@
 #include "gegl.h"
 #include "gegl-types-internal.h"
 #include "buffer/gegl-buffer-types.h"
+#include "buffer/gegl-tile-alloc.h"
 #include "buffer/gegl-tile-handler-cache.h"
 #include "buffer/gegl-tile-handler-zoom.h"
 #include "buffer/gegl-tile-backend-swap.h"
+#include "process/gegl-processor-private.h"
+#include "gegl-scratch-private.h"
 #include "gegl-stats.h"
 
 
@@ -37,8 +40,24 @@ enum
   PROP_TILE_CACHE_TOTAL_UNCLONED,
   PROP_TILE_CACHE_HITS,
   PROP_TILE_CACHE_MISSES,
+  PROP_TILE_CACHE_TOTAL_PROBATION,
+  PROP_TILE_CACHE_LRU_HITS,
+  PROP_TILE_CACHE_LRU_MISSES,
+  PROP_TILE_CACHE_2Q_HITS,
+  PROP_TILE_CACHE_2Q_MISSES,
+  PROP_TILE_ALLOC_TOTAL,
+  PROP_TILE_ALLOC_FREE_SLABS,
+  PROP_TILE_ALLOC_FRAGMENTATION,
   PROP_SWAP_TOTAL,
   PROP_SWAP_TOTAL_UNCLONED,
+  PROP_SWAP_TOTAL_UNCOMPRESSED,
+  PROP_SWAP_COMPRESSION_RATIO,
+  PROP_SWAP_COMPRESSION_TIME,
+  PROP_SWAP_DECOMPRESSION_TIME,
+  PROP_SWAP_POOL_TOTAL,
+  PROP_SWAP_POOL_TOTAL_UNCOMPRESSED,
+  PROP_SWAP_POOL_HITS,
+  PROP_SWAP_POOL_MISSES,
   PROP_SWAP_FILE_SIZE,
   PROP_SWAP_BUSY,
   PROP_SWAP_QUEUED_TOTAL,
@@ -48,7 +67,16 @@ enum
   PROP_SWAP_READ_TOTAL,
   PROP_SWAP_WRITING,
   PROP_SWAP_WRITE_TOTAL,
-  PROP_ZOOM_TOTAL
+  PROP_SWAP_QUEUE_DEPTH,
+  PROP_SWAP_READ_LATENCY,
+  PROP_SWAP_WRITE_LATENCY,
+  PROP_SWAP_PREFETCH_HITS,
+  PROP_ZOOM_TOTAL,
+  PROP_PROCESSOR_PIXELS_REUSED,
+  PROP_PROCESSOR_PIXELS_RENDERED,
+  PROP_SCRATCH_TOTAL,
+  PROP_SCRATCH_ALLOCS,
+  PROP_SCRATCH_MISSES
 };
 
 
@@ -108,6 +136,62 @@ gegl_stats_class_init (GeglStatsClass *klass)
                                                      0, G_MAXINT, 0,
                                                      G_PARAM_READABLE));
 
+  g_object_class_install_property (object_class, PROP_TILE_CACHE_TOTAL_PROBATION,
+                                   g_param_spec_uint64 ("tile-cache-total-probation",
+                                                        "Tile Cache total probationary size",
+                                                        "Total size of the tiles in the tile cache's probationary queues in bytes",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_TILE_CACHE_LRU_HITS,
+                                   g_param_spec_int ("tile-cache-lru-hits",
+                                                     "Tile Cache LRU hits",
+                                                     "Number of tile cache hits using the LRU policy",
+                                                     0, G_MAXINT, 0,
+                                                     G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_TILE_CACHE_LRU_MISSES,
+                                   g_param_spec_int ("tile-cache-lru-misses",
+                                                     "Tile Cache LRU misses",
+                                                     "Number of tile cache misses using the LRU policy",
+                                                     0, G_MAXINT, 0,
+                                                     G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_TILE_CACHE_2Q_HITS,
+                                   g_param_spec_int ("tile-cache-2q-hits",
+                                                     "Tile Cache 2Q hits",
+                                                     "Number of tile cache hits using the 2Q policy",
+                                                     0, G_MAXINT, 0,
+                                                     G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_TILE_CACHE_2Q_MISSES,
+                                   g_param_spec_int ("tile-cache-2q-misses",
+                                                     "Tile Cache 2Q misses",
+                                                     "Number of tile cache misses using the 2Q policy",
+                                                     0, G_MAXINT, 0,
+                                                     G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_TILE_ALLOC_TOTAL,
+                                   g_param_spec_uint64 ("tile-alloc-total",
+                                                        "Tile allocation total",
+                                                        "Total size of the memory allocated for tile data, including unused slab space",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_TILE_ALLOC_FREE_SLABS,
+                                   g_param_spec_int ("tile-alloc-free-slabs",
+                                                     "Tile allocation free slabs",
+                                                     "Number of completely unused tile-data slabs kept for reuse",
+                                                     0, G_MAXINT, 0,
+                                                     G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_TILE_ALLOC_FRAGMENTATION,
+                                   g_param_spec_double ("tile-alloc-fragmentation",
+                                                        "Tile allocation fragmentation",
+                                                        "Fraction of the tile-data slab memory not holding live tiles",
+                                                        0.0, 1.0, 0.0,
+                                                        G_PARAM_READABLE));
+
   g_object_class_install_property (object_class, PROP_SWAP_TOTAL,
                                    g_param_spec_uint64 ("swap-total",
                                                         "Swap total size",
@@ -122,6 +206,62 @@ gegl_stats_class_init (GeglStatsClass *klass)
                                                         0, G_MAXUINT64, 0,
                                                         G_PARAM_READABLE));
 
+  g_object_class_install_property (object_class, PROP_SWAP_TOTAL_UNCOMPRESSED,
+                                   g_param_spec_uint64 ("swap-total-uncompressed",
+                                                        "Swap total uncompressed",
+                                                        "Total size of the data in the swap if all the entries were uncompressed",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SWAP_COMPRESSION_RATIO,
+                                   g_param_spec_double ("swap-compression-ratio",
+                                                        "Swap compression ratio",
+                                                        "Ratio between the uncompressed and the compressed size of the data in the swap",
+                                                        0.0, G_MAXDOUBLE, 1.0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SWAP_COMPRESSION_TIME,
+                                   g_param_spec_double ("swap-compression-time",
+                                                        "Swap compression time",
+                                                        "Total time spent compressing data written to the swap, in seconds",
+                                                        0.0, G_MAXDOUBLE, 0.0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SWAP_DECOMPRESSION_TIME,
+                                   g_param_spec_double ("swap-decompression-time",
+                                                        "Swap decompression time",
+                                                        "Total time spent decompressing data read from the swap, in seconds",
+                                                        0.0, G_MAXDOUBLE, 0.0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SWAP_POOL_TOTAL,
+                                   g_param_spec_uint64 ("swap-pool-total",
+                                                        "Swap pool total",
+                                                        "Total size of the compressed data in the swap pool",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SWAP_POOL_TOTAL_UNCOMPRESSED,
+                                   g_param_spec_uint64 ("swap-pool-total-uncompressed",
+                                                        "Swap pool total uncompressed",
+                                                        "Total size of the data in the swap pool if it were uncompressed",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SWAP_POOL_HITS,
+                                   g_param_spec_int ("swap-pool-hits",
+                                                     "Swap pool hits",
+                                                     "Number of swap reads served by the swap pool",
+                                                     0, G_MAXINT, 0,
+                                                     G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SWAP_POOL_MISSES,
+                                   g_param_spec_int ("swap-pool-misses",
+                                                     "Swap pool misses",
+                                                     "Number of swap reads served by the swap file",
+                                                     0, G_MAXINT, 0,
+                                                     G_PARAM_READABLE));
+
   g_object_class_install_property (object_class, PROP_SWAP_FILE_SIZE,
                                    g_param_spec_uint64 ("swap-file-size",
                                                         "Swap file size",
@@ -190,12 +330,75 @@ gegl_stats_class_init (GeglStatsClass *klass)
                                                         0, G_MAXUINT64, 0,
                                                         G_PARAM_READABLE));
 
+  g_object_class_install_property (object_class, PROP_SWAP_QUEUE_DEPTH,
+                                   g_param_spec_int ("swap-queue-depth",
+                                                     "Swap queue depth",
+                                                     "Number of swap reads and writes queued or in progress",
+                                                     0, G_MAXINT, 0,
+                                                     G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SWAP_READ_LATENCY,
+                                   g_param_spec_double ("swap-read-latency",
+                                                        "Swap read latency",
+                                                        "Average time between requesting and completing a read from the swap file, in seconds",
+                                                        0.0, G_MAXDOUBLE, 0.0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SWAP_WRITE_LATENCY,
+                                   g_param_spec_double ("swap-write-latency",
+                                                        "Swap write latency",
+                                                        "Average time between queueing and completing a write to the swap file, in seconds",
+                                                        0.0, G_MAXDOUBLE, 0.0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SWAP_PREFETCH_HITS,
+                                   g_param_spec_int ("swap-prefetch-hits",
+                                                     "Swap prefetch hits",
+                                                     "Number of swap reads served by data read ahead of time",
+                                                     0, G_MAXINT, 0,
+                                                     G_PARAM_READABLE));
+
   g_object_class_install_property (object_class, PROP_ZOOM_TOTAL,
                                    g_param_spec_uint64 ("zoom-total",
                                                         "Zoom total",
                                                         "Total size of data processed by the zoom tile handler",
                                                         0, G_MAXUINT64, 0,
                                                         G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_PROCESSOR_PIXELS_REUSED,
+                                   g_param_spec_uint64 ("processor-pixels-reused",
+                                                        "Processor pixels reused",
+                                                        "Number of pixels requested from processors, found valid in the cache",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_PROCESSOR_PIXELS_RENDERED,
+                                   g_param_spec_uint64 ("processor-pixels-rendered",
+                                                        "Processor pixels rendered",
+                                                        "Number of pixels rendered into the cache by processors",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SCRATCH_TOTAL,
+                                   g_param_spec_uint64 ("scratch-total",
+                                                        "Scratch total",
+                                                        "Total size of scratch memory, in use or cached by the threads, in bytes",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SCRATCH_ALLOCS,
+                                   g_param_spec_uint64 ("scratch-allocs",
+                                                        "Scratch allocations",
+                                                        "Number of scratch memory allocations",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE));
+
+  g_object_class_install_property (object_class, PROP_SCRATCH_MISSES,
+                                   g_param_spec_uint64 ("scratch-misses",
+                                                        "Scratch misses",
+                                                        "Number of scratch memory allocations not served by the threads' caches",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE));
 }
 
 static void
@@ -245,6 +448,42 @@ gegl_stats_get_property (GObject    *object,
         g_value_set_int (value, gegl_tile_handler_cache_get_misses ());
         break;
 
+      case PROP_TILE_CACHE_TOTAL_PROBATION:
+        g_value_set_uint64 (value, gegl_tile_handler_cache_get_total_probation ());
+        break;
+
+      case PROP_TILE_CACHE_LRU_HITS:
+        g_value_set_int (value, gegl_tile_handler_cache_get_policy_hits (
+                                  GEGL_TILE_CACHE_POLICY_LRU));
+        break;
+
+      case PROP_TILE_CACHE_LRU_MISSES:
+        g_value_set_int (value, gegl_tile_handler_cache_get_policy_misses (
+                                  GEGL_TILE_CACHE_POLICY_LRU));
+        break;
+
+      case PROP_TILE_CACHE_2Q_HITS:
+        g_value_set_int (value, gegl_tile_handler_cache_get_policy_hits (
+                                  GEGL_TILE_CACHE_POLICY_2Q));
+        break;
+
+      case PROP_TILE_CACHE_2Q_MISSES:
+        g_value_set_int (value, gegl_tile_handler_cache_get_policy_misses (
+                                  GEGL_TILE_CACHE_POLICY_2Q));
+        break;
+
+      case PROP_TILE_ALLOC_TOTAL:
+        g_value_set_uint64 (value, gegl_tile_alloc_get_total ());
+        break;
+
+      case PROP_TILE_ALLOC_FREE_SLABS:
+        g_value_set_int (value, gegl_tile_alloc_get_free_slabs ());
+        break;
+
+      case PROP_TILE_ALLOC_FRAGMENTATION:
+        g_value_set_double (value, gegl_tile_alloc_get_fragmentation ());
+        break;
+
       case PROP_SWAP_TOTAL:
         g_value_set_uint64 (value, gegl_tile_backend_swap_get_total ());
         break;
@@ -253,6 +492,38 @@ gegl_stats_get_property (GObject    *object,
         g_value_set_uint64 (value, gegl_tile_backend_swap_get_total_uncloned ());
         break;
 
+      case PROP_SWAP_TOTAL_UNCOMPRESSED:
+        g_value_set_uint64 (value, gegl_tile_backend_swap_get_total_uncompressed ());
+        break;
+
+      case PROP_SWAP_COMPRESSION_RATIO:
+        g_value_set_double (value, gegl_tile_backend_swap_get_compression_ratio ());
+        break;
+
+      case PROP_SWAP_COMPRESSION_TIME:
+        g_value_set_double (value, gegl_tile_backend_swap_get_compression_time ());
+        break;
+
+      case PROP_SWAP_DECOMPRESSION_TIME:
+        g_value_set_double (value, gegl_tile_backend_swap_get_decompression_time ());
+        break;
+
+      case PROP_SWAP_POOL_TOTAL:
+        g_value_set_uint64 (value, gegl_tile_backend_swap_get_pool_total ());
+        break;
+
+      case PROP_SWAP_POOL_TOTAL_UNCOMPRESSED:
+        g_value_set_uint64 (value, gegl_tile_backend_swap_get_pool_total_uncompressed ());
+        break;
+
+      case PROP_SWAP_POOL_HITS:
+        g_value_set_int (value, gegl_tile_backend_swap_get_pool_hits ());
+        break;
+
+      case PROP_SWAP_POOL_MISSES:
+        g_value_set_int (value, gegl_tile_backend_swap_get_pool_misses ());
+        break;
+
       case PROP_SWAP_FILE_SIZE:
         g_value_set_uint64 (value, gegl_tile_backend_swap_get_file_size ());
         break;
@@ -289,10 +560,46 @@ gegl_stats_get_property (GObject    *object,
         g_value_set_uint64 (value, gegl_tile_backend_swap_get_write_total ());
         break;
 
+      case PROP_SWAP_QUEUE_DEPTH:
+        g_value_set_int (value, gegl_tile_backend_swap_get_queue_depth ());
+        break;
+
+      case PROP_SWAP_READ_LATENCY:
+        g_value_set_double (value, gegl_tile_backend_swap_get_read_latency ());
+        break;
+
+      case PROP_SWAP_WRITE_LATENCY:
+        g_value_set_double (value, gegl_tile_backend_swap_get_write_latency ());
+        break;
+
+      case PROP_SWAP_PREFETCH_HITS:
+        g_value_set_int (value, gegl_tile_backend_swap_get_prefetch_hits ());
+        break;
+
       case PROP_ZOOM_TOTAL:
         g_value_set_uint64 (value, gegl_tile_handler_zoom_get_total ());
         break;
 
+      case PROP_PROCESSOR_PIXELS_REUSED:
+        g_value_set_uint64 (value, gegl_processor_get_pixels_reused ());
+        break;
+
+      case PROP_PROCESSOR_PIXELS_RENDERED:
+        g_value_set_uint64 (value, gegl_processor_get_pixels_rendered ());
+        break;
+
+      case PROP_SCRATCH_TOTAL:
+        g_value_set_uint64 (value, gegl_scratch_get_total ());
+        break;
+
+      case PROP_SCRATCH_ALLOCS:
+        g_value_set_uint64 (value, gegl_scratch_get_allocs ());
+        break;
+
+      case PROP_SCRATCH_MISSES:
+        g_value_set_uint64 (value, gegl_scratch_get_misses ());
+        break;
+
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
         break;
@@ -305,4 +612,6 @@ gegl_stats_reset (GeglStats *stats)
   gegl_tile_handler_cache_reset_stats ();
   gegl_tile_backend_swap_reset_stats ();
   gegl_tile_handler_zoom_reset_stats ();
+  gegl_processor_reset_stats ();
+  gegl_scratch_reset_stats ();
 }
@@ -45,7 +45,8 @@ typedef enum
 {
   GEGL_SPLIT_STRATEGY_AUTO,
   GEGL_SPLIT_STRATEGY_HORIZONTAL,
-  GEGL_SPLIT_STRATEGY_VERTICAL
+  GEGL_SPLIT_STRATEGY_VERTICAL,
+  GEGL_SPLIT_STRATEGY_AFFINITY
 } GeglSplitStrategy;
 
 
@@ -38,6 +38,7 @@
 #include <gegl-version.h>
 #include <gegl-random.h>
 #include <gegl-parallel.h>
+#include <gegl-scratch.h>
 #include <gegl-node.h>
 #include <gegl-processor.h>
 #include <gegl-apply.h>
@@ -25,6 +25,7 @@
 #include "gegl-operation-composer.h"
 #include "gegl-operation-context.h"
 #include "gegl-config.h"
+#include "gegl-parallel-private.h"
 
 static gboolean gegl_operation_composer_process (GeglOperation       *operation,
                               GeglOperationContext     *context,
@@ -169,6 +170,8 @@ gegl_operation_composer_process (GeglOperation        *operation,
       if (gegl_operation_use_threading (operation, result))
       {
         ThreadData data;
+        gboolean   freeze_input;
+        gboolean   freeze_aux;
 
         data.klass = klass;
         data.operation = operation;
@@ -180,13 +183,35 @@ gegl_operation_composer_process (GeglOperation        *operation,
         data.level = level;
         data.success = TRUE;
 
-        gegl_parallel_distribute_area (
+        /* the inputs are read by all threads, and not written to, unless
+         * processing in-place; freeze them, so that their tiles are looked
+         * up without locking.  only inputs private to the graph are frozen;
+         * forked buffers, such as caches and buffers passed in by the
+         * application, may be modified while we're processing.
+         */
+        freeze_input = input && input != output &&
+                       ! gegl_object_get_has_forked (G_OBJECT (input));
+        freeze_aux   = aux && aux != output &&
+                       ! gegl_object_get_has_forked (G_OBJECT (aux));
+
+        if (freeze_input)
+          gegl_buffer_freeze (input);
+        if (freeze_aux)
+          gegl_buffer_freeze (aux);
+
+        gegl_parallel_distribute_buffer_area (
+          output, level,
           result,
           gegl_operation_get_pixels_per_thread (operation),
           GEGL_SPLIT_STRATEGY_AUTO,
           (GeglParallelDistributeAreaFunc) thread_process,
           &data);
 
+        if (freeze_input)
+          gegl_buffer_thaw (input);
+        if (freeze_aux)
+          gegl_buffer_thaw (aux);
+
         success = data.success;
       }
       else
@@ -435,6 +435,16 @@ gegl_operation_context_dup_input_maybe_copy (GeglOperationContext *context,
   if (input == output)
     return g_object_ref (input);
 
+  /* the tiles of a frozen input are looked up without locking, so there's no
+   * contention to avoid by copying it.  forked inputs are still copied, since
+   * they may be modified by others.
+   */
+  if (g_atomic_pointer_get (&input->tile_table) &&
+      ! gegl_object_get_has_forked (G_OBJECT (input)))
+    {
+      return g_object_ref (input);
+    }
+
 #if 1
   {
     GeglTileBackend *backend;
@@ -25,6 +25,7 @@
 #include "gegl-operation-filter.h"
 #include "gegl-operation-context.h"
 #include "gegl-config.h"
+#include "gegl-parallel-private.h"
 
 static gboolean gegl_operation_filter_process
                                       (GeglOperation        *operation,
@@ -198,7 +199,8 @@ gegl_operation_filter_process (GeglOperation        *operation,
     data.level = level;
     data.success = TRUE;
 
-    gegl_parallel_distribute_area (
+    gegl_parallel_distribute_buffer_area (
+      output, level,
       result,
       gegl_operation_get_pixels_per_thread (operation),
       split_strategy,
@@ -27,6 +27,7 @@
 #include "gegl-operation-point-composer.h"
 #include "gegl-operation-context.h"
 #include "gegl-config.h"
+#include "gegl-parallel-private.h"
 #include "gegl-types-internal.h"
 #include "gegl-buffer-private.h"
 #include "gegl-tile-storage.h"
@@ -76,6 +77,15 @@ thread_process (const GeglRectangle *area,
                                     data->aux_format,
                                     GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
 
+  if (GEGL_OPERATION_GET_CLASS (data->operation)->planar)
+    {
+      gegl_buffer_iterator_set_planar (i, 0, TRUE);
+      if (data->input)
+        gegl_buffer_iterator_set_planar (i, read, TRUE);
+      if (data->aux)
+        gegl_buffer_iterator_set_planar (i, aux, TRUE);
+    }
+
   while (gegl_buffer_iterator_next (i))
   {
      data->success =
@@ -328,7 +338,8 @@ gegl_operation_point_composer_process (GeglOperation       *operation,
             gegl_buffer_flush_ext (aux, result);
         }
 
-        gegl_parallel_distribute_area (
+        gegl_parallel_distribute_buffer_area (
+          output, level,
           result,
           gegl_operation_get_pixels_per_thread (operation),
           GEGL_SPLIT_STRATEGY_AUTO,
@@ -347,6 +358,15 @@ gegl_operation_point_composer_process (GeglOperation       *operation,
         if (aux)
           foo = gegl_buffer_iterator_add (i, aux, result, level, aux_format, GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
 
+        if (operation_class->planar)
+          {
+            gegl_buffer_iterator_set_planar (i, 0, TRUE);
+            if (input)
+              gegl_buffer_iterator_set_planar (i, read, TRUE);
+            if (aux)
+              gegl_buffer_iterator_set_planar (i, foo, TRUE);
+          }
+
         while (gegl_buffer_iterator_next (i))
           {
             point_composer_class->process (operation, input?i->items[read].data:NULL,
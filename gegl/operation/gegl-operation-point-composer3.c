@@ -26,6 +26,7 @@
 #include "gegl-operation-context.h"
 #include "gegl-types-internal.h"
 #include "gegl-config.h"
+#include "gegl-parallel-private.h"
 #include "gegl-buffer-private.h"
 #include "gegl-tile-storage.h"
 #include <sys/types.h>
@@ -77,6 +78,17 @@ thread_process (const GeglRectangle *area,
                                     data->aux2_format,
                                     GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
 
+  if (GEGL_OPERATION_GET_CLASS (data->operation)->planar)
+    {
+      gegl_buffer_iterator_set_planar (i, 0, TRUE);
+      if (data->input)
+        gegl_buffer_iterator_set_planar (i, read, TRUE);
+      if (data->aux)
+        gegl_buffer_iterator_set_planar (i, aux, TRUE);
+      if (data->aux2)
+        gegl_buffer_iterator_set_planar (i, aux2, TRUE);
+    }
+
   while (gegl_buffer_iterator_next (i))
   {
      data->success =
@@ -246,7 +258,8 @@ gegl_operation_point_composer3_process (GeglOperation       *operation,
             gegl_buffer_flush_ext (aux2, result);
         }
 
-        gegl_parallel_distribute_area (
+        gegl_parallel_distribute_buffer_area (
+          output, level,
           result,
           gegl_operation_get_pixels_per_thread (operation),
           GEGL_SPLIT_STRATEGY_AUTO,
@@ -271,6 +284,17 @@ gegl_operation_point_composer3_process (GeglOperation       *operation,
           bar = gegl_buffer_iterator_add (i, aux2, result, level, aux2_format,
                                           GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
 
+        if (GEGL_OPERATION_GET_CLASS (operation)->planar)
+          {
+            gegl_buffer_iterator_set_planar (i, 0, TRUE);
+            if (input)
+              gegl_buffer_iterator_set_planar (i, read, TRUE);
+            if (aux)
+              gegl_buffer_iterator_set_planar (i, foo, TRUE);
+            if (aux2)
+              gegl_buffer_iterator_set_planar (i, bar, TRUE);
+          }
+
         while (gegl_buffer_iterator_next (i))
           {
             point_composer3_class->process (operation, input?i->items[read].data:NULL,
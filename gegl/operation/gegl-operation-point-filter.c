@@ -26,6 +26,7 @@
 #include "gegl-operation-point-filter.h"
 #include "gegl-operation-context.h"
 #include "gegl-config.h"
+#include "gegl-parallel-private.h"
 #include "gegl-types-internal.h"
 #include "gegl-buffer-private.h"
 #include "gegl-tile-storage.h"
@@ -65,6 +66,13 @@ thread_process (const GeglRectangle *area,
                                      data->input_format,
                                      GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
 
+  if (GEGL_OPERATION_GET_CLASS (data->operation)->planar)
+    {
+      gegl_buffer_iterator_set_planar (i, 0, TRUE);
+      if (data->input)
+        gegl_buffer_iterator_set_planar (i, read, TRUE);
+    }
+
   while (gegl_buffer_iterator_next (i))
   {
      data->success =
@@ -286,7 +294,8 @@ gegl_operation_point_filter_process (GeglOperation       *operation,
         if (gegl_cl_is_accelerated () && input)
           gegl_buffer_flush_ext (input, result);
 
-        gegl_parallel_distribute_area (
+        gegl_parallel_distribute_buffer_area (
+          output, level,
           result,
           gegl_operation_get_pixels_per_thread (operation),
           GEGL_SPLIT_STRATEGY_AUTO,
@@ -305,6 +314,13 @@ gegl_operation_point_filter_process (GeglOperation       *operation,
           read = gegl_buffer_iterator_add (i, input, result, level, in_format,
                                            GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
 
+        if (operation_class->planar)
+          {
+            gegl_buffer_iterator_set_planar (i, 0, TRUE);
+            if (input)
+              gegl_buffer_iterator_set_planar (i, read, TRUE);
+          }
+
         while (gegl_buffer_iterator_next (i))
           {
             point_filter_class->process (operation, input?i->items[read].data:NULL,
@@ -87,7 +87,11 @@ struct _GeglOperationClass
                                   to accelerate rendering; this allows opting in/out
                                   in the sub-classes of these.
                                 */
-  guint64         bit_pad:60;
+  guint           planar:1;    /* point operations: hand the process function
+                                  planar data, see
+                                  gegl_buffer_iterator_set_planar().
+                                */
+  guint64         bit_pad:59;
 
   /* attach this operation with a GeglNode, override this if you are creating a
    * GeglGraph, it is already defined for Filters/Sources/Composers.
@@ -25,6 +25,10 @@ struct _GeglGraphTraversal
   GQueue      path;
   gboolean    rects_dirty;
   GeglBuffer *shared_empty;
+  GArray     *deferred_computed; /* rectangles computed into node caches,
+                                  * while announcing them is deferred
+                                  */
+  GMutex      deferred_mutex;
 };
 
 #endif /* __GEGL_GRAPH_TRAVERSAL_PRIVATE_H__ */
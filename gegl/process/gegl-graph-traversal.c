@@ -19,12 +19,17 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib-object.h>
 
 #include "gegl-types-internal.h"
 #include "gegl.h"
 #include "gegl-debug.h"
 #include "gegl-instrument.h"
+#include "gegl-config.h"
+#include "gegl-parallel.h"
+#include "gegl-parallel-private.h"
 
 #include "gegl-region.h"
 
@@ -41,6 +46,10 @@
 #include "operation/gegl-operation.h"
 #include "operation/gegl-operation-context.h"
 #include "operation/gegl-operation-context-private.h"
+#include "operation/gegl-operation-filter.h"
+#include "operation/gegl-operation-composer.h"
+#include "operation/gegl-operation-point-composer.h"
+#include "operation/gegl-operation-point-filter.h"
 
 typedef struct
 {
@@ -112,6 +121,7 @@ gegl_graph_build (GeglNode *node)
   GeglGraphTraversal *result = g_new0 (GeglGraphTraversal, 1);
 
   g_queue_init (&result->path);
+  g_mutex_init (&result->deferred_mutex);
 
   _gegl_graph_do_build (result, node);
 
@@ -142,6 +152,11 @@ gegl_graph_free (GeglGraphTraversal *path)
   g_queue_clear (&path->path);
   g_hash_table_unref (path->contexts);
   g_clear_object (&path->shared_empty);
+
+  if (path->deferred_computed)
+    gegl_graph_flush_computed (path, NULL);
+
+  g_mutex_clear (&path->deferred_mutex);
   g_free (path);
 }
 
@@ -393,6 +408,1010 @@ gegl_graph_get_shared_empty (GeglGraphTraversal *path)
 }
 
 
+typedef struct
+{
+  GeglCache     *cache;
+  GeglRectangle  rect;
+  gint           level;
+} GeglGraphComputed;
+
+/**
+ * gegl_graph_defer_computed:
+ * @path: The traversal path
+ *
+ * Defer telling the caches of the nodes about the rectangles
+ * computed into them, until gegl_graph_flush_computed is called.
+ * This is used when processing from a thread other than the one
+ * owning the graph, since the handlers of the caches' "computed"
+ * signal may not be thread-safe.
+ */
+void
+gegl_graph_defer_computed (GeglGraphTraversal *path)
+{
+  if (! path->deferred_computed)
+    path->deferred_computed = g_array_new (FALSE, FALSE, sizeof (GeglGraphComputed));
+}
+
+/**
+ * gegl_graph_flush_computed:
+ * @path: The traversal path
+ * @exclude: (nullable): A cache whose rectangles are announced by the caller
+ *
+ * Tell the caches of the nodes about the rectangles computed into
+ * them since gegl_graph_defer_computed was called, except for those
+ * of @exclude, and stop deferring.
+ */
+void
+gegl_graph_flush_computed (GeglGraphTraversal *path,
+                           GeglCache          *exclude)
+{
+  GArray *deferred = path->deferred_computed;
+  gint    i;
+
+  if (! deferred)
+    return;
+
+  path->deferred_computed = NULL;
+
+  for (i = 0; i < deferred->len; i++)
+    {
+      GeglGraphComputed *computed = &g_array_index (deferred,
+                                                    GeglGraphComputed, i);
+
+      if (computed->cache != exclude)
+        gegl_cache_computed (computed->cache, &computed->rect, computed->level);
+
+      g_object_unref (computed->cache);
+    }
+
+  g_array_free (deferred, TRUE);
+}
+
+/* tells @node's cache about the computed @rect, or records it for
+ * gegl_graph_flush_computed().  units of the graph may be processed
+ * concurrently, so recording is done under a lock.
+ */
+static void
+gegl_graph_cache_computed (GeglGraphTraversal  *path,
+                           GeglNode            *node,
+                           const GeglRectangle *rect,
+                           gint                 level)
+{
+  if (path->deferred_computed)
+    {
+      GeglGraphComputed computed;
+
+      computed.cache = g_object_ref (node->cache);
+      computed.rect  = *rect;
+      computed.level = level;
+
+      g_mutex_lock (&path->deferred_mutex);
+      g_array_append_val (path->deferred_computed, computed);
+      g_mutex_unlock (&path->deferred_mutex);
+    }
+  else
+    {
+      gegl_cache_computed (node->cache, rect, level);
+    }
+}
+
+/* processes @node, and returns its (borrowed) result, or NULL if the node
+ * produced nothing.
+ */
+static GeglBuffer *
+gegl_graph_process_node (GeglGraphTraversal *path,
+                         GeglNode           *node,
+                         gint                level)
+{
+  GeglOperation        *operation = node->operation;
+  GeglOperationContext *context;
+  GeglBuffer           *operation_result = NULL;
+
+  context = g_hash_table_lookup (path->contexts, node);
+  g_return_val_if_fail (context, NULL);
+
+  GEGL_NOTE (GEGL_DEBUG_PROCESS,
+             "Will process %s result_rect = %d, %d %d×%d",
+             gegl_node_get_debug_name (node),
+             context->result_rect.x, context->result_rect.y, context->result_rect.width, context->result_rect.height);
+
+  if (context->need_rect.width > 0 && context->need_rect.height > 0)
+    {
+      if (context->cached)
+        {
+          GEGL_NOTE (GEGL_DEBUG_PROCESS,
+                     "Using cached result for %s",
+                     gegl_node_get_debug_name (node));
+          operation_result = GEGL_BUFFER (node->cache);
+        }
+      else
+        {
+          /* provide something on input pad, always - this makes having
+             behavior depending on it not being set.. not work, is
+             sacrifising that worth it?
+           */
+          if (gegl_node_has_pad (node, "input") &&
+              !gegl_operation_context_get_object (context, "input"))
+            {
+              gegl_operation_context_set_object (context, "input", G_OBJECT (gegl_graph_get_shared_empty(path)));
+            }
+
+          context->level = level;
+
+          /* note: this hard-coding of "output" makes some more custom
+           * graph topologies harder than necessary.
+           */
+          gegl_operation_process (operation, context, "output", &context->need_rect, context->level);
+          operation_result = GEGL_BUFFER (gegl_operation_context_get_object (context, "output"));
+
+          if (operation_result && operation_result == (GeglBuffer *)operation->node->cache)
+            gegl_graph_cache_computed (path, operation->node, &context->need_rect, level);
+        }
+    }
+
+  return operation_result;
+}
+
+/* hands the result of @node to all the nodes consuming it */
+static void
+gegl_graph_deliver_result (GeglGraphTraversal *path,
+                           GeglNode           *node,
+                           GeglBuffer         *operation_result)
+{
+  GeglPad *output_pad = gegl_node_get_pad (node, "output");
+  GList   *targets = gegl_graph_get_connected_output_contexts (path, output_pad);
+  GList   *targets_iter;
+
+  GEGL_NOTE (GEGL_DEBUG_PROCESS,
+             "Will deliver the results of %s:%s to %d targets",
+             gegl_node_get_debug_name (node),
+             "output",
+             g_list_length (targets));
+
+  if (g_list_length (targets) > 1)
+    gegl_object_set_has_forked (G_OBJECT (operation_result));
+
+  for (targets_iter = targets; targets_iter; targets_iter = g_list_next (targets_iter))
+    {
+      ContextConnection *target_con = targets_iter->data;
+      gegl_operation_context_set_object (target_con->context, target_con->name, G_OBJECT (operation_result));
+    }
+  g_list_free_full (targets, free_context_connection);
+}
+
+
+/* Scheduled graph processing
+ *
+ * The nodes of the path are grouped into units, each of which is either a
+ * single node, or a chain of point operations feeding directly into each
+ * other through their "input" pads.  Each unit is assigned the depth of its
+ * last node -- the length of the longest path leading to it -- and units of
+ * equal depth, which can't depend on each other, are processed concurrently,
+ * such as the two inputs of a composer.  Results are delivered, and contexts
+ * purged, once all the units of a given depth are done.
+ *
+ * When the output format of each operation in a chain matches the input
+ * format of the next one, the chain is fused: a single iterator pass reads
+ * the chain's input (and the aux inputs of its composers), and writes its
+ * output, calling the point functions of all the operations back to back on
+ * small pieces of each chunk, so that intermediate results stay in the CPU
+ * cache, and intermediate buffers are never allocated.
+ *
+ * Other chains are processed in horizontal bands aligned to the tile grid,
+ * as a wavefront: at each step, each operation processes the band following
+ * the one it processed at the previous step, which the operation before it
+ * has just produced, so that consecutive operations run on different cores
+ * at the same time.
+ */
+
+/* the minimal band height, in pixels, when splitting tiles into bands to
+ * feed all threads.
+ */
+#define GEGL_GRAPH_MIN_BAND_HEIGHT 16
+
+/* the number of pixels processed by each operation of a fused chain at a
+ * time.
+ */
+#define GEGL_GRAPH_FUSED_PIECE_SIZE 1024
+
+typedef struct
+{
+  gint        first;     /* index of the unit's first node */
+  gint        last;      /* index of the unit's last node */
+  gint        n_nodes;   /* number of nodes in the unit, following the chain */
+  gint        depth;
+  gboolean    threaded;  /* whether the unit may run alongside other units */
+  GeglBuffer *result;    /* the (borrowed) result of the unit's last node */
+} GeglGraphUnit;
+
+typedef struct
+{
+  GeglGraphTraversal  *path;
+  GeglNode           **nodes;
+  gint                *next;     /* index of the next node in the chain, or -1 */
+  GeglGraphUnit      **units;    /* the units of the current depth */
+  gint                 n_units;
+  gint                 n_threaded;
+  gint                 level;
+} GeglGraphSchedule;
+
+typedef struct
+{
+  GeglOperation **operations;
+  gboolean       *composers;     /* whether each operation is a composer */
+  GeglBuffer    **inputs;        /* only the first input when fused */
+  GeglBuffer    **auxs;
+  GeglBuffer    **outputs;       /* only the last output when fused */
+  gint            n_operations;
+  gint            n_auxs;
+  GeglRectangle   roi;
+  gint            level;
+
+  /* fused chains */
+  const Babl    **formats;       /* the output format of each operation */
+  gint            max_bpp;       /* of the intermediate formats */
+
+  /* wavefront processing */
+  gint            band_height;
+  gint            first_band;    /* index of the first band on the band grid */
+  gint            n_bands;
+  gint            step;
+  gint            first_operation; /* first operation active at this step */
+} GeglGraphPipeline;
+
+static gint
+gegl_graph_floor_div (gint a,
+                      gint b)
+{
+  return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+static GeglRectangle
+gegl_graph_get_scaled_need_rect (GeglOperationContext *context,
+                                 gint                  level)
+{
+  GeglRectangle rect = context->need_rect;
+
+  /* the same scaling as done by gegl_operation_filter_process() */
+  if (level)
+    {
+      rect.x      >>= level;
+      rect.y      >>= level;
+      rect.width  >>= level;
+      rect.height >>= level;
+    }
+
+  return rect;
+}
+
+/* returns TRUE if @node can be processed as part of a chain, by calling the
+ * point filter's, or point composer's, functions directly.
+ */
+static gboolean
+gegl_graph_can_chain (GeglGraphTraversal *path,
+                      GeglNode           *node,
+                      gint                level)
+{
+  GeglOperation        *operation = node->operation;
+  GeglOperationClass   *klass;
+  GeglOperationClass   *point_class;
+  GeglOperationContext *context;
+  GeglRectangle         rect;
+
+  if (GEGL_IS_OPERATION_POINT_FILTER (operation))
+    point_class = g_type_class_peek (GEGL_TYPE_OPERATION_POINT_FILTER);
+  else if (GEGL_IS_OPERATION_POINT_COMPOSER (operation))
+    point_class = g_type_class_peek (GEGL_TYPE_OPERATION_POINT_COMPOSER);
+  else
+    return FALSE;
+
+  klass = GEGL_OPERATION_GET_CLASS (operation);
+
+  /* operations overriding the generic process() function may do something
+   * other than processing their input point by point, such as passing it
+   * through.
+   */
+  if (klass->process != point_class->process ||
+      ! klass->threaded                     ||
+      node->passthrough                     ||
+      gegl_operation_use_opencl (operation))
+    {
+      return FALSE;
+    }
+
+  context = g_hash_table_lookup (path->contexts, node);
+
+  if (! context || context->cached)
+    return FALSE;
+
+  rect = gegl_graph_get_scaled_need_rect (context, level);
+
+  return rect.width > 0 && rect.height > 0;
+}
+
+/* returns TRUE if the output of @node can be passed to @next_node directly,
+ * as interleaved data.  operations asking for planar data are always fed
+ * through the buffer iterator, which does the conversion.
+ */
+static gboolean
+gegl_graph_can_fuse (GeglNode *node,
+                     GeglNode *next_node)
+{
+  return ! GEGL_OPERATION_GET_CLASS (node->operation)->planar      &&
+         ! GEGL_OPERATION_GET_CLASS (next_node->operation)->planar &&
+         gegl_operation_get_format (node->operation,      "output") ==
+         gegl_operation_get_format (next_node->operation, "input");
+}
+
+static void
+gegl_graph_pipeline_process_fused (const GeglRectangle *area,
+                                   GeglGraphPipeline   *pipeline)
+{
+  GeglBufferIterator *iter;
+  gint                n          = pipeline->n_operations;
+  gint               *aux_items  = g_newa (gint, n);
+  gint               *aux_bpps   = g_newa (gint, n);
+  const Babl         *in_format;
+  const Babl         *out_format;
+  gint                in_bpp;
+  gint                out_bpp;
+  gint                in_item;
+  guchar             *scratch[2] = {NULL, NULL};
+  gint                scratch_size = 0;
+  gint                j;
+
+  in_format  = gegl_operation_get_format (pipeline->operations[0], "input");
+  out_format = pipeline->formats[n - 1];
+
+  in_bpp  = babl_format_get_bytes_per_pixel (in_format);
+  out_bpp = babl_format_get_bytes_per_pixel (out_format);
+
+  iter = gegl_buffer_iterator_new (pipeline->outputs[n - 1], area,
+                                   pipeline->level, out_format,
+                                   GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE,
+                                   2 + pipeline->n_auxs);
+
+  in_item = gegl_buffer_iterator_add (iter, pipeline->inputs[0], area,
+                                      pipeline->level, in_format,
+                                      GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+
+  for (j = 0; j < n; j++)
+    {
+      aux_items[j] = -1;
+
+      if (pipeline->auxs[j])
+        {
+          const Babl *aux_format;
+
+          aux_format = gegl_operation_get_format (pipeline->operations[j],
+                                                  "aux");
+
+          aux_bpps[j]  = babl_format_get_bytes_per_pixel (aux_format);
+          aux_items[j] = gegl_buffer_iterator_add (iter, pipeline->auxs[j],
+                                                   area, pipeline->level,
+                                                   aux_format,
+                                                   GEGL_ACCESS_READ,
+                                                   GEGL_ABYSS_NONE);
+        }
+    }
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const GeglRectangle *roi = &iter->items[0].roi;
+      gint                 rows;
+      gint                 y;
+
+      /* split the chunk into pieces of whole rows, so that each piece has
+       * a rectangular roi.
+       */
+      rows = MAX (GEGL_GRAPH_FUSED_PIECE_SIZE / roi->width, 1);
+
+      if (scratch_size < roi->width * rows * pipeline->max_bpp)
+        {
+          scratch_size = roi->width * rows * pipeline->max_bpp;
+
+          gegl_scratch_free (scratch[1]);
+          gegl_scratch_free (scratch[0]);
+
+          scratch[0] = gegl_scratch_alloc (scratch_size);
+          scratch[1] = gegl_scratch_alloc (scratch_size);
+        }
+
+      for (y = 0; y < roi->height; y += rows)
+        {
+          GeglRectangle  piece;
+          gint           offset = y * roi->width;
+          guchar        *src;
+
+          piece.x      = roi->x;
+          piece.y      = roi->y + y;
+          piece.width  = roi->width;
+          piece.height = MIN (rows, roi->height - y);
+
+          src = (guchar *) iter->items[in_item].data + offset * in_bpp;
+
+          for (j = 0; j < n; j++)
+            {
+              GeglOperation *operation = pipeline->operations[j];
+              guchar        *dst;
+
+              if (j == n - 1)
+                dst = (guchar *) iter->items[0].data + offset * out_bpp;
+              else
+                dst = scratch[j % 2];
+
+              if (pipeline->composers[j])
+                {
+                  guchar *aux = NULL;
+
+                  if (aux_items[j] >= 0)
+                    {
+                      aux = (guchar *) iter->items[aux_items[j]].data +
+                            offset * aux_bpps[j];
+                    }
+
+                  GEGL_OPERATION_POINT_COMPOSER_GET_CLASS (operation)->process (
+                    operation, src, aux, dst,
+                    piece.width * piece.height, &piece, pipeline->level);
+                }
+              else
+                {
+                  GEGL_OPERATION_POINT_FILTER_GET_CLASS (operation)->process (
+                    operation, src, dst,
+                    piece.width * piece.height, &piece, pipeline->level);
+                }
+
+              src = dst;
+            }
+        }
+    }
+
+  gegl_scratch_free (scratch[1]);
+  gegl_scratch_free (scratch[0]);
+}
+
+static GeglRectangle
+gegl_graph_pipeline_get_band (GeglGraphPipeline *pipeline,
+                              gint               band)
+{
+  GeglRectangle rect = pipeline->roi;
+  gint          y0;
+  gint          y1;
+
+  y0 = (pipeline->first_band + band)     * pipeline->band_height;
+  y1 = (pipeline->first_band + band + 1) * pipeline->band_height;
+
+  y0 = MAX (y0, pipeline->roi.y);
+  y1 = MIN (y1, pipeline->roi.y + pipeline->roi.height);
+
+  rect.y      = y0;
+  rect.height = y1 - y0;
+
+  return rect;
+}
+
+static void
+gegl_graph_pipeline_process_range (gsize              offset,
+                                   gsize              size,
+                                   GeglGraphPipeline *pipeline)
+{
+  gint i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      gint           j         = pipeline->first_operation + i;
+      GeglOperation *operation = pipeline->operations[j];
+      GeglRectangle  band;
+
+      band = gegl_graph_pipeline_get_band (pipeline, pipeline->step - j);
+
+      if (pipeline->composers[j])
+        {
+          GEGL_OPERATION_COMPOSER_GET_CLASS (operation)->process (
+            operation,
+            pipeline->inputs[j], pipeline->auxs[j], pipeline->outputs[j],
+            &band, pipeline->level);
+        }
+      else
+        {
+          GEGL_OPERATION_FILTER_GET_CLASS (operation)->process (
+            operation,
+            pipeline->inputs[j], pipeline->outputs[j],
+            &band, pipeline->level);
+        }
+    }
+}
+
+static void
+gegl_graph_pipeline_run_fused (GeglGraphPipeline *pipeline)
+{
+  GeglOperation *operation = pipeline->operations[0];
+
+  /* the fused pass does the work of all the operations for each pixel */
+  if (gegl_operation_use_threading (operation, &pipeline->roi))
+    {
+      gegl_parallel_distribute_buffer_area (
+        pipeline->outputs[pipeline->n_operations - 1], pipeline->level,
+        &pipeline->roi,
+        gegl_operation_get_pixels_per_thread (operation) /
+        pipeline->n_operations,
+        GEGL_SPLIT_STRATEGY_AUTO,
+        (GeglParallelDistributeAreaFunc) gegl_graph_pipeline_process_fused,
+        pipeline);
+    }
+  else
+    {
+      gegl_graph_pipeline_process_fused (&pipeline->roi, pipeline);
+    }
+}
+
+static void
+gegl_graph_pipeline_run_wavefront (GeglGraphPipeline *pipeline)
+{
+  gint n_threads = gegl_config_threads ();
+
+  /* use tile-sized bands, halving them while there are fewer bands than
+   * threads.
+   */
+  g_object_get (pipeline->outputs[0],
+                "tile-height", &pipeline->band_height,
+                NULL);
+
+  while (pipeline->band_height > GEGL_GRAPH_MIN_BAND_HEIGHT &&
+         pipeline->roi.height / pipeline->band_height < n_threads)
+    {
+      pipeline->band_height /= 2;
+    }
+
+  pipeline->first_band = gegl_graph_floor_div (pipeline->roi.y,
+                                               pipeline->band_height);
+  pipeline->n_bands    = gegl_graph_floor_div (pipeline->roi.y +
+                                               pipeline->roi.height - 1,
+                                               pipeline->band_height) -
+                         pipeline->first_band + 1;
+
+  for (pipeline->step = 0;
+       pipeline->step < pipeline->n_operations + pipeline->n_bands - 1;
+       pipeline->step++)
+    {
+      gint last_operation;
+
+      pipeline->first_operation = MAX (pipeline->step - pipeline->n_bands + 1, 0);
+      last_operation            = MIN (pipeline->step, pipeline->n_operations - 1);
+
+      gegl_parallel_distribute_range (
+        last_operation - pipeline->first_operation + 1, 0.0,
+        (GeglParallelDistributeRangeFunc) gegl_graph_pipeline_process_range,
+        pipeline);
+    }
+}
+
+static GeglBuffer *
+gegl_graph_process_chain (GeglGraphSchedule *schedule,
+                          GeglGraphUnit     *unit)
+{
+  GeglGraphTraversal     *path = schedule->path;
+  GeglOperationContext  **contexts;
+  GeglGraphPipeline       pipeline;
+  GeglBuffer             *result;
+  gboolean                fused = TRUE;
+  gint                    n     = unit->n_nodes;
+  gint                    i;
+  gint                    j;
+
+  contexts = g_new (GeglOperationContext *, n);
+
+  pipeline.operations   = g_new (GeglOperation *, n);
+  pipeline.composers    = g_new (gboolean, n);
+  pipeline.inputs       = g_new0 (GeglBuffer *, n);
+  pipeline.auxs         = g_new0 (GeglBuffer *, n);
+  pipeline.outputs      = g_new0 (GeglBuffer *, n);
+  pipeline.formats      = g_new (const Babl *, n);
+  pipeline.n_operations = n;
+  pipeline.n_auxs       = 0;
+  pipeline.max_bpp      = 0;
+  pipeline.level        = schedule->level;
+
+  for (i = unit->first, j = 0; j < n; i = schedule->next[i], j++)
+    {
+      GeglNode *node = schedule->nodes[i];
+
+      contexts[j]            = g_hash_table_lookup (path->contexts, node);
+      pipeline.operations[j] = node->operation;
+      pipeline.composers[j]  = GEGL_IS_OPERATION_POINT_COMPOSER (node->operation);
+      pipeline.formats[j]    = gegl_operation_get_format (node->operation,
+                                                          "output");
+
+      if (j < n - 1)
+        {
+          fused = fused && gegl_graph_can_fuse (node,
+                                                schedule->nodes[schedule->next[i]]);
+
+          pipeline.max_bpp = MAX (pipeline.max_bpp,
+                                  babl_format_get_bytes_per_pixel (pipeline.formats[j]));
+        }
+    }
+
+  /* set up the chain, the same way gegl_operation_process() would for each
+   * node.  the output of each node is passed to the next one in advance,
+   * unless the chain is fused, in which case only the chain's input and
+   * output buffers are needed.
+   */
+  for (i = unit->first, j = 0; j < n; i = schedule->next[i], j++)
+    {
+      GeglNode             *node      = schedule->nodes[i];
+      GeglOperation        *operation = node->operation;
+      GeglOperationContext *context   = contexts[j];
+      GeglRectangle         rect;
+
+      GEGL_NOTE (GEGL_DEBUG_PROCESS,
+                 "Will process %s result_rect = %d, %d %d×%d, %s",
+                 gegl_node_get_debug_name (node),
+                 context->result_rect.x, context->result_rect.y, context->result_rect.width, context->result_rect.height,
+                 fused ? "fused" : "pipelined");
+
+      context->level = schedule->level;
+
+      rect = gegl_graph_get_scaled_need_rect (context, schedule->level);
+
+      /* all the nodes of the chain share the same need rect */
+      if (j == 0)
+        pipeline.roi = rect;
+
+      if (pipeline.composers[j])
+        {
+          pipeline.auxs[j] = GEGL_BUFFER (gegl_operation_context_dup_object (context, "aux"));
+
+          if (pipeline.auxs[j])
+            pipeline.n_auxs++;
+        }
+
+      if (j == 0 || ! fused)
+        {
+          if (! gegl_operation_context_get_object (context, "input"))
+            {
+              gegl_operation_context_set_object (context, "input", G_OBJECT (gegl_graph_get_shared_empty (path)));
+            }
+
+          pipeline.inputs[j] = GEGL_BUFFER (gegl_operation_context_dup_object (context, "input"));
+        }
+
+      if (! fused)
+        {
+          pipeline.outputs[j] = gegl_operation_context_get_output_maybe_in_place (operation,
+                                                                                  context,
+                                                                                  pipeline.inputs[j],
+                                                                                  &rect);
+
+          if (j < n - 1)
+            gegl_graph_deliver_result (path, node, pipeline.outputs[j]);
+        }
+      else if (j == n - 1)
+        {
+          pipeline.outputs[j] = gegl_operation_context_get_output_maybe_in_place (operation,
+                                                                                  context,
+                                                                                  pipeline.inputs[0],
+                                                                                  &rect);
+        }
+    }
+
+  if (fused)
+    gegl_graph_pipeline_run_fused (&pipeline);
+  else
+    gegl_graph_pipeline_run_wavefront (&pipeline);
+
+  for (j = 0; j < n; j++)
+    {
+      GeglNode *node = pipeline.operations[j]->node;
+
+      /* the same bookkeeping as done by gegl_graph_process_node(), for nodes
+       * whose output is their cache.
+       */
+      if (pipeline.outputs[j] &&
+          pipeline.outputs[j] == (GeglBuffer *) node->cache)
+        {
+          gegl_graph_cache_computed (path, node, &contexts[j]->need_rect,
+                                     schedule->level);
+        }
+
+      g_clear_object (&pipeline.inputs[j]);
+      g_clear_object (&pipeline.auxs[j]);
+
+      /* the results of all but the last node have already been delivered,
+       * or were never produced.
+       */
+      if (j < n - 1)
+        gegl_operation_context_purge (contexts[j]);
+    }
+
+  result = pipeline.outputs[n - 1];
+
+  g_free (pipeline.formats);
+  g_free (pipeline.outputs);
+  g_free (pipeline.auxs);
+  g_free (pipeline.inputs);
+  g_free (pipeline.composers);
+  g_free (pipeline.operations);
+  g_free (contexts);
+
+  return result;
+}
+
+static void
+gegl_graph_process_unit (GeglGraphSchedule *schedule,
+                         GeglGraphUnit     *unit)
+{
+  if (unit->n_nodes == 1)
+    {
+      unit->result = gegl_graph_process_node (schedule->path,
+                                              schedule->nodes[unit->first],
+                                              schedule->level);
+    }
+  else
+    {
+      unit->result = gegl_graph_process_chain (schedule, unit);
+    }
+}
+
+static void
+gegl_graph_process_units_range (gsize              offset,
+                                gsize              size,
+                                GeglGraphSchedule *schedule)
+{
+  gint i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      if (i < schedule->n_threaded)
+        {
+          gegl_graph_process_unit (schedule, schedule->units[i]);
+        }
+      else
+        {
+          gint j;
+
+          /* units which aren't threaded are processed one after the other,
+           * alongside the rest.
+           */
+          for (j = schedule->n_threaded; j < schedule->n_units; j++)
+            gegl_graph_process_unit (schedule, schedule->units[j]);
+        }
+    }
+}
+
+static gboolean
+gegl_graph_process_scheduled (GeglGraphTraversal  *path,
+                              gint                 level,
+                              GeglBuffer         **result)
+{
+  GeglGraphSchedule  schedule;
+  GeglGraphUnit     *units;
+  GHashTable        *indices;
+  gint              *depths;
+  gboolean          *chained;
+  gint              *n_units_at_depth;
+  gint               n_nodes;
+  gint               n_threads;
+  gint               n_units    = 0;
+  gint               max_depth  = 0;
+  gboolean           worthwhile = FALSE;
+  GeglNode          *last_node;
+  GeglBuffer        *operation_result = NULL;
+  GList             *list_iter;
+  gint               depth;
+  gint               i;
+
+  n_nodes = g_queue_get_length (&path->path);
+
+  /* instrumentation isn't thread-safe, and is done per node */
+  if (gegl_instrument_enabled || n_nodes < 2)
+    return FALSE;
+
+  n_threads = gegl_config_threads ();
+
+  schedule.path  = path;
+  schedule.nodes = g_new (GeglNode *, n_nodes);
+  schedule.next  = g_new (gint, n_nodes);
+  schedule.level = level;
+
+  indices = g_hash_table_new (NULL, NULL);
+  depths  = g_new0 (gint, n_nodes);
+  chained = g_new0 (gboolean, n_nodes);
+
+  for (list_iter = g_queue_peek_head_link (&path->path), i = 0;
+       list_iter;
+       list_iter = list_iter->next, i++)
+    {
+      schedule.nodes[i] = GEGL_NODE (list_iter->data);
+      schedule.next[i]  = -1;
+
+      g_hash_table_insert (indices, schedule.nodes[i], GINT_TO_POINTER (i));
+    }
+
+  /* the path is sorted topologically, so the depth of each node is final by
+   * the time we get to it.
+   */
+  for (i = 0; i < n_nodes; i++)
+    {
+      GeglNode *node       = schedule.nodes[i];
+      GeglPad  *output_pad = gegl_node_get_pad (node, "output");
+      GList    *targets;
+      GList    *targets_iter;
+
+      if (! output_pad)
+        continue;
+
+      targets = gegl_graph_get_connected_output_contexts (path, output_pad);
+
+      for (targets_iter = targets; targets_iter; targets_iter = g_list_next (targets_iter))
+        {
+          ContextConnection    *target_con = targets_iter->data;
+          GeglNode             *target_node;
+          GeglOperationContext *context;
+          gint                  j;
+
+          target_node = target_con->context->operation->node;
+          j           = GPOINTER_TO_INT (g_hash_table_lookup (indices,
+                                                              target_node));
+
+          depths[j] = MAX (depths[j], depths[i] + 1);
+
+          if (targets->next || strcmp (target_con->name, "input"))
+            continue;
+
+          context = g_hash_table_lookup (path->contexts, node);
+
+          /* chains which can't be fused are only worth pipelining when
+           * using several threads.
+           */
+          if (gegl_graph_can_chain (path, node, level)        &&
+              gegl_graph_can_chain (path, target_node, level) &&
+              gegl_rectangle_equal (&context->need_rect,
+                                    &target_con->context->need_rect) &&
+              (n_threads > 1 || gegl_graph_can_fuse (node, target_node)))
+            {
+              schedule.next[i] = j;
+              chained[j]       = TRUE;
+            }
+        }
+
+      g_list_free_full (targets, free_context_connection);
+    }
+
+  units            = g_new0 (GeglGraphUnit, n_nodes);
+  n_units_at_depth = g_new0 (gint, n_nodes);
+
+  for (i = 0; i < n_nodes; i++)
+    {
+      GeglGraphUnit *unit;
+      gint           last;
+
+      if (chained[i])
+        continue;
+
+      unit = &units[n_units++];
+
+      unit->first    = i;
+      unit->n_nodes  = 1;
+      unit->threaded = GEGL_OPERATION_GET_CLASS (schedule.nodes[i]->operation)->threaded;
+
+      for (last = i; schedule.next[last] >= 0; last = schedule.next[last])
+        unit->n_nodes++;
+
+      unit->last  = last;
+      unit->depth = depths[last];
+
+      max_depth = MAX (max_depth, unit->depth);
+
+      if (unit->n_nodes > 1 ||
+          (++n_units_at_depth[unit->depth] > 1 && n_threads > 1))
+        {
+          worthwhile = TRUE;
+        }
+    }
+
+  if (! worthwhile)
+    {
+      g_free (n_units_at_depth);
+      g_free (units);
+      g_free (chained);
+      g_free (depths);
+      g_hash_table_unref (indices);
+      g_free (schedule.next);
+      g_free (schedule.nodes);
+
+      return FALSE;
+    }
+
+  /* create the shared empty buffer in advance, since it's created lazily,
+   * and units are processed from several threads.
+   */
+  gegl_graph_get_shared_empty (path);
+
+  last_node      = schedule.nodes[n_nodes - 1];
+  schedule.units = g_new (GeglGraphUnit *, n_units);
+
+  for (depth = 0; depth <= max_depth; depth++)
+    {
+      gint n_tasks;
+
+      schedule.n_units    = 0;
+      schedule.n_threaded = 0;
+
+      for (i = 0; i < n_units; i++)
+        {
+          if (units[i].depth == depth && units[i].threaded)
+            schedule.units[schedule.n_units++] = &units[i];
+        }
+
+      schedule.n_threaded = schedule.n_units;
+
+      for (i = 0; i < n_units; i++)
+        {
+          if (units[i].depth == depth && ! units[i].threaded)
+            schedule.units[schedule.n_units++] = &units[i];
+        }
+
+      if (schedule.n_units == 0)
+        continue;
+
+      n_tasks = schedule.n_threaded +
+                (schedule.n_units > schedule.n_threaded ? 1 : 0);
+
+      if (n_tasks == 1)
+        {
+          gegl_graph_process_units_range (0, 1, &schedule);
+        }
+      else
+        {
+          gegl_parallel_distribute_range (
+            n_tasks, 0.0,
+            (GeglParallelDistributeRangeFunc) gegl_graph_process_units_range,
+            &schedule);
+        }
+
+      for (i = 0; i < schedule.n_units; i++)
+        {
+          GeglGraphUnit *unit = schedule.units[i];
+          GeglNode      *node = schedule.nodes[unit->last];
+
+          if (unit->result)
+            gegl_graph_deliver_result (path, node, unit->result);
+
+          if (node == last_node)
+            {
+              operation_result = unit->result;
+            }
+          else
+            {
+              gegl_operation_context_purge (
+                g_hash_table_lookup (path->contexts, node));
+            }
+        }
+    }
+
+  if (operation_result)
+    *result = g_object_ref (operation_result);
+  else if (gegl_node_has_pad (last_node, "output"))
+    *result = g_object_ref (gegl_graph_get_shared_empty (path));
+  else
+    *result = NULL;
+
+  gegl_operation_context_purge (g_hash_table_lookup (path->contexts,
+                                                     last_node));
+
+  g_free (schedule.units);
+  g_free (n_units_at_depth);
+  g_free (units);
+  g_free (chained);
+  g_free (depths);
+  g_hash_table_unref (indices);
+  g_free (schedule.next);
+  g_free (schedule.nodes);
+
+  return TRUE;
+}
+
 /**
  * gegl_graph_process:
  * @path: The traversal path
@@ -401,6 +1420,12 @@ gegl_graph_get_shared_empty (GeglGraphTraversal *path)
  * resulting buffer from the final node, or NULL if
  * that node is a sink.
  *
+ * Chains of point operations with matching formats are
+ * processed in a single fused pass.  When using more than
+ * one thread, independent branches of the graph are
+ * processed concurrently, and other chains of point
+ * operations are pipelined.
+ *
  * If gegl_graph_prepare_request has not been called
  * the behavior of this function is undefined.
  *
@@ -417,6 +1442,9 @@ gegl_graph_process (GeglGraphTraversal *path,
   GeglOperationContext *last_context = NULL;
   GeglBuffer *operation_result = NULL;
 
+  if (gegl_graph_process_scheduled (path, level, &result))
+    return result;
+
   for (list_iter = g_queue_peek_head_link (&path->path);
        list_iter;
        list_iter = list_iter->next)
@@ -428,79 +1456,17 @@ gegl_graph_process (GeglGraphTraversal *path,
       
       GEGL_INSTRUMENT_START();
 
-      operation_result = NULL;
-
       if (last_context)
         gegl_operation_context_purge (last_context);
       
       context = g_hash_table_lookup (path->contexts, node);
       g_return_val_if_fail (context, NULL);
 
-      GEGL_NOTE (GEGL_DEBUG_PROCESS,
-                 "Will process %s result_rect = %d, %d %d×%d",
-                 gegl_node_get_debug_name (node),
-                 context->result_rect.x, context->result_rect.y, context->result_rect.width, context->result_rect.height);
-      
-      if (context->need_rect.width > 0 && context->need_rect.height > 0)
-        {
-          if (context->cached)
-            {
-              GEGL_NOTE (GEGL_DEBUG_PROCESS,
-                         "Using cached result for %s",
-                         gegl_node_get_debug_name (node));
-              operation_result = GEGL_BUFFER (node->cache);
-            }
-          else
-            {
-              /* provide something on input pad, always - this makes having
-                 behavior depending on it not being set.. not work, is
-                 sacrifising that worth it?
-               */
-              if (gegl_node_has_pad (node, "input") &&
-                  !gegl_operation_context_get_object (context, "input"))
-                {
-                  gegl_operation_context_set_object (context, "input", G_OBJECT (gegl_graph_get_shared_empty(path)));
-                }
-
-              context->level = level;
-
-              /* note: this hard-coding of "output" makes some more custom
-               * graph topologies harder than necessary.
-               */
-              gegl_operation_process (operation, context, "output", &context->need_rect, context->level);
-              operation_result = GEGL_BUFFER (gegl_operation_context_get_object (context, "output"));
-
-              if (operation_result && operation_result == (GeglBuffer *)operation->node->cache)
-                gegl_cache_computed (operation->node->cache, &context->need_rect, level);
-            }
-        }
-      else
-        {
-          operation_result = NULL;
-        }
+      operation_result = gegl_graph_process_node (path, node, level);
 
       if (operation_result)
-        {
-          GeglPad *output_pad = gegl_node_get_pad (node, "output");
-          GList   *targets = gegl_graph_get_connected_output_contexts (path, output_pad);
-          GList   *targets_iter;
+        gegl_graph_deliver_result (path, node, operation_result);
 
-          GEGL_NOTE (GEGL_DEBUG_PROCESS,
-                     "Will deliver the results of %s:%s to %d targets",
-                     gegl_node_get_debug_name (node),
-                     "output",
-                     g_list_length (targets));
-
-          if (g_list_length (targets) > 1)
-            gegl_object_set_has_forked (G_OBJECT (operation_result));
-
-          for (targets_iter = targets; targets_iter; targets_iter = g_list_next (targets_iter))
-            {
-              ContextConnection *target_con = targets_iter->data;
-              gegl_operation_context_set_object (target_con->context, target_con->name, G_OBJECT (operation_result));
-            }
-          g_list_free_full (targets, free_context_connection);
-        }
       last_context = context;
 
       GEGL_INSTRUMENT_END ("process", gegl_node_get_operation (node));
@@ -34,4 +34,8 @@ GeglBuffer         *gegl_graph_process          (GeglGraphTraversal  *path,
 
 GeglRectangle       gegl_graph_get_bounding_box (GeglGraphTraversal  *path);
 
+void                gegl_graph_defer_computed   (GeglGraphTraversal  *path);
+void                gegl_graph_flush_computed   (GeglGraphTraversal  *path,
+                                                 GeglCache           *exclude);
+
 #endif /* __GEGL_GRAPH_TRAVERSAL_H__ */
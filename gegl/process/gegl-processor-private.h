@@ -43,6 +43,11 @@ void           gegl_processor_set_rectangle (GeglProcessor       *processor,
                                              const GeglRectangle *rectangle);
 gboolean       gegl_processor_work          (GeglProcessor       *processor,
                                              gdouble             *progress);
+
+guint64        gegl_processor_get_pixels_reused   (void);
+guint64        gegl_processor_get_pixels_rendered (void);
+void           gegl_processor_reset_stats         (void);
+
 G_END_DECLS
 
 #endif /* __GEGL_PROCESSOR_PRIVATE_H__ */
@@ -32,8 +32,11 @@
 #include "operation/gegl-operation-sink.h"
 
 #include "gegl-config.h"
+#include "gegl-instrument.h"
+#include "gegl-parallel.h"
 #include "gegl-processor.h"
 #include "gegl-processor-private.h"
+#include "process/gegl-eval-manager.h"
 
 #include "graph/gegl-visitor.h"
 #include "graph/gegl-callback-visitor.h"
@@ -47,7 +50,8 @@ enum
   PROP_NODE,
   PROP_CHUNK_SIZE,
   PROP_PROGRESS,
-  PROP_RECTANGLE
+  PROP_RECTANGLE,
+  PROP_PARALLEL
 };
 
 
@@ -86,12 +90,34 @@ struct _GeglProcessor
   gint             chunk_size;
 
   gdouble          progress;
+
+  gboolean         parallel;
+  GeglEvalManager *eval_managers[GEGL_MAX_THREADS]; /* one per thread, used
+                                                     * for parallel rendering */
+
+  GArray          *priorities;       /* unscaled priority rectangles, in
+                                      * order of decreasing priority */
+  GArray          *scaled_priorities; /* the same, at the current level */
+  GeglRegion      *pending_region;   /* the part of the rectangle left to
+                                      * queue when rendering by priority,
+                                      * or NULL */
+  gint             target_level;     /* the level to refine down to */
+  gint             coarse_level;     /* the level to start rendering at */
+  gint             start_level;
+  gint             rendered_level;   /* the finest completely rendered level,
+                                      * or -1 */
+  gboolean         cancelled;
 };
 
 
 G_DEFINE_TYPE (GeglProcessor, gegl_processor, G_TYPE_OBJECT)
 
 
+/* updated by all processors, possibly from several threads at once */
+static volatile guintptr pixels_reused   = 0;
+static volatile guintptr pixels_rendered = 0;
+
+
 static void
 gegl_processor_class_init (GeglProcessorClass *klass)
 {
@@ -130,6 +156,13 @@ gegl_processor_class_init (GeglProcessorClass *klass)
                                                      1, 4096 * 4096, gegl_config()->chunk_size,
                                                      G_PARAM_READWRITE |
                                                      G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_class_install_property (gobject_class, PROP_PARALLEL,
+                                   g_param_spec_boolean ("parallel",
+                                                         "parallel",
+                                                         "Render several tile-aligned chunks of the cache concurrently, writing them directly into the cache.",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE));
 }
 
 static void
@@ -143,6 +176,15 @@ gegl_processor_init (GeglProcessor *processor)
   processor->queued_region    = NULL;
   processor->dirty_rectangles = NULL;
   processor->chunk_size       = 128 * 128;
+  processor->parallel         = FALSE;
+  processor->priorities       = g_array_new (FALSE, FALSE, sizeof (GeglRectangle));
+  processor->scaled_priorities = g_array_new (FALSE, FALSE, sizeof (GeglRectangle));
+  processor->pending_region   = NULL;
+  processor->target_level     = 0;
+  processor->coarse_level     = 0;
+  processor->start_level      = 0;
+  processor->rendered_level   = -1;
+  processor->cancelled        = FALSE;
 }
 
 static void
@@ -156,6 +198,15 @@ gegl_processor_constructed (GObject *object)
 }
 
 
+static void
+gegl_processor_clear_eval_managers (GeglProcessor *processor)
+{
+  gint i;
+
+  for (i = 0; i < GEGL_MAX_THREADS; i++)
+    g_clear_object (&processor->eval_managers[i]);
+}
+
 static void
 gegl_processor_finalize (GObject *self_object)
 {
@@ -163,12 +214,18 @@ gegl_processor_finalize (GObject *self_object)
 
   g_clear_pointer (&processor->context, gegl_operation_context_destroy);
 
+  gegl_processor_clear_eval_managers (processor);
+
   g_clear_object (&processor->node);
   g_clear_object (&processor->real_node);
   g_clear_object (&processor->input);
 
   g_clear_pointer (&processor->queued_region, gegl_region_destroy);
   g_clear_pointer (&processor->valid_region, gegl_region_destroy);
+  g_clear_pointer (&processor->pending_region, gegl_region_destroy);
+
+  g_array_free (processor->priorities, TRUE);
+  g_array_free (processor->scaled_priorities, TRUE);
 
   G_OBJECT_CLASS (gegl_processor_parent_class)->finalize (self_object);
 }
@@ -195,6 +252,10 @@ gegl_processor_set_property (GObject      *gobject,
         gegl_processor_set_rectangle (self, g_value_get_pointer (value));
         break;
 
+      case PROP_PARALLEL:
+        self->parallel = g_value_get_boolean (value);
+        break;
+
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, property_id, pspec);
         break;
@@ -226,6 +287,10 @@ gegl_processor_get_property (GObject    *gobject,
         g_value_set_double (value, gegl_processor_progress (self));
         break;
 
+      case PROP_PARALLEL:
+        g_value_set_boolean (value, self->parallel);
+        break;
+
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, property_id, pspec);
         break;
@@ -239,6 +304,8 @@ gegl_processor_set_node (GeglProcessor *processor,
   g_return_if_fail (GEGL_IS_NODE (node));
   g_return_if_fail (node->is_graph || GEGL_IS_OPERATION (node->operation));
 
+  gegl_processor_clear_eval_managers (processor);
+
   g_set_object (&processor->node, node);
   g_clear_object (&processor->real_node);
 
@@ -294,6 +361,31 @@ gegl_processor_set_node (GeglProcessor *processor,
   g_object_notify (G_OBJECT (processor), "node");
 }
 
+/* scales the priority rectangles to the current level once, rather than
+ * for every chunk queued.
+ */
+static void
+gegl_processor_scale_priorities (GeglProcessor *processor)
+{
+  gint level = processor->level;
+  gint i;
+
+  g_array_set_size (processor->scaled_priorities, processor->priorities->len);
+
+  for (i = 0; i < processor->priorities->len; i++)
+    {
+      const GeglRectangle *priority = &g_array_index (processor->priorities,
+                                                      GeglRectangle, i);
+      GeglRectangle       *scaled   = &g_array_index (processor->scaled_priorities,
+                                                      GeglRectangle, i);
+
+      scaled->x      = priority->x      >> level;
+      scaled->y      = priority->y      >> level;
+      scaled->width  = priority->width  >> level;
+      scaled->height = priority->height >> level;
+    }
+}
+
 static void
 set_scaled_rectangle (GeglProcessor *processor)
 {
@@ -301,6 +393,86 @@ set_scaled_rectangle (GeglProcessor *processor)
   processor->rectangle.y = processor->rectangle_unscaled.y >> processor->level;
   processor->rectangle.width = processor->rectangle_unscaled.width >> processor->level;
   processor->rectangle.height = processor->rectangle_unscaled.height >> processor->level;
+
+  gegl_processor_scale_priorities (processor);
+  g_clear_pointer (&processor->pending_region, gegl_region_destroy);
+}
+
+/* drops the queued work, along with the region it was queued from */
+static void
+gegl_processor_clear_dirty_rectangles (GeglProcessor *processor)
+{
+  GSList *iter;
+
+  for (iter = processor->dirty_rectangles; iter; iter = g_slist_next (iter))
+    {
+      g_slice_free (GeglRectangle, iter->data);
+    }
+  g_slist_free (processor->dirty_rectangles);
+  processor->dirty_rectangles = NULL;
+
+  g_clear_pointer (&processor->pending_region, gegl_region_destroy);
+}
+
+/* coarser levels are only rendered into caches, sinks are always processed
+ * at the target level.
+ */
+static gboolean
+gegl_processor_is_refinable (GeglProcessor *processor)
+{
+  return processor->input && processor->input == processor->real_node;
+}
+
+/* if the node's operation is a sink and it needs the full content then
+ * a context will be set up together with a cache and
+ * needed and result rectangles.  the context is destroyed once the sink
+ * has been written to, or the processor is cancelled.
+ */
+static void
+gegl_processor_setup_context (GeglProcessor *processor)
+{
+  if (processor->real_node && processor->input &&
+      GEGL_IS_OPERATION_SINK (processor->real_node->operation) &&
+      gegl_operation_sink_needs_full (processor->real_node->operation))
+    {
+      GeglCache *cache;
+
+      cache = gegl_node_get_cache (processor->input);
+
+      if (!processor->context)
+        {
+          processor->context = gegl_operation_context_new (processor->real_node->operation, NULL);
+        }
+
+      gegl_operation_context_set_object (processor->context, "input", G_OBJECT (cache));
+
+      gegl_operation_context_set_result_rect (processor->context,
+                                              &processor->rectangle_unscaled);
+      gegl_operation_context_set_need_rect   (processor->context,
+                                              &processor->rectangle_unscaled);
+    }
+}
+
+/* drops the queued work, and goes back to rendering the coarsest level.
+ * the dirty rectangles are recomputed from the processor's rectangle and
+ * the valid region, so nothing already rendered is lost.
+ */
+static void
+gegl_processor_restart (GeglProcessor *processor)
+{
+  gegl_processor_clear_dirty_rectangles (processor);
+
+  if (gegl_processor_is_refinable (processor))
+    processor->start_level = MAX (processor->coarse_level, processor->target_level);
+  else
+    processor->start_level = processor->target_level;
+
+  processor->level          = processor->start_level;
+  processor->rendered_level = -1;
+  processor->cancelled      = FALSE;
+
+  set_scaled_rectangle (processor);
+  gegl_processor_setup_context (processor);
 }
 
 
@@ -313,7 +485,6 @@ void
 gegl_processor_set_rectangle (GeglProcessor       *processor,
                               const GeglRectangle *rectangle)
 {
-  GSList        *iter;
   GeglRectangle  input_bounding_box;
 
   g_return_if_fail (processor->input != NULL);
@@ -344,40 +515,9 @@ gegl_processor_set_rectangle (GeglProcessor       *processor,
       gegl_rectangle_intersect (&processor->rectangle_unscaled, &processor->rectangle_unscaled, &bounds);
 #endif
     }
-    {
-
-      /* remove already queued dirty rectangles */
-      for (iter = processor->dirty_rectangles; iter; iter = g_slist_next (iter))
-        {
-          g_slice_free (GeglRectangle, iter->data);
-        }
-      g_slist_free (processor->dirty_rectangles);
-      processor->dirty_rectangles = NULL;
-    }
-
-  /* if the node's operation is a sink and it needs the full content then
-   * a context will be set up together with a cache and
-   * needed and result rectangles */
-  if (processor->real_node &&
-      GEGL_IS_OPERATION_SINK (processor->real_node->operation) &&
-      gegl_operation_sink_needs_full (processor->real_node->operation))
-    {
-      GeglCache *cache;
-
-      cache = gegl_node_get_cache (processor->input);
-
-      if (!processor->context)
-        {
-          processor->context = gegl_operation_context_new (processor->real_node->operation, NULL);
-        }
 
-      gegl_operation_context_set_object (processor->context, "input", G_OBJECT (cache));
-
-      gegl_operation_context_set_result_rect (processor->context,
-                                              &processor->rectangle_unscaled);
-      gegl_operation_context_set_need_rect   (processor->context,
-                                              &processor->rectangle_unscaled);
-    }
+  /* drop the queued work, and start over from the coarsest level */
+  gegl_processor_restart (processor);
 
   if (processor->valid_region)
     {
@@ -420,6 +560,307 @@ gegl_processor_get_band_size (gint size)
   return band_size;
 }
 
+/* Replaces the first dirty rectangle with the parts of it not already valid
+ * in the cache, if any.  Returns TRUE if the list of dirty rectangles was
+ * changed.
+ */
+static gboolean
+gegl_processor_subtract_cached (GeglProcessor *processor,
+                                GeglCache     *cache)
+{
+  GeglRectangle *dr    = processor->dirty_rectangles->data;
+  GeglRegion    *valid = cache->valid_region[processor->level];
+  GeglRegion    *region;
+  GeglRectangle *rectangles;
+  gint           n_rectangles;
+  guint64        residual = 0;
+  gint           i;
+
+  switch (gegl_region_rect_in (valid, dr))
+    {
+    case GEGL_OVERLAP_RECTANGLE_OUT:
+      return FALSE;
+
+    case GEGL_OVERLAP_RECTANGLE_IN:
+      n_rectangles = 0;
+      rectangles   = NULL;
+      break;
+
+    case GEGL_OVERLAP_RECTANGLE_PART:
+    default:
+      region = gegl_region_rectangle (dr);
+      gegl_region_subtract (region, valid);
+      gegl_region_get_rectangles (region, &rectangles, &n_rectangles);
+      gegl_region_destroy (region);
+      break;
+    }
+
+  processor->dirty_rectangles = g_slist_remove (processor->dirty_rectangles, dr);
+
+  /* queue the residual rectangles in place of the original one */
+  for (i = n_rectangles - 1; i >= 0; i--)
+    {
+      processor->dirty_rectangles =
+        g_slist_prepend (processor->dirty_rectangles,
+                         g_slice_dup (GeglRectangle, &rectangles[i]));
+
+      residual += (guint64) rectangles[i].width * rectangles[i].height;
+    }
+
+  g_atomic_pointer_add (&pixels_reused,
+                        (guint64) dr->width * dr->height - residual);
+
+  g_free (rectangles);
+  g_slice_free (GeglRectangle, dr);
+
+  return TRUE;
+}
+
+static gboolean
+gegl_processor_is_unthreaded_node (GeglNode *node,
+                                   gpointer  data)
+{
+  return ! GEGL_OPERATION_GET_CLASS (node->operation)->threaded;
+}
+
+/* returns TRUE if the processor should render chunks in parallel, which
+ * requires all the operations of the graph to be threaded, since they may
+ * be processed from several threads at once.
+ */
+static gboolean
+gegl_processor_use_parallel (GeglProcessor *processor)
+{
+  GeglVisitor *visitor;
+  gboolean     unthreaded;
+
+  /* instrumentation isn't thread-safe, and chunks are written directly into
+   * the cache only at level 0.
+   */
+  if (! processor->parallel         ||
+      processor->level != 0         ||
+      gegl_config_threads () == 1   ||
+      gegl_instrument_enabled)
+    {
+      return FALSE;
+    }
+
+  visitor = gegl_callback_visitor_new (gegl_processor_is_unthreaded_node,
+                                       NULL);
+
+  unthreaded = gegl_visitor_traverse (visitor,
+                                      GEGL_VISITABLE (processor->input));
+
+  g_object_unref (visitor);
+
+  return ! unthreaded;
+}
+
+static gint
+floor_to_multiple (gint value,
+                   gint multiple)
+{
+  if (value >= 0)
+    return value / multiple * multiple;
+  else
+    return -((-value + multiple - 1) / multiple * multiple);
+}
+
+typedef struct
+{
+  GeglProcessor *processor;
+  GeglBuffer    *cache;
+  GeglRectangle *chunks;
+  gint           n_chunks;
+  volatile gint  next_chunk;
+} RenderChunksData;
+
+static void
+render_chunks (gint              i,
+               gint              n,
+               RenderChunksData *data)
+{
+  GeglEvalManager *eval_manager = data->processor->eval_managers[i];
+  gint             chunk;
+
+  while ((chunk = g_atomic_int_add (&data->next_chunk, 1)) < data->n_chunks)
+    {
+      const GeglRectangle *roi = &data->chunks[chunk];
+      GeglBuffer          *result;
+
+      result = gegl_eval_manager_apply (eval_manager, roi, 0);
+
+      if (result)
+        {
+          /* the chunks are aligned to the tile grid, so the copy can usually
+           * share the tiles of the result, rather than copying the data.
+           */
+          if (result != data->cache)
+            gegl_buffer_copy (result, roi, GEGL_ABYSS_NONE, data->cache, roi);
+
+          g_object_unref (result);
+        }
+    }
+}
+
+/* returns the extent of the chunks to render, made of whole tiles, of about
+ * the processor's chunk size.
+ */
+static void
+gegl_processor_get_chunk_extent (GeglProcessor *processor,
+                                 gint          *chunk_width,
+                                 gint          *chunk_height)
+{
+  gint tile_width  = gegl_config ()->tile_width;
+  gint tile_height = gegl_config ()->tile_height;
+
+  if (gegl_processor_is_refinable (processor))
+    {
+      g_object_get (gegl_node_get_cache (processor->input),
+                    "tile-width",  &tile_width,
+                    "tile-height", &tile_height,
+                    NULL);
+    }
+
+  *chunk_width  = tile_width;
+  *chunk_height = tile_height;
+
+  while (*chunk_width * *chunk_height * 2 <= processor->chunk_size)
+    {
+      if (*chunk_width <= *chunk_height)
+        *chunk_width  *= 2;
+      else
+        *chunk_height *= 2;
+    }
+}
+
+/* Renders the parts of the first dirty rectangles not found in the cache,
+ * split into chunks aligned to the tile grid.  A batch of chunks is
+ * rendered concurrently, each thread using its own evaluation manager, and
+ * the remaining chunks are queued back.  Returns TRUE if there is more work.
+ */
+static gboolean
+render_rectangle_parallel (GeglProcessor *processor,
+                           GeglCache     *cache)
+{
+  GArray           *chunks;
+  RenderChunksData  data;
+  gint              chunk_width;
+  gint              chunk_height;
+  gint              n_threads = gegl_config_threads ();
+  gint              n_batch;
+  gint              i;
+
+  if (! processor->dirty_rectangles)
+    return FALSE;
+
+  gegl_processor_get_chunk_extent (processor, &chunk_width, &chunk_height);
+
+  chunks = g_array_new (FALSE, FALSE, sizeof (GeglRectangle));
+
+  /* gather chunks from the dirty rectangles, in order, until there is at
+   * least a chunk per thread.
+   */
+  while (processor->dirty_rectangles && chunks->len < n_threads)
+    {
+      GeglRectangle *rect;
+      gint           x;
+      gint           y;
+
+      if (gegl_processor_subtract_cached (processor, cache))
+        continue;
+
+      rect = processor->dirty_rectangles->data;
+      processor->dirty_rectangles = g_slist_remove (processor->dirty_rectangles,
+                                                    rect);
+
+      for (y = floor_to_multiple (rect->y, chunk_height);
+           y < rect->y + rect->height;
+           y += chunk_height)
+        {
+          for (x = floor_to_multiple (rect->x, chunk_width);
+               x < rect->x + rect->width;
+               x += chunk_width)
+            {
+              GeglRectangle chunk = {x, y, chunk_width, chunk_height};
+
+              gegl_rectangle_intersect (&chunk, &chunk, rect);
+
+              g_array_append_val (chunks, chunk);
+            }
+        }
+
+      g_slice_free (GeglRectangle, rect);
+    }
+
+  /* render a chunk per thread, and queue back the rest, preserving their
+   * order.
+   */
+  n_batch = MIN (chunks->len, n_threads);
+
+  for (i = chunks->len - 1; i >= n_batch; i--)
+    {
+      processor->dirty_rectangles =
+        g_slist_prepend (processor->dirty_rectangles,
+                         g_slice_dup (GeglRectangle,
+                                      &g_array_index (chunks, GeglRectangle, i)));
+    }
+
+  if (n_batch > 0)
+    {
+      /* each thread needs an evaluation manager of its own, since they keep
+       * per-request state.  prepare them here, rather than concurrently.
+       */
+      for (i = 0; i < n_batch; i++)
+        {
+          if (! processor->eval_managers[i])
+            {
+              processor->eval_managers[i] =
+                gegl_eval_manager_new (processor->input, "output");
+            }
+
+          gegl_eval_manager_prepare (processor->eval_managers[i]);
+
+          /* the nodes computed into their caches are announced below */
+          gegl_graph_defer_computed (processor->eval_managers[i]->traversal);
+        }
+
+      data.processor  = processor;
+      data.cache      = GEGL_BUFFER (cache);
+      data.chunks     = (GeglRectangle *) chunks->data;
+      data.n_chunks   = n_batch;
+      data.next_chunk = 0;
+
+      gegl_parallel_distribute (n_batch,
+                                (GeglParallelDistributeFunc) render_chunks,
+                                &data);
+
+      /* tell the caches about the computed chunks from this thread, since
+       * their handlers may not be thread-safe.  the chunks rendered into
+       * the processor's cache are announced once each, here, whether or not
+       * the output node rendered directly into it.
+       */
+      for (i = 0; i < n_batch; i++)
+        {
+          gegl_graph_flush_computed (processor->eval_managers[i]->traversal,
+                                     cache);
+        }
+
+      for (i = 0; i < n_batch; i++)
+        {
+          const GeglRectangle *chunk = &g_array_index (chunks, GeglRectangle, i);
+
+          gegl_cache_computed (cache, chunk, 0);
+
+          g_atomic_pointer_add (&pixels_rendered,
+                                (guint64) chunk->width * chunk->height);
+        }
+    }
+
+  g_array_free (chunks, TRUE);
+
+  return processor->dirty_rectangles != NULL;
+}
+
 /* If the processor's dirty rectangle is too big then it will be cut, added
  * to the processor's list of dirty rectangles and TRUE will be returned.
  * If the rectangle is small enough it will be processed, using a buffer or
@@ -442,11 +883,20 @@ render_rectangle (GeglProcessor *processor)
       cache = gegl_node_get_cache (processor->input);
       format = gegl_buffer_get_format ((GeglBuffer *)cache);
       pxsize = babl_format_get_bytes_per_pixel (format);
+
+      if (gegl_processor_use_parallel (processor))
+        return render_rectangle_parallel (processor, cache);
     }
 
   if (processor->dirty_rectangles)
     {
-      GeglRectangle *dr = processor->dirty_rectangles->data;
+      GeglRectangle *dr;
+
+      /* Only render the parts of the rectangle not already in the cache */
+      if (buffered && gegl_processor_subtract_cached (processor, cache))
+        return processor->dirty_rectangles != NULL;
+
+      dr = processor->dirty_rectangles->data;
 
       /* If a dirty rectangle is bigger than the max area, then cut it
        * to smaller pieces */
@@ -500,12 +950,14 @@ render_rectangle (GeglProcessor *processor)
               found_full = TRUE;
               break;
             }
-            /* XXX: dr should be adjusted to be the bounding box of not-found
-             * in cache if there is partial hits
-             */
           }
 
-          if (!found_full)
+          if (found_full)
+            {
+              g_atomic_pointer_add (&pixels_reused,
+                                    (guint64) dr->width * dr->height);
+            }
+          else
             {
               /* create a buffer and initialise it */
               guchar *buf;
@@ -530,6 +982,9 @@ render_rectangle (GeglProcessor *processor)
               /* tells the cache that the rectangle (dr) has been computed */
               gegl_cache_computed (cache, dr, processor->level);
 
+              g_atomic_pointer_add (&pixels_rendered,
+                                    (guint64) dr->width * dr->height);
+
               /* release the buffer */
               g_free (buf);
             }
@@ -640,6 +1095,131 @@ gegl_processor_progress (GeglProcessor *processor)
   return ret;
 }
 
+/* returns the chunk of @region nearest to (@x, @y), aligned to the chunk
+ * grid, and clipped to one of the region's rectangles.
+ */
+static GeglRectangle
+gegl_processor_get_nearest_chunk (GeglProcessor *processor,
+                                  GeglRegion    *region,
+                                  gint           x,
+                                  gint           y)
+{
+  GeglRectangle *rectangles;
+  gint           n_rectangles;
+  GeglRectangle  chunk = {0, 0, 0, 0};
+  gint           chunk_width;
+  gint           chunk_height;
+  gint64         min_distance = G_MAXINT64;
+  gint           nearest_x    = 0;
+  gint           nearest_y    = 0;
+  gint           nearest      = -1;
+  gint           i;
+
+  gegl_region_get_rectangles (region, &rectangles, &n_rectangles);
+
+  for (i = 0; i < n_rectangles; i++)
+    {
+      const GeglRectangle *rect = &rectangles[i];
+      gint                 px   = CLAMP (x, rect->x, rect->x + rect->width  - 1);
+      gint                 py   = CLAMP (y, rect->y, rect->y + rect->height - 1);
+      gint64               distance;
+
+      distance = (gint64) (px - x) * (px - x) + (gint64) (py - y) * (py - y);
+
+      if (distance < min_distance)
+        {
+          min_distance = distance;
+          nearest_x    = px;
+          nearest_y    = py;
+          nearest      = i;
+        }
+    }
+
+  if (nearest >= 0)
+    {
+      gegl_processor_get_chunk_extent (processor, &chunk_width, &chunk_height);
+
+      chunk.x      = floor_to_multiple (nearest_x, chunk_width);
+      chunk.y      = floor_to_multiple (nearest_y, chunk_height);
+      chunk.width  = chunk_width;
+      chunk.height = chunk_height;
+
+      gegl_rectangle_intersect (&chunk, &chunk, &rectangles[nearest]);
+    }
+
+  g_free (rectangles);
+
+  return chunk;
+}
+
+/* queues the chunks of @region to render next, according to the priority
+ * rectangles: the parts of higher-priority rectangles come first, starting
+ * from their center, and the rest of the region follows, nearest to the
+ * center of the first priority rectangle first.  the queued chunks are
+ * removed from @region.
+ */
+static void
+gegl_processor_queue_priority_chunks (GeglProcessor *processor,
+                                      GeglRegion    *region)
+{
+  gint n_chunks = 1;
+  gint i;
+
+  /* queue a chunk per thread when rendering in parallel */
+  if (gegl_processor_is_refinable (processor) &&
+      gegl_processor_use_parallel (processor))
+    {
+      n_chunks = gegl_config_threads ();
+    }
+
+  for (i = 0; i < n_chunks && ! gegl_region_empty (region); i++)
+    {
+      GeglRectangle  chunk = {0, 0, 0, 0};
+      GeglRegion    *chunk_region;
+      gint           j;
+
+      for (j = 0; j < processor->scaled_priorities->len && gegl_rectangle_is_empty (&chunk); j++)
+        {
+          const GeglRectangle *scaled = &g_array_index (processor->scaled_priorities,
+                                                        GeglRectangle, j);
+          GeglRegion          *part;
+
+          part = gegl_region_rectangle (scaled);
+          gegl_region_intersect (part, region);
+
+          if (! gegl_region_empty (part))
+            {
+              chunk = gegl_processor_get_nearest_chunk (
+                processor, part,
+                scaled->x + scaled->width  / 2,
+                scaled->y + scaled->height / 2);
+            }
+
+          gegl_region_destroy (part);
+        }
+
+      if (gegl_rectangle_is_empty (&chunk))
+        {
+          const GeglRectangle *scaled = &g_array_index (processor->scaled_priorities,
+                                                        GeglRectangle, 0);
+
+          chunk = gegl_processor_get_nearest_chunk (
+            processor, region,
+            scaled->x + scaled->width  / 2,
+            scaled->y + scaled->height / 2);
+        }
+
+      processor->dirty_rectangles = g_slist_prepend (processor->dirty_rectangles,
+                                                     g_slice_dup (GeglRectangle, &chunk));
+
+      chunk_region = gegl_region_rectangle (&chunk);
+      gegl_region_subtract (region, chunk_region);
+      gegl_region_destroy (chunk_region);
+    }
+
+  processor->dirty_rectangles = g_slist_reverse (processor->dirty_rectangles);
+}
+
 /* Processes the rectangle (might be only splitting it to smaller ones) and
  * updates the progress indicator */
 static gboolean
@@ -695,12 +1275,45 @@ gegl_processor_render (GeglProcessor *processor,
   if (rectangle)
     { /* we're asked to work on a specific rectangle thus we only focus
          on it */
-      GeglRegion    *region = gegl_region_rectangle (rectangle);
+      GeglRegion    *region;
       GeglRectangle *rectangles;
       gint           n_rectangles;
       gint           i;
 
+      if (processor->priorities->len > 0)
+        {
+          /* the region left to render is computed once, and the chunks
+           * are taken from it as they are queued.  once it runs out, it is
+           * computed again, to pick up anything invalidated meanwhile.
+           */
+          if (! processor->pending_region)
+            {
+              processor->pending_region = gegl_region_rectangle (rectangle);
+              gegl_region_subtract (processor->pending_region, valid_region);
+            }
+
+          if (gegl_region_empty (processor->pending_region))
+            {
+              g_clear_pointer (&processor->pending_region, gegl_region_destroy);
+
+              return FALSE;
+            }
+
+          gegl_processor_queue_priority_chunks (processor,
+                                                processor->pending_region);
+
+          if (gegl_region_empty (processor->pending_region))
+            g_clear_pointer (&processor->pending_region, gegl_region_destroy);
+
+          if (progress)
+            *progress = 1.0 - ((double) area_left (valid_region, rectangle) /
+                               rect_area (rectangle));
+          return TRUE;
+        }
+
+      region = gegl_region_rectangle (rectangle);
       gegl_region_subtract (region, valid_region);
+
       gegl_region_get_rectangles (region, &rectangles, &n_rectangles);
       gegl_region_destroy (region);
 
@@ -777,6 +1390,14 @@ gegl_processor_work (GeglProcessor *processor,
 {
   gboolean   more_work = FALSE;
 
+  if (processor->cancelled)
+    {
+      if (progress)
+        *progress = 1.0;
+
+      return FALSE;
+    }
+
   if (gegl_config()->use_opencl)
     {
       if (gegl_cl_is_accelerated ()
@@ -797,6 +1418,30 @@ gegl_processor_work (GeglProcessor *processor,
   more_work = gegl_processor_render (processor, &processor->rectangle, progress);
   if (more_work)
     {
+      /* account for the levels being refined */
+      if (progress && processor->start_level > processor->target_level)
+        {
+          *progress = (processor->start_level - processor->level + *progress) /
+                      (processor->start_level - processor->target_level + 1);
+        }
+
+      return TRUE;
+    }
+
+  processor->rendered_level = processor->level;
+
+  /* move on to the next finer level */
+  if (processor->level > processor->target_level)
+    {
+      processor->level--;
+      set_scaled_rectangle (processor);
+
+      if (progress)
+        {
+          *progress = (gdouble) (processor->start_level - processor->level) /
+                      (processor->start_level - processor->target_level + 1);
+        }
+
       return TRUE;
     }
 
@@ -836,12 +1481,94 @@ gegl_node_new_processor (GeglNode            *node,
 void gegl_processor_set_level (GeglProcessor *processor,
                                gint           level)
 {
-  processor->level = level;
-  set_scaled_rectangle (processor);
+  processor->target_level = level;
+  gegl_processor_restart (processor);
 }
 void gegl_processor_set_scale (GeglProcessor *processor,
                                gdouble        scale)
 {
-  processor->level = gegl_level_from_scale (scale);
-  set_scaled_rectangle (processor);
+  processor->target_level = gegl_level_from_scale (scale);
+  gegl_processor_restart (processor);
+}
+
+void
+gegl_processor_set_coarse_level (GeglProcessor *processor,
+                                 gint           level)
+{
+  g_return_if_fail (GEGL_IS_PROCESSOR (processor));
+  g_return_if_fail (level >= 0 && level < GEGL_CACHE_VALID_MIPMAPS);
+
+  processor->coarse_level = level;
+  gegl_processor_restart (processor);
+}
+
+gint
+gegl_processor_get_rendered_level (GeglProcessor *processor)
+{
+  g_return_val_if_fail (GEGL_IS_PROCESSOR (processor), -1);
+
+  return processor->rendered_level;
+}
+
+void
+gegl_processor_add_priority_rectangle (GeglProcessor       *processor,
+                                       const GeglRectangle *rectangle)
+{
+  g_return_if_fail (GEGL_IS_PROCESSOR (processor));
+  g_return_if_fail (rectangle != NULL);
+
+  g_array_append_val (processor->priorities, *rectangle);
+
+  /* the queued work is recomputed according to the new priorities */
+  gegl_processor_clear_dirty_rectangles (processor);
+  gegl_processor_scale_priorities (processor);
+}
+
+void
+gegl_processor_clear_priority_rectangles (GeglProcessor *processor)
+{
+  g_return_if_fail (GEGL_IS_PROCESSOR (processor));
+
+  g_array_set_size (processor->priorities, 0);
+
+  gegl_processor_clear_dirty_rectangles (processor);
+  gegl_processor_scale_priorities (processor);
+}
+
+void
+gegl_processor_cancel (GeglProcessor *processor)
+{
+  g_return_if_fail (GEGL_IS_PROCESSOR (processor));
+
+  gegl_processor_clear_dirty_rectangles (processor);
+
+  gegl_region_destroy (processor->queued_region);
+  processor->queued_region = gegl_region_new ();
+
+  /* a sink needing the full input isn't written to with partial results.
+   * the context is set up again when the processor is restarted, by
+   * setting its rectangle or level.
+   */
+  g_clear_pointer (&processor->context, gegl_operation_context_destroy);
+
+  processor->cancelled = TRUE;
+}
+
+guint64
+gegl_processor_get_pixels_reused (void)
+{
+  return (guintptr) g_atomic_pointer_get (&pixels_reused);
+}
+
+guint64
+gegl_processor_get_pixels_rendered (void)
+{
+  return (guintptr) g_atomic_pointer_get (&pixels_rendered);
+}
+
+void
+gegl_processor_reset_stats (void)
+{
+  g_atomic_pointer_set (&pixels_reused,   0);
+  g_atomic_pointer_set (&pixels_rendered, 0);
 }
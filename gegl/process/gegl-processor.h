@@ -29,6 +29,17 @@ G_BEGIN_DECLS
  * non GUI tasks using #gegl_node_blit and #gegl_node_process directly
  * should be sufficient. See #gegl_processor_work for a code sample.
  *
+ * When its "parallel" property is set, and all the operations of the graph
+ * are threaded, a processor rendering into a cache renders several chunks
+ * aligned to the tile grid at once, writing them directly into the cache.
+ *
+ * For interactive use, a processor can render the parts of its rectangle
+ * inside priority rectangles first, such as the center of a viewport, and
+ * can first render a coarse mipmap level, refining it level by level.
+ * Work that became stale, e.g. after panning, can be dropped with
+ * #gegl_processor_cancel, or retargeted with #gegl_processor_set_rectangle;
+ * the parts already in the cache are not rendered again.
+ *
  */
 
 /**
@@ -79,6 +90,61 @@ void           gegl_processor_set_rectangle (GeglProcessor       *processor,
 gboolean       gegl_processor_work          (GeglProcessor *processor,
                                              gdouble       *progress);
 
+/**
+ * gegl_processor_set_coarse_level:
+ * @processor: a #GeglProcessor
+ * @level: the mipmap level to start rendering at
+ *
+ * When @level is coarser than the processor's level, the rectangle is first
+ * rendered at @level, and then refined one level at a time, down to the
+ * processor's level, so that a preview is available early.  Has no effect
+ * on processors of sink nodes.
+ */
+void           gegl_processor_set_coarse_level (GeglProcessor *processor,
+                                                gint           level);
+
+/**
+ * gegl_processor_get_rendered_level:
+ * @processor: a #GeglProcessor
+ *
+ * Returns the finest mipmap level at which the processor's rectangle has
+ * been completely rendered, or -1 if there is none yet.
+ */
+gint           gegl_processor_get_rendered_level (GeglProcessor *processor);
+
+/**
+ * gegl_processor_add_priority_rectangle:
+ * @processor: a #GeglProcessor
+ * @rectangle: the #GeglRectangle to render first, in level 0 coordinates
+ *
+ * Makes the processor render the part of its rectangle inside @rectangle
+ * before the rest, starting from its center.  Rectangles added earlier
+ * take precedence over ones added later; once all of them are rendered,
+ * the rest of the rectangle is rendered outwards from the center of the
+ * first one.
+ */
+void           gegl_processor_add_priority_rectangle (GeglProcessor       *processor,
+                                                      const GeglRectangle *rectangle);
+
+/**
+ * gegl_processor_clear_priority_rectangles:
+ * @processor: a #GeglProcessor
+ *
+ * Removes all priority rectangles, see
+ * #gegl_processor_add_priority_rectangle.
+ */
+void           gegl_processor_clear_priority_rectangles (GeglProcessor *processor);
+
+/**
+ * gegl_processor_cancel:
+ * @processor: a #GeglProcessor
+ *
+ * Drops all the queued work of the processor, after which
+ * #gegl_processor_work returns FALSE, until a new rectangle or level is set.
+ * The parts already rendered stay in the cache.
+ */
+void           gegl_processor_cancel        (GeglProcessor *processor);
+
 G_END_DECLS
 
 #endif /* __GEGL_PROCESSOR_H__ */
@@ -59,8 +59,8 @@ hor_blur (GeglBuffer          *src,
   gfloat *dst_buf;
   gfloat rad1 = 1.0 / (gfloat)(radius * 2 + 1);
 
-  src_buf = g_new0 (gfloat, src_rect->width * src_rect->height * 4);
-  dst_buf = g_new0 (gfloat, dst_rect->width * dst_rect->height * 4);
+  src_buf = gegl_scratch_new  (gfloat, src_rect->width * src_rect->height * 4);
+  dst_buf = gegl_scratch_new0 (gfloat, dst_rect->width * dst_rect->height * 4);
 
   gegl_buffer_get (src, src_rect, 1.0, format,
                    src_buf, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_CLAMP);
@@ -97,8 +97,8 @@ hor_blur (GeglBuffer          *src,
   gegl_buffer_set (dst, dst_rect, 0, format,
                    dst_buf, GEGL_AUTO_ROWSTRIDE);
 
-  g_free (src_buf);
-  g_free (dst_buf);
+  gegl_scratch_free (dst_buf);
+  gegl_scratch_free (src_buf);
 }
 
 static void
@@ -120,8 +120,8 @@ ver_blur (GeglBuffer          *src,
   gfloat *dst_buf;
   gfloat rad1 = 1.0 / (gfloat)(radius * 2 + 1);
 
-  src_buf = g_new0 (gfloat, src_rect->width * src_rect->height * 4);
-  dst_buf = g_new0 (gfloat, dst_rect->width * dst_rect->height * 4);
+  src_buf = gegl_scratch_new  (gfloat, src_rect->width * src_rect->height * 4);
+  dst_buf = gegl_scratch_new0 (gfloat, dst_rect->width * dst_rect->height * 4);
 
   gegl_buffer_get (src, src_rect, 1.0, format,
                    src_buf, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_CLAMP);
@@ -159,8 +159,8 @@ ver_blur (GeglBuffer          *src,
   gegl_buffer_set (dst, dst_rect, 0, format,
                    dst_buf, GEGL_AUTO_ROWSTRIDE);
 
-  g_free (src_buf);
-  g_free (dst_buf);
+  gegl_scratch_free (dst_buf);
+  gegl_scratch_free (src_buf);
 }
 
 #undef SRC_OFFSET
@@ -83,6 +83,7 @@ static void prepare (GeglOperation *operation)
 /* For GeglOperationPointFilter subclasses, we operate on linear
  * buffers with a pixel count.
  */
+GEGL_OP_SIMD_CLONES
 static gboolean
 process (GeglOperation       *op,
          void                *in_buf,
@@ -222,6 +222,8 @@ gegl_op_class_init (GeglOpClass *klass)
       NULL);
 
   operation_class->no_cache = TRUE;
+  /* process() only hands out the buffer, and may be called concurrently */
+  operation_class->threaded = TRUE;
 }
 
 #endif
@@ -131,6 +131,7 @@ preprocess (GeglProperties *o)
 /* GeglOperationPointFilter gives us a linear buffer to operate on
  * in our requested pixel format
  */
+GEGL_OP_SIMD_CLONES
 static gboolean
 process (GeglOperation       *op,
          void                *in_buf,
@@ -122,6 +122,7 @@ static const char* kernel_source_ya =
 "  out[gid]  =  out_v;                                                   \n"
 "}                                                                       \n";
 
+GEGL_OP_SIMD_CLONES
 static void
 process_rgb (GeglOperation       *op,
              void                *in_buf,
@@ -140,6 +141,7 @@ process_rgb (GeglOperation       *op,
   gfloat      white;
 
   glong       i;
+  gint        c;
 
   in_pixel = in_buf;
   out_pixel = out_buf;
@@ -148,17 +150,17 @@ process_rgb (GeglOperation       *op,
   diff = MAX (white - black_level, 0.000001);
   gain = 1.0f / diff;
 
-  for (i=0; i<n_pixels; i++)
+  for (c = 0; c < 3; c++)
     {
-      out_pixel[0] = (in_pixel[0] - black_level) * gain;
-      out_pixel[1] = (in_pixel[1] - black_level) * gain;
-      out_pixel[2] = (in_pixel[2] - black_level) * gain;
+      const gfloat *in  = in_pixel  + c * n_pixels;
+      gfloat       *out = out_pixel + c * n_pixels;
 
-      out_pixel += 3;
-      in_pixel  += 3;
+      for (i=0; i<n_pixels; i++)
+        out[i] = (in[i] - black_level) * gain;
     }
 }
 
+GEGL_OP_SIMD_CLONES
 static void
 process_rgba (GeglOperation       *op,
               void                *in_buf,
@@ -177,6 +179,7 @@ process_rgba (GeglOperation       *op,
   gfloat      white;
   
   glong       i;
+  gint        c;
 
   in_pixel = in_buf;
   out_pixel = out_buf;
@@ -185,18 +188,20 @@ process_rgba (GeglOperation       *op,
   diff = MAX (white - black_level, 0.000001);
   gain = 1.0f / diff;
 
-  for (i=0; i<n_pixels; i++)
+  for (c = 0; c < 3; c++)
     {
-      out_pixel[0] = (in_pixel[0] - black_level) * gain;
-      out_pixel[1] = (in_pixel[1] - black_level) * gain;
-      out_pixel[2] = (in_pixel[2] - black_level) * gain;
-      out_pixel[3] = in_pixel[3];
-      
-      out_pixel += 4;
-      in_pixel  += 4;
+      const gfloat *in  = in_pixel  + c * n_pixels;
+      gfloat       *out = out_pixel + c * n_pixels;
+
+      for (i=0; i<n_pixels; i++)
+        out[i] = (in[i] - black_level) * gain;
     }
+
+  memcpy (out_pixel + 3 * n_pixels, in_pixel + 3 * n_pixels,
+          n_pixels * sizeof (gfloat));
 }
 
+GEGL_OP_SIMD_CLONES
 static void
 process_y (GeglOperation       *op,
            void                *in_buf,
@@ -232,6 +237,7 @@ process_y (GeglOperation       *op,
     }
 }
 
+GEGL_OP_SIMD_CLONES
 static void
 process_ya (GeglOperation       *op,
             void                *in_buf,
@@ -259,13 +265,10 @@ process_ya (GeglOperation       *op,
   gain = 1.0f / diff;
 
   for (i=0; i<n_pixels; i++)
-    {
-      out_pixel[0] = (in_pixel[0] - black_level) * gain;
-      out_pixel[1] = in_pixel[1];
+    out_pixel[i] = (in_pixel[i] - black_level) * gain;
 
-      out_pixel += 2;
-      in_pixel  += 2;
-    }
+  memcpy (out_pixel + n_pixels, in_pixel + n_pixels,
+          n_pixels * sizeof (gfloat));
 }
 
 static void
@@ -354,7 +357,8 @@ prepare (GeglOperation *operation)
 }
 
 /* GeglOperationPointFilter gives us a linear buffer to operate on
- * in our requested pixel format
+ * in our requested pixel format, with the components stored in separate
+ * planes, see gegl_buffer_iterator_set_planar()
  */
 static gboolean
 process (GeglOperation       *operation,
@@ -452,6 +456,7 @@ gegl_op_class_init (GeglOpClass *klass)
   object_class->finalize = finalize;
 
   operation_class->opencl_support = TRUE;
+  operation_class->planar         = TRUE;
   operation_class->prepare        = prepare;
 
   point_filter_class->process    = process;
@@ -615,8 +615,8 @@ iir_young_hor_blur (IirYoungBlur1dFunc   real_blur_1D,
 {
   GeglRectangle  cur_row = *rect;
   const gint     nc = babl_format_get_n_components (format);
-  gfloat        *row = g_new (gfloat, (3 + rect->width + 3) * nc);
-  gdouble       *tmp = g_new (gdouble, (3 + rect->width + 3) * nc);
+  gfloat        *row = gegl_scratch_new (gfloat, (3 + rect->width + 3) * nc);
+  gdouble       *tmp = gegl_scratch_new (gdouble, (3 + rect->width + 3) * nc);
   gint           v;
 
   cur_row.height = 1;
@@ -638,8 +638,8 @@ iir_young_hor_blur (IirYoungBlur1dFunc   real_blur_1D,
                        GEGL_AUTO_ROWSTRIDE);
     }
 
-  g_free (tmp);
-  g_free (row);
+  gegl_scratch_free (tmp);
+  gegl_scratch_free (row);
 }
 
 static void
@@ -655,8 +655,8 @@ iir_young_ver_blur (IirYoungBlur1dFunc   real_blur_1D,
 {
   GeglRectangle  cur_col = *rect;
   const gint     nc = babl_format_get_n_components (format);
-  gfloat        *col = g_new (gfloat, (3 + rect->height + 3) * nc);
-  gdouble       *tmp = g_new (gdouble, (3 + rect->height + 3) * nc);
+  gfloat        *col = gegl_scratch_new (gfloat, (3 + rect->height + 3) * nc);
+  gdouble       *tmp = gegl_scratch_new (gdouble, (3 + rect->height + 3) * nc);
   gint           i;
 
   cur_col.width = 1;
@@ -678,8 +678,8 @@ iir_young_ver_blur (IirYoungBlur1dFunc   real_blur_1D,
                        GEGL_AUTO_ROWSTRIDE);
     }
 
-  g_free (tmp);
-  g_free (col);
+  gegl_scratch_free (tmp);
+  gegl_scratch_free (col);
 }
 
 
@@ -738,8 +738,8 @@ fir_hor_blur (GeglBuffer          *src,
   in_row.width  += clen - 1;
   in_row.x      -= clen / 2;
 
-  row = gegl_malloc (sizeof (gfloat) * in_row.width  * nc);
-  out = gegl_malloc (sizeof (gfloat) * cur_row.width * nc);
+  row = gegl_scratch_new (gfloat, in_row.width  * nc);
+  out = gegl_scratch_new (gfloat, cur_row.width * nc);
 
   for (v = 0; v < rect->height; v++)
     {
@@ -752,8 +752,8 @@ fir_hor_blur (GeglBuffer          *src,
       gegl_buffer_set (dst, &cur_row, level, format, out, GEGL_AUTO_ROWSTRIDE);
     }
 
-  gegl_free (out);
-  gegl_free (row);
+  gegl_scratch_free (out);
+  gegl_scratch_free (row);
 }
 
 static void
@@ -779,8 +779,8 @@ fir_ver_blur (GeglBuffer          *src,
   in_col.height += clen - 1;
   in_col.y      -= clen / 2;
 
-  col = gegl_malloc (sizeof (gfloat) * in_col.height  * nc);
-  out = gegl_malloc (sizeof (gfloat) * cur_col.height * nc);
+  col = gegl_scratch_new (gfloat, in_col.height  * nc);
+  out = gegl_scratch_new (gfloat, cur_col.height * nc);
 
   for (v = 0; v < rect->width; v++)
     {
@@ -793,8 +793,8 @@ fir_ver_blur (GeglBuffer          *src,
       gegl_buffer_set (dst, &cur_col, level, format, out, GEGL_AUTO_ROWSTRIDE);
     }
 
-  gegl_free (out);
-  gegl_free (col);
+  gegl_scratch_free (out);
+  gegl_scratch_free (col);
 }
 
 
@@ -40,6 +40,7 @@ prepare (GeglOperation *operation)
   gegl_operation_set_format (operation, "output", babl_format_with_space ("R'G'B'A float", space));
 }
 
+GEGL_OP_SIMD_CLONES
 static gboolean
 process (GeglOperation       *op,
          void                *in_buf,
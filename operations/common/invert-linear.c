@@ -32,6 +32,7 @@
 
 #include "gegl-op.h"
 
+GEGL_OP_SIMD_CLONES
 static gboolean
 process (GeglOperation       *op,
          void                *in_buf,
@@ -52,8 +52,10 @@ property_double (out_high, _("High output"), 1.0)
 #include "gegl-op.h"
 
 /* GeglOperationPointFilter gives us a linear buffer to operate on
- * in our requested pixel format
+ * in our requested pixel format, with the components stored in separate
+ * planes, see gegl_buffer_iterator_set_planar()
  */
+GEGL_OP_SIMD_CLONES
 static gboolean
 process (GeglOperation       *op,
          void                *in_buf,
@@ -71,6 +73,7 @@ process (GeglOperation       *op,
   gfloat      out_offset;
   gfloat      scale;
   glong       i;
+  gint        c;
 
   in_pixel = in_buf;
   out_pixel = out_buf;
@@ -85,15 +88,18 @@ process (GeglOperation       *op,
 
   scale = out_range/in_range;
 
-  for (i=0; i<n_pixels; i++)
+  for (c = 0; c < 3; c++)
     {
-      int c;
-      for (c=0;c<3;c++)
-        out_pixel[c] = (in_pixel[c]- in_offset) * scale + out_offset;
-      out_pixel[3] = in_pixel[3];
-      out_pixel += 4;
-      in_pixel += 4;
+      const gfloat *in  = in_pixel  + c * n_pixels;
+      gfloat       *out = out_pixel + c * n_pixels;
+
+      for (i = 0; i < n_pixels; i++)
+        out[i] = (in[i] - in_offset) * scale + out_offset;
     }
+
+  memcpy (out_pixel + 3 * n_pixels, in_pixel + 3 * n_pixels,
+          n_pixels * sizeof (gfloat));
+
   return TRUE;
 }
 
@@ -197,6 +203,7 @@ gegl_op_class_init (GeglOpClass *klass)
   point_filter_class->cl_process = cl_process;
 
   operation_class->opencl_support = TRUE;
+  operation_class->planar         = TRUE;
 
   gegl_operation_class_set_keys (operation_class,
     "name",        "gegl:levels",
@@ -523,7 +523,7 @@ convert_values_to_bins (Histogram *hist,
     {
       for (c = 0; c < n_components; c++)
         {
-          hist->components[c].bins       = g_new0 (gint, DEFAULT_N_BINS);
+          hist->components[c].bins       = gegl_scratch_new0 (gint, DEFAULT_N_BINS);
           hist->components[c].bin_values = default_bin_values;
         }
 
@@ -546,13 +546,13 @@ convert_values_to_bins (Histogram *hist,
     }
   else
     {
-      InputValue *values       = g_new (InputValue, n_pixels);
-      InputValue *scratch      = g_new (InputValue, n_pixels);
+      InputValue *values       = gegl_scratch_new (InputValue, n_pixels);
+      InputValue *scratch      = gegl_scratch_new (InputValue, n_pixels);
       gint       *alpha_values = NULL;
 
       if (has_alpha)
         {
-          alpha_values = g_new (gint, n_pixels);
+          alpha_values = gegl_scratch_new (gint, n_pixels);
 
           hist->alpha_values = alpha_values;
         }
@@ -573,7 +573,7 @@ convert_values_to_bins (Histogram *hist,
 
           prev_value = values[0].value;
 
-          bin_values    = g_new (gfloat, n_pixels);
+          bin_values    = gegl_scratch_new (gfloat, n_pixels);
           bin_values[0] = prev_value;
           if (c == n_color_components)
             {
@@ -602,12 +602,12 @@ convert_values_to_bins (Histogram *hist,
                 values[i].value = ((gfloat *) p)[1];
             }
 
-          hist->components[c].bins       = g_new0 (gint, bin + 1);
+          hist->components[c].bins       = gegl_scratch_new0 (gint, bin + 1);
           hist->components[c].bin_values = bin_values;
         }
 
-      g_free (scratch);
-      g_free (values);
+      gegl_scratch_free (scratch);
+      gegl_scratch_free (values);
     }
 }
 
@@ -838,8 +838,8 @@ process (GeglOperation       *operation,
   dst_stride   = roi->width * n_components;
   n_src_pixels = src_rect.width * src_rect.height;
   n_dst_pixels = roi->width * roi->height;
-  src_buf = g_new (gint32, n_src_pixels * n_components);
-  dst_buf = g_new (gfloat, n_dst_pixels * n_components);
+  src_buf = gegl_scratch_new (gint32, n_src_pixels * n_components);
+  dst_buf = gegl_scratch_new (gfloat, n_dst_pixels * n_components);
 
   gegl_buffer_get (input, &src_rect, 1.0, format, src_buf,
                    GEGL_AUTO_ROWSTRIDE, get_abyss_policy (operation, "input"));
@@ -938,18 +938,18 @@ process (GeglOperation       *operation,
 
   for (c = 0; c < n_components; c++)
     {
-      g_free (hist->components[c].bins);
+      gegl_scratch_free (hist->components[c].bins);
 
       if (! data->quantize)
-        g_free (hist->components[c].bin_values);
+        gegl_scratch_free (hist->components[c].bin_values);
     }
 
   if (! data->quantize && has_alpha)
-    g_free (hist->alpha_values);
+    gegl_scratch_free (hist->alpha_values);
 
   g_slice_free (Histogram, hist);
-  g_free (dst_buf);
-  g_free (src_buf);
+  gegl_scratch_free (dst_buf);
+  gegl_scratch_free (src_buf);
 
   return TRUE;
 }
@@ -53,6 +53,7 @@ prepare (GeglOperation *operation)
   gegl_operation_set_format (operation, "output", babl_format_with_space ("YA float", space));
 }
 
+GEGL_OP_SIMD_CLONES
 static gboolean
 process (GeglOperation       *op,
          void                *in_buf,
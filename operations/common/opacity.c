@@ -56,6 +56,7 @@ prepare (GeglOperation *self)
   return;
 }
 
+GEGL_OP_SIMD_CLONES
 static void
 process_premultiplied_float (GeglOperation       *op,
                       void                *in_buf,
@@ -105,6 +106,7 @@ process_premultiplied_float (GeglOperation       *op,
       }
 }
 
+GEGL_OP_SIMD_CLONES
 static void
 process_with_alpha_float (GeglOperation       *op,
                           void                *in_buf,
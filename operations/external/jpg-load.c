@@ -154,7 +154,7 @@ static void
 gio_source_destroy(j_decompress_ptr cinfo)
 {
     GioSource *self = (GioSource *)cinfo->client_data;
-    g_free(self->buffer);
+    g_clear_pointer(&self->buffer, g_free);
 }
 
 static void
@@ -194,147 +194,267 @@ static const Babl *jpg_get_space (struct jpeg_decompress_struct *cinfo)
   return NULL;
 }
 
-static gint
-gegl_jpg_load_query_jpg (GInputStream *stream,
-                         gint         *width,
-                         gint         *height,
-                         const Babl  **out_format)
+/* rows are decoded, and written to the output, in chunks of about this many
+ * bytes
+ */
+#define CHUNK_SIZE (1 << 20)
+
+/* libjpeg can scale the image down by up to 8x while decoding it, by only
+ * using the lower frequencies of each block; mipmap levels above that are
+ * built from the last one by the buffer.
+ */
+#define MAX_LEVEL 3
+
+typedef struct
 {
+  GFile                         *file;
+  gchar                         *etag; /* the entity tag of the file when
+                                        * the header was read */
+  GInputStream                  *stream;
+  GioSource                      gio_source;
+
   struct jpeg_decompress_struct  cinfo;
   struct jpeg_error_mgr          jerr;
   struct jpeg_source_mgr         src;
-  gint                           status = 0;
-  const Babl *format = NULL;
-  GioSource gio_source = { stream, NULL, 1024 };
-
-  cinfo.err = jpeg_std_error (&jerr);
-  jpeg_create_decompress (&cinfo);
-  setup_read_icc_profile (&cinfo);
+  gboolean                       created;
+  gboolean                       decompressing;
 
-  gio_source_enable(&cinfo, &src, &gio_source);
+  /* the mipmap level the image is decompressed at */
+  gint                           level;
 
-  (void) jpeg_read_header (&cinfo, TRUE);
+  const Babl                    *format;
+  gint                           width;
+  gint                           height;
+} Priv;
 
-  format = babl_from_jpeg_colorspace(cinfo.out_color_space,
-                                     jpg_get_space (&cinfo));
-  if (width)
-    *width = cinfo.image_width;
-  if (height)
-    *height = cinfo.image_height;
-  if (out_format)
-    *out_format = format;
-  if (!format)
+static void
+gegl_jpg_load_decoder_close (Priv *p)
+{
+  if (p->created)
     {
-      g_warning ("attempted to load JPEG with unsupported color space: '%s'",
-                 jpeg_colorspace_name(cinfo.out_color_space));
-      status = -1;
+      jpeg_destroy_decompress (&p->cinfo);
+      p->created       = FALSE;
+      p->decompressing = FALSE;
     }
 
-  jpeg_destroy_decompress (&cinfo);
+  g_clear_pointer (&p->gio_source.buffer, g_free);
 
-  return status;
+  if (p->stream)
+    {
+      g_input_stream_close (p->stream, NULL, NULL);
+      g_clear_object (&p->stream);
+    }
 }
 
+/* opens the file and reads its header.  decompression is started separately,
+ * once the mipmap level to decode at is known.
+ */
 static gint
-gegl_jpg_load_buffer_import_jpg (GeglBuffer   *gegl_buffer,
-                                 GInputStream *stream,
-                                 gint          dest_x,
-                                 gint          dest_y)
+gegl_jpg_load_decoder_open (GeglOperation  *operation,
+                            GError        **err)
 {
-  gint row_stride;
-  struct jpeg_decompress_struct  cinfo;
-  struct jpeg_error_mgr          jerr;
-  struct jpeg_source_mgr         src;
-  JSAMPARRAY                     buffer;
-  const Babl                    *format;
-  GeglRectangle                  write_rect;
-  GioSource gio_source = { stream, NULL, 1024 };
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  Priv           *p = (Priv *) o->user_data;
+  gchar          *etag;
+
+  g_clear_object (&p->file);
+  p->stream = gegl_gio_open_input_stream (o->uri, o->path, &p->file, err);
+  if (!p->stream)
+    return -1;
+
+  /* when reopening the decoder for rows it has passed, or for another
+   * level, the file must still be the one whose header prepare() read;
+   * otherwise, fail, and let the next prepare() start over.
+   */
+  etag = gegl_gio_get_stream_etag (p->stream);
+
+  if (p->format && g_strcmp0 (etag, p->etag))
+    {
+      g_set_error_literal (err, G_IO_ERROR, G_IO_ERROR_FAILED,
+                           "file changed since it was prepared");
+      g_free (etag);
+      return -1;
+    }
 
-  cinfo.err = jpeg_std_error (&jerr);
-  jpeg_create_decompress (&cinfo);
-  setup_read_icc_profile (&cinfo);
+  g_free (p->etag);
+  p->etag = etag;
 
-  gio_source_enable(&cinfo, &src, &gio_source);
+  p->gio_source.stream      = p->stream;
+  p->gio_source.buffer      = NULL;
+  p->gio_source.buffer_size = 1024;
 
-  (void) jpeg_read_header (&cinfo, TRUE);
+  p->cinfo.err = jpeg_std_error (&p->jerr);
+  jpeg_create_decompress (&p->cinfo);
+  p->created = TRUE;
+  setup_read_icc_profile (&p->cinfo);
 
-  /* This is the most accurate method and could be the fastest too. But
-   * the results may vary on different platforms due to different
-   * rounding behavior and precision.
-   */
-  cinfo.dct_method = JDCT_FLOAT;
+  gio_source_enable(&p->cinfo, &p->src, &p->gio_source);
 
-  (void) jpeg_start_decompress (&cinfo);
+  (void) jpeg_read_header (&p->cinfo, TRUE);
 
-  format = babl_from_jpeg_colorspace(cinfo.out_color_space,
-                                     jpg_get_space (&cinfo));
-  if (!format)
+  p->format = babl_from_jpeg_colorspace(p->cinfo.out_color_space,
+                                        jpg_get_space (&p->cinfo));
+  if (!p->format)
     {
       g_warning ("attempted to load JPEG with unsupported color space: '%s'",
-                 jpeg_colorspace_name(cinfo.out_color_space));
-      jpeg_destroy_decompress (&cinfo);
+                 jpeg_colorspace_name(p->cinfo.out_color_space));
+      gegl_jpg_load_decoder_close (p);
       return -1;
     }
 
-  row_stride = cinfo.output_width * cinfo.output_components;
+  p->width  = p->cinfo.image_width;
+  p->height = p->cinfo.image_height;
+
+  return 0;
+}
+
+static void
+gegl_jpg_load_decoder_start (Priv *p,
+                             gint  level)
+{
+  g_return_if_fail (p->created && ! p->decompressing);
+
+  /* This is the most accurate method and could be the fastest too. But
+   * the results may vary on different platforms due to different
+   * rounding behavior and precision.
+   */
+  p->cinfo.dct_method = JDCT_FLOAT;
+
+  p->cinfo.scale_num   = 1;
+  p->cinfo.scale_denom = 1 << level;
 
-  if ((row_stride) % 2)
-    (row_stride)++;
+  (void) jpeg_start_decompress (&p->cinfo);
 
-  /* allocated with the jpeg library, and freed with the decompress context */
-  buffer = (*cinfo.mem->alloc_sarray)
-    ((j_common_ptr) &cinfo, JPOOL_IMAGE, row_stride, 1);
+  p->decompressing = TRUE;
+  p->level         = level;
+}
 
-  write_rect.x = dest_x;
-  write_rect.y = dest_y;
-  write_rect.width  = cinfo.output_width;
-  write_rect.height = 1;
+/* decodes the rows of @rows, in the coordinates of the decoder's level, into
+ * the same level of @output, skipping the rows before it.  the decoder only
+ * moves forward, so it has to be reopened to read rows it has already passed.
+ */
+static gint
+gegl_jpg_load_decoder_read_rows (Priv                *p,
+                                 GeglBuffer          *output,
+                                 const GeglRectangle *rows)
+{
+  struct jpeg_decompress_struct *cinfo = &p->cinfo;
+  gint                           row_stride;
+  gint                           end;
+  gint                           n_rows;
+  guchar                        *pixels;
+  JSAMPROW                      *row_p;
+  gint                           i;
+
+  g_return_val_if_fail (p->decompressing, -1);
+  g_return_val_if_fail ((gint) cinfo->output_scanline <= rows->y, -1);
+
+  row_stride = cinfo->output_width * cinfo->output_components;
+  end        = MIN (rows->y + rows->height, (gint) cinfo->output_height);
+  n_rows     = CLAMP (CHUNK_SIZE / row_stride, 1, rows->height);
+
+  pixels = g_malloc (n_rows * row_stride);
+  row_p  = g_new (JSAMPROW, n_rows);
+
+  for (i = 0; i < n_rows; i++)
+    row_p[i] = pixels + i * row_stride;
+
+#ifdef HAVE_JPEG_SKIP_SCANLINES
+  if ((gint) cinfo->output_scanline < rows->y)
+    jpeg_skip_scanlines (cinfo, rows->y - cinfo->output_scanline);
+#endif
+
+  while ((gint) cinfo->output_scanline < rows->y)
+    jpeg_read_scanlines (cinfo, row_p, 1);
 
   // Most CMYK JPEG files are produced by Adobe Photoshop. Each component is stored where 0 means 100% ink
   // However this might not be case for all. Gory details: https://bugzilla.mozilla.org/show_bug.cgi?id=674619
   //
   // inverted cmyks are however how babl now expects jpgs so we're good
 
-  while (cinfo.output_scanline < cinfo.output_height)
+  while ((gint) cinfo->output_scanline < end)
     {
-      jpeg_read_scanlines (&cinfo, buffer, 1);
+      gint y = cinfo->output_scanline;
+      gint n = 0;
+
+      /* jpeg_read_scanlines() may return fewer rows than asked for */
+      while (n < MIN (n_rows, end - y))
+        n += jpeg_read_scanlines (cinfo, row_p + n, MIN (n_rows, end - y) - n);
 
-      gegl_buffer_set (gegl_buffer, &write_rect, 0,
-                       format, buffer[0],
-                       GEGL_AUTO_ROWSTRIDE);
-      write_rect.y += 1;
+      gegl_buffer_set (output, GEGL_RECTANGLE (0, y, cinfo->output_width, n),
+                       p->level, p->format, pixels, row_stride);
     }
 
-  jpeg_destroy_decompress (&cinfo);
+  g_free (row_p);
+  g_free (pixels);
 
   return 0;
 }
 
-static GeglRectangle
-gegl_jpg_load_get_bounding_box (GeglOperation *operation)
+static void
+gegl_jpg_load_prepare (GeglOperation *operation)
 {
-  gint width, height;
-  GeglProperties   *o = GEGL_PROPERTIES (operation);
-  const Babl *format = NULL;
-  GFile *file = NULL;
-  GError *err = NULL;
-  gint status = -1;
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  Priv           *p = (o->user_data) ? o->user_data : g_new0 (Priv, 1);
+  GError         *err = NULL;
 
-  GInputStream *stream = gegl_gio_open_input_stream(o->uri, o->path, &file, &err);
-  if (!stream)
-    return (GeglRectangle) {0, 0, 0, 0};
-  status = gegl_jpg_load_query_jpg (stream, &width, &height, &format);
-  g_input_stream_close(stream, NULL, NULL);
+  o->user_data = (void*) p;
+
+  /* start over when the file, or its contents, changed */
+  if (p->file)
+    {
+      GFile *file = NULL;
+      gchar *etag = NULL;
+
+      if (o->uri && strlen (o->uri) > 0)
+        file = g_file_new_for_uri (o->uri);
+      else if (o->path && strlen (o->path) > 0)
+        file = g_file_new_for_path (o->path);
+
+      if (file)
+        etag = gegl_gio_get_etag (file);
+
+      if (!file || !g_file_equal (p->file, file) || g_strcmp0 (p->etag, etag))
+        {
+          gegl_jpg_load_decoder_close (p);
+          g_clear_object (&p->file);
+          p->format = NULL;
+        }
+
+      g_clear_object (&file);
+      g_free (etag);
+    }
+
+  /* the decoder is only needed here for the header; once the image has
+   * been decoded it stays closed until process() needs rows again.
+   */
+  if (!p->format && gegl_jpg_load_decoder_open (operation, &err))
+    {
+      if (err)
+        {
+          g_warning ("%s failed to open file %s for reading: %s",
+                     G_OBJECT_TYPE_NAME (operation), o->path, err->message);
+          g_clear_error (&err);
+        }
+
+      gegl_jpg_load_decoder_close (p);
+      p->format = NULL;
+    }
 
-  if (format)
-    gegl_operation_set_format (operation, "output", format);
+  if (p->format)
+    gegl_operation_set_format (operation, "output", p->format);
+}
+
+static GeglRectangle
+gegl_jpg_load_get_bounding_box (GeglOperation *operation)
+{
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  Priv           *p = (Priv *) o->user_data;
 
-  g_object_unref(stream);
-  g_clear_object(&file);
-  if (err || status)
+  if (!p || !p->format)
     return (GeglRectangle) {0, 0, 0, 0};
   else
-    return (GeglRectangle) {0, 0, width, height};
+    return (GeglRectangle) {0, 0, p->width, p->height};
 }
 
 static gboolean
@@ -344,32 +464,94 @@ gegl_jpg_load_process (GeglOperation       *operation,
                        gint                 level)
 {
   GeglProperties *o = GEGL_PROPERTIES (operation);
-  GFile *file = NULL;
-  GError *err = NULL;
-  gint status = -1;
-  GInputStream *stream = gegl_gio_open_input_stream(o->uri, o->path, &file, &err);
-  if (!stream)
-    return FALSE;
-  status = gegl_jpg_load_buffer_import_jpg(output, stream, 0, 0);
-  g_input_stream_close(stream, NULL, NULL);
+  Priv           *p = (Priv *) o->user_data;
+  GError         *err = NULL;
+  GeglRectangle   rows;
+
+  /* when rendering a mipmap level, let libjpeg decode the image at the
+   * reduced size, and write the rows straight to that level of the output.
+   */
+  level = MIN (level, MAX_LEVEL);
 
-  if (err)
+  rows.x      = 0;
+  rows.y      = result->y >> level;
+  rows.width  = (p->width + (1 << level) - 1) >> level;
+  rows.height = ((result->y + result->height + (1 << level) - 1) >> level) -
+                rows.y;
+
+  if (p->decompressing &&
+      (p->level != level || (gint) p->cinfo.output_scanline > rows.y))
+    gegl_jpg_load_decoder_close (p);
+
+  if (!p->created && gegl_jpg_load_decoder_open (operation, &err))
     {
-      g_warning ("%s failed to open file %s for reading: %s",
-        G_OBJECT_TYPE_NAME (operation), o->path, err->message);
-      g_object_unref(stream);
+      if (err)
+        {
+          g_warning ("%s failed to open file %s for reading: %s",
+                     G_OBJECT_TYPE_NAME (operation), o->path, err->message);
+          g_clear_error (&err);
+        }
+
+      gegl_jpg_load_decoder_close (p);
       return FALSE;
     }
 
-  g_object_unref(stream);
-  return status != 1;
+  if (!p->decompressing)
+    gegl_jpg_load_decoder_start (p, level);
+
+  if (gegl_jpg_load_decoder_read_rows (p, output, &rows))
+    return FALSE;
+
+  /* the whole image has been decoded, don't hold on to the file */
+  if (p->cinfo.output_scanline == p->cinfo.output_height)
+    gegl_jpg_load_decoder_close (p);
+
+  return TRUE;
 }
 
+/* the image is decoded on demand, in full-width bands of rows, while the cache
+ * keeps track of the rows decoded so far.  the rows the decoder has to pass
+ * to reach @roi are decoded and cached as well, so that they don't require
+ * reopening the file later.
+ */
 static GeglRectangle
 gegl_jpg_load_get_cached_region (GeglOperation       *operation,
                                  const GeglRectangle *roi)
 {
-  return gegl_jpg_load_get_bounding_box (operation);
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  Priv           *p = (Priv *) o->user_data;
+  GeglRectangle   result = gegl_jpg_load_get_bounding_box (operation);
+  gint            position = 0;
+  gint            start;
+
+  if (p && p->decompressing)
+    position = (gint) p->cinfo.output_scanline << p->level;
+
+  start = roi->y >= position ? position : 0;
+
+  gegl_rectangle_intersect (&result, &result,
+                            GEGL_RECTANGLE (result.x, start, result.width,
+                                            roi->y + roi->height - start));
+
+  return result;
+}
+
+static void
+gegl_jpg_load_finalize (GObject *object)
+{
+  GeglProperties *o = GEGL_PROPERTIES (object);
+
+  if (o->user_data)
+    {
+      Priv *p = (Priv *) o->user_data;
+
+      gegl_jpg_load_decoder_close (p);
+      g_clear_object (&p->file);
+      g_clear_pointer (&p->etag, g_free);
+      g_clear_pointer (&o->user_data, g_free);
+    }
+
+  G_OBJECT_CLASS (gegl_op_parent_class)->finalize (object);
 }
 
 static void
@@ -378,10 +560,13 @@ gegl_op_class_init (GeglOpClass *klass)
   GeglOperationClass       *operation_class;
   GeglOperationSourceClass *source_class;
 
+  G_OBJECT_CLASS (klass)->finalize = gegl_jpg_load_finalize;
+
   operation_class = GEGL_OPERATION_CLASS (klass);
   source_class    = GEGL_OPERATION_SOURCE_CLASS (klass);
 
   source_class->process = gegl_jpg_load_process;
+  operation_class->prepare = gegl_jpg_load_prepare;
   operation_class->get_bounding_box = gegl_jpg_load_get_bounding_box;
   operation_class->get_cached_region = gegl_jpg_load_get_cached_region;
 
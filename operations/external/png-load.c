@@ -48,7 +48,8 @@ do { \
 
 typedef enum {
   LOAD_PNG_TOO_SHORT,
-  LOAD_PNG_WRONG_HEADER
+  LOAD_PNG_WRONG_HEADER,
+  LOAD_PNG_CHANGED
 } LoadPngErrors;
 
 static GQuark error_quark(void)
@@ -212,92 +213,140 @@ gegl_png_space (png_structp load_png_ptr,
   return NULL;
 }
 
+/* rows are decoded, and written to the output, in chunks of about this many
+ * bytes
+ */
+#define CHUNK_SIZE (1 << 20)
+
+typedef struct
+{
+  GFile        *file;
+  gchar        *etag; /* the entity tag of the file when the header was read */
+  GInputStream *stream;
+  png_structp   png_ptr;
+  png_infop     info_ptr;
+
+  const Babl   *format;
+  gint          width;
+  gint          height;
+  gint          bpp;
+  gint          number_of_passes;
+
+  /* the row the decoder would read next */
+  gint          next_row;
+} Priv;
+
+static void
+decoder_close (Priv *p)
+{
+  if (p->png_ptr)
+    png_destroy_read_struct (&p->png_ptr, &p->info_ptr, NULL);
+
+  if (p->stream)
+    {
+      g_input_stream_close (p->stream, NULL, NULL);
+      g_clear_object (&p->stream);
+    }
+
+  p->png_ptr  = NULL;
+  p->info_ptr = NULL;
+  p->next_row = 0;
+}
+
 static gint
-gegl_buffer_import_png (GeglBuffer  *gegl_buffer,
-                        GInputStream *stream,
-                        gint         dest_x,
-                        gint         dest_y,
-                        gint        *ret_width,
-                        gint        *ret_height,
-                        const Babl  *format, // can be NULL
-                        GError **err)
+decoder_open (GeglOperation  *operation,
+              GError        **err)
 {
-  gint           width;
-  gint           bit_depth;
-  gint           bpp;
-  gint           number_of_passes=1;
-  const Babl    *space = NULL;
-  png_uint_32    w;
-  png_uint_32    h;
-  png_structp    load_png_ptr;
-  png_infop      load_info_ptr;
-  guchar        *pixels;
-  /*png_bytep     *rows;*/
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  Priv           *p = (Priv *) o->user_data;
+  gint            bit_depth;
+  gint            bpp;
+  gint            number_of_passes=1;
+  const Babl     *space = NULL;
+  png_uint_32     w;
+  png_uint_32     h;
+  gchar          *etag;
+
+  g_clear_object (&p->file);
+  p->stream = gegl_gio_open_input_stream (o->uri, o->path, &p->file, err);
+  if (!p->stream)
+    {
+      decoder_close (p);
+      return -1;
+    }
 
+  /* when reopening the decoder for rows it has passed, the file must still
+   * be the one whose header prepare() read; otherwise, fail, and let the
+   * next prepare() start over.
+   */
+  etag = gegl_gio_get_stream_etag (p->stream);
 
-  unsigned   int i;
-  png_bytep  *row_p = NULL;
+  if (p->format && g_strcmp0 (etag, p->etag))
+    {
+      g_set_error (err, error_quark (), LOAD_PNG_CHANGED,
+                   "file changed since it was prepared");
+      g_free (etag);
+      decoder_close (p);
+      return -1;
+    }
 
-  g_return_val_if_fail(stream, -1);
+  g_free (p->etag);
+  p->etag = etag;
 
-  if (!check_valid_png_header(stream, err))
+  if (!check_valid_png_header(p->stream, err))
     {
+      decoder_close (p);
       return -1;
     }
 
-  load_png_ptr = png_create_read_struct (PNG_LIBPNG_VER_STRING, NULL, error_fn, NULL);
+  p->png_ptr = png_create_read_struct (PNG_LIBPNG_VER_STRING, NULL, error_fn, NULL);
 
-  if (!load_png_ptr)
+  if (!p->png_ptr)
     {
+      decoder_close (p);
       return -1;
     }
 
-  load_info_ptr = png_create_info_struct (load_png_ptr);
-  if (!load_info_ptr)
+  p->info_ptr = png_create_info_struct (p->png_ptr);
+  if (!p->info_ptr)
     {
-      png_destroy_read_struct (&load_png_ptr, &load_info_ptr, NULL);
+      decoder_close (p);
       return -1;
     }
-  png_set_benign_errors (load_png_ptr, TRUE);
-  png_set_option (load_png_ptr, PNG_SKIP_sRGB_CHECK_PROFILE, PNG_OPTION_ON);
+  png_set_benign_errors (p->png_ptr, TRUE);
+  png_set_option (p->png_ptr, PNG_SKIP_sRGB_CHECK_PROFILE, PNG_OPTION_ON);
 
-  if (setjmp (png_jmpbuf (load_png_ptr)))
+  if (setjmp (png_jmpbuf (p->png_ptr)))
     {
-      png_destroy_read_struct (&load_png_ptr, &load_info_ptr, NULL);
-      g_free (row_p);
+      decoder_close (p);
       return -1;
     }
 
-  png_set_read_fn(load_png_ptr, stream, read_fn);
+  png_set_read_fn(p->png_ptr, p->stream, read_fn);
 
-  png_set_sig_bytes (load_png_ptr, 8); // we already read header
-  png_read_info (load_png_ptr, load_info_ptr);
+  png_set_sig_bytes (p->png_ptr, 8); // we already read header
+  png_read_info (p->png_ptr, p->info_ptr);
   {
     int color_type;
     int interlace_type;
 
-    png_get_IHDR (load_png_ptr,
-                  load_info_ptr,
+    png_get_IHDR (p->png_ptr,
+                  p->info_ptr,
                   &w, &h,
                   &bit_depth,
                   &color_type,
                   &interlace_type,
                   NULL, NULL);
-    width = w;
-    if (ret_width)
-      *ret_width = w;
-    if (ret_height)
-      *ret_height = h;
 
     if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
       {
-        png_set_expand (load_png_ptr);
+        png_set_expand (p->png_ptr);
         bit_depth = 8;
       }
 
-    if (png_get_valid (load_png_ptr, load_info_ptr, PNG_INFO_tRNS))
+    if (png_get_valid (p->png_ptr, p->info_ptr, PNG_INFO_tRNS))
       {
-        png_set_tRNS_to_alpha (load_png_ptr);
+        png_set_tRNS_to_alpha (p->png_ptr);
         color_type |= PNG_COLOR_MASK_ALPHA;
       }
 
@@ -323,187 +372,223 @@ gegl_buffer_import_png (GeglBuffer  *gegl_buffer,
           break;
         default:
           g_warning ("color type mismatch");
-          png_destroy_read_struct (&load_png_ptr, &load_info_ptr, NULL);
+          decoder_close (p);
           return -1;
       }
 
-    space = gegl_png_space (load_png_ptr, load_info_ptr);
+    space = gegl_png_space (p->png_ptr, p->info_ptr);
 
     if (color_type == PNG_COLOR_TYPE_PALETTE)
-      png_set_palette_to_rgb (load_png_ptr);
+      png_set_palette_to_rgb (p->png_ptr);
 
     if (bit_depth == 16)
       bpp = bpp << 1;
 
-    if (!format)
-      format = get_babl_format(bit_depth, color_type, space);
+    p->format = get_babl_format(bit_depth, color_type, space);
+    if (!p->format)
+      {
+        decoder_close (p);
+        return -1;
+      }
 
 #if BYTE_ORDER == LITTLE_ENDIAN
     if (bit_depth == 16)
-      png_set_swap (load_png_ptr);
+      png_set_swap (p->png_ptr);
 #endif
 
     if (interlace_type == PNG_INTERLACE_ADAM7)
-      number_of_passes = png_set_interlace_handling (load_png_ptr);
+      number_of_passes = png_set_interlace_handling (p->png_ptr);
 
     if (!space)
     {
-    if (png_get_valid (load_png_ptr, load_info_ptr, PNG_INFO_gAMA))
+    if (png_get_valid (p->png_ptr, p->info_ptr, PNG_INFO_gAMA))
       {
         gdouble gamma;
-        png_get_gAMA (load_png_ptr, load_info_ptr, &gamma);
-        png_set_gamma (load_png_ptr, 2.2, gamma);
+        png_get_gAMA (p->png_ptr, p->info_ptr, &gamma);
+        png_set_gamma (p->png_ptr, 2.2, gamma);
       }
     else
       {
-        png_set_gamma (load_png_ptr, 2.2, 0.45455);
+        png_set_gamma (p->png_ptr, 2.2, 0.45455);
       }
     }
 
-    png_read_update_info (load_png_ptr, load_info_ptr);
+    png_read_update_info (p->png_ptr, p->info_ptr);
   }
 
-  pixels = g_malloc0 (width*bpp);
+  p->width            = w;
+  p->height           = h;
+  p->bpp              = bpp;
+  p->number_of_passes = number_of_passes;
+  p->next_row         = 0;
 
-  {
-    gint           pass;
-    GeglRectangle  rect;
+  return 0;
+}
 
-    for (pass=0; pass<number_of_passes; pass++)
-      {
-        for(i=0; i<h; i++)
-          {
-            gegl_rectangle_set (&rect, 0, i, width, 1);
+/* decodes the rows of @rows into @output, skipping the rows before it.  the
+ * decoder only moves forward, so it has to be reopened to read rows it has
+ * already passed.
+ */
+static gint
+decoder_read_rows (Priv                *p,
+                   GeglBuffer          *output,
+                   const GeglRectangle *rows)
+{
+  gint        rowstride = p->width * p->bpp;
+  gint        end       = MIN (rows->y + rows->height, p->height);
+  gint        n_rows    = CLAMP (CHUNK_SIZE / rowstride, 1, rows->height);
+  guchar     *pixels;
+  png_bytep  *row_p;
+  gint        i;
 
-            if (pass != 0)
-              gegl_buffer_get (gegl_buffer, &rect, 1.0, format, pixels, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+  g_return_val_if_fail (p->png_ptr, -1);
+  g_return_val_if_fail (p->next_row <= rows->y, -1);
 
-            png_read_rows (load_png_ptr, &pixels, NULL, 1);
-            gegl_buffer_set (gegl_buffer, &rect, 0, format, pixels,
-                             GEGL_AUTO_ROWSTRIDE);
-          }
-      }
-  }
+  pixels = g_malloc (n_rows * rowstride);
+  row_p  = g_new (png_bytep, n_rows);
+
+  for (i = 0; i < n_rows; i++)
+    row_p[i] = pixels + i * rowstride;
+
+  if (setjmp (png_jmpbuf (p->png_ptr)))
+    {
+      decoder_close (p);
+      g_free (row_p);
+      g_free (pixels);
+      return -1;
+    }
 
+  while (p->next_row < rows->y)
+    {
+      png_read_row (p->png_ptr, pixels, NULL);
+      p->next_row++;
+    }
 
-  png_read_end (load_png_ptr, NULL);
-  png_destroy_read_struct (&load_png_ptr, &load_info_ptr, NULL);
+  while (p->next_row < end)
+    {
+      gint n = MIN (n_rows, end - p->next_row);
 
+      png_read_rows (p->png_ptr, row_p, NULL, n);
+      gegl_buffer_set (output, GEGL_RECTANGLE (0, p->next_row, p->width, n),
+                       0, p->format, pixels, rowstride);
+      p->next_row += n;
+    }
+
+  g_free (row_p);
   g_free (pixels);
 
   return 0;
 }
 
+/* interlaced images can only be decoded as a whole */
+static gint
+decoder_read_image (Priv       *p,
+                    GeglBuffer *output)
+{
+  gint        rowstride = p->width * p->bpp;
+  guchar     *pixels;
+  png_bytep  *row_p;
+  gint        i;
 
+  g_return_val_if_fail (p->png_ptr, -1);
+  g_return_val_if_fail (p->next_row == 0, -1);
 
-static gint query_png (GInputStream *stream,
-                       gint        *width,
-                       gint        *height,
-                       const Babl  **format,
-                       GError **err)
-{
-  png_uint_32   w;
-  png_uint_32   h;
-  png_structp   load_png_ptr;
-  png_infop     load_info_ptr;
-  const Babl *  space = NULL; // null means sRGB
+  pixels = g_try_malloc ((gsize) p->height * rowstride);
+  if (!pixels)
+    return -1;
 
-  png_bytep  *row_p = NULL;
-  g_return_val_if_fail(stream, -1);
+  row_p = g_new (png_bytep, p->height);
 
-  if (!check_valid_png_header(stream, err))
-    {
-      return -1;
-    }
+  for (i = 0; i < p->height; i++)
+    row_p[i] = pixels + (gsize) i * rowstride;
 
-  load_png_ptr = png_create_read_struct (PNG_LIBPNG_VER_STRING, NULL, error_fn, NULL);
-  if (!load_png_ptr)
+  if (setjmp (png_jmpbuf (p->png_ptr)))
     {
+      decoder_close (p);
+      g_free (row_p);
+      g_free (pixels);
       return -1;
     }
 
-  load_info_ptr = png_create_info_struct (load_png_ptr);
-  if (!load_info_ptr)
-    {
-      png_destroy_read_struct (&load_png_ptr, &load_info_ptr, NULL);
-      return -1;
-    }
-  png_set_benign_errors (load_png_ptr, TRUE);
-  png_set_option (load_png_ptr, PNG_SKIP_sRGB_CHECK_PROFILE, PNG_OPTION_ON);
+  png_read_image (p->png_ptr, row_p);
+  p->next_row = p->height;
 
+  gegl_buffer_set (output, GEGL_RECTANGLE (0, 0, p->width, p->height),
+                   0, p->format, pixels, rowstride);
 
-  if (setjmp (png_jmpbuf (load_png_ptr)))
-    {
-     png_destroy_read_struct (&load_png_ptr, &load_info_ptr, NULL);
-     g_free (row_p);
-      return -1;
-    }
+  g_free (row_p);
+  g_free (pixels);
 
-  png_set_read_fn(load_png_ptr, stream, read_fn);
-  png_set_sig_bytes (load_png_ptr, 8); // we already read header
-  png_read_info (load_png_ptr, load_info_ptr);
-  {
-    int bit_depth;
-    int color_type;
-    const Babl *f;
+  return 0;
+}
 
-    png_get_IHDR (load_png_ptr,
-                  load_info_ptr,
-                  &w, &h,
-                  &bit_depth,
-                  &color_type,
-                  NULL, NULL, NULL);
-    *width = w;
-    *height = h;
+static void
+prepare (GeglOperation *operation)
+{
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  Priv           *p = (o->user_data) ? o->user_data : g_new0 (Priv, 1);
+  GError         *err = NULL;
 
-    if (png_get_valid (load_png_ptr, load_info_ptr, PNG_INFO_tRNS))
-      color_type |= PNG_COLOR_MASK_ALPHA;
+  o->user_data = (void*) p;
 
-    space = gegl_png_space (load_png_ptr, load_info_ptr);
+  /* start over when the file, or its contents, changed */
+  if (p->file)
+    {
+      GFile *file = NULL;
+      gchar *etag = NULL;
+
+      if (o->uri && strlen (o->uri) > 0)
+        file = g_file_new_for_uri (o->uri);
+      else if (o->path && strlen (o->path) > 0)
+        file = g_file_new_for_path (o->path);
+
+      if (file)
+        etag = gegl_gio_get_etag (file);
+
+      if (!file || !g_file_equal (p->file, file) || g_strcmp0 (p->etag, etag))
+        {
+          decoder_close (p);
+          g_clear_object (&p->file);
+          p->format = NULL;
+          p->width  = 0;
+          p->height = 0;
+        }
+
+      g_clear_object (&file);
+      g_free (etag);
+    }
 
-    f = get_babl_format(bit_depth, color_type, space);
-    if (!f)
-      {
-        png_destroy_read_struct (&load_png_ptr, &load_info_ptr, NULL);
-        return -1;
-      }
-    *format = f;
+  /* the decoder is only needed here for the header; once the image has
+   * been decoded it stays closed until process() needs rows again.
+   */
+  if (!p->format)
+    {
+      if (decoder_open (operation, &err))
+        {
+          WARN_IF_ERROR(err);
+          g_clear_error (&err);
+          p->format = NULL;
+          p->width  = 0;
+          p->height = 0;
+        }
+    }
 
-  }
-  png_destroy_read_struct (&load_png_ptr, &load_info_ptr, NULL);
-  return 0;
+  gegl_operation_set_format (operation, "output", p->format);
 }
 
 static GeglRectangle
 get_bounding_box (GeglOperation *operation)
 {
-  GeglProperties   *o = GEGL_PROPERTIES (operation);
-  GeglRectangle result = {0,0,0,0};
-  gint          width, height;
-  gint          status;
-  const Babl *  format;
-  GError *err = NULL;
-  GFile *infile = NULL;
-
-  GInputStream *stream = gegl_gio_open_input_stream(o->uri, o->path, &infile, &err);
-  WARN_IF_ERROR(err);
-  if (!stream) return result;
-  status = query_png(stream, &width, &height, &format, &err);
-  WARN_IF_ERROR(err);
-  g_input_stream_close(stream, NULL, NULL);
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  Priv           *p = (Priv *) o->user_data;
+  GeglRectangle   result = {0,0,0,0};
 
-  if (status)
+  if (p && p->format)
     {
-      width = 0;
-      height = 0;
+      result.width  = p->width;
+      result.height = p->height;
     }
 
-  gegl_operation_set_format (operation, "output", format);
-  result.width  = width;
-  result.height  = height;
-
-  g_clear_object(&infile);
-  g_object_unref(stream);
   return result;
 }
 
@@ -514,28 +599,35 @@ process (GeglOperation       *operation,
          gint                 level)
 {
   GeglProperties *o = GEGL_PROPERTIES (operation);
-  gint        problem;
-  gint        width, height;
-  Babl        *format = NULL;
-  GError *err = NULL;
-  GFile *infile = NULL;
-  GInputStream *stream = gegl_gio_open_input_stream(o->uri, o->path, &infile, &err);
-  WARN_IF_ERROR(err);
-  problem = gegl_buffer_import_png (output, stream, 0, 0,
-                                    &width, &height, format, &err);
+  Priv           *p = (Priv *) o->user_data;
+  gint            problem;
+  GError         *err = NULL;
+
+  if (p->png_ptr && p->next_row > result->y)
+    decoder_close (p);
+
+  problem = p->png_ptr ? 0 : decoder_open (operation, &err);
   WARN_IF_ERROR(err);
-  g_input_stream_close(stream, NULL, NULL);
+  g_clear_error (&err);
+
+  if (!problem)
+    {
+      if (p->number_of_passes > 1)
+        problem = decoder_read_image (p, output);
+      else
+        problem = decoder_read_rows (p, output, result);
+    }
+
+  /* the whole image has been decoded, don't hold on to the file */
+  if (!problem && p->next_row == p->height)
+    decoder_close (p);
 
   if (problem)
     {
-      g_object_unref(infile);
-      g_object_unref(stream);
       g_warning ("%s failed to open file %s for reading.",
                  G_OBJECT_TYPE_NAME (operation), o->path);
       return FALSE;
     }
-  g_clear_object(&infile);
-  g_object_unref(stream);
   return TRUE;
 }
 
@@ -543,7 +635,45 @@ static GeglRectangle
 get_cached_region (GeglOperation       *operation,
                    const GeglRectangle *roi)
 {
-  return get_bounding_box (operation);
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  Priv           *p = (Priv *) o->user_data;
+  GeglRectangle   result = get_bounding_box (operation);
+
+  /* non-interlaced images are decoded on demand, in full-width bands of
+   * rows, while the cache keeps track of the rows decoded so far.  the rows
+   * the decoder has to skip to reach @roi are decoded and cached as well,
+   * so that they don't require reopening the file later.
+   */
+  if (p && p->number_of_passes == 1)
+    {
+      gint start = roi->y >= p->next_row ? p->next_row : 0;
+
+      result.y      = start;
+      result.height = roi->y + roi->height - start;
+
+      gegl_rectangle_intersect (&result, &result,
+                                GEGL_RECTANGLE (0, 0, p->width, p->height));
+    }
+
+  return result;
+}
+
+static void
+finalize (GObject *object)
+{
+  GeglProperties *o = GEGL_PROPERTIES (object);
+
+  if (o->user_data)
+    {
+      Priv *p = (Priv *) o->user_data;
+
+      decoder_close (p);
+      g_clear_object (&p->file);
+      g_clear_pointer (&p->etag, g_free);
+      g_clear_pointer (&o->user_data, g_free);
+    }
+
+  G_OBJECT_CLASS (gegl_op_parent_class)->finalize (object);
 }
 
 static void
@@ -552,10 +682,13 @@ gegl_op_class_init (GeglOpClass *klass)
   GeglOperationClass       *operation_class;
   GeglOperationSourceClass *source_class;
 
+  G_OBJECT_CLASS (klass)->finalize = finalize;
+
   operation_class = GEGL_OPERATION_CLASS (klass);
   source_class    = GEGL_OPERATION_SOURCE_CLASS (klass);
 
   source_class->process = process;
+  operation_class->prepare = prepare;
   operation_class->get_bounding_box = get_bounding_box;
   operation_class->get_cached_region = get_cached_region;
 
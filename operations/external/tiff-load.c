@@ -69,6 +69,10 @@ typedef struct
 
   gint width;
   gint height;
+
+  /* the decoding unit; strips span the whole width */
+  gint tile_width;
+  gint tile_height;
 } Priv;
 
 static void
@@ -90,6 +94,7 @@ cleanup(GeglOperation *operation)
       g_clear_object (&p->file);
 
       p->width = p->height = 0;
+      p->tile_width = p->tile_height = 0;
       p->directory = 0;
     }
 }
@@ -549,6 +554,26 @@ query_tiff(GeglOperation *operation)
   p->height = (gint) height;
   p->width = (gint) width;
 
+  if (TIFFIsTiled(p->tiff))
+    {
+      guint32 tile_width, tile_height;
+
+      TIFFGetField(p->tiff, TIFFTAG_TILEWIDTH, &tile_width);
+      TIFFGetField(p->tiff, TIFFTAG_TILELENGTH, &tile_height);
+
+      p->tile_width = (gint) tile_width;
+      p->tile_height = (gint) tile_height;
+    }
+  else
+    {
+      guint32 rows_per_strip;
+
+      TIFFGetFieldDefaulted(p->tiff, TIFFTAG_ROWSPERSTRIP, &rows_per_strip);
+
+      p->tile_width = p->width;
+      p->tile_height = (gint) MAX(MIN(rows_per_strip, height), 1);
+    }
+
   return 0;
 }
 
@@ -595,45 +620,75 @@ load_RGBA(GeglOperation *operation,
   return 0;
 }
 
+/* reads the tile, or strip, of the given plane at (x, y) into buffer */
+static gboolean
+read_tile(Priv    *p,
+          guchar  *buffer,
+          gint     x,
+          gint     y,
+          gint     plane)
+{
+  if (TIFFIsTiled(p->tiff))
+    return TIFFReadTile(p->tiff, buffer, x, y, 0, plane) >= 0;
+  else
+    return TIFFReadEncodedStrip(p->tiff,
+                                TIFFComputeStrip(p->tiff, y, plane),
+                                buffer, -1) >= 0;
+}
+
+static guchar *
+new_tile_buffer(Priv *p)
+{
+  if (TIFFIsTiled(p->tiff))
+    return g_try_new(guchar, TIFFTileSize(p->tiff));
+  else
+    return g_try_new(guchar, TIFFStripSize(p->tiff));
+}
+
 static gint
-load_contiguous(GeglOperation *operation,
-                GeglBuffer    *output)
+load_contiguous(GeglOperation       *operation,
+                GeglBuffer          *output,
+                const GeglRectangle *result)
 {
   GeglProperties *o = GEGL_PROPERTIES(operation);
   Priv *p = (Priv*) o->user_data;
-  guint32 tile_width = (guint32) p->width;
-  guint32 tile_height = 1;
+  gint bytes_per_pixel;
+  gint rowstride;
   guchar *buffer;
   gint x, y;
 
   g_return_val_if_fail(p->tiff != NULL, -1);
 
-  if (!TIFFIsTiled(p->tiff))
-      buffer = g_try_new(guchar, TIFFScanlineSize(p->tiff));
-  else
-    {
-      TIFFGetField(p->tiff, TIFFTAG_TILEWIDTH, &tile_width);
-      TIFFGetField(p->tiff, TIFFTAG_TILELENGTH, &tile_height);
-
-      buffer = g_try_new(guchar, TIFFTileSize(p->tiff));
-    }
+  buffer = new_tile_buffer(p);
 
   g_assert(buffer != NULL);
 
-  for (y = 0; y < p->height; y += tile_height)
+  bytes_per_pixel = babl_format_get_bytes_per_pixel(p->format);
+  rowstride = p->tile_width * bytes_per_pixel;
+
+  for (y = result->y - result->y % p->tile_height;
+       y < result->y + result->height;
+       y += p->tile_height)
     {
-      for (x = 0; x < p->width; x += tile_width)
+      for (x = result->x - result->x % p->tile_width;
+           x < result->x + result->width;
+           x += p->tile_width)
         {
-          GeglRectangle tile = { x, y, tile_width, tile_height };
+          GeglRectangle tile = { x, y, p->tile_width, p->tile_height };
 
-          if (TIFFIsTiled(p->tiff))
-            TIFFReadTile(p->tiff, buffer, x, y, 0, 0);
-          else
-            TIFFReadScanline(p->tiff, buffer, y, 0);
+          if (!gegl_rectangle_intersect(&tile, &tile, result))
+            continue;
+
+          if (!read_tile(p, buffer, x, y, 0))
+            {
+              g_free(buffer);
+              return -1;
+            }
 
           gegl_buffer_set(output, &tile, 0, p->format,
-                          (guchar *) buffer,
-                          GEGL_AUTO_ROWSTRIDE);
+                          buffer + (tile.y - y) * rowstride +
+                                   (tile.x - x) * bytes_per_pixel,
+                          rowstride);
         }
     }
 
@@ -642,13 +697,12 @@ load_contiguous(GeglOperation *operation,
 }
 
 static gint
-load_separated(GeglOperation *operation,
-               GeglBuffer    *output)
+load_separated(GeglOperation       *operation,
+               GeglBuffer          *output,
+               const GeglRectangle *result)
 {
   GeglProperties *o = GEGL_PROPERTIES(operation);
   Priv *p = (Priv*) o->user_data;
-  guint32 tile_width = (guint32) p->width;
-  guint32 tile_height = 1;
   gint output_bytes_per_pixel;
   gint nb_components, offset = 0;
   guchar *buffer;
@@ -656,15 +710,7 @@ load_separated(GeglOperation *operation,
 
   g_return_val_if_fail(p->tiff != NULL, -1);
 
-  if (!TIFFIsTiled(p->tiff))
-    buffer = g_try_new(guchar, TIFFScanlineSize(p->tiff));
-  else
-    {
-      TIFFGetField(p->tiff, TIFFTAG_TILEWIDTH, &tile_width);
-      TIFFGetField(p->tiff, TIFFTAG_TILELENGTH, &tile_height);
-
-      buffer = g_try_new(guchar, TIFFTileSize(p->tiff));
-    }
+  buffer = new_tile_buffer(p);
 
   g_assert(buffer != NULL);
 
@@ -684,26 +730,39 @@ load_separated(GeglOperation *operation,
 
       plane_bytes_per_pixel = babl_format_get_bytes_per_pixel(plane_format);
 
-      for (y = 0; y < p->height; y += tile_height)
+      for (y = result->y - result->y % p->tile_height;
+           y < result->y + result->height;
+           y += p->tile_height)
         {
-          for (x = 0; x < p->width; x += tile_width)
+          for (x = result->x - result->x % p->tile_width;
+               x < result->x + result->width;
+               x += p->tile_width)
             {
-              GeglRectangle output_tile = { x, y, tile_width, tile_height };
-              GeglRectangle plane_tile = { 0, 0, tile_width, tile_height };
+              GeglRectangle output_tile = { x, y, p->tile_width, p->tile_height };
+              GeglRectangle plane_tile = { 0, 0, p->tile_width, p->tile_height };
+              GeglRectangle plane_rect;
               GeglBufferIterator *iterator;
               GeglBuffer *linear;
 
-              if (TIFFIsTiled(p->tiff))
-                TIFFReadTile(p->tiff, buffer, x, y, 0, i);
-              else
-                TIFFReadScanline(p->tiff, buffer, y, i);
+              if (!gegl_rectangle_intersect(&output_tile, &output_tile, result))
+                continue;
+
+              if (!read_tile(p, buffer, x, y, i))
+                {
+                  g_free(buffer);
+                  return -1;
+                }
+
+              plane_rect = output_tile;
+              plane_rect.x -= x;
+              plane_rect.y -= y;
 
               linear = gegl_buffer_linear_new_from_data(buffer, plane_format,
                                                         &plane_tile,
                                                         GEGL_AUTO_ROWSTRIDE,
                                                         NULL, NULL);
 
-              iterator = gegl_buffer_iterator_new(linear, &plane_tile,
+              iterator = gegl_buffer_iterator_new(linear, &plane_rect,
                                                   0, NULL,
                                                   GEGL_ACCESS_READ,
                                                   GEGL_ABYSS_NONE, 2);
@@ -856,12 +915,12 @@ process(GeglOperation *operation,
         break;
 
       case TIFF_LOADING_CONTIGUOUS:
-        if (!load_contiguous(operation, output))
+        if (!load_contiguous(operation, output, result))
           return TRUE;
         break;
 
       case TIFF_LOADING_SEPARATED:
-        if (!load_separated(operation, output))
+        if (!load_separated(operation, output, result))
           return TRUE;
         break;
 
@@ -877,7 +936,31 @@ static GeglRectangle
 get_cached_region(GeglOperation       *operation,
                   const GeglRectangle *roi)
 {
-  return get_bounding_box(operation);
+  GeglProperties *o = GEGL_PROPERTIES(operation);
+  Priv *p = (Priv*) o->user_data;
+  GeglRectangle bounding_box = get_bounding_box(operation);
+  GeglRectangle result;
+
+  /* the RGBA loader can only decode the whole image at once, while tiles and
+   * strips are decoded on demand, so only round the roi up to whole ones, and
+   * let the cache keep track of what's been decoded so far.
+   */
+  if (p->tiff == NULL || p->mode == TIFF_LOADING_RGBA)
+    return bounding_box;
+
+  result.x = roi->x - roi->x % p->tile_width;
+  result.y = roi->y - roi->y % p->tile_height;
+  result.width = roi->x + roi->width - result.x;
+  result.height = roi->y + roi->height - result.y;
+
+  result.width += (p->tile_width - result.width % p->tile_width) %
+                  p->tile_width;
+  result.height += (p->tile_height - result.height % p->tile_height) %
+                   p->tile_height;
+
+  gegl_rectangle_intersect(&result, &result, &bounding_box);
+
+  return result;
 }
 
 static void
@@ -29,7 +29,8 @@
 
 enum
 {
-  PROP_ABYSS_POLICY = 1
+  PROP_ABYSS_POLICY = 1,
+  PROP_FILTER
 };
 
 static void              gegl_scale_get_property     (GObject      *object,
@@ -42,6 +43,7 @@ static void              gegl_scale_set_property     (GObject      *object,
                                                       GParamSpec   *pspec);
 
 static GeglAbyssPolicy   gegl_scale_get_abyss_policy (OpTransform  *transform);
+static GeglAbyssPolicy   gegl_scale_get_filter       (OpTransform  *transform);
 
 /* ************************* */
 
@@ -85,6 +87,33 @@ op_scale_get_type (void)
   return g_define_type_id;
 }
 
+GType
+gegl_scale_filter_get_type (void)
+{
+  static GType etype = 0;
+
+  if (etype == 0)
+    {
+      static GEnumValue values[] =
+        {
+          { GEGL_SCALE_FILTER_SAMPLER,  N_("Sampler"),  "sampler"  },
+          { GEGL_SCALE_FILTER_LANCZOS,  N_("Lanczos"),  "lanczos"  },
+          { GEGL_SCALE_FILTER_MITCHELL, N_("Mitchell"), "mitchell" },
+          { 0, NULL, NULL }
+        };
+      gint i;
+
+      for (i = 0; i < G_N_ELEMENTS (values); i++)
+        if (values[i].value_name)
+          values[i].value_name = dgettext (GETTEXT_PACKAGE,
+                                           values[i].value_name);
+
+      etype = g_enum_register_static ("GeglScaleFilter", values);
+    }
+
+  return etype;
+}
+
 static void
 op_scale_class_init (OpScaleClass *klass)
 {
@@ -95,6 +124,7 @@ op_scale_class_init (OpScaleClass *klass)
   gobject_class->get_property       = gegl_scale_get_property;
 
   transform_class->get_abyss_policy = gegl_scale_get_abyss_policy;
+  transform_class->get_filter       = gegl_scale_get_filter;
 
   g_object_class_install_property (gobject_class, PROP_ABYSS_POLICY,
                                    g_param_spec_enum (
@@ -104,6 +134,16 @@ op_scale_class_init (OpScaleClass *klass)
                                      GEGL_TYPE_ABYSS_POLICY,
                                      GEGL_ABYSS_NONE,
                                      G_PARAM_CONSTRUCT | G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_FILTER,
+                                   g_param_spec_enum (
+                                     "filter",
+                                     _("Filter"),
+                                     _("Separable filter used instead of "
+                                       "the sampler for uniform scales"),
+                                     GEGL_TYPE_SCALE_FILTER,
+                                     GEGL_SCALE_FILTER_SAMPLER,
+                                     G_PARAM_CONSTRUCT | G_PARAM_READWRITE));
 }
 
 static void
@@ -124,6 +164,9 @@ gegl_scale_get_property (GObject    *object,
     case PROP_ABYSS_POLICY:
       g_value_set_enum (value, self->abyss_policy);
       break;
+    case PROP_FILTER:
+      g_value_set_enum (value, self->filter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -143,6 +186,9 @@ gegl_scale_set_property (GObject      *object,
     case PROP_ABYSS_POLICY:
       self->abyss_policy = g_value_get_enum (value);
       break;
+    case PROP_FILTER:
+      self->filter = g_value_get_enum (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -154,3 +200,9 @@ gegl_scale_get_abyss_policy (OpTransform *transform)
 {
   return OP_SCALE (transform)->abyss_policy;
 }
+
+static GeglAbyssPolicy
+gegl_scale_get_filter (OpTransform *transform)
+{
+  return (GeglAbyssPolicy) OP_SCALE (transform)->filter;
+}
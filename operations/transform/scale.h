@@ -12,6 +12,15 @@ G_BEGIN_DECLS
 #define IS_OP_SCALE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  TYPE_OP_SCALE))
 #define OP_SCALE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  TYPE_OP_SCALE, OpScaleClass))
 
+#define GEGL_TYPE_SCALE_FILTER   (gegl_scale_filter_get_type ())
+
+typedef enum
+{
+  GEGL_SCALE_FILTER_SAMPLER  = GEGL_BUFFER_FILTER_AUTO,
+  GEGL_SCALE_FILTER_LANCZOS  = GEGL_BUFFER_FILTER_LANCZOS,
+  GEGL_SCALE_FILTER_MITCHELL = GEGL_BUFFER_FILTER_MITCHELL
+} GeglScaleFilter;
+
 typedef struct _OpScale OpScale;
 
 struct _OpScale
@@ -19,6 +28,7 @@ struct _OpScale
   OpTransform     parent_instance;
 
   GeglAbyssPolicy abyss_policy;
+  GeglScaleFilter filter;
 };
 
 typedef struct _OpScaleClass OpScaleClass;
@@ -28,7 +38,8 @@ struct _OpScaleClass
   OpTransformClass parent_class;
 };
 
-GType op_scale_get_type (void) G_GNUC_CONST;
+GType op_scale_get_type         (void) G_GNUC_CONST;
+GType gegl_scale_filter_get_type (void) G_GNUC_CONST;
 
 G_END_DECLS
 
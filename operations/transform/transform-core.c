@@ -100,6 +100,13 @@ static GeglNode     *gegl_transform_detect                       (GeglOperation
 
 static gboolean      gegl_matrix3_is_affine                      (GeglMatrix3          *matrix);
 static gboolean      gegl_transform_matrix3_allow_fast_translate (GeglMatrix3          *matrix);
+static gboolean      gegl_transform_matrix3_is_orthogonal        (GeglMatrix3          *matrix);
+static gint          gegl_transform_get_scale_level              (OpTransform          *transform,
+                                                                  GeglMatrix3          *matrix);
+static gboolean      gegl_transform_get_filter_scale             (OpTransform          *transform,
+                                                                  GeglMatrix3          *matrix,
+                                                                  gdouble              *scale);
+static gint          gegl_transform_get_filter_margin            (gdouble               scale);
 static void          gegl_transform_create_composite_matrix      (OpTransform          *transform,
                                                                   GeglMatrix3          *matrix);
 
@@ -200,6 +207,7 @@ op_transform_class_init (OpTransformClass *klass)
 
   klass->create_matrix                = NULL;
   klass->get_abyss_policy             = NULL;
+  klass->get_filter                   = NULL;
 
   gegl_operation_class_set_key (op_class, "categories", "transform");
 
@@ -335,6 +343,15 @@ gegl_transform_get_abyss_policy (OpTransform *transform)
   return GEGL_ABYSS_NONE;
 }
 
+static GeglAbyssPolicy
+gegl_transform_get_filter (OpTransform *transform)
+{
+  if (OP_TRANSFORM_GET_CLASS (transform)->get_filter)
+    return OP_TRANSFORM_GET_CLASS (transform)->get_filter (transform);
+
+  return GEGL_BUFFER_FILTER_AUTO;
+}
+
 static void
 gegl_transform_bounding_box (const gdouble       *points,
                              const gint           num_points,
@@ -675,6 +692,8 @@ gegl_transform_is_intermediate_node (OpTransform *transform)
               transform->sampler != OP_TRANSFORM (sink)->sampler    ||
               gegl_transform_get_abyss_policy (transform) !=
               gegl_transform_get_abyss_policy (OP_TRANSFORM (sink)) ||
+              gegl_transform_get_filter (transform) !=
+              gegl_transform_get_filter (OP_TRANSFORM (sink))       ||
               transform->near_z != OP_TRANSFORM (sink)->near_z)
             {
               is_intermediate = FALSE;
@@ -869,6 +888,9 @@ gegl_transform_get_required_for_output (GeglOperation       *op,
   gint           n_temp_points;
   gdouble        need_points [12];
   gint           n_need_points;
+  gint           scale_level;
+  gint           filter_margin = 0;
+  gdouble        filter_scale;
   gint           i;
 
   requested_rect = *region;
@@ -878,6 +900,9 @@ gegl_transform_get_required_for_output (GeglOperation       *op,
     return requested_rect;
 
   gegl_transform_create_composite_matrix (transform, &inverse);
+  scale_level = gegl_transform_get_scale_level (transform, &inverse);
+  if (gegl_transform_get_filter_scale (transform, &inverse, &filter_scale))
+    filter_margin = gegl_transform_get_filter_margin (filter_scale);
   gegl_matrix3_invert (&inverse);
 
   if (gegl_transform_is_intermediate_node (transform) ||
@@ -940,6 +965,28 @@ gegl_transform_get_required_for_output (GeglOperation       *op,
        */
       need_rect.width  += context_rect.width  - (gint) 1;
       need_rect.height += context_rect.height - (gint) 1;
+
+      /*
+       * transform_scale() samples the input's mipmap, whose pixels
+       * average blocks reaching past the sampler's context rect.
+       */
+      if (scale_level > 0)
+        {
+          gint margin = 2 << scale_level;
+
+          need_rect.x      -= margin;
+          need_rect.y      -= margin;
+          need_rect.width  += 2 * margin;
+          need_rect.height += 2 * margin;
+        }
+
+      /*
+       * Likewise for the support of transform_filter()'s filter.
+       */
+      need_rect.x      -= filter_margin;
+      need_rect.y      -= filter_margin;
+      need_rect.width  += 2 * filter_margin;
+      need_rect.height += 2 * filter_margin;
     }
 
   return need_rect;
@@ -960,6 +1007,8 @@ gegl_transform_get_invalidated_by_change (GeglOperation       *op,
   gdouble        vertices [8];
   gdouble        affected_points [10];
   gint           n_affected_points;
+  gint           scale_level;
+  gdouble        filter_scale;
   gint           i;
   GeglRectangle  region = *input_region;
 
@@ -1023,6 +1072,34 @@ gegl_transform_get_invalidated_by_change (GeglOperation       *op,
   region.width  += context_rect.width  - (gint) 1;
   region.height += context_rect.height - (gint) 1;
 
+  /*
+   * Likewise for the mipmap blocks sampled by transform_scale().
+   */
+  scale_level = gegl_transform_get_scale_level (transform, &matrix);
+
+  if (scale_level > 0)
+    {
+      gint margin = 2 << scale_level;
+
+      region.x      -= margin;
+      region.y      -= margin;
+      region.width  += 2 * margin;
+      region.height += 2 * margin;
+    }
+
+  /*
+   * And for the support of transform_filter()'s filter.
+   */
+  if (gegl_transform_get_filter_scale (transform, &matrix, &filter_scale))
+    {
+      gint margin = gegl_transform_get_filter_margin (filter_scale);
+
+      region.x      -= margin;
+      region.y      -= margin;
+      region.width  += 2 * margin;
+      region.height += 2 * margin;
+    }
+
   /*
    * Convert indices to absolute positions:
    */
@@ -1124,8 +1201,6 @@ transform_affine (GeglOperation       *operation,
                                          level?GEGL_SAMPLER_NEAREST:transform->sampler,
                                          level);
 
-  GeglSamplerGetFun sampler_get_fun = gegl_sampler_get_fun (sampler);
-
   GeglRectangle  bounding_box = *gegl_buffer_get_abyss (src);
   GeglRectangle  context_rect = *gegl_sampler_get_context_rect (sampler);
   GeglRectangle  dest_extent  = *roi;
@@ -1141,11 +1216,6 @@ transform_affine (GeglOperation       *operation,
   dest_extent.width  >>= level;
   dest_extent.height >>= level;
 
-  /*
-   * XXX: fast paths as existing in files in the same dir as
-   *      transform.c should probably be hooked in here, and bailing
-   *      out before using the generic code.
-   */
   /*
    * It is assumed that the affine transformation has been normalized,
    * so that inverse.coeff[2][0] = inverse.coeff[2][1] = 0 and
@@ -1221,26 +1291,21 @@ transform_affine (GeglOperation       *operation,
               gdouble u_float = u_start;
               gdouble v_float = v_start;
 
-              gint x;
-
               memset (dest_ptr, 0, (gint) components * sizeof (gfloat) * x1);
               dest_ptr += (gint) components * x1;
 
               u_float += x1 * inverse_jacobian.coeff [0][0];
               v_float += x1 * inverse_jacobian.coeff [1][0];
 
-              for (x = x1; x < x2; x++)
-                {
-                  sampler_get_fun (sampler,
-                                   u_float, v_float,
-                                   &inverse_jacobian,
-                                   dest_ptr,
-                                   abyss_policy);
-                  dest_ptr += (gint) components;
-
-                  u_float += inverse_jacobian.coeff [0][0];
-                  v_float += inverse_jacobian.coeff [1][0];
-                }
+              gegl_sampler_get_span (sampler,
+                                     u_float, v_float,
+                                     inverse_jacobian.coeff [0][0],
+                                     inverse_jacobian.coeff [1][0],
+                                     &inverse_jacobian,
+                                     dest_ptr,
+                                     x2 - x1,
+                                     abyss_policy);
+              dest_ptr += (gint) components * (x2 - x1);
 
               memset (dest_ptr, 0, (gint) components * sizeof (gfloat) * (roi->width - x2));
               dest_ptr += (gint) components * (roi->width - x2);
@@ -1551,6 +1616,507 @@ transform_nearest (GeglOperation       *operation,
   g_object_unref (sampler);
 }
 
+static inline void
+gegl_transform_copy_pixels (guchar       * restrict dest,
+                            const guchar * restrict src,
+                            gint                    src_stride,
+                            gint                    n,
+                            gint                    bpp)
+{
+  if (src_stride == bpp)
+    {
+      memcpy (dest, src, n * bpp);
+
+      return;
+    }
+
+  /* let the compiler inline the copies of the common pixel sizes */
+  switch (bpp)
+    {
+    case 4:
+      for (; n; n--, dest += 4, src += src_stride)
+        memcpy (dest, src, 4);
+      break;
+
+    case 8:
+      for (; n; n--, dest += 8, src += src_stride)
+        memcpy (dest, src, 8);
+      break;
+
+    case 16:
+      for (; n; n--, dest += 16, src += src_stride)
+        memcpy (dest, src, 16);
+      break;
+
+    default:
+      for (; n; n--, dest += bpp, src += src_stride)
+        memcpy (dest, src, bpp);
+      break;
+    }
+}
+
+/*
+ * Rotations by multiples of 90 degrees and flips, which map pixel centers
+ * to pixel centers, only shuffle the input pixels around.  The nearest and
+ * linear samplers reproduce the input pixels exactly at their centers, so
+ * each output tile is copied from the corresponding input rectangle,
+ * giving the same result as sampling it.
+ */
+static void
+transform_orthogonal (GeglOperation       *operation,
+                      GeglBuffer          *dest,
+                      GeglBuffer          *src,
+                      GeglMatrix3         *matrix,
+                      const GeglRectangle *roi,
+                      gint                 level)
+{
+  OpTransform        *transform      = (OpTransform *) operation;
+  const Babl         *format         = gegl_operation_get_format (operation, "output");
+  gint                bpp            = babl_format_get_bytes_per_pixel (format);
+  gdouble             inverse_near_z = 1.0 / transform->near_z;
+  GeglAbyssPolicy     abyss_policy   = gegl_transform_get_abyss_policy (transform);
+  GeglSampler        *sampler        = gegl_buffer_sampler_new_at_level (src,
+                                         format,
+                                         transform->sampler,
+                                         0);
+  GeglRectangle       bounding_box   = *gegl_buffer_get_abyss (src);
+  GeglRectangle       context_rect   = *gegl_sampler_get_context_rect (sampler);
+  GeglMatrix3         inverse;
+  GeglBufferIterator *i;
+  gint                a, b, d, e;
+  gint                x0, y0;
+  gint                r, c;
+
+  g_object_unref (sampler);
+
+  bounding_box.x      += context_rect.x;
+  bounding_box.y      += context_rect.y;
+  bounding_box.width  += context_rect.width  - 1;
+  bounding_box.height += context_rect.height - 1;
+
+  gegl_matrix3_copy_into (&inverse, matrix);
+  gegl_matrix3_invert (&inverse);
+
+  /*
+   * The coefficients are within GEGL_TRANSFORM_CORE_EPSILON of
+   * integers; snap them.
+   */
+  for (r = 0; r < 2; r++)
+    {
+      for (c = 0; c < 3; c++)
+        inverse.coeff [r][c] = round (inverse.coeff [r][c]);
+    }
+
+  inverse.coeff [2][0] = 0.0;
+  inverse.coeff [2][1] = 0.0;
+  inverse.coeff [2][2] = 1.0;
+
+  a = inverse.coeff [0][0];
+  b = inverse.coeff [0][1];
+  d = inverse.coeff [1][0];
+  e = inverse.coeff [1][1];
+
+  /*
+   * The center of the output pixel (x, y) maps to the center of the
+   * input pixel (a x + b y + x0, d x + e y + y0).
+   */
+  x0 = (gint) inverse.coeff [0][2] + (a + b - 1) / 2;
+  y0 = (gint) inverse.coeff [1][2] + (d + e - 1) / 2;
+
+  i = gegl_buffer_iterator_new (dest,
+                                roi,
+                                0,
+                                format,
+                                GEGL_ACCESS_WRITE,
+                                GEGL_ABYSS_NONE, 1);
+
+  while (gegl_buffer_iterator_next (i))
+    {
+      GeglRectangle *roi      = &i->items[0].roi;
+      guchar        *dest_ptr = i->items[0].data;
+      GeglRectangle  src_rect;
+      guchar        *src_data;
+      gint           src_stride;
+      gint           x1, y1;
+      gint           x2, y2;
+      gint           y;
+
+      /*
+       * The input rectangle spanned by the tile's corners.
+       */
+      x1 = a * roi->x + b * roi->y + x0;
+      y1 = d * roi->x + e * roi->y + y0;
+      x2 = a * (roi->x + roi->width  - 1) + b * (roi->y + roi->height - 1) + x0;
+      y2 = d * (roi->x + roi->width  - 1) + e * (roi->y + roi->height - 1) + y0;
+
+      src_rect.x      = MIN (x1, x2);
+      src_rect.y      = MIN (y1, y2);
+      src_rect.width  = ABS (x2 - x1) + 1;
+      src_rect.height = ABS (y2 - y1) + 1;
+
+      src_data = gegl_scratch_alloc (src_rect.width * src_rect.height * bpp);
+
+      gegl_buffer_get (src, &src_rect, 1.0, format, src_data,
+                       GEGL_AUTO_ROWSTRIDE, abyss_policy);
+
+      src_stride = (a + d * src_rect.width) * bpp;
+
+      for (y = roi->y; y < roi->y + roi->height; y++)
+        {
+          gdouble u_start = inverse.coeff [0][0] * (roi->x + (gdouble) 0.5) +
+                            inverse.coeff [0][1] * (y      + (gdouble) 0.5) +
+                            inverse.coeff [0][2];
+          gdouble v_start = inverse.coeff [1][0] * (roi->x + (gdouble) 0.5) +
+                            inverse.coeff [1][1] * (y      + (gdouble) 0.5) +
+                            inverse.coeff [1][2];
+
+          x1 = 0;
+          x2 = roi->width;
+
+          if (gegl_transform_scanline_limits (&inverse, inverse_near_z,
+                                              &bounding_box,
+                                              u_start, v_start, 1.0,
+                                              &x1, &x2))
+            {
+              gint u = a * (roi->x + x1) + b * y + x0 - src_rect.x;
+              gint v = d * (roi->x + x1) + e * y + y0 - src_rect.y;
+
+              memset (dest_ptr, 0, bpp * x1);
+              dest_ptr += bpp * x1;
+
+              gegl_transform_copy_pixels (dest_ptr,
+                                          src_data +
+                                          (v * src_rect.width + u) * bpp,
+                                          src_stride,
+                                          x2 - x1,
+                                          bpp);
+              dest_ptr += bpp * (x2 - x1);
+
+              memset (dest_ptr, 0, bpp * (roi->width - x2));
+              dest_ptr += bpp * (roi->width - x2);
+            }
+          else
+            {
+              memset (dest_ptr, 0, bpp * roi->width);
+              dest_ptr += bpp * roi->width;
+            }
+        }
+
+      gegl_scratch_free (src_data);
+    }
+}
+
+/*
+ * Interpolates the output pixels [x1, x2) of a row between the input rows
+ * top and bottom, using the same arithmetic as the linear sampler.
+ */
+static inline void
+gegl_transform_scale_row (gfloat       * restrict dest,
+                          const gfloat * restrict top,
+                          const gfloat * restrict bottom,
+                          const gint   * restrict col_offset,
+                          const gfloat * restrict col_weight,
+                          gfloat                  y,
+                          gint                    x1,
+                          gint                    x2,
+                          const gint              components)
+{
+  gint x;
+
+  for (x = x1; x < x2; x++)
+    {
+      const gfloat * restrict top_left = top    + col_offset[x];
+      const gfloat * restrict top_rite = top_left + components;
+      const gfloat * restrict bot_left = bottom + col_offset[x];
+      const gfloat * restrict bot_rite = bot_left + components;
+
+      const gfloat x_times_y = col_weight[x] * y;
+      const gfloat w_times_y = y - x_times_y;
+      const gfloat x_times_z = col_weight[x] - x_times_y;
+      const gfloat w_times_z = (gfloat) 1. - ( col_weight[x] + w_times_y );
+
+      gint c;
+
+      for (c = 0; c < components; c++)
+        dest[c] =
+          x_times_y * bot_rite[c]
+          +
+          w_times_y * bot_left[c]
+          +
+          x_times_z * top_rite[c]
+          +
+          w_times_z * top_left[c];
+
+      dest += components;
+    }
+}
+
+/*
+ * Axis-aligned scales sample the input along a fixed set of columns and
+ * rows, so the linear sampler's coordinates and weights are computed once
+ * per column and row of each tile, rather than once per pixel, and the
+ * input is read a rectangle at a time.
+ *
+ * When trading quality for speed, rather than box-filtering each sample,
+ * downscales by a factor of 2 or more sample the mipmap level whose
+ * resolution is closest above the output's; see
+ * gegl_transform_get_scale_level().
+ */
+static void
+transform_scale (GeglOperation       *operation,
+                 GeglBuffer          *dest,
+                 GeglBuffer          *src,
+                 GeglMatrix3         *matrix,
+                 const GeglRectangle *roi,
+                 gint                 level)
+{
+  OpTransform        *transform      = (OpTransform *) operation;
+  const Babl         *format         = gegl_operation_get_format (operation, "output");
+  gint                components     = babl_format_get_n_components (format);
+  gdouble             inverse_near_z = 1.0 / transform->near_z;
+  GeglAbyssPolicy     abyss_policy   = gegl_transform_get_abyss_policy (transform);
+  gint                scale_level    = gegl_transform_get_scale_level (transform,
+                                                                       matrix);
+  gdouble             level_scale    = 1.0 / (1 << scale_level);
+  GeglSampler        *sampler        = gegl_buffer_sampler_new_at_level (src,
+                                         format,
+                                         GEGL_SAMPLER_LINEAR,
+                                         0);
+  GeglRectangle       bounding_box   = *gegl_buffer_get_abyss (src);
+  GeglRectangle       context_rect   = *gegl_sampler_get_context_rect (sampler);
+  GeglMatrix3         inverse;
+  GeglBufferIterator *i;
+  gdouble             base_u;
+  gdouble             base_v;
+
+  g_object_unref (sampler);
+
+  bounding_box.x      += context_rect.x;
+  bounding_box.y      += context_rect.y;
+  bounding_box.width  += context_rect.width  - 1;
+  bounding_box.height += context_rect.height - 1;
+
+  gegl_matrix3_copy_into (&inverse, matrix);
+  gegl_matrix3_invert (&inverse);
+
+  base_u = inverse.coeff [0][0] * ((gdouble) 0.5) +
+           inverse.coeff [0][1] * ((gdouble) 0.5) +
+           inverse.coeff [0][2];
+  base_v = inverse.coeff [1][0] * ((gdouble) 0.5) +
+           inverse.coeff [1][1] * ((gdouble) 0.5) +
+           inverse.coeff [1][2];
+
+  i = gegl_buffer_iterator_new (dest,
+                                roi,
+                                0,
+                                format,
+                                GEGL_ACCESS_WRITE,
+                                GEGL_ABYSS_NONE, 1);
+
+  while (gegl_buffer_iterator_next (i))
+    {
+      GeglRectangle *roi        = &i->items[0].roi;
+      gfloat        *dest_ptr   = i->items[0].data;
+      gint          *col_offset = gegl_scratch_new (gint,   roi->width);
+      gfloat        *col_weight = gegl_scratch_new (gfloat, roi->width);
+      gint          *row_offset = gegl_scratch_new (gint,   roi->height);
+      gfloat        *row_weight = gegl_scratch_new (gfloat, roi->height);
+      gint          *row_limits = gegl_scratch_new (gint,   2 * roi->height);
+      gint           col_x1     = roi->width;
+      gint           col_x2     = 0;
+      GeglRectangle  src_rect;
+      gfloat        *src_data;
+      gint           src_x2     = G_MININT;
+      gint           src_y2     = G_MININT;
+      gint           x;
+      gint           y;
+
+      gdouble u_start =
+        base_u +
+        inverse.coeff [0][0] * ( roi->x ) +
+        inverse.coeff [0][1] * ( roi->y );
+      gdouble v_start =
+        base_v +
+        inverse.coeff [1][0] * ( roi->x ) +
+        inverse.coeff [1][1] * ( roi->y );
+      gdouble u;
+
+      src_rect.x = G_MAXINT;
+      src_rect.y = G_MAXINT;
+
+      /*
+       * Find the output pixels of each row that are sampled, and the
+       * input rows they're interpolated between.
+       */
+      for (y = 0; y < roi->height; y++)
+        {
+          gint x1 = 0;
+          gint x2 = roi->width;
+
+          if (gegl_transform_scanline_limits (&inverse, inverse_near_z,
+                                              &bounding_box,
+                                              u_start, v_start, 1.0,
+                                              &x1, &x2) &&
+              x1 < x2)
+            {
+              const gdouble v_float = v_start + x1 * inverse.coeff [1][0];
+              const float   iv      = (float) (v_float * level_scale) - 0.5;
+              const gint    iy      = floorf (iv);
+
+              row_offset[y] = iy;
+              row_weight[y] = iv - iy;
+
+              src_rect.y = MIN (src_rect.y, iy);
+              src_y2     = MAX (src_y2, iy + 2);
+
+              col_x1 = MIN (col_x1, x1);
+              col_x2 = MAX (col_x2, x2);
+            }
+          else
+            {
+              x1 = x2 = 0;
+            }
+
+          row_limits[2 * y]     = x1;
+          row_limits[2 * y + 1] = x2;
+
+          v_start += inverse.coeff [1][1];
+        }
+
+      if (col_x1 < col_x2)
+        {
+          /*
+           * Likewise for the columns.  The scale is axis-aligned, so all rows
+           * share them.
+           */
+          u = u_start + col_x1 * inverse.coeff [0][0];
+
+          for (x = col_x1; x < col_x2; x++)
+            {
+              const float iu = (float) (u * level_scale) - 0.5;
+              const gint  ix = floorf (iu);
+
+              col_offset[x] = ix;
+              col_weight[x] = iu - ix;
+
+              src_rect.x = MIN (src_rect.x, ix);
+              src_x2     = MAX (src_x2, ix + 2);
+
+              u += inverse.coeff [0][0];
+            }
+
+          src_rect.width  = src_x2 - src_rect.x;
+          src_rect.height = src_y2 - src_rect.y;
+
+          for (x = col_x1; x < col_x2; x++)
+            col_offset[x] = (col_offset[x] - src_rect.x) * components;
+
+          src_data = gegl_scratch_new (gfloat, src_rect.width * src_rect.height *
+                                               components);
+
+          gegl_buffer_get (src, &src_rect, level_scale, format, src_data,
+                           GEGL_AUTO_ROWSTRIDE, abyss_policy);
+
+          for (y = 0; y < roi->height; y++)
+            {
+              const gint x1 = row_limits[2 * y];
+              const gint x2 = row_limits[2 * y + 1];
+
+              if (x1 < x2)
+                {
+                  const gfloat *top    = src_data +
+                                         (row_offset[y] - src_rect.y) *
+                                         src_rect.width * components;
+                  const gfloat *bottom = top + src_rect.width * components;
+
+                  memset (dest_ptr, 0, components * sizeof (gfloat) * x1);
+
+                  /* specialize the common case, so that the channel loop is
+                   * unrolled
+                   */
+                  if (components == 4)
+                    {
+                      gegl_transform_scale_row (dest_ptr + components * x1,
+                                                top, bottom,
+                                                col_offset, col_weight,
+                                                row_weight[y], x1, x2, 4);
+                    }
+                  else
+                    {
+                      gegl_transform_scale_row (dest_ptr + components * x1,
+                                                top, bottom,
+                                                col_offset, col_weight,
+                                                row_weight[y], x1, x2,
+                                                components);
+                    }
+
+                  memset (dest_ptr + components * x2, 0,
+                          components * sizeof (gfloat) * (roi->width - x2));
+                }
+              else
+                {
+                  memset (dest_ptr, 0, components * sizeof (gfloat) * roi->width);
+                }
+
+              dest_ptr += components * roi->width;
+            }
+
+          gegl_scratch_free (src_data);
+        }
+      else
+        {
+          memset (dest_ptr, 0,
+                  components * sizeof (gfloat) * roi->width * roi->height);
+        }
+
+      gegl_scratch_free (row_limits);
+      gegl_scratch_free (row_weight);
+      gegl_scratch_free (row_offset);
+      gegl_scratch_free (col_weight);
+      gegl_scratch_free (col_offset);
+    }
+}
+
+/*
+ * Resamples a uniform scale, followed by an integer translation, with the
+ * separable filter selected by the transform, using gegl_buffer_get().
+ */
+static void
+transform_filter (GeglOperation       *operation,
+                  GeglBuffer          *dest,
+                  GeglBuffer          *src,
+                  GeglMatrix3         *matrix,
+                  const GeglRectangle *roi,
+                  gint                 level)
+{
+  OpTransform        *transform    = (OpTransform *) operation;
+  const Babl         *format       = gegl_operation_get_format (operation, "output");
+  GeglAbyssPolicy     abyss_policy = gegl_transform_get_abyss_policy (transform);
+  GeglAbyssPolicy     filter       = gegl_transform_get_filter (transform);
+  gdouble             scale        = matrix->coeff [0][0];
+  gint                offset_x     = round (matrix->coeff [0][2]);
+  gint                offset_y     = round (matrix->coeff [1][2]);
+  GeglBufferIterator *i;
+
+  i = gegl_buffer_iterator_new (dest,
+                                roi,
+                                level,
+                                format,
+                                GEGL_ACCESS_WRITE,
+                                GEGL_ABYSS_NONE, 1);
+
+  while (gegl_buffer_iterator_next (i))
+    {
+      GeglRectangle src_roi = i->items[0].roi;
+
+      src_roi.x -= offset_x;
+      src_roi.y -= offset_y;
+
+      gegl_buffer_get (src, &src_roi, scale, format, i->items[0].data,
+                       GEGL_AUTO_ROWSTRIDE, abyss_policy | filter);
+    }
+}
+
 static inline gboolean is_zero (const gdouble f)
 {
   return (((gdouble) f)*((gdouble) f)
@@ -1592,6 +2158,127 @@ gegl_transform_matrix3_allow_fast_translate (GeglMatrix3 *matrix)
   return gegl_matrix3_is_translate (matrix);
 }
 
+/*
+ * Check if the matrix rotates by a multiple of 90 degrees, and/or flips,
+ * and translates by an integer vector, so that it maps pixel centers to
+ * pixel centers.
+ */
+static gboolean
+gegl_transform_matrix3_is_orthogonal (GeglMatrix3 *matrix)
+{
+  gint r, c;
+
+  if (! gegl_matrix3_is_affine (matrix))
+    return FALSE;
+
+  for (r = 0; r < 2; r++)
+    {
+      if (! is_zero (matrix->coeff [r][2] - round (matrix->coeff [r][2])))
+        return FALSE;
+
+      for (c = 0; c < 2; c++)
+        {
+          if (! is_zero (matrix->coeff [r][c]) &&
+              ! is_one (fabs (matrix->coeff [r][c])))
+            return FALSE;
+        }
+    }
+
+  /*
+   * Exactly one nonzero coefficient per row and column.
+   */
+  return is_zero (matrix->coeff [0][0]) != is_zero (matrix->coeff [0][1]) &&
+         is_zero (matrix->coeff [0][0]) == is_zero (matrix->coeff [1][1]) &&
+         is_zero (matrix->coeff [0][1]) == is_zero (matrix->coeff [1][0]);
+}
+
+/*
+ * Returns the mipmap level transform_scale() samples the input at, or -1
+ * if the matrix isn't an axis-aligned scale it handles.  Upscales, and
+ * downscales by less than a factor of 2, which the linear sampler doesn't
+ * box-filter, are sampled at level 0.  Larger downscales are left to the
+ * sampler's box filter at full quality; otherwise, they're sampled at the
+ * highest level that still leaves less than a factor of 2, in both
+ * directions.
+ */
+static gint
+gegl_transform_get_scale_level (OpTransform *transform,
+                                GeglMatrix3 *matrix)
+{
+  gdouble min_scale;
+  gdouble max_scale;
+  gint    level = 0;
+
+  if (transform->sampler != GEGL_SAMPLER_LINEAR      ||
+      ! gegl_matrix3_is_affine (matrix)               ||
+      ! is_zero (matrix->coeff [0][1])                ||
+      ! is_zero (matrix->coeff [1][0])                ||
+      is_zero (matrix->coeff [0][0])                  ||
+      is_zero (matrix->coeff [1][1]))
+    return -1;
+
+  /*
+   * The number of input pixels per output pixel, in each direction.
+   */
+  min_scale = 1.0 / MAX (fabs (matrix->coeff [0][0]),
+                         fabs (matrix->coeff [1][1]));
+  max_scale = 1.0 / MIN (fabs (matrix->coeff [0][0]),
+                         fabs (matrix->coeff [1][1]));
+
+  if (min_scale >= 2.0 && gegl_config ()->quality >= 1.0)
+    return -1;
+
+  while (min_scale >= 2.0)
+    {
+      min_scale /= 2.0;
+      max_scale /= 2.0;
+      level++;
+    }
+
+  /* too anisotropic for a single level */
+  if (max_scale >= 2.0)
+    return -1;
+
+  return level;
+}
+
+/*
+ * Returns TRUE if the transform resamples the input with a separable
+ * filter, which transform_filter() can do when the matrix is a uniform
+ * scale, followed by an integer translation.  The scale is returned in
+ * @scale.
+ */
+static gboolean
+gegl_transform_get_filter_scale (OpTransform *transform,
+                                 GeglMatrix3 *matrix,
+                                 gdouble     *scale)
+{
+  if (gegl_transform_get_filter (transform) == GEGL_BUFFER_FILTER_AUTO  ||
+      ! gegl_matrix3_is_affine (matrix)                                 ||
+      ! is_zero (matrix->coeff [0][1])                                  ||
+      ! is_zero (matrix->coeff [1][0])                                  ||
+      matrix->coeff [0][0] <= 0.0                                       ||
+      ! is_zero (matrix->coeff [0][0] - matrix->coeff [1][1])           ||
+      ! is_zero (matrix->coeff [0][2] - round (matrix->coeff [0][2]))   ||
+      ! is_zero (matrix->coeff [1][2] - round (matrix->coeff [1][2])))
+    return FALSE;
+
+  *scale = matrix->coeff [0][0];
+
+  return TRUE;
+}
+
+/*
+ * The number of input pixels past the sampled area gegl_buffer_get() reads
+ * when resampling with a separable filter: the support of the widest one,
+ * Lanczos-3, plus a block of the mipmap level downscales are read from.
+ */
+static gint
+gegl_transform_get_filter_margin (gdouble scale)
+{
+  return ceil (3.0 / MIN (scale, 1.0)) + ceil (1.0 / scale) + 1;
+}
+
 static gboolean
 gegl_transform_process (GeglOperation        *operation,
                         GeglOperationContext *context,
@@ -1602,6 +2289,7 @@ gegl_transform_process (GeglOperation        *operation,
   GeglBuffer  *input;
   GeglBuffer  *output;
   GeglMatrix3  matrix;
+  gdouble      filter_scale;
   OpTransform *transform = (OpTransform *) operation;
 
   gegl_transform_create_composite_matrix (transform, &matrix);
@@ -1667,6 +2355,29 @@ gegl_transform_process (GeglOperation        *operation,
       if (transform->sampler == GEGL_SAMPLER_NEAREST)
         func = transform_nearest;
 
+      /*
+       * Fast paths.  They only handle full resolution rendering; at lower
+       * levels, the generic code uses the nearest sampler anyway.
+       */
+      if (level == 0)
+        {
+          if (gegl_transform_get_filter_scale (transform, &matrix,
+                                               &filter_scale))
+            {
+              func = transform_filter;
+            }
+          else if ((transform->sampler == GEGL_SAMPLER_NEAREST ||
+                    transform->sampler == GEGL_SAMPLER_LINEAR) &&
+                   gegl_transform_matrix3_is_orthogonal (&matrix))
+            {
+              func = transform_orthogonal;
+            }
+          else if (gegl_transform_get_scale_level (transform, &matrix) >= 0)
+            {
+              func = transform_scale;
+            }
+        }
+
       input  = (GeglBuffer*) gegl_operation_context_dup_object (context, "input");
       output = gegl_operation_context_get_target (context, "output");
 
@@ -1677,6 +2388,7 @@ gegl_transform_process (GeglOperation        *operation,
       if (gegl_operation_use_threading (operation, result))
       {
         ThreadData data;
+        gboolean   freeze;
 
         data.func = func;
         data.matrix = &matrix;
@@ -1687,12 +2399,27 @@ gegl_transform_process (GeglOperation        *operation,
         data.roi = result;
         data.level = level;
 
+        /* all threads sample the input; freeze it, so that its tiles are
+         * looked up without locking, and the threads can share it, instead
+         * of each reading through a copy.  forked inputs, such as caches and
+         * buffers passed in by the application, may be modified while we're
+         * processing, so they're left alone.
+         */
+        freeze = input != output &&
+                 ! gegl_object_get_has_forked (G_OBJECT (input));
+
+        if (freeze)
+          gegl_buffer_freeze (input);
+
         gegl_parallel_distribute_area (
           result,
           gegl_operation_get_pixels_per_thread (operation),
           GEGL_SPLIT_STRATEGY_AUTO,
           (GeglParallelDistributeAreaFunc) thread_process,
           &data);
+
+        if (freeze)
+          gegl_buffer_thaw (input);
       }
       else
       {
@@ -32,6 +32,7 @@ struct _OpTransformClass
   void            (* create_matrix)    (OpTransform *transform,
                                         GeglMatrix3 *matrix);
   GeglAbyssPolicy (* get_abyss_policy) (OpTransform *transform);
+  GeglAbyssPolicy (* get_filter)       (OpTransform *transform);
 };
 
 GType op_transform_get_type (void) G_GNUC_CONST;
@@ -0,0 +1,47 @@
+#include "test-common.h"
+
+void chain5x (GeglBuffer *buffer);
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  GeglBuffer *buffer;
+
+  gegl_init (&argc, &argv);
+
+  buffer = test_buffer (4096, 2048, babl_format ("RGBA float"));
+
+  g_object_set (gegl_config (), "thread-affinity", FALSE, NULL);
+  bench ("chain_5x", buffer, &chain5x);
+
+  g_object_set (gegl_config (), "thread-affinity", TRUE, NULL);
+  bench ("chain_5x_affinity", buffer, &chain5x);
+
+  g_object_unref (buffer);
+
+  return 0;
+}
+
+/* levels and exposure process planar data, so the chain isn't fused into a
+ * single point op, and each op walks the tiles separately.
+ */
+void chain5x (GeglBuffer *buffer)
+{
+  GeglBuffer *buffer2;
+  GeglNode   *gegl, *source, *node1, *node2, *node3, *node4, *node5, *sink;
+
+  gegl = gegl_node_new ();
+  source = gegl_node_new_child (gegl, "operation", "gegl:buffer-source", "buffer", buffer, NULL);
+  node1 = gegl_node_new_child (gegl, "operation", "gegl:levels", "in-high", 0.9, NULL);
+  node2 = gegl_node_new_child (gegl, "operation", "gegl:exposure", "exposure", 0.1, NULL);
+  node3 = gegl_node_new_child (gegl, "operation", "gegl:levels", "in-high", 0.9, NULL);
+  node4 = gegl_node_new_child (gegl, "operation", "gegl:exposure", "exposure", 0.1, NULL);
+  node5 = gegl_node_new_child (gegl, "operation", "gegl:levels", "in-high", 0.9, NULL);
+  sink = gegl_node_new_child (gegl, "operation", "gegl:buffer-sink", "buffer", &buffer2, NULL);
+
+  gegl_node_link_many (source, node1, node2, node3, node4, node5, sink, NULL);
+  gegl_node_process (sink);
+  g_object_unref (gegl);
+  g_object_unref (buffer2);
+}
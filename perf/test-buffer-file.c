@@ -0,0 +1,163 @@
+#include "test-common.h"
+
+#include <glib/gstdio.h>
+
+#define SIZE  2048
+#define SCALE 0.125
+
+typedef enum
+{
+  FILE_LINKED,
+  FILE_FLAT,
+  FILE_FLAT_COMPRESSED
+} FileType;
+
+static const gchar *file_names[] = {"linked index",
+                                    "flat index",
+                                    "flat index, compressed"};
+
+static gchar *paths[3];
+
+/* a smooth image, whose tiles compress like those of a typical photo or
+ * rendering would
+ */
+static GeglBuffer *
+create_buffer (void)
+{
+  GeglRectangle  extent = {0, 0, SIZE, SIZE};
+  GeglBuffer    *buffer;
+  guchar        *row;
+  gint           x;
+  gint           y;
+
+  buffer = gegl_buffer_new (&extent, babl_format ("R'G'B'A u8"));
+  row    = g_malloc (SIZE * 4);
+
+  for (y = 0; y < SIZE; y++)
+    {
+      GeglRectangle rect = {0, y, SIZE, 1};
+
+      for (x = 0; x < SIZE; x++)
+        {
+          row[x * 4 + 0] = x / 8;
+          row[x * 4 + 1] = y / 8;
+          row[x * 4 + 2] = (x + y) / 16;
+          row[x * 4 + 3] = 255;
+        }
+
+      gegl_buffer_set (buffer, &rect, 0, babl_format ("R'G'B'A u8"),
+                       row, GEGL_AUTO_ROWSTRIDE);
+    }
+
+  g_free (row);
+
+  return buffer;
+}
+
+static void
+write_files (GeglBuffer  *buffer,
+             const gchar *dir)
+{
+  GeglBuffer *linked;
+  FileType    type;
+
+  for (type = FILE_LINKED; type <= FILE_FLAT_COMPRESSED; type++)
+    paths[type] = g_strdup_printf ("%s/buffer-%d.gegl", dir, type);
+
+  /* buffers backed by a file keep the linked index */
+  linked = g_object_new (GEGL_TYPE_BUFFER,
+                         "format", gegl_buffer_get_format (buffer),
+                         "path",   paths[FILE_LINKED],
+                         "width",  SIZE,
+                         "height", SIZE,
+                         NULL);
+  gegl_buffer_copy (buffer, NULL, GEGL_ABYSS_NONE, linked, NULL);
+  gegl_buffer_flush (linked);
+  g_object_unref (linked);
+
+  gegl_buffer_save (buffer, paths[FILE_FLAT], NULL);
+
+  g_object_set (gegl_config (), "file-compression", "fast", NULL);
+  gegl_buffer_save (buffer, paths[FILE_FLAT_COMPRESSED], NULL);
+  g_object_set (gegl_config (), "file-compression", NULL, NULL);
+
+  for (type = FILE_LINKED; type <= FILE_FLAT_COMPRESSED; type++)
+    {
+      GStatBuf stat_buf;
+
+      if (g_stat (paths[type], &stat_buf) == 0)
+        {
+          printf ("%s: %.2f mb\n",
+                  file_names[type], stat_buf.st_size / 1024.0 / 1024.0);
+        }
+    }
+}
+
+static void
+bench_load (FileType type,
+            gdouble  scale)
+{
+  GeglRectangle  rect = {0, 0, SIZE * scale, SIZE * scale};
+  guchar        *data = g_malloc (rect.width * rect.height * 4);
+  gchar         *id;
+  gint           i;
+
+  test_start ();
+  for (i = 0; i < ITERATIONS && converged < BAIL_COUNT; i++)
+    {
+      GeglBuffer *buffer;
+
+      test_start_iter ();
+
+      buffer = gegl_buffer_load (paths[type]);
+      gegl_buffer_get (buffer, &rect, scale, babl_format ("R'G'B'A u8"),
+                       data, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+      g_object_unref (buffer);
+
+      test_end_iter ();
+    }
+
+  id = g_strdup_printf ("load %s, scale %g", file_names[type], scale);
+  test_end (id, (gdouble) SIZE * SIZE * 4 * ITERATIONS);
+  g_free (id);
+
+  g_free (data);
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  GeglBuffer *buffer;
+  gchar      *dir;
+  FileType    type;
+
+  gegl_init (&argc, &argv);
+
+  dir = g_dir_make_tmp ("test-buffer-file-XXXXXX", NULL);
+
+  buffer = create_buffer ();
+  write_files (buffer, dir);
+  g_object_unref (buffer);
+
+  /* reading the whole buffer */
+  for (type = FILE_LINKED; type <= FILE_FLAT_COMPRESSED; type++)
+    bench_load (type, 1.0);
+
+  /* a zoomed-out view, which the flat files have stored levels for */
+  for (type = FILE_LINKED; type <= FILE_FLAT_COMPRESSED; type++)
+    bench_load (type, SCALE);
+
+  for (type = FILE_LINKED; type <= FILE_FLAT_COMPRESSED; type++)
+    {
+      g_unlink (paths[type]);
+      g_free (paths[type]);
+    }
+
+  g_remove (dir);
+  g_free (dir);
+
+  gegl_exit ();
+
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include "test-common.h"
+
+#define SIZE  2048
+#define SCALE 0.125
+
+static void
+bench_pyramid (const gchar *format_name,
+               gboolean     eager)
+{
+  const Babl    *format = babl_format (format_name);
+  GeglRectangle  rect   = {0, 0, SIZE * SCALE, SIZE * SCALE};
+  GeglBuffer    *buffer;
+  guchar        *data;
+  gchar         *id;
+  gint           i;
+
+  buffer = test_buffer (SIZE, SIZE, format);
+  data   = g_malloc (rect.width * rect.height *
+                     babl_format_get_bytes_per_pixel (format));
+
+  test_start ();
+  for (i = 0; i < ITERATIONS && converged < BAIL_COUNT; i++)
+    {
+      GeglBuffer *copy = gegl_buffer_dup (buffer);
+
+      test_start_iter ();
+
+      if (eager)
+        gegl_buffer_build_pyramid (copy, NULL, -1);
+
+      gegl_buffer_get (copy, &rect, SCALE, format,
+                       data, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+      test_end_iter ();
+
+      g_object_unref (copy);
+    }
+
+  id = g_strdup_printf ("%s pyramid %s", eager ? "eager" : "on-demand",
+                        format_name);
+  test_end (id, (gdouble) SIZE * SIZE *
+                babl_format_get_bytes_per_pixel (format) * ITERATIONS);
+  g_free (id);
+
+  g_free (data);
+  g_object_unref (buffer);
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  const gchar *formats[] = {"RGBA float", "RGBA u16", "RGBA u8", "R'G'B'A u8"};
+  gint         i;
+
+  gegl_init (&argc, &argv);
+
+  for (i = 0; i < (gint) G_N_ELEMENTS (formats); i++)
+    {
+      bench_pyramid (formats[i], FALSE);
+      bench_pyramid (formats[i], TRUE);
+    }
+
+  gegl_exit ();
+
+  return 0;
+}
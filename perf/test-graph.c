@@ -0,0 +1,153 @@
+#include "test-common.h"
+
+#define ROI_SIZE     256
+#define CHAIN_LENGTH 20
+
+static GeglNode *
+add_chain (GeglNode *gegl,
+           GeglNode *input,
+           gint      length)
+{
+  gint i;
+
+  for (i = 0; i < length; i++)
+    {
+      GeglNode *node;
+
+      if (i % 2)
+        {
+          node = gegl_node_new_child (gegl,
+                                      "operation", "gegl:brightness-contrast",
+                                      "contrast",   1.0 + 0.01 * i,
+                                      "brightness", 0.01,
+                                      NULL);
+        }
+      else
+        {
+          node = gegl_node_new_child (gegl,
+                                      "operation", "gegl:invert-linear",
+                                      NULL);
+        }
+
+      gegl_node_link (input, node);
+
+      input = node;
+    }
+
+  return input;
+}
+
+/* a long chain of point filters, followed by a blur.  returns the output
+ * node of the graph.
+ */
+static GeglNode *
+create_chain_graph (GeglNode   *gegl,
+                    GeglBuffer *buffer)
+{
+  GeglNode *source;
+  GeglNode *blur;
+
+  source = gegl_node_new_child (gegl, "operation", "gegl:buffer-source",
+                                "buffer", buffer, NULL);
+  blur   = gegl_node_new_child (gegl, "operation", "gegl:gaussian-blur",
+                                "std-dev-x", 2.0,
+                                "std-dev-y", 2.0,
+                                NULL);
+
+  gegl_node_link (add_chain (gegl, source, CHAIN_LENGTH), blur);
+
+  return blur;
+}
+
+/* two independent branches, composited on top of each other.  returns the
+ * output node of the graph.
+ */
+static GeglNode *
+create_branch_graph (GeglNode   *gegl,
+                     GeglBuffer *buffer)
+{
+  GeglNode *source;
+  GeglNode *over;
+
+  source = gegl_node_new_child (gegl, "operation", "gegl:buffer-source",
+                                "buffer", buffer, NULL);
+  over   = gegl_node_new_child (gegl, "operation", "gegl:over", NULL);
+
+  gegl_node_connect_to (add_chain (gegl, source, CHAIN_LENGTH / 2), "output",
+                        over,                                       "input");
+  gegl_node_connect_to (add_chain (gegl, source, CHAIN_LENGTH / 2), "output",
+                        over,                                       "aux");
+
+  return over;
+}
+
+static void
+bench_graph (const gchar *name,
+             GeglNode    *output,
+             gint         n_threads)
+{
+  GeglRectangle  roi    = {300, 200, ROI_SIZE, ROI_SIZE};
+  gfloat        *data   = g_new (gfloat, ROI_SIZE * ROI_SIZE * 4);
+  gchar         *id;
+  gint           i;
+
+  g_object_set (gegl_config (),
+                "threads", n_threads,
+                NULL);
+
+  /* warm up */
+  gegl_node_blit (output, 1.0, &roi, babl_format ("RGBA float"), data,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  test_start ();
+  for (i = 0; i < ITERATIONS && converged < BAIL_COUNT; i++)
+    {
+      test_start_iter ();
+      gegl_node_blit (output, 1.0, &roi, babl_format ("RGBA float"), data,
+                      GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+      test_end_iter ();
+    }
+
+  id = g_strdup_printf ("graph %s, %d thread%s",
+                        name, n_threads, n_threads == 1 ? "" : "s");
+  test_end (id, (gdouble) ROI_SIZE * ROI_SIZE * 16 * ITERATIONS);
+  g_free (id);
+
+  g_free (data);
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  GeglBuffer *buffer;
+  GeglNode   *gegl;
+  GeglNode   *output;
+  gint        n_threads;
+
+  gegl_init (&argc, &argv);
+
+  g_object_get (gegl_config (),
+                "threads", &n_threads,
+                NULL);
+
+  buffer = test_buffer (1024, 1024, babl_format ("RGBA float"));
+
+  gegl   = gegl_node_new ();
+  output = create_chain_graph (gegl, buffer);
+  bench_graph ("chain", output, 1);
+  bench_graph ("chain", output, n_threads);
+  g_object_unref (gegl);
+
+  gegl   = gegl_node_new ();
+  output = create_branch_graph (gegl, buffer);
+  bench_graph ("branches", output, 1);
+  bench_graph ("branches", output, n_threads);
+  g_object_unref (gegl);
+
+  g_object_unref (buffer);
+
+  gegl_exit ();
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+#include "test-common.h"
+
+#define SIZE     1024
+#define N_OUTER  8
+
+typedef enum
+{
+  COST_UNIFORM,
+  COST_BAND,
+  COST_CORNER
+} CostDistribution;
+
+static const gchar *cost_names[] = {"uniform", "band", "corner"};
+
+/* returns the relative cost of processing a pixel, simulating operations
+ * whose cost varies across the image, such as an expensive region of a
+ * fractal, or tiles that need to be read back from the swap.
+ */
+static inline gint
+pixel_cost (CostDistribution distribution,
+            gint             x,
+            gint             y)
+{
+  switch (distribution)
+    {
+    case COST_UNIFORM:
+      return 4;
+
+    case COST_BAND:
+      /* the first eighth of the rows is 32 times as expensive */
+      return y < SIZE / 8 ? 32 : 1;
+
+    case COST_CORNER:
+      /* the top-left 1/64th of the area is 256 times as expensive */
+      return x < SIZE / 8 && y < SIZE / 8 ? 256 : 1;
+    }
+
+  return 1;
+}
+
+static void
+process_area (const GeglRectangle *area,
+              gpointer             user_data)
+{
+  CostDistribution distribution = GPOINTER_TO_INT (user_data);
+  volatile guint32 sum          = 0;
+  gint             x;
+  gint             y;
+
+  for (y = area->y; y < area->y + area->height; y++)
+    {
+      for (x = area->x; x < area->x + area->width; x++)
+        {
+          guint32 state = x * 31 + y;
+          gint    cost  = pixel_cost (distribution, x, y);
+          gint    i;
+
+          for (i = 0; i < cost; i++)
+            state = state * 1103515245 + 12345;
+
+          sum += state;
+        }
+    }
+}
+
+static void
+run_area (CostDistribution distribution)
+{
+  GeglRectangle area = {0, 0, SIZE, SIZE};
+
+  gegl_parallel_distribute_area (&area, 4096.0,
+                                 GEGL_SPLIT_STRATEGY_AUTO,
+                                 process_area,
+                                 GINT_TO_POINTER (distribution));
+}
+
+/* each outer part processes a horizontal strip, distributing it further
+ * from within the outer distributed function.
+ */
+static void
+process_outer (gsize    offset,
+               gsize    size,
+               gpointer user_data)
+{
+  gsize i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      GeglRectangle area = {0, i * (SIZE / N_OUTER), SIZE, SIZE / N_OUTER};
+
+      gegl_parallel_distribute_area (&area, 4096.0,
+                                     GEGL_SPLIT_STRATEGY_AUTO,
+                                     process_area,
+                                     user_data);
+    }
+}
+
+static void
+run_nested (CostDistribution distribution)
+{
+  gegl_parallel_distribute_range (N_OUTER, 0.0,
+                                  process_outer,
+                                  GINT_TO_POINTER (distribution));
+}
+
+static void
+bench_parallel (const gchar      *name,
+                void            (*run) (CostDistribution distribution),
+                CostDistribution  distribution)
+{
+  gchar *id;
+  gint   i;
+
+  /* warm up */
+  run (distribution);
+
+  test_start ();
+  for (i = 0; i < ITERATIONS && converged < BAIL_COUNT; i++)
+    {
+      test_start_iter ();
+      run (distribution);
+      test_end_iter ();
+    }
+
+  id = g_strdup_printf ("parallel %s, %s cost", name, cost_names[distribution]);
+  test_end (id, (gdouble) SIZE * SIZE * 16 * ITERATIONS);
+  g_free (id);
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  CostDistribution distribution;
+
+  gegl_init (&argc, &argv);
+
+  for (distribution = COST_UNIFORM; distribution <= COST_CORNER; distribution++)
+    bench_parallel ("area", run_area, distribution);
+
+  for (distribution = COST_UNIFORM; distribution <= COST_CORNER; distribution++)
+    bench_parallel ("nested", run_nested, distribution);
+
+  gegl_exit ();
+
+  return 0;
+}
@@ -0,0 +1,132 @@
+#include "test-common.h"
+
+#define BPP         16
+#define N_BUFFERS   4
+#define N_ACCESSES  4096
+#define MAX_THREADS 64
+
+typedef struct
+{
+  GeglBuffer *buffer;
+  gint        seed;
+} ThreadData;
+
+static GeglBuffer *buffers[N_BUFFERS];
+
+/* read single pixels at pseudo-random, fully cached, locations of the
+ * thread's buffer.  each access goes through a tile-cache lookup, so the
+ * total throughput is bound by the scalability of the cache hit path.
+ */
+static gpointer
+cache_hits_thread (gpointer user_data)
+{
+  ThreadData          *data   = user_data;
+  const GeglRectangle *extent = gegl_buffer_get_extent (data->buffer);
+  const Babl          *format = babl_format ("RGBA float");
+  guint32              state  = data->seed;
+  gfloat               pixel[4];
+  gint                 i;
+
+  for (i = 0; i < N_ACCESSES; i++)
+    {
+      GeglRectangle rect = {0, 0, 1, 1};
+
+      state  = state * 1103515245 + 12345;
+      rect.x = (state >> 8) % extent->width;
+      state  = state * 1103515245 + 12345;
+      rect.y = (state >> 8) % extent->height;
+
+      gegl_buffer_get (data->buffer, &rect, 1.0, format, pixel,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+    }
+
+  return NULL;
+}
+
+static void
+run_threads (gint     n_threads,
+             gboolean shared)
+{
+  GThread    *threads[MAX_THREADS];
+  ThreadData  data[MAX_THREADS];
+  gint        i;
+
+  for (i = 0; i < n_threads; i++)
+    {
+      data[i].buffer = buffers[shared ? 0 : i % N_BUFFERS];
+      data[i].seed   = i + 1;
+
+      threads[i] = g_thread_new (NULL, cache_hits_thread, &data[i]);
+    }
+
+  for (i = 0; i < n_threads; i++)
+    g_thread_join (threads[i]);
+}
+
+static void
+bench_threads (gint     n_threads,
+               gboolean shared)
+{
+  gchar *id;
+  gint   hits;
+  gint   misses;
+  gint   i;
+
+  /* warm up */
+  run_threads (n_threads, shared);
+
+  gegl_reset_stats ();
+
+  test_start ();
+  for (i = 0; i < ITERATIONS && converged < BAIL_COUNT; i++)
+    {
+      test_start_iter ();
+      run_threads (n_threads, shared);
+      test_end_iter ();
+    }
+
+  g_object_get (gegl_stats (),
+                "tile-cache-hits",   &hits,
+                "tile-cache-misses", &misses,
+                NULL);
+
+  id = g_strdup_printf ("tile-cache hits, %s buffer%s, %d thread%s",
+                        shared ? "shared" : "separate",
+                        shared ? ""       : "s",
+                        n_threads,
+                        n_threads == 1 ? "" : "s");
+  test_end_suffix (id, "",
+                   (gdouble) n_threads * N_ACCESSES * ITERATIONS * BPP);
+  g_print ("  hit ratio: %.2f%%\n",
+           100.0 * hits / MAX (hits + misses, 1));
+  g_free (id);
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  gint max_threads;
+  gint n_threads;
+  gint i;
+
+  gegl_init (&argc, &argv);
+
+  for (i = 0; i < N_BUFFERS; i++)
+    buffers[i] = test_buffer (1024, 1024, babl_format ("RGBA float"));
+
+  max_threads = MIN (g_get_num_processors (), MAX_THREADS);
+
+  for (n_threads = 1; n_threads <= max_threads; n_threads *= 2)
+    bench_threads (n_threads, FALSE);
+
+  for (n_threads = 1; n_threads <= max_threads; n_threads *= 2)
+    bench_threads (n_threads, TRUE);
+
+  for (i = 0; i < N_BUFFERS; i++)
+    g_object_unref (buffers[i]);
+
+  gegl_exit ();
+
+  return 0;
+}
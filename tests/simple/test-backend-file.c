@@ -17,9 +17,14 @@
 #include "gegl.h"
 #include "gegl-buffer-backend.h"
 #include "gegl-tile-backend-file.h"
+#include "gegl-tile-backend-mmap.h"
+#include "gegl-buffer-index.h"
 
 #include <glib/gstdio.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -153,6 +158,7 @@ test_buffer_load (void)
   gchar           *tmpdir = NULL;
   gchar           *buf_a_path = NULL;
   GeglBuffer      *buf_a = NULL;
+  GeglTileBackend *backend_a = NULL;
   const Babl      *format = babl_format ("R'G'B'A u8");
   GeglRectangle    roi = {0, 0, 128, 128};
 
@@ -198,7 +204,399 @@ test_buffer_load (void)
       result = FALSE;
     }
 
+  g_object_get (buf_a,
+                "backend", &backend_a,
+                NULL);
+
+  if (GEGL_IS_TILE_BACKEND_MMAP (backend_a))
+    {
+      printf ("Buffer used the mmap backend.\n");
+      result = FALSE;
+    }
+
+  g_object_unref (backend_a);
+
+  g_object_unref (buf_a);
+
+  g_unlink (buf_a_path);
+  g_remove (tmpdir);
+
+  g_free (tmpdir);
+  g_free (buf_a_path);
+
+  return result;
+}
+
+static gboolean
+test_buffer_load_mapped (void)
+{
+  gboolean         result = TRUE;
+  gchar           *tmpdir = NULL;
+  gchar           *buf_a_path = NULL;
+  GeglBuffer      *buf_a = NULL;
+  GeglBuffer      *buf_b = NULL;
+  GeglTileBackend *backend_b = NULL;
+  const Babl      *format = babl_format ("R'G'B'A u8");
+  GeglRectangle    roi = {0, 0, 300, 200};
+  guchar          *data;
+  guchar          *result_data;
+  gint             i;
+
+  tmpdir = g_dir_make_tmp ("test-backend-file-XXXXXX", NULL);
+  g_return_val_if_fail (tmpdir, FALSE);
+
+  buf_a_path = g_build_filename (tmpdir, "buf_a.gegl", NULL);
+
+  data        = g_malloc (roi.width * roi.height * 4);
+  result_data = g_malloc (roi.width * roi.height * 4);
+
+  for (i = 0; i < roi.width * roi.height * 4; i++)
+    data[i] = i % 251;
+
+  buf_a = gegl_buffer_new (&roi, format);
+  gegl_buffer_set (buf_a, &roi, 0, format, data, GEGL_AUTO_ROWSTRIDE);
+  gegl_buffer_save (buf_a, buf_a_path, &roi);
+  g_object_unref (buf_a);
+
+  buf_b = gegl_buffer_load_mapped (buf_a_path);
+
+  g_object_get (buf_b,
+                "backend", &backend_b,
+                NULL);
+
+  if (!GEGL_IS_TILE_BACKEND_MMAP (backend_b))
+    {
+      printf ("Buffer did not use the mmap backend.\n");
+      result = FALSE;
+    }
+
+  g_object_unref (backend_b);
+
+  gegl_buffer_get (buf_b, &roi, 1.0, format, result_data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  if (memcmp (data, result_data, roi.width * roi.height * 4))
+    {
+      printf ("Mapped data does not match.\n");
+      result = FALSE;
+    }
+
+  /* modifying the loaded buffer should not affect the file */
+  memset (result_data, 0xff, roi.width * roi.height * 4);
+  gegl_buffer_set (buf_b, &roi, 0, format, result_data, GEGL_AUTO_ROWSTRIDE);
+
+  buf_a = gegl_buffer_load (buf_a_path);
+
+  gegl_buffer_get (buf_a, &roi, 1.0, format, result_data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  if (memcmp (data, result_data, roi.width * roi.height * 4))
+    {
+      printf ("File data was modified.\n");
+      result = FALSE;
+    }
+
+  gegl_buffer_get (buf_b, &roi, 1.0, format, result_data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  for (i = 0; i < roi.width * roi.height * 4; i++)
+    {
+      if (result_data[i] != 0xff)
+        {
+          printf ("Modified data does not match.\n");
+          result = FALSE;
+          break;
+        }
+    }
+
+  g_object_unref (buf_a);
+
+  /* saving over the file replaces it, rather than modifying the mapping */
+  buf_a = gegl_buffer_load_mapped (buf_a_path);
+
+  gegl_buffer_save (buf_b, buf_a_path, &roi);
+
+  gegl_buffer_get (buf_a, &roi, 1.0, format, result_data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  if (memcmp (data, result_data, roi.width * roi.height * 4))
+    {
+      printf ("Mapped data changed when saving over the file.\n");
+      result = FALSE;
+    }
+
+  g_object_unref (buf_a);
+  g_object_unref (buf_b);
+
+  buf_b = gegl_buffer_load (buf_a_path);
+
+  gegl_buffer_get (buf_b, &roi, 1.0, format, result_data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  for (i = 0; i < roi.width * roi.height * 4; i++)
+    {
+      if (result_data[i] != 0xff)
+        {
+          printf ("Saved data does not match.\n");
+          result = FALSE;
+          break;
+        }
+    }
+
+  g_object_unref (buf_b);
+
+  g_free (result_data);
+  g_free (data);
+
+  g_unlink (buf_a_path);
+  g_remove (tmpdir);
+
+  g_free (tmpdir);
+  g_free (buf_a_path);
+
+  return result;
+}
+
+static gboolean
+test_buffer_save_levels (void)
+{
+  gboolean         result = TRUE;
+  gchar           *tmpdir = NULL;
+  gchar           *buf_a_path = NULL;
+  GeglBuffer      *buf_a = NULL;
+  GeglBuffer      *buf_b = NULL;
+  const Babl      *format = babl_format ("R'G'B'A u8");
+  GeglRectangle    roi = {0, 0, 512, 512};
+  GeglRectangle    scaled_roi = {0, 0, 128, 128};
+  guchar          *data;
+  guchar          *result_data;
+  guchar          *scaled_data;
+  guchar          *scaled_result_data;
+  gint             i;
+
+  tmpdir = g_dir_make_tmp ("test-backend-file-XXXXXX", NULL);
+  g_return_val_if_fail (tmpdir, FALSE);
+
+  buf_a_path = g_build_filename (tmpdir, "buf_a.gegl", NULL);
+
+  data               = g_malloc (roi.width * roi.height * 4);
+  result_data        = g_malloc (roi.width * roi.height * 4);
+  scaled_data        = g_malloc (scaled_roi.width * scaled_roi.height * 4);
+  scaled_result_data = g_malloc (scaled_roi.width * scaled_roi.height * 4);
+
+  /* smooth data, which compresses */
+  for (i = 0; i < roi.width * roi.height * 4; i++)
+    data[i] = (i / 4 / roi.width) + (i % 4);
+
+  buf_a = gegl_buffer_new (&roi, format);
+  gegl_buffer_set (buf_a, &roi, 0, format, data, GEGL_AUTO_ROWSTRIDE);
+  gegl_buffer_get (buf_a, &scaled_roi, 0.25, format, scaled_data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  g_object_set (gegl_config (),
+                "file-compression", "fast",
+                NULL);
+  gegl_buffer_save (buf_a, buf_a_path, &roi);
+  g_object_set (gegl_config (),
+                "file-compression", NULL,
+                NULL);
+
+  g_object_unref (buf_a);
+
+  buf_b = gegl_buffer_load_mapped (buf_a_path);
+
+  gegl_buffer_get (buf_b, &roi, 1.0, format, result_data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  if (memcmp (data, result_data, roi.width * roi.height * 4))
+    {
+      printf ("Compressed data does not match.\n");
+      result = FALSE;
+    }
+
+  /* the zoomed-out view comes from the stored levels */
+  gegl_buffer_get (buf_b, &scaled_roi, 0.25, format, scaled_result_data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  if (memcmp (scaled_data, scaled_result_data,
+              scaled_roi.width * scaled_roi.height * 4))
+    {
+      printf ("Stored level data does not match.\n");
+      result = FALSE;
+    }
+
+  /* and is updated when the buffer is modified */
+  memset (result_data, 0xff, roi.width * roi.height * 4);
+  gegl_buffer_set (buf_b, &roi, 0, format, result_data, GEGL_AUTO_ROWSTRIDE);
+
+  gegl_buffer_get (buf_b, &scaled_roi, 0.25, format, scaled_result_data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  for (i = 0; i < scaled_roi.width * scaled_roi.height * 4; i++)
+    {
+      if (scaled_result_data[i] != 0xff)
+        {
+          printf ("Stored level was not updated.\n");
+          result = FALSE;
+          break;
+        }
+    }
+
+  g_object_unref (buf_b);
+
+  /* the file backend reads the compressed tiles too */
+  buf_b = gegl_buffer_open (buf_a_path);
+
+  gegl_buffer_get (buf_b, &roi, 1.0, format, result_data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  if (memcmp (data, result_data, roi.width * roi.height * 4))
+    {
+      printf ("Opened compressed data does not match.\n");
+      result = FALSE;
+    }
+
+  g_object_unref (buf_b);
+
+  g_free (scaled_result_data);
+  g_free (scaled_data);
+  g_free (result_data);
+  g_free (data);
+
+  g_unlink (buf_a_path);
+  g_remove (tmpdir);
+
+  g_free (tmpdir);
+  g_free (buf_a_path);
+
+  return result;
+}
+
+/* files saved without compression can still be read by following the
+ * linked index of revision 0, while files with compressed tiles can't, and
+ * have a different magic.
+ */
+static gboolean
+test_buffer_save_linked_index (void)
+{
+  gboolean         result = TRUE;
+  gchar           *tmpdir = NULL;
+  gchar           *buf_a_path = NULL;
+  GeglBuffer      *buf_a = NULL;
+  const Babl      *format = babl_format ("R'G'B'A u8");
+  GeglRectangle    roi = {0, 0, 256, 256};
+  GeglBufferItem  *header;
+  GList           *tiles;
+  GList           *iter;
+  goffset          offset;
+  guchar          *data;
+  gint             tile_size;
+  gint             n_tiles = 0;
+  gint             i;
+  int              fd;
+
+  tmpdir = g_dir_make_tmp ("test-backend-file-XXXXXX", NULL);
+  g_return_val_if_fail (tmpdir, FALSE);
+
+  buf_a_path = g_build_filename (tmpdir, "buf_a.gegl", NULL);
+
+  data = g_malloc (roi.width * roi.height * 4);
+  memset (data, 0x80, roi.width * roi.height * 4);
+
+  buf_a = gegl_buffer_new (&roi, format);
+  gegl_buffer_set (buf_a, &roi, 0, format, data, GEGL_AUTO_ROWSTRIDE);
+
+  gegl_buffer_save (buf_a, buf_a_path, &roi);
+
+  fd = g_open (buf_a_path, O_RDONLY, 0);
+  header = gegl_buffer_read_header (fd, NULL);
+
+  if (memcmp (header->header.magic, "GEGL", 4) || ! header->header.next)
+    {
+      printf ("Uncompressed file has no linked index.\n");
+      result = FALSE;
+    }
+
+  if (header->header.n_levels != 1)
+    {
+      printf ("Saving generated mipmap levels.\n");
+      result = FALSE;
+    }
+
+  tile_size = header->header.tile_width *
+              header->header.tile_height *
+              header->header.bytes_per_pixel;
+  offset    = header->header.next;
+  tiles     = gegl_buffer_read_index (fd, &offset);
+
+  for (iter = tiles; iter; iter = iter->next)
+    {
+      GeglBufferTile *entry = iter->data;
+
+      if (entry->z != 0)
+        {
+          printf ("Saved tile %d, %d of level %d, which didn't exist.\n",
+                  entry->x, entry->y, entry->z);
+          result = FALSE;
+          continue;
+        }
+
+      memset (data, 0, tile_size);
+
+      if (lseek (fd, entry->offset, SEEK_SET) != entry->offset ||
+          read (fd, data, tile_size) != tile_size)
+        {
+          printf ("Failed reading linked tile %d, %d.\n", entry->x, entry->y);
+          result = FALSE;
+          continue;
+        }
+
+      for (i = 0; i < tile_size; i++)
+        {
+          if (data[i] != 0x80)
+            {
+              printf ("Linked tile %d, %d does not match.\n",
+                      entry->x, entry->y);
+              result = FALSE;
+              break;
+            }
+        }
+
+      n_tiles++;
+    }
+
+  if (n_tiles == 0)
+    {
+      printf ("Linked index has no tiles.\n");
+      result = FALSE;
+    }
+
+  g_list_free_full (tiles, g_free);
+  g_free (header);
+  close (fd);
+
+  g_object_set (gegl_config (),
+                "file-compression", "fast",
+                NULL);
+  gegl_buffer_save (buf_a, buf_a_path, &roi);
+  g_object_set (gegl_config (),
+                "file-compression", NULL,
+                NULL);
+
+  fd = g_open (buf_a_path, O_RDONLY, 0);
+  header = gegl_buffer_read_header (fd, NULL);
+
+  if (memcmp (header->header.magic, "GEGZ", 4) || header->header.next)
+    {
+      printf ("Compressed file can be read as revision 0.\n");
+      result = FALSE;
+    }
+
+  g_free (header);
+  close (fd);
+
   g_object_unref (buf_a);
+  g_free (data);
 
   g_unlink (buf_a_path);
   g_remove (tmpdir);
@@ -439,6 +837,9 @@ int main(int argc, char **argv)
   RUN_TEST (test_buffer_path)
   RUN_TEST (test_buffer_path_from_backend)
   RUN_TEST (test_buffer_load)
+  RUN_TEST (test_buffer_load_mapped)
+  RUN_TEST (test_buffer_save_levels)
+  RUN_TEST (test_buffer_save_linked_index)
   RUN_TEST (test_buffer_same_path)
   RUN_TEST (test_buffer_open)
   RUN_TEST (test_buffer_change_extent)
@@ -0,0 +1,492 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <glib/gstdio.h>
+
+#include <gegl.h>
+#include <gegl-buffer-backend.h>
+#include "gegl-tile-backend-swap.h"
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-tile-backend-swap/" #function, function);
+
+#define TILE_WIDTH  64
+#define TILE_HEIGHT 64
+#define TILE_SIZE   (TILE_WIDTH * TILE_HEIGHT * 4)
+
+
+static GeglTileBackend *
+swap_backend_new (void)
+{
+  return g_object_new (GEGL_TYPE_TILE_BACKEND_SWAP,
+                       "tile-width",  TILE_WIDTH,
+                       "tile-height", TILE_HEIGHT,
+                       "format",      babl_format ("R'G'B'A u8"),
+                       NULL);
+}
+
+/* returns the i-th byte of a tile written with @value.  noisy data doesn't
+ * compress, while other data compresses well.
+ */
+static inline guchar
+tile_byte (guchar   value,
+           gboolean noisy,
+           gint     i)
+{
+  if (noisy)
+    return value ^ (guchar) ((i * 2654435761u) >> 24);
+  else
+    return value;
+}
+
+static void
+write_tile (GeglTileBackend *backend,
+            gint             x,
+            guchar           value,
+            gboolean         noisy)
+{
+  GeglTile *tile = gegl_tile_new (TILE_SIZE);
+  guchar   *data = gegl_tile_get_data (tile);
+  gint      i;
+
+  for (i = 0; i < TILE_SIZE; i++)
+    data[i] = tile_byte (value, noisy, i);
+
+  gegl_tile_source_set_tile (GEGL_TILE_SOURCE (backend), x, 0, 0, tile);
+
+  gegl_tile_unref (tile);
+}
+
+static void
+check_tile (GeglTileBackend *backend,
+            gint             x,
+            guchar           value,
+            gboolean         noisy)
+{
+  GeglTile *tile;
+  guchar   *data;
+  gint      i;
+
+  tile = gegl_tile_source_get_tile (GEGL_TILE_SOURCE (backend), x, 0, 0);
+
+  g_assert_nonnull (tile);
+
+  data = gegl_tile_get_data (tile);
+
+  for (i = 0; i < TILE_SIZE; i++)
+    {
+      if (data[i] != tile_byte (value, noisy, i))
+        g_assert_cmpint (data[i], ==, tile_byte (value, noisy, i));
+    }
+
+  gegl_tile_unref (tile);
+}
+
+static void
+prefetch_tile (GeglTileBackend *backend,
+               gint             x)
+{
+  gegl_tile_source_command (GEGL_TILE_SOURCE (backend),
+                            GEGL_TILE_PREFETCH, x, 0, 0, NULL);
+}
+
+/* waits for the writer threads to serve all the queued ops */
+static void
+wait_idle (void)
+{
+  while (gegl_tile_backend_swap_get_busy ())
+    g_usleep (1000);
+}
+
+/* waits for the reader threads to serve all the queued reads */
+static void
+wait_reads (void)
+{
+  while (gegl_tile_backend_swap_get_queue_depth () > 0)
+    g_usleep (1000);
+}
+
+static void
+set_pool_size (guint64 size)
+{
+  g_object_set (gegl_config (),
+                "swap-compression", "fast",
+                "swap-pool-size",   size,
+                NULL);
+}
+
+/* returns the compressed size of a tile written by write_tile() */
+static guint64
+get_pooled_tile_size (void)
+{
+  GeglTileBackend *backend = swap_backend_new ();
+  guint64          size;
+
+  set_pool_size (16 << 20);
+
+  write_tile (backend, 0, 0, FALSE);
+  wait_idle ();
+
+  size = gegl_tile_backend_swap_get_pool_total ();
+
+  g_assert_cmpuint (size, >, 0);
+  g_assert_cmpuint (size, <, TILE_SIZE);
+
+  g_object_unref (backend);
+  wait_idle ();
+
+  return size;
+}
+
+/**
+ * Tests that written tiles are kept compressed in the pool, and read back
+ * from it, without touching the swap file.
+ **/
+static void
+pool_hit (void)
+{
+  GeglTileBackend *backend = swap_backend_new ();
+  const gint       n       = 16;
+  gint             i;
+
+  set_pool_size (16 << 20);
+
+  gegl_tile_backend_swap_reset_stats ();
+
+  for (i = 0; i < n; i++)
+    write_tile (backend, i, i, FALSE);
+
+  wait_idle ();
+
+  g_assert_cmpuint (gegl_tile_backend_swap_get_pool_total_uncompressed (), ==,
+                    n * TILE_SIZE);
+  g_assert_cmpuint (gegl_tile_backend_swap_get_write_total (), ==, 0);
+
+  for (i = 0; i < n; i++)
+    check_tile (backend, i, i, FALSE);
+
+  g_assert_cmpint (gegl_tile_backend_swap_get_pool_hits (), ==, n);
+  g_assert_cmpint (gegl_tile_backend_swap_get_pool_misses (), ==, 0);
+  g_assert_cmpuint (gegl_tile_backend_swap_get_read_total (), ==, 0);
+
+  g_object_unref (backend);
+  wait_idle ();
+
+  g_assert_cmpuint (gegl_tile_backend_swap_get_pool_total (), ==, 0);
+}
+
+/**
+ * Tests that once the pool is full, the least-recently used tiles are
+ * written to the swap file, with the data compressed for the pool, and are
+ * read back from there.
+ **/
+static void
+pool_evict (void)
+{
+  GeglTileBackend *backend;
+  const gint       n         = 16;
+  const gint       n_pooled  = 4;
+  guint64          tile_size = get_pooled_tile_size ();
+  gint             i;
+
+  backend = swap_backend_new ();
+
+  set_pool_size (n_pooled * tile_size);
+
+  gegl_tile_backend_swap_reset_stats ();
+
+  for (i = 0; i < n; i++)
+    write_tile (backend, i, i, FALSE);
+
+  wait_idle ();
+
+  g_assert_cmpuint (gegl_tile_backend_swap_get_pool_total (), ==,
+                    n_pooled * tile_size);
+  g_assert_cmpuint (gegl_tile_backend_swap_get_write_total (), ==,
+                    (n - n_pooled) * tile_size);
+
+  for (i = 0; i < n; i++)
+    check_tile (backend, i, i, FALSE);
+
+  g_assert_cmpint (gegl_tile_backend_swap_get_pool_hits (), ==, n_pooled);
+  g_assert_cmpint (gegl_tile_backend_swap_get_pool_misses (), ==,
+                   n - n_pooled);
+  g_assert_cmpuint (gegl_tile_backend_swap_get_read_total (), ==,
+                    (n - n_pooled) * tile_size);
+
+  g_object_unref (backend);
+  wait_idle ();
+
+  g_assert_cmpuint (gegl_tile_backend_swap_get_pool_total (), ==, 0);
+}
+
+/**
+ * Tests that rewriting tiles faster than the writer threads can serve them
+ * drops the pending writes of older data, whether they're still queued, or
+ * already being compressed for the pool, so that the pool ends up holding
+ * only the newest data, and nothing reaches the swap file.
+ **/
+static void
+pool_drop_pending (void)
+{
+  GeglTileBackend *backend  = swap_backend_new ();
+  const gint       n        = 8;
+  const gint       n_rounds = 64;
+  gint             round;
+  gint             i;
+
+  set_pool_size (16 << 20);
+
+  gegl_tile_backend_swap_reset_stats ();
+
+  for (round = 0; round < n_rounds; round++)
+    {
+      for (i = 0; i < n; i++)
+        write_tile (backend, i, round, FALSE);
+    }
+
+  wait_idle ();
+
+  g_assert_cmpuint (gegl_tile_backend_swap_get_pool_total_uncompressed (), ==,
+                    n * TILE_SIZE);
+  g_assert_cmpuint (gegl_tile_backend_swap_get_write_total (), ==, 0);
+
+  for (i = 0; i < n; i++)
+    check_tile (backend, i, n_rounds - 1, FALSE);
+
+  g_object_unref (backend);
+  wait_idle ();
+
+  g_assert_cmpuint (gegl_tile_backend_swap_get_pool_total (), ==, 0);
+}
+
+/**
+ * Tests that tiles read ahead of time are served from the read-ahead data,
+ * rather than read again.
+ **/
+static void
+prefetch_hit (void)
+{
+  GeglTileBackend *backend = swap_backend_new ();
+  const gint       n       = 16;
+  gint             i;
+
+  set_pool_size (0);
+
+  for (i = 0; i < n; i++)
+    write_tile (backend, i, i, i % 2);
+
+  wait_idle ();
+
+  gegl_tile_backend_swap_reset_stats ();
+
+  for (i = 0; i < n; i++)
+    prefetch_tile (backend, i);
+
+  wait_reads ();
+
+  for (i = 0; i < n; i++)
+    check_tile (backend, i, i, i % 2);
+
+  g_assert_cmpint (gegl_tile_backend_swap_get_prefetch_hits (), ==, n);
+
+  g_object_unref (backend);
+  wait_idle ();
+}
+
+/**
+ * Tests that overwriting a tile while it's being read ahead of time, or
+ * after it was, discards the stale data, however far the read got.
+ **/
+static void
+prefetch_overwrite (void)
+{
+  GeglTileBackend *backend  = swap_backend_new ();
+  const gint       n        = 16;
+  const gint       n_rounds = 16;
+  gint             round;
+  gint             i;
+
+  set_pool_size (0);
+
+  gegl_tile_backend_swap_reset_stats ();
+
+  for (round = 0; round < n_rounds; round++)
+    {
+      for (i = 0; i < n; i++)
+        write_tile (backend, i, 2 * round, FALSE);
+
+      wait_idle ();
+
+      /* the new data is noisy, so that its stored size differs from that of
+       * the data being read.  every other round, the reads are given some
+       * time to progress before the tiles are overwritten.
+       */
+      for (i = 0; i < n; i++)
+        {
+          prefetch_tile (backend, i);
+
+          if (round % 2)
+            g_usleep (100);
+
+          write_tile (backend, i, 2 * round + 1, TRUE);
+        }
+
+      for (i = 0; i < n; i++)
+        check_tile (backend, i, 2 * round + 1, TRUE);
+
+      wait_idle ();
+      wait_reads ();
+
+      for (i = 0; i < n; i++)
+        check_tile (backend, i, 2 * round + 1, TRUE);
+    }
+
+  g_assert_cmpint (gegl_tile_backend_swap_get_prefetch_hits (), ==, 0);
+
+  g_object_unref (backend);
+  wait_idle ();
+}
+
+#define N_WRITER_THREADS 4
+#define N_WRITER_TILES   8
+#define N_WRITER_ROUNDS  32
+
+/* the data written to tile @x in @round by writer_thread_func() */
+#define WRITER_TILE_VALUE(seed, round, x) ((seed) + (round) + (x))
+#define WRITER_TILE_NOISY(round, x)       (((round) + (x)) % 3 == 0)
+
+static gpointer
+writer_thread_func (gpointer data)
+{
+  GeglTileBackend *backend = data;
+  gint             seed    = g_random_int_range (0, 256);
+  gint             round;
+  gint             i;
+
+  for (round = 0; round < N_WRITER_ROUNDS; round++)
+    {
+      for (i = 0; i < N_WRITER_TILES; i++)
+        {
+          write_tile (backend, i,
+                      WRITER_TILE_VALUE (seed, round, i),
+                      WRITER_TILE_NOISY (round, i));
+        }
+
+      for (i = 0; i < N_WRITER_TILES; i++)
+        {
+          check_tile (backend, i,
+                      WRITER_TILE_VALUE (seed, round, i),
+                      WRITER_TILE_NOISY (round, i));
+        }
+    }
+
+  return GINT_TO_POINTER (seed);
+}
+
+/**
+ * Tests that several threads, each repeatedly writing the same tiles, and
+ * reading them back, see their own data, both while the writes are
+ * pending, and once they're stored in the swap file.
+ **/
+static void
+several_writers (void)
+{
+  GeglTileBackend *backends[N_WRITER_THREADS];
+  GThread         *threads[N_WRITER_THREADS];
+  gint             seeds[N_WRITER_THREADS];
+  gint             i;
+  gint             j;
+
+  set_pool_size (0);
+
+  for (i = 0; i < N_WRITER_THREADS; i++)
+    {
+      backends[i] = swap_backend_new ();
+      threads[i]  = g_thread_new ("swap test writer",
+                                  writer_thread_func, backends[i]);
+    }
+
+  for (i = 0; i < N_WRITER_THREADS; i++)
+    seeds[i] = GPOINTER_TO_INT (g_thread_join (threads[i]));
+
+  wait_idle ();
+
+  for (i = 0; i < N_WRITER_THREADS; i++)
+    {
+      for (j = 0; j < N_WRITER_TILES; j++)
+        {
+          check_tile (backends[i], j,
+                      WRITER_TILE_VALUE (seeds[i], N_WRITER_ROUNDS - 1, j),
+                      WRITER_TILE_NOISY (N_WRITER_ROUNDS - 1, j));
+        }
+
+      g_object_unref (backends[i]);
+    }
+
+  wait_idle ();
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gchar *swap_dir = g_dir_make_tmp ("test-backend-swap-XXXXXX", NULL);
+  GDir  *dir;
+  gint   result;
+
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  /* the tests are run with GEGL_SWAP=RAM, but the swap backend is used
+   * directly here, and needs an actual swap file.
+   */
+  g_object_set (gegl_config (),
+                "swap", swap_dir,
+                NULL);
+
+  ADD_TEST (pool_hit);
+  ADD_TEST (pool_evict);
+  ADD_TEST (pool_drop_pending);
+  ADD_TEST (prefetch_hit);
+  ADD_TEST (prefetch_overwrite);
+  ADD_TEST (several_writers);
+
+  result = g_test_run ();
+
+  gegl_exit ();
+
+  if ((dir = g_dir_open (swap_dir, 0, NULL)))
+    {
+      const gchar *name;
+
+      while ((name = g_dir_read_name (dir)))
+        {
+          gchar *path = g_build_filename (swap_dir, name, NULL);
+
+          g_unlink (path);
+          g_free (path);
+        }
+
+      g_dir_close (dir);
+    }
+
+  g_rmdir (swap_dir);
+  g_free (swap_dir);
+
+  return result;
+}
@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gegl.h>
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-buffer-freeze/" #function, function);
+
+#define SIZE 600
+
+
+static GeglBuffer *
+create_buffer (guchar offset)
+{
+  GeglBuffer *buffer;
+  guchar     *data;
+  gint        i;
+
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, SIZE, SIZE),
+                            babl_format ("Y u8"));
+
+  data = g_new (guchar, SIZE * SIZE);
+
+  for (i = 0; i < SIZE * SIZE; i++)
+    data[i] = i % 251 + offset;
+
+  gegl_buffer_set (buffer, NULL, 0, babl_format ("Y u8"),
+                   data, GEGL_AUTO_ROWSTRIDE);
+
+  g_free (data);
+
+  return buffer;
+}
+
+static void
+check_area (const GeglRectangle *area,
+            GeglBuffer          *buffer)
+{
+  guchar  offset;
+  guchar *data;
+  gint    x;
+  gint    y;
+
+  gegl_buffer_get (buffer, GEGL_RECTANGLE (0, 0, 1, 1), 1.0,
+                   babl_format ("Y u8"), &offset,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  data = g_new (guchar, area->width * area->height);
+
+  gegl_buffer_get (buffer, area, 1.0, babl_format ("Y u8"), data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  for (y = 0; y < area->height; y++)
+    {
+      for (x = 0; x < area->width; x++)
+        {
+          gint i = (area->y + y) * SIZE + (area->x + x);
+
+          g_assert_cmpint (data[y * area->width + x], ==,
+                           (guchar) (i % 251 + offset));
+        }
+    }
+
+  g_free (data);
+}
+
+static void
+check_buffer (GeglBuffer *buffer)
+{
+  gegl_parallel_distribute_area (GEGL_RECTANGLE (0, 0, SIZE, SIZE), 1.0,
+                                 GEGL_SPLIT_STRATEGY_AUTO,
+                                 (GeglParallelDistributeAreaFunc) check_area,
+                                 buffer);
+}
+
+/**
+ * Tests reading a frozen buffer from multiple threads, repeatedly, so that
+ * the tiles are first fetched normally, and then looked up without locking.
+ **/
+static void
+read_frozen (void)
+{
+  GeglBuffer *buffer = create_buffer (0);
+
+  gegl_buffer_freeze (buffer);
+
+  check_buffer (buffer);
+  check_buffer (buffer);
+
+  gegl_buffer_thaw (buffer);
+
+  check_buffer (buffer);
+
+  g_object_unref (buffer);
+}
+
+/**
+ * Tests that a buffer stays frozen until the last matching thaw, and that
+ * writes made once it's thawed are visible to subsequent reads, including
+ * ones made while frozen again.
+ **/
+static void
+nested_freeze (void)
+{
+  GeglBuffer *buffer = create_buffer (0);
+  GeglBuffer *other  = create_buffer (7);
+
+  gegl_buffer_freeze (buffer);
+  gegl_buffer_freeze (buffer);
+
+  check_buffer (buffer);
+
+  gegl_buffer_thaw (buffer);
+
+  check_buffer (buffer);
+
+  gegl_buffer_thaw (buffer);
+
+  gegl_buffer_copy (other, NULL, GEGL_ABYSS_NONE, buffer, NULL);
+
+  gegl_buffer_freeze (buffer);
+
+  check_buffer (buffer);
+
+  gegl_buffer_thaw (buffer);
+
+  g_object_unref (other);
+  g_object_unref (buffer);
+}
+
+/**
+ * Tests destroying a buffer while it's still frozen.
+ **/
+static void
+unref_frozen (void)
+{
+  GeglBuffer *buffer = create_buffer (0);
+
+  gegl_buffer_freeze (buffer);
+
+  check_buffer (buffer);
+
+  g_object_unref (buffer);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  ADD_TEST (read_frozen);
+  ADD_TEST (nested_freeze);
+  ADD_TEST (unref_frozen);
+
+  return g_test_run ();
+}
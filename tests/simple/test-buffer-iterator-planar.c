@@ -0,0 +1,290 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gegl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N_COMPONENTS 4
+
+static inline gfloat
+pixel_value (gint x,
+             gint y,
+             gint c)
+{
+  return x + y * 0.001f + c * 1000.0f;
+}
+
+/* returns a buffer spanning a bit more than 2x2 tiles, so that iterating
+ * over it goes through whole tiles, as well as rows of partial tiles.
+ */
+static GeglBuffer *
+create_buffer (const Babl *format)
+{
+  GeglBuffer    *buffer;
+  GeglRectangle  extent = {0, 0, 0, 0};
+  gfloat        *data;
+  gint           x;
+  gint           y;
+  gint           c;
+
+  buffer = gegl_buffer_new (NULL, format);
+
+  g_object_get (buffer,
+                "tile-width",  &extent.width,
+                "tile-height", &extent.height,
+                NULL);
+
+  extent.width  = extent.width  * 2 + 5;
+  extent.height = extent.height * 2 + 3;
+
+  gegl_buffer_set_extent (buffer, &extent);
+
+  data = g_new (gfloat, extent.width * extent.height * N_COMPONENTS);
+
+  for (y = 0; y < extent.height; y++)
+    for (x = 0; x < extent.width; x++)
+      for (c = 0; c < N_COMPONENTS; c++)
+        data[(y * extent.width + x) * N_COMPONENTS + c] = pixel_value (x, y, c);
+
+  gegl_buffer_set (buffer, &extent, 0, babl_format ("RGBA float"),
+                   data, GEGL_AUTO_ROWSTRIDE);
+
+  g_free (data);
+
+  return buffer;
+}
+
+/* checks that each plane of the chunks holds the values of the corresponding
+ * component.
+ */
+static gboolean
+test_planar_read (void)
+{
+  gboolean            result = TRUE;
+  GeglBuffer         *buffer;
+  GeglBufferIterator *iter;
+  GeglRectangle       roi;
+
+  buffer = create_buffer (babl_format ("RGBA float"));
+
+  roi = *gegl_buffer_get_extent (buffer);
+  roi.x += 3;
+  roi.y += 1;
+  roi.width  -= 3;
+  roi.height -= 1;
+
+  iter = gegl_buffer_iterator_new (buffer, &roi, 0,
+                                   babl_format ("RGBA float"),
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
+  gegl_buffer_iterator_set_planar (iter, 0, TRUE);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const gfloat        *data = iter->items[0].data;
+      const GeglRectangle *r    = &iter->items[0].roi;
+      gint                 x;
+      gint                 y;
+      gint                 c;
+
+      for (c = 0; c < N_COMPONENTS; c++)
+        {
+          const gfloat *plane = data + c * iter->length;
+
+          for (y = 0; y < r->height; y++)
+            for (x = 0; x < r->width; x++)
+              {
+                if (plane[y * r->width + x] !=
+                    pixel_value (r->x + x, r->y + y, c))
+                  {
+                    result = FALSE;
+                  }
+              }
+        }
+    }
+
+  g_object_unref (buffer);
+
+  return result;
+}
+
+/* checks that modifications to the planes are written back, both to a
+ * buffer of the iterated format, and to one needing a format conversion.
+ */
+static gboolean
+test_planar_write (void)
+{
+  gboolean    result = TRUE;
+  const Babl *formats[] = {babl_format ("RGBA float"),
+                           babl_format ("RGBA double")};
+  gint        i;
+
+  for (i = 0; i < (gint) G_N_ELEMENTS (formats); i++)
+    {
+      GeglBuffer          *buffer;
+      GeglBufferIterator  *iter;
+      const GeglRectangle *extent;
+      gfloat              *data;
+      gint                 x;
+      gint                 y;
+      gint                 c;
+
+      buffer = create_buffer (formats[i]);
+      extent = gegl_buffer_get_extent (buffer);
+
+      iter = gegl_buffer_iterator_new (buffer, NULL, 0,
+                                       babl_format ("RGBA float"),
+                                       GEGL_ACCESS_READWRITE, GEGL_ABYSS_NONE,
+                                       1);
+      gegl_buffer_iterator_set_planar (iter, 0, TRUE);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          gfloat *plane = iter->items[0].data;
+          gint    j;
+
+          for (c = 0; c < N_COMPONENTS; c++)
+            {
+              for (j = 0; j < iter->length; j++)
+                *plane++ += c + 1;
+            }
+        }
+
+      data = g_new (gfloat, extent->width * extent->height * N_COMPONENTS);
+
+      gegl_buffer_get (buffer, extent, 1.0, babl_format ("RGBA float"),
+                       data, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+      for (y = 0; y < extent->height; y++)
+        for (x = 0; x < extent->width; x++)
+          for (c = 0; c < N_COMPONENTS; c++)
+            {
+              gfloat value = data[(y * extent->width + x) * N_COMPONENTS + c];
+
+              if (value != pixel_value (x, y, c) + (c + 1))
+                result = FALSE;
+            }
+
+      g_free (data);
+      g_object_unref (buffer);
+    }
+
+  return result;
+}
+
+/* checks processing a buffer in place, reading and writing it through
+ * separate planar items, the way point operations do.
+ */
+static gboolean
+test_planar_in_place (void)
+{
+  gboolean             result = TRUE;
+  GeglBuffer          *buffer;
+  GeglBufferIterator  *iter;
+  const GeglRectangle *extent;
+  gfloat              *data;
+  gint                 read;
+  gint                 x;
+  gint                 y;
+  gint                 c;
+
+  buffer = create_buffer (babl_format ("RGBA float"));
+  extent = gegl_buffer_get_extent (buffer);
+
+  iter = gegl_buffer_iterator_new (buffer, NULL, 0,
+                                   babl_format ("RGBA float"),
+                                   GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 2);
+  read = gegl_buffer_iterator_add (iter, buffer, NULL, 0,
+                                   babl_format ("RGBA float"),
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+  gegl_buffer_iterator_set_planar (iter, 0,    TRUE);
+  gegl_buffer_iterator_set_planar (iter, read, TRUE);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const gfloat *in  = iter->items[read].data;
+      gfloat       *out = iter->items[0].data;
+      gint          j;
+
+      /* swap the first and last planes */
+      for (j = 0; j < iter->length; j++)
+        {
+          out[j]                    = in[j + 3 * iter->length];
+          out[j + iter->length]     = in[j + iter->length];
+          out[j + 2 * iter->length] = in[j + 2 * iter->length];
+          out[j + 3 * iter->length] = in[j];
+        }
+    }
+
+  data = g_new (gfloat, extent->width * extent->height * N_COMPONENTS);
+
+  gegl_buffer_get (buffer, extent, 1.0, babl_format ("RGBA float"),
+                   data, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  for (y = 0; y < extent->height; y++)
+    for (x = 0; x < extent->width; x++)
+      for (c = 0; c < N_COMPONENTS; c++)
+        {
+          gfloat value = data[(y * extent->width + x) * N_COMPONENTS + c];
+          gint   src_c = c == 0 ? 3 : c == 3 ? 0 : c;
+
+          if (value != pixel_value (x, y, src_c))
+            result = FALSE;
+        }
+
+  g_free (data);
+  g_object_unref (buffer);
+
+  return result;
+}
+
+#define RUN_TEST(test_name) \
+{ \
+  if (test_name()) \
+    { \
+      printf ("" #test_name " ... PASS\n"); \
+      tests_passed++; \
+    } \
+  else \
+    { \
+      printf ("" #test_name " ... FAIL\n"); \
+      tests_failed++; \
+    } \
+  tests_run++; \
+}
+
+int main(int argc, char **argv)
+{
+  gint tests_run    = 0;
+  gint tests_passed = 0;
+  gint tests_failed = 0;
+
+  gegl_init(0, NULL);
+  g_object_set(G_OBJECT(gegl_config()),
+               "swap", "RAM",
+               "use-opencl", FALSE,
+               NULL);
+
+  RUN_TEST (test_planar_read)
+  RUN_TEST (test_planar_write)
+  RUN_TEST (test_planar_in_place)
+
+  gegl_exit();
+
+  if (tests_passed == tests_run)
+    return 0;
+  return -1;
+}
@@ -0,0 +1,215 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+
+#include <gegl.h>
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-buffer-resample/" #function, function);
+
+#define SIZE      256
+#define EPSILON   1e-4
+#define N_FILTERS 2
+
+
+static const GeglAbyssPolicy filters[N_FILTERS] = {GEGL_BUFFER_FILTER_LANCZOS,
+                                                   GEGL_BUFFER_FILTER_MITCHELL};
+
+static const gdouble scales[] = {0.2, 0.3, 0.5, 0.7, 1.5, 3.0};
+
+
+/* fills the buffer with a vertical stripe pattern, or a constant color if
+ * @stripes is FALSE.
+ */
+static GeglBuffer *
+create_buffer (gboolean stripes)
+{
+  const Babl *format = babl_format ("RGBA float");
+  GeglBuffer *buffer;
+  gfloat     *data;
+  gint        x;
+  gint        y;
+
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, SIZE, SIZE), format);
+
+  data = g_new (gfloat, 4 * SIZE * SIZE);
+
+  for (y = 0; y < SIZE; y++)
+    {
+      for (x = 0; x < SIZE; x++)
+        {
+          gfloat *pixel = data + 4 * (y * SIZE + x);
+
+          pixel[0] = stripes ? x % 2 : 0.25f;
+          pixel[1] = stripes ? x % 2 : 0.5f;
+          pixel[2] = stripes ? x % 2 : 0.75f;
+          pixel[3] = 1.0f;
+        }
+    }
+
+  gegl_buffer_set (buffer, NULL, 0, format, data, GEGL_AUTO_ROWSTRIDE);
+
+  g_free (data);
+
+  return buffer;
+}
+
+/**
+ * Tests that resampling a constant color reproduces it, at different
+ * downscales and upscales, including ones read from a mipmap level.
+ **/
+static void
+constant (void)
+{
+  GeglBuffer *buffer = create_buffer (FALSE);
+  gint        f;
+  gint        s;
+
+  for (f = 0; f < N_FILTERS; f++)
+    {
+      for (s = 0; s < G_N_ELEMENTS (scales); s++)
+        {
+          GeglRectangle  rect;
+          gfloat        *data;
+          gint           i;
+
+          rect.x      = 3;
+          rect.y      = 5;
+          rect.width  = floor (SIZE * scales[s]) - 6;
+          rect.height = floor (SIZE * scales[s]) - 10;
+
+          data = g_new (gfloat, 4 * rect.width * rect.height);
+
+          gegl_buffer_get (buffer, &rect, scales[s],
+                           babl_format ("RGBA float"), data,
+                           GEGL_AUTO_ROWSTRIDE,
+                           GEGL_ABYSS_CLAMP | filters[f]);
+
+          for (i = 0; i < rect.width * rect.height; i++)
+            {
+              g_assert_cmpfloat (fabs (data[4 * i + 0] - 0.25f), <, EPSILON);
+              g_assert_cmpfloat (fabs (data[4 * i + 1] - 0.5f),  <, EPSILON);
+              g_assert_cmpfloat (fabs (data[4 * i + 2] - 0.75f), <, EPSILON);
+              g_assert_cmpfloat (fabs (data[4 * i + 3] - 1.0f),  <, EPSILON);
+            }
+
+          g_free (data);
+        }
+    }
+
+  g_object_unref (buffer);
+}
+
+/**
+ * Tests that downscaling one-pixel stripes by a factor of 2 filters them
+ * into a uniform gray, rather than aliasing them.
+ **/
+static void
+stripes (void)
+{
+  GeglBuffer *buffer = create_buffer (TRUE);
+  gint        f;
+
+  for (f = 0; f < N_FILTERS; f++)
+    {
+      GeglRectangle  rect = {8, 8, SIZE / 2 - 16, SIZE / 2 - 16};
+      gfloat        *data;
+      gint           i;
+
+      data = g_new (gfloat, rect.width * rect.height);
+
+      gegl_buffer_get (buffer, &rect, 0.5, babl_format ("Y float"), data,
+                       GEGL_AUTO_ROWSTRIDE,
+                       GEGL_ABYSS_CLAMP | filters[f]);
+
+      for (i = 0; i < rect.width * rect.height; i++)
+        g_assert_cmpfloat (fabs (data[i] - 0.5f), <, EPSILON);
+
+      g_free (data);
+    }
+
+  g_object_unref (buffer);
+}
+
+/**
+ * Tests that gegl:scale-ratio resamples uniform scales with its filter.
+ **/
+static void
+scale_op (void)
+{
+  GeglBuffer *buffer = create_buffer (TRUE);
+  gint        f;
+
+  for (f = 0; f < N_FILTERS; f++)
+    {
+      GeglNode      *graph;
+      GeglNode      *source;
+      GeglNode      *scale;
+      GeglRectangle  rect = {8, 8, SIZE / 2 - 16, SIZE / 2 - 16};
+      gfloat        *data1;
+      gfloat        *data2;
+      gint           i;
+
+      graph  = gegl_node_new ();
+      source = gegl_node_new_child (graph,
+                                    "operation", "gegl:buffer-source",
+                                    "buffer",    buffer,
+                                    NULL);
+      scale  = gegl_node_new_child (graph,
+                                    "operation",    "gegl:scale-ratio",
+                                    "x",            0.5,
+                                    "y",            0.5,
+                                    "abyss-policy", GEGL_ABYSS_CLAMP,
+                                    "filter",       filters[f],
+                                    NULL);
+
+      gegl_node_link (source, scale);
+
+      data1 = g_new (gfloat, 4 * rect.width * rect.height);
+      data2 = g_new (gfloat, 4 * rect.width * rect.height);
+
+      gegl_node_blit (scale, 1.0, &rect, babl_format ("RaGaBaA float"), data1,
+                      GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+      gegl_buffer_get (buffer, &rect, 0.5, babl_format ("RaGaBaA float"),
+                       data2, GEGL_AUTO_ROWSTRIDE,
+                       GEGL_ABYSS_CLAMP | filters[f]);
+
+      for (i = 0; i < 4 * rect.width * rect.height; i++)
+        g_assert_cmpfloat (fabs (data1[i] - data2[i]), <, EPSILON);
+
+      g_free (data1);
+      g_free (data2);
+
+      g_object_unref (graph);
+    }
+
+  g_object_unref (buffer);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  ADD_TEST (constant);
+  ADD_TEST (stripes);
+  ADD_TEST (scale_op);
+
+  return g_test_run ();
+}
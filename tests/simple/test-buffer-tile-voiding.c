@@ -143,6 +143,127 @@ test_buffer_copy (void)
   return result;
 }
 
+static gboolean
+test_buffer_build_pyramid (void)
+{
+  gboolean result = TRUE;
+
+  GeglBuffer *bufferA, *bufferB;
+  const Babl *format = babl_format ("RGBA float");
+  const gint bpp = babl_format_get_bytes_per_pixel (format);
+  GeglRectangle full_extent = {0, 0, 0, 0};
+  GeglRectangle scaled_extent = {0, 0, 0, 0};
+  GeglRectangle dirty_rect = {0, 0, 0, 0};
+  guint64 zoom_total_before, zoom_total_after;
+
+  gint level;
+  gint i;
+
+  gint input_buffer_size;
+  gint output_buffer_size;
+
+  gfloat *input_buffer;
+  guchar *output_buffer_a, *output_buffer_b;
+
+  bufferA = gegl_buffer_new (NULL, format);
+  bufferB = gegl_buffer_new (NULL, format);
+
+  g_object_get (bufferA,
+                "tile-width", &full_extent.width,
+                "tile-height", &full_extent.height,
+                NULL);
+
+  dirty_rect.x = full_extent.width / 2;
+  dirty_rect.y = full_extent.height / 2;
+  dirty_rect.width = full_extent.width;
+  dirty_rect.height = full_extent.height;
+
+  full_extent.width *= 5;
+  full_extent.height *= 3;
+
+  input_buffer_size = full_extent.width * full_extent.height * bpp;
+  output_buffer_size = (full_extent.width / 2) * (full_extent.height / 2) * bpp;
+
+  input_buffer = gegl_malloc (input_buffer_size);
+  output_buffer_a = gegl_malloc (output_buffer_size);
+  output_buffer_b = gegl_malloc (output_buffer_size);
+
+  for (i = 0; i < input_buffer_size / (gint) sizeof (gfloat); i++)
+    input_buffer[i] = g_random_double ();
+
+  gegl_buffer_set_extent (bufferA, &full_extent);
+  gegl_buffer_set_extent (bufferB, &full_extent);
+
+  gegl_buffer_set (bufferA, NULL, 0, format, input_buffer, GEGL_AUTO_ROWSTRIDE);
+  gegl_buffer_set (bufferB, NULL, 0, format, input_buffer, GEGL_AUTO_ROWSTRIDE);
+
+  for (i = 0; i < 2; i++)
+    {
+      /* build the levels of A eagerly, while the levels of B are built on
+       * demand, and assert that they're the same.  the second time around,
+       * only the levels covering the modified area are rebuilt.
+       */
+      gegl_buffer_build_pyramid (bufferA, NULL, -1);
+
+      g_object_get (gegl_stats (), "zoom-total", &zoom_total_before, NULL);
+
+      for (level = 1; level <= 3; level++)
+        {
+          gdouble scale = 1.0 / (1 << level);
+
+          scaled_extent.width = full_extent.width >> level;
+          scaled_extent.height = full_extent.height >> level;
+
+          gegl_buffer_get (bufferA,
+                           &scaled_extent,
+                           scale,
+                           format,
+                           output_buffer_a,
+                           GEGL_AUTO_ROWSTRIDE,
+                           GEGL_ABYSS_NONE);
+
+          g_object_get (gegl_stats (), "zoom-total", &zoom_total_after, NULL);
+
+          if (zoom_total_after != zoom_total_before)
+            {
+              printf ("%s: level %d of A was not built!\n", G_STRFUNC, level);
+              result = FALSE;
+            }
+
+          gegl_buffer_get (bufferB,
+                           &scaled_extent,
+                           scale,
+                           format,
+                           output_buffer_b,
+                           GEGL_AUTO_ROWSTRIDE,
+                           GEGL_ABYSS_NONE);
+
+          g_object_get (gegl_stats (), "zoom-total", &zoom_total_before, NULL);
+
+          if (0 != memcmp (output_buffer_a, output_buffer_b,
+                           scaled_extent.width * scaled_extent.height * bpp))
+            {
+              printf ("%s: level %d doesn't match!\n", G_STRFUNC, level);
+              result = FALSE;
+            }
+        }
+
+      gegl_buffer_set (bufferA, &dirty_rect, 0, format, input_buffer + 1,
+                       GEGL_AUTO_ROWSTRIDE);
+      gegl_buffer_set (bufferB, &dirty_rect, 0, format, input_buffer + 1,
+                       GEGL_AUTO_ROWSTRIDE);
+    }
+
+  gegl_free (input_buffer);
+  gegl_free (output_buffer_a);
+  gegl_free (output_buffer_b);
+
+  g_object_unref (bufferA);
+  g_object_unref (bufferB);
+
+  return result;
+}
+
 #define RUN_TEST(test_name) \
 { \
   if (test_name()) \
@@ -171,6 +292,7 @@ int main(int argc, char **argv)
                NULL);
 
   RUN_TEST (test_buffer_copy)
+  RUN_TEST (test_buffer_build_pyramid)
 
   gegl_exit();
 
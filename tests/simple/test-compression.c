@@ -0,0 +1,179 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <gegl.h>
+
+#include "gegl-compression.h"
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-compression/" #function, function);
+
+#define BPP 16
+#define N   (128 * 64)
+
+
+typedef enum
+{
+  DATA_UNIFORM,
+  DATA_SMOOTH,
+  DATA_RANDOM
+} DataType;
+
+
+static guchar *
+create_data (DataType type)
+{
+  guchar *data = g_malloc (N * BPP);
+  GRand  *rand = g_rand_new_with_seed (0);
+  gint    i;
+
+  for (i = 0; i < N * BPP; i++)
+    {
+      switch (type)
+        {
+        case DATA_UNIFORM:
+          data[i] = i % BPP;
+          break;
+
+        case DATA_SMOOTH:
+          data[i] = (i / BPP / 256) + (i % BPP);
+          break;
+
+        case DATA_RANDOM:
+          data[i] = g_rand_int (rand);
+          break;
+        }
+    }
+
+  g_rand_free (rand);
+
+  return data;
+}
+
+static void
+round_trip (DataType type)
+{
+  const gchar **algorithms = gegl_compression_list ();
+  guchar       *data       = create_data (type);
+  guchar       *compressed = g_malloc (N * BPP);
+  guchar       *result     = g_malloc (N * BPP);
+  gint          i;
+
+  g_assert (algorithms[0] != NULL);
+
+  for (i = 0; algorithms[i]; i++)
+    {
+      const GeglCompression *compression = gegl_compression (algorithms[i]);
+      gint                   size;
+
+      g_assert (compression != NULL);
+
+      /* the data isn't guaranteed to be compressible, but if it is, it
+       * should decompress to the original data.
+       */
+      if (! gegl_compression_compress (compression, BPP, data, N,
+                                       compressed, &size, N * BPP))
+        {
+          g_assert (type == DATA_RANDOM);
+
+          continue;
+        }
+
+      g_assert_cmpint (size, <=, N * BPP);
+
+      memset (result, 0, N * BPP);
+
+      g_assert (gegl_compression_decompress (compression, BPP, result, N,
+                                             compressed, size));
+
+      g_assert (! memcmp (data, result, N * BPP));
+
+      /* a buffer smaller than the compressed data should be rejected */
+      if (size > 0)
+        {
+          g_assert (! gegl_compression_compress (compression, BPP, data, N,
+                                                 compressed, &size,
+                                                 size - 1));
+        }
+    }
+
+  g_free (result);
+  g_free (compressed);
+  g_free (data);
+  g_free (algorithms);
+}
+
+/**
+ * Tests that all algorithms can round-trip uniform data, and that it is
+ * actually compressed by the generic algorithms.
+ **/
+static void
+uniform_data (void)
+{
+  const gchar *generic[]  = {"fast", "balanced", "best"};
+  guchar      *data       = create_data (DATA_UNIFORM);
+  guchar      *compressed = g_malloc (N * BPP);
+  gint         i;
+
+  round_trip (DATA_UNIFORM);
+
+  for (i = 0; i < G_N_ELEMENTS (generic); i++)
+    {
+      const GeglCompression *compression = gegl_compression (generic[i]);
+      gint                   size;
+
+      g_assert (compression != NULL);
+
+      g_assert (gegl_compression_compress (compression, BPP, data, N,
+                                           compressed, &size, N * BPP / 16));
+    }
+
+  g_free (compressed);
+  g_free (data);
+}
+
+/**
+ * Tests that all algorithms can round-trip smooth data.
+ **/
+static void
+smooth_data (void)
+{
+  round_trip (DATA_SMOOTH);
+}
+
+/**
+ * Tests that all algorithms can round-trip, or reject, random data.
+ **/
+static void
+random_data (void)
+{
+  round_trip (DATA_RANDOM);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  ADD_TEST (uniform_data);
+  ADD_TEST (smooth_data);
+  ADD_TEST (random_data);
+
+  return g_test_run ();
+}
@@ -0,0 +1,112 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gegl.h>
+
+#include "gegl-cpuaccel.h"
+
+#if (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__)
+#include <cpuid.h>
+#define HAVE_X86_CPUID 1
+#endif
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-cpuaccel/" #function, function);
+
+#define X86_AVX_FAMILY (GEGL_CPU_ACCEL_X86_AVX  | \
+                        GEGL_CPU_ACCEL_X86_AVX2 | \
+                        GEGL_CPU_ACCEL_X86_FMA  | \
+                        GEGL_CPU_ACCEL_X86_AVX512F)
+
+
+#ifdef HAVE_X86_CPUID
+
+/* the register states enabled by the os, independently of gegl's detection */
+static guint32
+get_xcr0 (void)
+{
+  guint32 eax, ebx, ecx, edx;
+
+  if (! __get_cpuid (1, &eax, &ebx, &ecx, &edx) || ! (ecx & bit_OSXSAVE))
+    return 0;
+
+  /* xgetbv, spelled out for assemblers that don't know it */
+  __asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0"
+                        : "=a" (eax), "=d" (edx)
+                        : "c" (0));
+
+  return eax;
+}
+
+#endif
+
+/**
+ * Tests that the reported avx-class instruction sets imply the ones they
+ * extend.
+ **/
+static void
+implications (void)
+{
+  GeglCpuAccelFlags flags = gegl_cpu_accel_get_support ();
+
+  if (flags & GEGL_CPU_ACCEL_X86_AVX512F)
+    g_assert (flags & GEGL_CPU_ACCEL_X86_AVX2);
+
+  if (flags & GEGL_CPU_ACCEL_X86_AVX2)
+    g_assert (flags & GEGL_CPU_ACCEL_X86_AVX);
+
+  if (flags & GEGL_CPU_ACCEL_X86_FMA)
+    g_assert (flags & GEGL_CPU_ACCEL_X86_AVX);
+
+  if (flags & X86_AVX_FAMILY)
+    g_assert (flags & GEGL_CPU_ACCEL_X86_SSE);
+}
+
+/**
+ * Tests that the avx family is only reported when the os saves the wider
+ * registers.
+ **/
+static void
+os_support (void)
+{
+  GeglCpuAccelFlags flags = gegl_cpu_accel_get_support ();
+
+#ifdef HAVE_X86_CPUID
+  guint32 xcr0 = get_xcr0 ();
+
+  /* sse and avx state */
+  if ((xcr0 & 0x06) != 0x06)
+    g_assert_cmpint (flags & X86_AVX_FAMILY, ==, 0);
+
+  /* opmask, upper zmm0-15 and zmm16-31 state */
+  if ((xcr0 & 0xe0) != 0xe0)
+    g_assert_cmpint (flags & GEGL_CPU_ACCEL_X86_AVX512F, ==, 0);
+#else
+  g_assert_cmpint (flags & X86_AVX_FAMILY, ==, 0);
+#endif
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  ADD_TEST (implications);
+  ADD_TEST (os_support);
+
+  return g_test_run ();
+}
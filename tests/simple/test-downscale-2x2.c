@@ -0,0 +1,149 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <gegl.h>
+
+#include "gegl-algorithms.h"
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-downscale-2x2/" #function, function);
+
+/* the padding at the end of each row, in components */
+#define ROW_PADDING 3
+
+#define PADDING_BYTE 0xa5
+
+
+static const gint sizes[] = {1, 2, 3, 5, 7, 8, 9, 15, 17, 33, 64, 65};
+
+
+/* compares the function gegl_downscale_2x2() dispatches to for format, which
+ * is a vectorized one where the cpu supports it, against the generic
+ * function, for a range of odd and even sizes, with padded rows.
+ */
+static void
+compare (const gchar         *format_name,
+         GeglDownscale2x2Fun  generic_fun)
+{
+  const Babl *format     = babl_format (format_name);
+  const Babl *type       = babl_format_get_type (format, 0);
+  gint        bpp        = babl_format_get_bytes_per_pixel (format);
+  gint        comp_size  = bpp / babl_format_get_n_components (format);
+  gint        max_size   = sizes[G_N_ELEMENTS (sizes) - 1];
+  gint        max_stride = (max_size * bpp + ROW_PADDING * comp_size);
+  guchar     *src;
+  guchar     *dst;
+  guchar     *ref;
+  gint        i;
+  gint        j;
+
+  src = g_malloc (max_stride * max_size);
+  dst = g_malloc (max_stride * max_size);
+  ref = g_malloc (max_stride * max_size);
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    for (j = 0; j < G_N_ELEMENTS (sizes); j++)
+      {
+        gint width         = sizes[i];
+        gint height        = sizes[j];
+        gint src_rowstride = width * bpp + ROW_PADDING * comp_size;
+        gint dst_rowstride = (width / 2) * bpp + ROW_PADDING * comp_size;
+        gint n             = src_rowstride * height / comp_size;
+        gint k;
+
+        if (type == babl_type ("float"))
+          {
+            gfloat *p = (gfloat *) src;
+
+            for (k = 0; k < n; k++)
+              p[k] = g_test_rand_double_range (-0.5, 1.5);
+          }
+        else
+          {
+            for (k = 0; k < n * comp_size; k++)
+              src[k] = g_test_rand_int_range (0, 256);
+          }
+
+        memset (dst, PADDING_BYTE, max_stride * max_size);
+        memset (ref, PADDING_BYTE, max_stride * max_size);
+
+        gegl_downscale_2x2 (format,
+                            width, height,
+                            src, src_rowstride,
+                            dst, dst_rowstride);
+        generic_fun        (format,
+                            width, height,
+                            src, src_rowstride,
+                            ref, dst_rowstride);
+
+        if (memcmp (dst, ref, max_stride * max_size))
+          {
+            g_printerr ("'%s' downscale of %dx%d pixels differs from the "
+                        "generic one\n",
+                        format_name, width, height);
+            g_test_fail ();
+          }
+      }
+
+  g_free (src);
+  g_free (dst);
+  g_free (ref);
+}
+
+/**
+ * Tests the u8 downscale.
+ **/
+static void
+u8 (void)
+{
+  compare ("RGBA u8",    gegl_downscale_2x2_u8);
+  compare ("RaGaBaA u8", gegl_downscale_2x2_u8);
+}
+
+/**
+ * Tests the u16 downscale.
+ **/
+static void
+u16 (void)
+{
+  compare ("RGBA u16",    gegl_downscale_2x2_u16);
+  compare ("RaGaBaA u16", gegl_downscale_2x2_u16);
+}
+
+/**
+ * Tests the float downscale.
+ **/
+static void
+float_ (void)
+{
+  compare ("RGBA float",    gegl_downscale_2x2_float);
+  compare ("RaGaBaA float", gegl_downscale_2x2_float);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  ADD_TEST (u8);
+  ADD_TEST (u16);
+  g_test_add_func ("/gegl-downscale-2x2/float", float_);
+
+  return g_test_run ();
+}
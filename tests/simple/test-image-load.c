@@ -0,0 +1,549 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <gegl.h>
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-image-load/" #function, function);
+
+#define WIDTH  331
+#define HEIGHT 517
+
+#define FORMAT "R'G'B'A u8"
+#define BPP    4
+
+/* the jpeg decoder can reduce the image by up to 8x */
+#define JPG_MAX_LEVEL 3
+#define JPG_TOLERANCE 12
+
+
+static gchar *tmpdir;
+
+
+/* writes a smooth test pattern, which differs for each @seed, to @path,
+ * using @save_op.
+ */
+static void
+save_image (const gchar *path,
+            const gchar *save_op,
+            gint         width,
+            gint         height,
+            gint         seed)
+{
+  GeglBuffer *buffer;
+  GeglNode   *graph;
+  GeglNode   *source;
+  GeglNode   *save;
+  guchar     *data;
+  gint        x;
+  gint        y;
+
+  data = g_malloc (width * height * BPP);
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x < width; x++)
+        {
+          guchar *pixel = data + (y * width + x) * BPP;
+
+          pixel[0] = 128 + 100 * sin (x / 23.0 + seed);
+          pixel[1] = 128 + 100 * cos (y / 31.0 + seed);
+          pixel[2] = 128 + 100 * sin ((x + y) / 41.0 + seed * 2);
+          pixel[3] = 0xff;
+        }
+    }
+
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, width, height),
+                            babl_format (FORMAT));
+  gegl_buffer_set (buffer, NULL, 0, babl_format (FORMAT),
+                   data, GEGL_AUTO_ROWSTRIDE);
+
+  graph  = gegl_node_new ();
+  source = gegl_node_new_child (graph,
+                                "operation", "gegl:buffer-source",
+                                "buffer",    buffer,
+                                NULL);
+  save   = gegl_node_new_child (graph,
+                                "operation", save_op,
+                                "path",      path,
+                                NULL);
+
+  if (! strcmp (save_op, "gegl:png-save"))
+    gegl_node_set (save, "bitdepth", 8, NULL);
+  else if (! strcmp (save_op, "gegl:jpg-save"))
+    gegl_node_set (save, "quality", 95, "progressive", FALSE, NULL);
+  else if (! strcmp (save_op, "gegl:tiff-save"))
+    gegl_node_set (save, "bitdepth", 8, NULL);
+
+  gegl_node_link (source, save);
+  gegl_node_process (save);
+
+  g_object_unref (graph);
+  g_object_unref (buffer);
+  g_free (data);
+}
+
+static GeglNode *
+new_load_node (GeglNode    *graph,
+               const gchar *load_op,
+               const gchar *path)
+{
+  return gegl_node_new_child (graph,
+                              "operation", load_op,
+                              "path",      path,
+                              NULL);
+}
+
+/* decodes @roi of a separate, fresh load node */
+static guchar *
+decode_fresh (const gchar         *load_op,
+              const gchar         *path,
+              const GeglRectangle *roi)
+{
+  GeglNode *graph = gegl_node_new ();
+  GeglNode *load  = new_load_node (graph, load_op, path);
+  guchar   *data  = g_malloc0 (roi->width * roi->height * BPP);
+
+  gegl_node_blit (load, 1.0, roi, babl_format (FORMAT),
+                  data, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  g_object_unref (graph);
+
+  return data;
+}
+
+/* checks that @roi of @data matches the same area of @full, which holds the
+ * whole image, up to @tolerance.
+ */
+static gboolean
+compare_region (const guchar        *data,
+                const guchar        *full,
+                gint                 full_width,
+                const GeglRectangle *roi,
+                gint                 tolerance)
+{
+  gint x;
+  gint y;
+  gint i;
+
+  for (y = 0; y < roi->height; y++)
+    {
+      for (x = 0; x < roi->width; x++)
+        {
+          const guchar *a = data + (y * roi->width + x) * BPP;
+          const guchar *b = full + ((roi->y + y) * full_width +
+                                    (roi->x + x)) * BPP;
+
+          for (i = 0; i < BPP; i++)
+            {
+              if (abs (a[i] - b[i]) > tolerance)
+                {
+                  g_printerr ("pixel %d, %d differs from the full decode: "
+                              "%d != %d\n",
+                              roi->x + x, roi->y + y, a[i], b[i]);
+                  return FALSE;
+                }
+            }
+        }
+    }
+
+  return TRUE;
+}
+
+/* decodes a few regions of the image at @path, out of order, using a single
+ * load node, and compares them against a full decode.  the node doesn't
+ * cache its output, so going back to rows above the decoder position makes
+ * the loader reopen the file.
+ */
+static void
+check_on_demand (const gchar *load_op,
+                 const gchar *path,
+                 gint         width,
+                 gint         height)
+{
+  /* going down, up, down, and over the whole height */
+  const GeglRectangle rois[] = {{width / 4, height * 3 / 4, width / 2, height / 8},
+                                {3,         17,             width - 6, height / 4},
+                                {0,         height / 2,     width,     1         },
+                                {width / 3, 0,              width / 3, height    }};
+  GeglRectangle       bounds;
+  GeglNode           *graph;
+  GeglNode           *load;
+  guchar             *full;
+  gint                i;
+
+  full = decode_fresh (load_op, path, GEGL_RECTANGLE (0, 0, width, height));
+
+  graph = gegl_node_new ();
+  load  = new_load_node (graph, load_op, path);
+
+  gegl_node_set (load, "dont-cache", TRUE, NULL);
+
+  bounds = gegl_node_get_bounding_box (load);
+  g_assert_cmpint (bounds.width,  ==, width);
+  g_assert_cmpint (bounds.height, ==, height);
+
+  for (i = 0; i < G_N_ELEMENTS (rois); i++)
+    {
+      guchar *data = g_malloc0 (rois[i].width * rois[i].height * BPP);
+
+      gegl_node_blit (load, 1.0, &rois[i], babl_format (FORMAT),
+                      data, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+      if (! compare_region (data, full, width, &rois[i], 0))
+        g_test_fail ();
+
+      g_free (data);
+    }
+
+  g_object_unref (graph);
+  g_free (full);
+}
+
+/* loads an image, rewrites the file at the same path with a different
+ * image, sets the path again, and checks the new image is loaded.
+ */
+static void
+check_rewrite (const gchar *load_op,
+               const gchar *save_op,
+               const gchar *path)
+{
+  GeglRectangle  roi = {0, 0, WIDTH / 2, HEIGHT / 2};
+  GeglRectangle  bounds;
+  GFile         *file;
+  GeglNode      *graph;
+  GeglNode      *load;
+  guchar        *data;
+  guchar        *full;
+
+  save_image (path, save_op, WIDTH, HEIGHT, 0);
+
+  graph = gegl_node_new ();
+  load  = new_load_node (graph, load_op, path);
+  data  = g_malloc0 (roi.width * roi.height * BPP);
+
+  gegl_node_blit (load, 1.0, &roi, babl_format (FORMAT),
+                  data, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  save_image (path, save_op, WIDTH / 2, HEIGHT / 2, 1);
+
+  /* make sure the modification time changes, even on file systems with a
+   * coarse timestamp resolution.
+   */
+  file = g_file_new_for_path (path);
+  g_file_set_attribute_uint64 (file, G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                               g_get_real_time () / G_USEC_PER_SEC + 10,
+                               G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  g_object_unref (file);
+
+  gegl_node_set (load, "path", path, NULL);
+
+  bounds = gegl_node_get_bounding_box (load);
+  g_assert_cmpint (bounds.width,  ==, WIDTH / 2);
+  g_assert_cmpint (bounds.height, ==, HEIGHT / 2);
+
+  gegl_node_blit (load, 1.0, &roi, babl_format (FORMAT),
+                  data, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  full = decode_fresh (load_op, path, &roi);
+
+  if (memcmp (data, full, roi.width * roi.height * BPP))
+    {
+      g_printerr ("'%s' still decodes the replaced file\n", load_op);
+      g_test_fail ();
+    }
+
+  g_object_unref (graph);
+  g_free (full);
+  g_free (data);
+
+  g_unlink (path);
+}
+
+/* renders the image at @path at mipmap levels 1 to JPG_MAX_LEVEL, which the
+ * decoder produces at reduced size, and checks their extents, and that they
+ * are close to the full decode reduced by the mipmap.  then goes back to
+ * level 0, which needs the decoder reopened at full size.
+ */
+static void
+check_jpg_levels (const gchar *path,
+                  gint         width,
+                  gint         height)
+{
+  GeglRectangle  full_rect = {0, 0, width, height};
+  GeglBuffer    *full_buffer;
+  GeglNode      *graph;
+  GeglNode      *load;
+  guchar        *full;
+  guchar        *data;
+  gint           level;
+
+  full = decode_fresh ("gegl:jpg-load", path, &full_rect);
+
+  full_buffer = gegl_buffer_new (&full_rect, babl_format (FORMAT));
+  gegl_buffer_set (full_buffer, NULL, 0, babl_format (FORMAT),
+                   full, GEGL_AUTO_ROWSTRIDE);
+
+  graph = gegl_node_new ();
+  load  = new_load_node (graph, "gegl:jpg-load", path);
+
+  for (level = 1; level <= JPG_MAX_LEVEL; level++)
+    {
+      gdouble       scale = 1.0 / (1 << level);
+      GeglRectangle rect  = {0, 0, width >> level, height >> level};
+      GeglRectangle outer = {0, 0, rect.width + 1, rect.height + 1};
+      guchar       *reduced;
+
+      data    = g_malloc0 (outer.width * outer.height * BPP);
+      reduced = g_malloc0 (outer.width * outer.height * BPP);
+
+      gegl_node_blit (load, scale, &outer, babl_format (FORMAT),
+                      data, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+      gegl_buffer_get (full_buffer, &outer, scale, babl_format (FORMAT),
+                       reduced, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+      /* the level covers the reduced image, and nothing past it */
+      g_assert_cmpint (data[((rect.height - 1) * outer.width +
+                             rect.width - 1) * BPP + 3], ==, 0xff);
+      g_assert_cmpint (data[(rect.height * outer.width +
+                             rect.width) * BPP + 3], ==, 0);
+      g_assert_cmpint (data[(0 * outer.width +
+                             rect.width) * BPP + 3], ==, 0);
+      g_assert_cmpint (data[(rect.height * outer.width +
+                             0) * BPP + 3], ==, 0);
+
+      if (! compare_region (data, reduced, outer.width,
+                            GEGL_RECTANGLE (0, 0, outer.width, outer.height),
+                            JPG_TOLERANCE))
+        {
+          g_printerr ("level %d differs from the reduced full decode\n",
+                      level);
+          g_test_fail ();
+        }
+
+      g_free (reduced);
+      g_free (data);
+    }
+
+  /* back to full size */
+  data = g_malloc0 (width * height * BPP);
+
+  gegl_node_blit (load, 1.0, &full_rect, babl_format (FORMAT),
+                  data, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  if (! compare_region (data, full, width, &full_rect, 0))
+    {
+      g_printerr ("level 0 differs after rendering other levels\n");
+      g_test_fail ();
+    }
+
+  g_free (data);
+
+  g_object_unref (graph);
+  g_object_unref (full_buffer);
+  g_free (full);
+}
+
+static gboolean
+have_ops (const gchar *load_op,
+          const gchar *save_op)
+{
+  if (! gegl_has_operation (load_op) ||
+      (save_op && ! gegl_has_operation (save_op)))
+    {
+      g_test_skip ("operation not available");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * Tests decoding regions of a PNG out of order.
+ **/
+static void
+png_on_demand (void)
+{
+  gchar *path;
+
+  if (! have_ops ("gegl:png-load", "gegl:png-save"))
+    return;
+
+  path = g_build_filename (tmpdir, "on-demand.png", NULL);
+
+  save_image (path, "gegl:png-save", WIDTH, HEIGHT, 0);
+  check_on_demand ("gegl:png-load", path, WIDTH, HEIGHT);
+
+  g_unlink (path);
+  g_free (path);
+}
+
+/**
+ * Tests decoding regions of an interlaced PNG out of order.
+ **/
+static void
+png_interlaced_on_demand (void)
+{
+  gchar *path;
+
+  if (! have_ops ("gegl:png-load", NULL))
+    return;
+
+  path = g_build_filename (g_getenv ("ABS_TOP_SRCDIR"),
+                           "tests", "compositions", "data",
+                           "interlaced.png", NULL);
+
+  check_on_demand ("gegl:png-load", path, 67, 93);
+
+  g_free (path);
+}
+
+/**
+ * Tests decoding regions of a JPEG out of order.
+ **/
+static void
+jpg_on_demand (void)
+{
+  gchar *path;
+
+  if (! have_ops ("gegl:jpg-load", "gegl:jpg-save"))
+    return;
+
+  path = g_build_filename (tmpdir, "on-demand.jpg", NULL);
+
+  save_image (path, "gegl:jpg-save", WIDTH, HEIGHT, 0);
+  check_on_demand ("gegl:jpg-load", path, WIDTH, HEIGHT);
+
+  g_unlink (path);
+  g_free (path);
+}
+
+/**
+ * Tests decoding a JPEG at reduced sizes for mipmap levels.
+ **/
+static void
+jpg_levels (void)
+{
+  gchar *path;
+
+  if (! have_ops ("gegl:jpg-load", "gegl:jpg-save"))
+    return;
+
+  path = g_build_filename (tmpdir, "levels.jpg", NULL);
+
+  /* a multiple of the largest reduction, so that the levels have no
+   * partial pixels
+   */
+  save_image (path, "gegl:jpg-save", 336, 520, 0);
+  check_jpg_levels (path, 336, 520);
+
+  g_unlink (path);
+  g_free (path);
+}
+
+/**
+ * Tests decoding regions of a TIFF out of order.
+ **/
+static void
+tiff_on_demand (void)
+{
+  gchar *path;
+
+  if (! have_ops ("gegl:tiff-load", "gegl:tiff-save"))
+    return;
+
+  path = g_build_filename (tmpdir, "on-demand.tif", NULL);
+
+  save_image (path, "gegl:tiff-save", WIDTH, HEIGHT, 0);
+  check_on_demand ("gegl:tiff-load", path, WIDTH, HEIGHT);
+
+  g_unlink (path);
+  g_free (path);
+}
+
+/**
+ * Tests that a PNG rewritten in place is loaded again.
+ **/
+static void
+png_rewrite (void)
+{
+  gchar *path;
+
+  if (! have_ops ("gegl:png-load", "gegl:png-save"))
+    return;
+
+  path = g_build_filename (tmpdir, "rewrite.png", NULL);
+
+  check_rewrite ("gegl:png-load", "gegl:png-save", path);
+
+  g_free (path);
+}
+
+/**
+ * Tests that a JPEG rewritten in place is loaded again.
+ **/
+static void
+jpg_rewrite (void)
+{
+  gchar *path;
+
+  if (! have_ops ("gegl:jpg-load", "gegl:jpg-save"))
+    return;
+
+  path = g_build_filename (tmpdir, "rewrite.jpg", NULL);
+
+  check_rewrite ("gegl:jpg-load", "gegl:jpg-save", path);
+
+  g_free (path);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gint result;
+
+  /* make gegl_node_blit() render scaled-down requests from mipmap levels */
+  g_setenv ("GEGL_MIPMAP_RENDERING", "1", TRUE);
+
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  tmpdir = g_dir_make_tmp ("test-image-load-XXXXXX", NULL);
+  g_assert (tmpdir);
+
+  ADD_TEST (png_on_demand);
+  ADD_TEST (png_interlaced_on_demand);
+  ADD_TEST (jpg_on_demand);
+  ADD_TEST (jpg_levels);
+  ADD_TEST (tiff_on_demand);
+  ADD_TEST (png_rewrite);
+  ADD_TEST (jpg_rewrite);
+
+  result = g_test_run ();
+
+  g_remove (tmpdir);
+  g_free (tmpdir);
+
+  gegl_exit ();
+
+  return result;
+}
@@ -0,0 +1,388 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gegl.h>
+
+#include "gegl-parallel-private.h"
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-parallel/" #function, function);
+
+#define SIZE    256
+#define N_OUTER 4
+
+
+static volatile gint counts[SIZE * SIZE];
+
+
+static void
+reset_counts (void)
+{
+  gint i;
+
+  for (i = 0; i < SIZE * SIZE; i++)
+    counts[i] = 0;
+}
+
+static void
+check_counts (gint n)
+{
+  gint i;
+
+  for (i = 0; i < n; i++)
+    g_assert_cmpint (counts[i], ==, 1);
+}
+
+static void
+count_part (gint     i,
+            gint     n,
+            gpointer user_data)
+{
+  g_assert_cmpint (i, >=, 0);
+  g_assert_cmpint (i, <, n);
+
+  g_atomic_int_set ((gint *) user_data, n);
+  g_atomic_int_inc (&counts[i]);
+}
+
+static void
+count_range (gsize    offset,
+             gsize    size,
+             gpointer user_data)
+{
+  gsize i;
+
+  /* make the cost uneven, so that parts get stolen */
+  if (offset < SIZE * SIZE / 8)
+    g_usleep (100);
+
+  for (i = offset; i < offset + size; i++)
+    g_atomic_int_inc (&counts[i]);
+}
+
+static void
+count_area (const GeglRectangle *area,
+            gpointer             user_data)
+{
+  gint x;
+  gint y;
+
+  for (y = area->y; y < area->y + area->height; y++)
+    {
+      for (x = area->x; x < area->x + area->width; x++)
+        g_atomic_int_inc (&counts[y * SIZE + x]);
+    }
+}
+
+/* checks that the edges of @area are either edges of the distributed area,
+ * passed as @user_data, or tile boundaries.
+ */
+static void
+count_area_aligned (const GeglRectangle *area,
+                    gpointer             user_data)
+{
+  const GeglRectangle *whole = user_data;
+  gint                 tile_width;
+  gint                 tile_height;
+
+  g_object_get (gegl_config (),
+                "tile-width",  &tile_width,
+                "tile-height", &tile_height,
+                NULL);
+
+  if (area->x != whole->x)
+    g_assert_cmpint (area->x % tile_width, ==, 0);
+  if (area->x + area->width != whole->x + whole->width)
+    g_assert_cmpint ((area->x + area->width) % tile_width, ==, 0);
+  if (area->y != whole->y)
+    g_assert_cmpint (area->y % tile_height, ==, 0);
+  if (area->y + area->height != whole->y + whole->height)
+    g_assert_cmpint ((area->y + area->height) % tile_height, ==, 0);
+
+  count_area (area, NULL);
+}
+
+typedef struct
+{
+  GeglRectangle whole;
+  GeglRectangle tile_grid;
+} AlignedData;
+
+/* checks that the edges of @area are either edges of the distributed area,
+ * or boundaries of the tiles of the given grid.
+ */
+static void
+count_area_grid_aligned (const GeglRectangle *area,
+                         AlignedData         *data)
+{
+  const GeglRectangle *whole = &data->whole;
+  const GeglRectangle *grid  = &data->tile_grid;
+
+  if (area->x != whole->x)
+    g_assert_cmpint ((area->x - grid->x) % grid->width, ==, 0);
+  if (area->x + area->width != whole->x + whole->width)
+    g_assert_cmpint ((area->x + area->width - grid->x) % grid->width, ==, 0);
+  if (area->y != whole->y)
+    g_assert_cmpint ((area->y - grid->y) % grid->height, ==, 0);
+  if (area->y + area->height != whole->y + whole->height)
+    g_assert_cmpint ((area->y + area->height - grid->y) % grid->height, ==, 0);
+
+  count_area (area, NULL);
+}
+
+static void
+count_nested (gsize    offset,
+              gsize    size,
+              gpointer user_data)
+{
+  gsize i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      GeglRectangle area = {0, i * (SIZE / N_OUTER), SIZE, SIZE / N_OUTER};
+
+      gegl_parallel_distribute_area (&area, 16.0, GEGL_SPLIT_STRATEGY_AUTO,
+                                     count_area, NULL);
+    }
+}
+
+/**
+ * Tests that gegl_parallel_distribute() calls the function exactly once for
+ * each part.
+ **/
+static void
+distribute (void)
+{
+  gint max_n;
+
+  for (max_n = 1; max_n <= 8; max_n++)
+    {
+      gint n = 0;
+
+      reset_counts ();
+
+      gegl_parallel_distribute (max_n, count_part, &n);
+
+      g_assert_cmpint (n, >=, 1);
+      g_assert_cmpint (n, <=, max_n);
+
+      check_counts (n);
+      g_assert_cmpint (counts[n], ==, 0);
+    }
+}
+
+/**
+ * Tests that gegl_parallel_distribute_range() processes each element exactly
+ * once.
+ **/
+static void
+distribute_range (void)
+{
+  reset_counts ();
+
+  gegl_parallel_distribute_range (SIZE * SIZE, 16.0, count_range, NULL);
+
+  check_counts (SIZE * SIZE);
+}
+
+/**
+ * Tests that gegl_parallel_distribute_area() processes each pixel exactly
+ * once, using both split strategies.
+ **/
+static void
+distribute_area (void)
+{
+  GeglRectangle area = {0, 0, SIZE, SIZE};
+
+  reset_counts ();
+
+  gegl_parallel_distribute_area (&area, 16.0, GEGL_SPLIT_STRATEGY_HORIZONTAL,
+                                 count_area, NULL);
+
+  check_counts (SIZE * SIZE);
+
+  reset_counts ();
+
+  gegl_parallel_distribute_area (&area, 16.0, GEGL_SPLIT_STRATEGY_VERTICAL,
+                                 count_area, NULL);
+
+  check_counts (SIZE * SIZE);
+}
+
+/**
+ * Tests that gegl_parallel_distribute_area() processes each pixel exactly
+ * once using the affinity strategy, in tile-aligned sub-areas, both when
+ * requested explicitly, and when enabled through the config.
+ **/
+static void
+distribute_area_affinity (void)
+{
+  GeglRectangle area = {3, 5, SIZE - 3, SIZE - 5};
+  gint          tile_width;
+  gint          tile_height;
+  gint          x;
+  gint          y;
+
+  g_object_get (gegl_config (),
+                "tile-width",  &tile_width,
+                "tile-height", &tile_height,
+                NULL);
+
+  /* use small tiles, so that the area spans plenty of cells */
+  g_object_set (gegl_config (),
+                "tile-width",  16,
+                "tile-height", 16,
+                NULL);
+
+  reset_counts ();
+
+  gegl_parallel_distribute_area (&area, 16.0, GEGL_SPLIT_STRATEGY_AFFINITY,
+                                 count_area_aligned, &area);
+
+  for (y = 0; y < SIZE; y++)
+    {
+      for (x = 0; x < SIZE; x++)
+        {
+          g_assert_cmpint (counts[y * SIZE + x], ==,
+                           gegl_rectangle_contains (
+                             &area, GEGL_RECTANGLE (x, y, 1, 1)));
+        }
+    }
+
+  area = *GEGL_RECTANGLE (0, 0, SIZE, SIZE);
+
+  g_object_set (gegl_config (),
+                "thread-affinity", TRUE,
+                NULL);
+
+  reset_counts ();
+
+  gegl_parallel_distribute_area (&area, 16.0, GEGL_SPLIT_STRATEGY_AUTO,
+                                 count_area_aligned, &area);
+
+  check_counts (SIZE * SIZE);
+
+  g_object_set (gegl_config (),
+                "thread-affinity", FALSE,
+                "tile-width",      tile_width,
+                "tile-height",     tile_height,
+                NULL);
+}
+
+/**
+ * Tests that gegl_parallel_distribute_buffer_area() aligns the affinity
+ * cells to the tiles of the buffer, rather than to the default tile size.
+ **/
+static void
+distribute_buffer_area_affinity (void)
+{
+  GeglBuffer  *buffer;
+  GeglBuffer  *shifted;
+  AlignedData  data;
+  gint         x;
+  gint         y;
+
+  buffer = g_object_new (GEGL_TYPE_BUFFER,
+                         "format",      babl_format ("Y u8"),
+                         "x",           0,
+                         "y",           0,
+                         "width",       SIZE + 16,
+                         "height",      SIZE + 16,
+                         "tile-width",  16,
+                         "tile-height", 16,
+                         NULL);
+
+  /* tile boundaries of the shifted buffer lie 5 pixels left of, and 3
+   * pixels above, multiples of 16.
+   */
+  shifted = g_object_new (GEGL_TYPE_BUFFER,
+                          "source",  buffer,
+                          "x",       0,
+                          "y",       0,
+                          "width",   SIZE,
+                          "height",  SIZE,
+                          "shift-x", 5,
+                          "shift-y", 3,
+                          NULL);
+
+  data.whole     = *GEGL_RECTANGLE (0, 0, SIZE, SIZE);
+  data.tile_grid = *GEGL_RECTANGLE (-5, -3, 16, 16);
+
+  reset_counts ();
+
+  gegl_parallel_distribute_buffer_area (
+    shifted, 0, &data.whole, 16.0, GEGL_SPLIT_STRATEGY_AFFINITY,
+    (GeglParallelDistributeAreaFunc) count_area_grid_aligned, &data);
+
+  check_counts (SIZE * SIZE);
+
+  /* at level 1, the shift is halved, and the tiles keep their size */
+  data.whole     = *GEGL_RECTANGLE (0, 0, SIZE / 2, SIZE / 2);
+  data.tile_grid = *GEGL_RECTANGLE (-2, -1, 16, 16);
+
+  reset_counts ();
+
+  gegl_parallel_distribute_buffer_area (
+    shifted, 1, &data.whole, 16.0, GEGL_SPLIT_STRATEGY_AFFINITY,
+    (GeglParallelDistributeAreaFunc) count_area_grid_aligned, &data);
+
+  for (y = 0; y < SIZE; y++)
+    {
+      for (x = 0; x < SIZE; x++)
+        {
+          g_assert_cmpint (counts[y * SIZE + x], ==,
+                           gegl_rectangle_contains (
+                             &data.whole, GEGL_RECTANGLE (x, y, 1, 1)));
+        }
+    }
+
+  g_object_unref (shifted);
+  g_object_unref (buffer);
+}
+
+/**
+ * Tests that distributing work from within a distributed function processes
+ * each pixel exactly once.
+ **/
+static void
+distribute_nested (void)
+{
+  reset_counts ();
+
+  gegl_parallel_distribute_range (N_OUTER, 0.0, count_nested, NULL);
+
+  check_counts (SIZE * SIZE);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  g_object_set (gegl_config (),
+                "threads", 4,
+                NULL);
+
+  ADD_TEST (distribute);
+  ADD_TEST (distribute_range);
+  ADD_TEST (distribute_area);
+  ADD_TEST (distribute_area_affinity);
+  ADD_TEST (distribute_buffer_area_affinity);
+  ADD_TEST (distribute_nested);
+
+  return g_test_run ();
+}
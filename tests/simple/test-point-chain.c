@@ -0,0 +1,222 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+
+#include <gegl.h>
+
+
+#define ADD_TEST(function) g_test_add_func ("/point-chain/" #function, function);
+
+#define WIDTH  300
+#define HEIGHT 200
+#define EPSILON 1e-5
+
+
+static GeglBuffer *
+create_buffer (void)
+{
+  GeglBuffer *buffer;
+  gfloat     *data;
+  GRand      *rand = g_rand_new_with_seed (0);
+  gint        i;
+
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (-10, -20, WIDTH, HEIGHT),
+                            babl_format ("RGBA float"));
+  data   = g_new (gfloat, WIDTH * HEIGHT * 4);
+
+  for (i = 0; i < WIDTH * HEIGHT * 4; i++)
+    data[i] = g_rand_double (rand);
+
+  gegl_buffer_set (buffer, NULL, 0, babl_format ("RGBA float"), data,
+                   GEGL_AUTO_ROWSTRIDE);
+
+  g_free (data);
+  g_rand_free (rand);
+
+  return buffer;
+}
+
+/* links @node after @input, separating the two with a non-point operation
+ * if @separate is TRUE, so that they can't be processed as a chain.
+ */
+static GeglNode *
+link_node (GeglNode *gegl,
+           GeglNode *input,
+           GeglNode *node,
+           gboolean  separate)
+{
+  if (separate)
+    {
+      GeglNode *nop = gegl_node_new_child (gegl,
+                                           "operation", "gegl:nop",
+                                           NULL);
+
+      gegl_node_link (input, nop);
+
+      input = nop;
+    }
+
+  gegl_node_link (input, node);
+
+  return node;
+}
+
+/* a chain of point filters and composers, with a change of format in the
+ * middle.
+ */
+static GeglNode *
+create_graph (GeglNode   *gegl,
+              GeglBuffer *buffer,
+              gboolean    separate)
+{
+  GeglNode  *node;
+  GeglNode  *color;
+  GeglNode  *over;
+  GeglColor *value = gegl_color_new ("rgba(0.2, 0.4, 0.6, 0.5)");
+
+  node = gegl_node_new_child (gegl,
+                              "operation", "gegl:buffer-source",
+                              "buffer",    buffer,
+                              NULL);
+
+  node = link_node (gegl, node,
+                    gegl_node_new_child (gegl,
+                                         "operation",  "gegl:brightness-contrast",
+                                         "contrast",   1.5,
+                                         "brightness", 0.1,
+                                         NULL),
+                    separate);
+
+  node = link_node (gegl, node,
+                    gegl_node_new_child (gegl,
+                                         "operation", "gegl:invert-linear",
+                                         NULL),
+                    separate);
+
+  color = gegl_node_new_child (gegl,
+                               "operation", "gegl:color",
+                               "value",     value,
+                               NULL);
+  over  = gegl_node_new_child (gegl,
+                               "operation", "gegl:over",
+                               NULL);
+
+  g_object_unref (value);
+
+  gegl_node_connect_to (color, "output", over, "aux");
+
+  node = link_node (gegl, node, over, separate);
+
+  node = link_node (gegl, node,
+                    gegl_node_new_child (gegl,
+                                         "operation", "gegl:saturation",
+                                         "scale",     0.5,
+                                         NULL),
+                    separate);
+
+  node = link_node (gegl, node,
+                    gegl_node_new_child (gegl,
+                                         "operation", "gegl:invert-linear",
+                                         NULL),
+                    separate);
+
+  return node;
+}
+
+static gfloat *
+render (gboolean             separate,
+        const GeglRectangle *roi,
+        gint                 level)
+{
+  GeglBuffer *buffer = create_buffer ();
+  GeglNode   *gegl   = gegl_node_new ();
+  GeglNode   *output = create_graph (gegl, buffer, separate);
+  gdouble     scale  = 1.0 / (1 << level);
+  gfloat     *data   = g_new0 (gfloat, roi->width * roi->height * 4);
+
+  gegl_node_blit (output, scale, roi, babl_format ("RGBA float"), data,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  g_object_unref (gegl);
+  g_object_unref (buffer);
+
+  return data;
+}
+
+static void
+compare (const GeglRectangle *roi,
+         gint                 level)
+{
+  gfloat *expected = render (TRUE,  roi, level);
+  gfloat *result   = render (FALSE, roi, level);
+  gint    i;
+
+  for (i = 0; i < roi->width * roi->height * 4; i++)
+    g_assert_cmpfloat (fabs (result[i] - expected[i]), <, EPSILON);
+
+  g_free (result);
+  g_free (expected);
+}
+
+static void
+compare_threads (gint n_threads)
+{
+  g_object_set (gegl_config (),
+                "threads", n_threads,
+                NULL);
+
+  compare (GEGL_RECTANGLE (-10, -20, WIDTH, HEIGHT), 0);
+  compare (GEGL_RECTANGLE (17, 3, 61, 129), 0);
+  compare (GEGL_RECTANGLE (0, 0, WIDTH / 2, HEIGHT / 2), 1);
+}
+
+/**
+ * Tests that a chain of point operations, processed with a single thread,
+ * produces the same result as processing each operation separately.
+ **/
+static void
+single_thread (void)
+{
+  compare_threads (1);
+}
+
+/**
+ * Tests that a chain of point operations, processed with several threads,
+ * produces the same result as processing each operation separately.
+ **/
+static void
+multiple_threads (void)
+{
+  compare_threads (4);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  g_object_set (gegl_config (),
+                "swap",       "RAM",
+                "use-opencl", FALSE,
+                NULL);
+
+  ADD_TEST (single_thread);
+  ADD_TEST (multiple_threads);
+
+  return g_test_run ();
+}
@@ -0,0 +1,453 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+
+#include <gegl.h>
+
+#include "gegl-stats.h"
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-processor/" #function, function);
+
+#define WIDTH   500
+#define HEIGHT  300
+#define EPSILON 1e-5
+
+
+typedef struct
+{
+  GeglBuffer *buffer;
+  GeglNode   *gegl;
+  GeglNode   *output;
+} Graph;
+
+
+static void
+graph_init (Graph *graph)
+{
+  GeglNode *source;
+  gfloat   *data;
+  GRand    *rand = g_rand_new_with_seed (0);
+  gint      i;
+
+  graph->buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT),
+                                   babl_format ("RGBA float"));
+
+  data = g_new (gfloat, WIDTH * HEIGHT * 4);
+
+  for (i = 0; i < WIDTH * HEIGHT * 4; i++)
+    data[i] = g_rand_double (rand);
+
+  gegl_buffer_set (graph->buffer, NULL, 0, babl_format ("RGBA float"), data,
+                   GEGL_AUTO_ROWSTRIDE);
+
+  g_free (data);
+  g_rand_free (rand);
+
+  graph->gegl   = gegl_node_new ();
+  source        = gegl_node_new_child (graph->gegl,
+                                       "operation", "gegl:buffer-source",
+                                       "buffer",    graph->buffer,
+                                       NULL);
+  graph->output = gegl_node_new_child (graph->gegl,
+                                       "operation", "gegl:brightness-contrast",
+                                       "contrast",  1.5,
+                                       NULL);
+
+  gegl_node_link (source, graph->output);
+}
+
+static void
+graph_destroy (Graph *graph)
+{
+  g_object_unref (graph->gegl);
+  g_object_unref (graph->buffer);
+}
+
+/* processes @rect of the graph's output node into its cache */
+static void
+process (Graph               *graph,
+         const GeglRectangle *rect,
+         gboolean             parallel)
+{
+  GeglProcessor *processor = gegl_node_new_processor (graph->output, rect);
+
+  g_object_set (processor,
+                "parallel", parallel,
+                NULL);
+
+  while (gegl_processor_work (processor, NULL));
+
+  g_object_unref (processor);
+}
+
+/* compares the cached result of the graph over @rect to the result of
+ * rendering it directly.
+ */
+static void
+check (Graph               *graph,
+       const GeglRectangle *rect)
+{
+  gint    n        = rect->width * rect->height * 4;
+  gfloat *expected = g_new (gfloat, n);
+  gfloat *result   = g_new (gfloat, n);
+  gint    i;
+
+  gegl_node_blit (graph->output, 1.0, rect, babl_format ("RGBA float"),
+                  expected, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+  gegl_node_blit (graph->output, 1.0, rect, babl_format ("RGBA float"),
+                  result, GEGL_AUTO_ROWSTRIDE,
+                  GEGL_BLIT_CACHE | GEGL_BLIT_DIRTY);
+
+  for (i = 0; i < n; i++)
+    g_assert_cmpfloat (fabs (result[i] - expected[i]), <, EPSILON);
+
+  g_free (result);
+  g_free (expected);
+}
+
+/**
+ * Tests that rendering chunks in parallel fills the cache correctly.
+ **/
+static void
+parallel (void)
+{
+  Graph graph;
+
+  graph_init (&graph);
+
+  process (&graph, GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT), TRUE);
+  check (&graph, GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT));
+
+  graph_destroy (&graph);
+}
+
+typedef struct
+{
+  GMutex   mutex;
+  GThread *thread;
+  guint64  area;
+  gint     n_other_thread;
+} Computed;
+
+static void
+computed_cb (GeglNode            *node,
+             const GeglRectangle *rect,
+             Computed            *computed)
+{
+  g_mutex_lock (&computed->mutex);
+
+  computed->area += (guint64) rect->width * rect->height;
+
+  if (g_thread_self () != computed->thread)
+    computed->n_other_thread++;
+
+  g_mutex_unlock (&computed->mutex);
+}
+
+/**
+ * Tests that rendering chunks in parallel announces each chunk through the
+ * "computed" signal exactly once, from the processor's thread, even when
+ * the output node renders directly into its cache.
+ **/
+static void
+parallel_computed (void)
+{
+  Graph     graph;
+  GeglNode *blur;
+  Computed  computed;
+
+  graph_init (&graph);
+
+  /* unlike point filters, area filters render into their cache */
+  blur = gegl_node_new_child (graph.gegl,
+                              "operation", "gegl:box-blur",
+                              "radius",    2,
+                              NULL);
+
+  gegl_node_link (graph.output, blur);
+
+  graph.output = blur;
+
+  g_mutex_init (&computed.mutex);
+  computed.thread         = g_thread_self ();
+  computed.area           = 0;
+  computed.n_other_thread = 0;
+
+  g_signal_connect (blur, "computed",
+                    G_CALLBACK (computed_cb), &computed);
+
+  process (&graph, GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT), TRUE);
+
+  g_signal_handlers_disconnect_by_data (blur, &computed);
+
+  g_assert_cmpint (computed.n_other_thread, ==, 0);
+  g_assert_cmpuint (computed.area, ==, WIDTH * HEIGHT);
+
+  g_mutex_clear (&computed.mutex);
+
+  check (&graph, GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT));
+
+  graph_destroy (&graph);
+}
+
+/**
+ * Tests that rendering a rectangle partially covered by the cache, either
+ * serially or in parallel, fills the cache correctly.
+ **/
+static void
+partial_hit (void)
+{
+  gint i;
+
+  for (i = 0; i < 2; i++)
+    {
+      gboolean parallel = i;
+      Graph    graph;
+
+      graph_init (&graph);
+
+      process (&graph, GEGL_RECTANGLE (30, 20, 200, 100), parallel);
+      process (&graph, GEGL_RECTANGLE (130, 70, 250, 150), parallel);
+
+      check (&graph, GEGL_RECTANGLE (30, 20, 200, 100));
+      check (&graph, GEGL_RECTANGLE (130, 70, 250, 150));
+
+      graph_destroy (&graph);
+    }
+}
+
+/**
+ * Tests that rendering a rectangle partially covered by the cache only
+ * renders the uncovered part, and reports the covered part as reused.
+ **/
+static void
+reuse_stats (void)
+{
+  gint i;
+
+  for (i = 0; i < 2; i++)
+    {
+      gboolean parallel = i;
+      Graph    graph;
+      guint64  reused;
+      guint64  rendered;
+
+      graph_init (&graph);
+
+      process (&graph, GEGL_RECTANGLE (30, 20, 200, 100), parallel);
+
+      gegl_stats_reset (gegl_stats ());
+
+      process (&graph, GEGL_RECTANGLE (130, 70, 250, 150), parallel);
+
+      g_object_get (gegl_stats (),
+                    "processor-pixels-reused",   &reused,
+                    "processor-pixels-rendered", &rendered,
+                    NULL);
+
+      g_assert_cmpuint (reused, ==, 100 * 50);
+      g_assert_cmpuint (rendered, ==, 250 * 150 - 100 * 50);
+
+      check (&graph, GEGL_RECTANGLE (130, 70, 250, 150));
+
+      graph_destroy (&graph);
+    }
+}
+
+/**
+ * Tests that the part of the rectangle inside a priority rectangle is
+ * rendered first.
+ **/
+static void
+priority (void)
+{
+  gint i;
+
+  for (i = 0; i < 2; i++)
+    {
+      gboolean       parallel = i;
+      GeglRectangle  focus    = {256, 128, 64, 64};
+      Graph          graph;
+      GeglProcessor *processor;
+      guint64        rendered = 0;
+
+      graph_init (&graph);
+
+      processor = gegl_node_new_processor (graph.output,
+                                           GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT));
+
+      g_object_set (processor,
+                    "parallel", parallel,
+                    NULL);
+
+      gegl_processor_add_priority_rectangle (processor, &focus);
+
+      gegl_stats_reset (gegl_stats ());
+
+      while (rendered == 0 && gegl_processor_work (processor, NULL))
+        {
+          g_object_get (gegl_stats (),
+                        "processor-pixels-rendered", &rendered,
+                        NULL);
+        }
+
+      g_assert_cmpuint (rendered, <, WIDTH * HEIGHT);
+
+      check (&graph, &focus);
+
+      g_object_unref (processor);
+      graph_destroy (&graph);
+    }
+}
+
+/**
+ * Tests that refining the rendering from a coarse level ends with the full
+ * resolution result in the cache.
+ **/
+static void
+coarse_to_fine (void)
+{
+  Graph          graph;
+  GeglProcessor *processor;
+  gdouble        progress;
+  gdouble        last_progress = 0.0;
+
+  graph_init (&graph);
+
+  processor = gegl_node_new_processor (graph.output,
+                                       GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT));
+
+  gegl_processor_set_coarse_level (processor, 2);
+
+  g_assert_cmpint (gegl_processor_get_rendered_level (processor), ==, -1);
+
+  while (gegl_processor_work (processor, &progress))
+    {
+      g_assert_cmpfloat (progress, >=, last_progress);
+
+      last_progress = progress;
+    }
+
+  g_assert_cmpint (gegl_processor_get_rendered_level (processor), ==, 0);
+
+  check (&graph, GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT));
+
+  g_object_unref (processor);
+  graph_destroy (&graph);
+}
+
+/**
+ * Tests that a cancelled processor stops working, and that retargeting it
+ * resumes the work.
+ **/
+static void
+cancel (void)
+{
+  Graph          graph;
+  GeglProcessor *processor;
+
+  graph_init (&graph);
+
+  processor = gegl_node_new_processor (graph.output,
+                                       GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT));
+
+  g_assert (gegl_processor_work (processor, NULL));
+
+  gegl_processor_cancel (processor);
+
+  g_assert (! gegl_processor_work (processor, NULL));
+
+  gegl_processor_set_rectangle (processor, GEGL_RECTANGLE (100, 50, 200, 100));
+
+  while (gegl_processor_work (processor, NULL));
+
+  check (&graph, GEGL_RECTANGLE (100, 50, 200, 100));
+
+  g_object_unref (processor);
+  graph_destroy (&graph);
+}
+
+/**
+ * Tests that a sink needing its full input, whose processor was cancelled,
+ * is written to once the processor is restarted.
+ **/
+static void
+cancel_sink (void)
+{
+  Graph          graph;
+  GeglNode      *sink;
+  GeglProcessor *processor;
+  GeglBuffer    *result = NULL;
+
+  graph_init (&graph);
+
+  sink = gegl_node_new_child (graph.gegl,
+                              "operation", "gegl:buffer-sink",
+                              "buffer",    &result,
+                              NULL);
+
+  gegl_node_link (graph.output, sink);
+
+  processor = gegl_node_new_processor (sink,
+                                       GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT));
+
+  g_assert (gegl_processor_work (processor, NULL));
+
+  gegl_processor_cancel (processor);
+
+  g_assert (! gegl_processor_work (processor, NULL));
+  g_assert (result == NULL);
+
+  gegl_processor_set_level (processor, 0);
+
+  while (gegl_processor_work (processor, NULL));
+
+  g_assert (result != NULL);
+  g_assert (gegl_rectangle_equal (gegl_buffer_get_extent (result),
+                                  GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT)));
+
+  check (&graph, GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT));
+
+  g_object_unref (result);
+  g_object_unref (processor);
+  graph_destroy (&graph);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  g_object_set (gegl_config (),
+                "swap",       "RAM",
+                "use-opencl", FALSE,
+                "threads",    4,
+                NULL);
+
+  ADD_TEST (parallel);
+  ADD_TEST (parallel_computed);
+  ADD_TEST (partial_hit);
+  ADD_TEST (reuse_stats);
+  ADD_TEST (priority);
+  ADD_TEST (coarse_to_fine);
+  ADD_TEST (cancel);
+  ADD_TEST (cancel_sink);
+
+  return g_test_run ();
+}
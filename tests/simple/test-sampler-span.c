@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <gegl.h>
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-sampler-span/" #function, function);
+
+#define SIZE   200
+#define N      150
+
+
+static GeglBuffer *
+create_buffer (void)
+{
+  GeglBuffer *buffer;
+  gfloat     *data;
+  gint        i;
+
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, SIZE, SIZE),
+                            babl_format ("RGBA float"));
+
+  data = g_new (gfloat, 4 * SIZE * SIZE);
+
+  for (i = 0; i < 4 * SIZE * SIZE; i++)
+    data[i] = (i * 7919 % 1009) / 1009.0f;
+
+  gegl_buffer_set (buffer, NULL, 0, babl_format ("RGBA float"),
+                   data, GEGL_AUTO_ROWSTRIDE);
+
+  g_free (data);
+
+  return buffer;
+}
+
+/* samples a span, both using gegl_sampler_get_span(), and one pixel at a
+ * time, and checks that the results are identical.
+ */
+static void
+check_span (GeglSamplerType  type,
+            const gchar     *format_name,
+            gdouble          x,
+            gdouble          y,
+            gdouble          dx,
+            gdouble          dy)
+{
+  GeglBuffer        *buffer = create_buffer ();
+  const Babl        *format = babl_format (format_name);
+  gint               bpp    = babl_format_get_bytes_per_pixel (format);
+  GeglSampler       *sampler;
+  GeglSamplerGetFun  sampler_get_fun;
+  GeglBufferMatrix2  scale  = {{{dx, 0.0}, {dy, 1.0}}};
+  guchar            *span;
+  guchar            *pixels;
+  gint               i;
+
+  sampler         = gegl_buffer_sampler_new (buffer, format, type);
+  sampler_get_fun = gegl_sampler_get_fun (sampler);
+
+  span   = g_malloc0 (N * bpp);
+  pixels = g_malloc0 (N * bpp);
+
+  gegl_sampler_get_span (sampler, x, y, dx, dy, &scale, span, N,
+                         GEGL_ABYSS_CLAMP);
+
+  for (i = 0; i < N; i++)
+    {
+      sampler_get_fun (sampler, x, y, &scale, pixels + i * bpp,
+                       GEGL_ABYSS_CLAMP);
+
+      x += dx;
+      y += dy;
+    }
+
+  g_assert_true (memcmp (span, pixels, N * bpp) == 0);
+
+  g_free (pixels);
+  g_free (span);
+
+  g_object_unref (sampler);
+  g_object_unref (buffer);
+}
+
+static void
+check_sampler (GeglSamplerType type)
+{
+  /* identity, in a format the samplers interpolate directly */
+  check_span (type, "RaGaBaA float", 0.5, 10.5, 1.0, 0.0);
+  /* a rotation, crossing the buffer's edge, with a conversion */
+  check_span (type, "R'G'B'A u8",   -20.3, 30.7, 0.8, 0.6);
+  /* a downscale, large enough for box filtering */
+  check_span (type, "RGBA float",     3.1,  5.2, 3.0, 0.5);
+}
+
+/**
+ * Tests that gegl_sampler_get_span() gives the same results as sampling
+ * each pixel separately.
+ **/
+static void
+nearest (void)
+{
+  check_sampler (GEGL_SAMPLER_NEAREST);
+}
+
+static void
+linear (void)
+{
+  check_sampler (GEGL_SAMPLER_LINEAR);
+}
+
+static void
+cubic (void)
+{
+  check_sampler (GEGL_SAMPLER_CUBIC);
+}
+
+static void
+nohalo (void)
+{
+  check_sampler (GEGL_SAMPLER_NOHALO);
+}
+
+static void
+lohalo (void)
+{
+  check_sampler (GEGL_SAMPLER_LOHALO);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  ADD_TEST (nearest);
+  ADD_TEST (linear);
+  ADD_TEST (cubic);
+  ADD_TEST (nohalo);
+  ADD_TEST (lohalo);
+
+  return g_test_run ();
+}
@@ -0,0 +1,152 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <gegl.h>
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-scratch/" #function, function);
+
+#define N_SIZES 5
+
+
+static const gsize sizes[N_SIZES] = {1, 100, 4096, 100000, 32 << 20};
+
+
+static guint64
+get_stat (const gchar *name)
+{
+  guint64 value;
+
+  g_object_get (gegl_stats (), name, &value, NULL);
+
+  return value;
+}
+
+/**
+ * Tests that scratch memory is aligned, and usable up to the requested
+ * size.
+ **/
+static void
+alloc_free (void)
+{
+  gpointer ptrs[N_SIZES];
+  gint     i;
+
+  for (i = 0; i < N_SIZES; i++)
+    {
+      ptrs[i] = gegl_scratch_alloc (sizes[i]);
+
+      g_assert_cmpuint ((guintptr) ptrs[i] % 16, ==, 0);
+
+      memset (ptrs[i], i, sizes[i]);
+    }
+
+  for (i = N_SIZES - 1; i >= 0; i--)
+    gegl_scratch_free (ptrs[i]);
+
+  gegl_scratch_free (NULL);
+}
+
+/**
+ * Tests that gegl_scratch_alloc0() returns zeroed memory, even when reusing
+ * a previously-freed block.
+ **/
+static void
+alloc0 (void)
+{
+  guchar *ptr;
+  gint    i;
+
+  ptr = gegl_scratch_alloc (1000);
+  memset (ptr, 0xff, 1000);
+  gegl_scratch_free (ptr);
+
+  ptr = gegl_scratch_new0 (guchar, 1000);
+
+  for (i = 0; i < 1000; i++)
+    g_assert_cmpint (ptr[i], ==, 0);
+
+  gegl_scratch_free (ptr);
+}
+
+/**
+ * Tests that freed blocks are reused by subsequent allocations of a similar
+ * size, and that allocations are counted by GeglStats.
+ **/
+static void
+reuse (void)
+{
+  gpointer ptr;
+  gpointer ptr2;
+
+  ptr = gegl_scratch_alloc (3000);
+  gegl_scratch_free (ptr);
+
+  gegl_stats_reset (gegl_stats ());
+
+  ptr2 = gegl_scratch_alloc (2500);
+
+  g_assert_true (ptr2 == ptr);
+
+  gegl_scratch_free (ptr2);
+
+  g_assert_cmpuint (get_stat ("scratch-allocs"), ==, 1);
+  g_assert_cmpuint (get_stat ("scratch-misses"), ==, 0);
+  g_assert_cmpuint (get_stat ("scratch-total"),  >=, 2500);
+}
+
+static gpointer
+free_func (gpointer ptr)
+{
+  gegl_scratch_free (ptr);
+
+  return NULL;
+}
+
+/**
+ * Tests freeing scratch memory from a different thread than the one that
+ * allocated it.
+ **/
+static void
+free_other_thread (void)
+{
+  gint i;
+
+  for (i = 0; i < N_SIZES; i++)
+    {
+      GThread *thread;
+
+      thread = g_thread_new ("free", free_func, gegl_scratch_alloc (sizes[i]));
+
+      g_thread_join (thread);
+    }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  ADD_TEST (alloc_free);
+  ADD_TEST (alloc0);
+  ADD_TEST (reuse);
+  ADD_TEST (free_other_thread);
+
+  return g_test_run ();
+}
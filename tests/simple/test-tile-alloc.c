@@ -0,0 +1,293 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <gegl.h>
+#include <gegl-buffer-backend.h>
+#include "gegl-tile-alloc.h"
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-tile-alloc/" #function, function);
+
+/* the distance between consecutive pieces of a slab */
+#define STRIDE(size) \
+  (GEGL_TILE_ALLOC_ALIGNMENT + \
+   (((size) + GEGL_TILE_ALLOC_ALIGNMENT - 1) & ~(GEGL_TILE_ALLOC_ALIGNMENT - 1)))
+
+
+/**
+ * Tests that each size gets a pool of its own, whose pieces are carved out
+ * of a shared slab, and that sizes too big for a slab are allocated
+ * directly.
+ **/
+static void
+size_classes (void)
+{
+  const gsize  sizes[] = {12345, 23456};
+  const gsize  big     = 4 << 20;
+  guchar      *ptrs[G_N_ELEMENTS (sizes)][2];
+  guchar      *ptr;
+  guint64      total;
+  gint         i;
+
+  gegl_tile_alloc_trim ();
+
+  for (i = 0; i < (gint) G_N_ELEMENTS (sizes); i++)
+    {
+      total = gegl_tile_alloc_get_total ();
+
+      /* the first piece of a size brings in a whole slab ... */
+      ptrs[i][0] = gegl_tile_alloc (sizes[i]);
+
+      g_assert_cmpuint (gegl_tile_alloc_get_total (), >, total + 2 * sizes[i]);
+
+      total = gegl_tile_alloc_get_total ();
+
+      /* ... which the next one comes from, right after the first */
+      ptrs[i][1] = gegl_tile_alloc (sizes[i]);
+
+      g_assert_cmpuint (gegl_tile_alloc_get_total (), ==, total);
+      g_assert_true (ptrs[i][1] == ptrs[i][0] + STRIDE (sizes[i]));
+
+      g_assert_cmpuint ((guintptr) ptrs[i][0] % GEGL_TILE_ALLOC_ALIGNMENT, ==, 0);
+      g_assert_cmpuint ((guintptr) ptrs[i][1] % GEGL_TILE_ALLOC_ALIGNMENT, ==, 0);
+
+      memset (ptrs[i][0], 1, sizes[i]);
+      memset (ptrs[i][1], 2, sizes[i]);
+    }
+
+  /* the pools don't share slabs */
+  g_assert_true (ptrs[1][0] + sizes[1] <= ptrs[0][0] ||
+                 ptrs[1][0] >= ptrs[0][1] + sizes[0]);
+
+  total = gegl_tile_alloc_get_total ();
+
+  ptr = gegl_tile_alloc (big);
+
+  g_assert_cmpuint (gegl_tile_alloc_get_total (), ==, total + big);
+  g_assert_cmpuint ((guintptr) ptr % GEGL_TILE_ALLOC_ALIGNMENT, ==, 0);
+
+  memset (ptr, 3, big);
+
+  gegl_tile_free (ptr);
+
+  g_assert_cmpuint (gegl_tile_alloc_get_total (), ==, total);
+
+  for (i = 0; i < (gint) G_N_ELEMENTS (sizes); i++)
+    {
+      g_assert_cmpint (ptrs[i][0][sizes[i] - 1], ==, 1);
+      g_assert_cmpint (ptrs[i][1][0], ==, 2);
+
+      gegl_tile_free (ptrs[i][0]);
+      gegl_tile_free (ptrs[i][1]);
+    }
+
+  gegl_tile_alloc_trim ();
+}
+
+/**
+ * Tests that only a few completely free slabs are kept around and reused,
+ * and that after trimming returns them to the system, new slabs are
+ * brought in as needed.
+ **/
+static void
+reuse_after_trim (void)
+{
+  const gsize  size = 100000;
+  gpointer     ptrs[100];
+  gpointer     ptr;
+  guint64      total;
+  guint64      peak;
+  gint         i;
+
+  gegl_tile_alloc_trim ();
+
+  g_assert_cmpint (gegl_tile_alloc_get_free_slabs (), ==, 0);
+
+  total = gegl_tile_alloc_get_total ();
+
+  /* enough pieces for several slabs */
+  for (i = 0; i < (gint) G_N_ELEMENTS (ptrs); i++)
+    ptrs[i] = gegl_tile_alloc (size);
+
+  peak = gegl_tile_alloc_get_total ();
+
+  g_assert_cmpuint (peak, >=, total + G_N_ELEMENTS (ptrs) * size);
+
+  for (i = 0; i < (gint) G_N_ELEMENTS (ptrs); i++)
+    gegl_tile_free (ptrs[i]);
+
+  g_assert_cmpint (gegl_tile_alloc_get_free_slabs (), >, 0);
+  g_assert_cmpint (gegl_tile_alloc_get_free_slabs (), <, 4);
+  g_assert_cmpuint (gegl_tile_alloc_get_total (), <, peak);
+  g_assert_cmpuint (gegl_tile_alloc_get_total (), >, total);
+
+  /* a kept slab is reused, rather than a new one brought in */
+  peak = gegl_tile_alloc_get_total ();
+
+  ptr = gegl_tile_alloc (size);
+
+  g_assert_cmpuint (gegl_tile_alloc_get_total (), ==, peak);
+
+  gegl_tile_free (ptr);
+
+  gegl_tile_alloc_trim ();
+
+  g_assert_cmpint (gegl_tile_alloc_get_free_slabs (), ==, 0);
+  g_assert_cmpuint (gegl_tile_alloc_get_total (), ==, total);
+
+  /* the pool still works once all its slabs are gone */
+  for (i = 0; i < (gint) G_N_ELEMENTS (ptrs); i++)
+    {
+      ptrs[i] = gegl_tile_alloc (size);
+
+      memset (ptrs[i], i, size);
+    }
+
+  g_assert_cmpuint (gegl_tile_alloc_get_total (), >=,
+                    total + G_N_ELEMENTS (ptrs) * size);
+
+  for (i = 0; i < (gint) G_N_ELEMENTS (ptrs); i++)
+    {
+      g_assert_cmpint (((guchar *) ptrs[i])[size - 1], ==, i);
+
+      gegl_tile_free (ptrs[i]);
+    }
+
+  gegl_tile_alloc_trim ();
+
+  g_assert_cmpuint (gegl_tile_alloc_get_total (), ==, total);
+}
+
+static gpointer
+free_func (gpointer data)
+{
+  GPtrArray *ptrs = data;
+  gint       i;
+
+  for (i = 0; i < ptrs->len; i++)
+    gegl_tile_free (g_ptr_array_index (ptrs, i));
+
+  return NULL;
+}
+
+/**
+ * Tests that tile memory freed by a different thread than the one that
+ * allocated it goes back to the pool it was allocated from.
+ **/
+static void
+free_other_thread (void)
+{
+  const gsize  size = 34567;
+  GPtrArray   *ptrs = g_ptr_array_new ();
+  GThread     *thread;
+  gpointer     first;
+  gpointer     ptr;
+  guint64      total;
+  guint64      peak;
+
+  gegl_tile_alloc_trim ();
+
+  total = gegl_tile_alloc_get_total ();
+
+  /* fill a slab */
+  first = gegl_tile_alloc (size);
+  g_ptr_array_add (ptrs, first);
+
+  peak = gegl_tile_alloc_get_total ();
+
+  while (gegl_tile_alloc_get_total () == peak)
+    g_ptr_array_add (ptrs, gegl_tile_alloc (size));
+
+  /* the last piece started a new slab, keep it */
+  ptr = g_ptr_array_remove_index (ptrs, ptrs->len - 1);
+
+  peak = gegl_tile_alloc_get_total ();
+
+  thread = g_thread_new ("free", free_func, ptrs);
+  g_thread_join (thread);
+
+  /* the first slab is now completely free, and kept by the pool */
+  g_assert_cmpint (gegl_tile_alloc_get_free_slabs (), ==, 1);
+  g_assert_cmpuint (gegl_tile_alloc_get_total (), ==, peak);
+
+  gegl_tile_free (ptr);
+
+  gegl_tile_alloc_trim ();
+
+  g_assert_cmpuint (gegl_tile_alloc_get_total (), ==, total);
+
+  /* a single piece freed by another thread is handed out again */
+  g_ptr_array_set_size (ptrs, 0);
+  first = gegl_tile_alloc (size);
+  g_ptr_array_add (ptrs, first);
+
+  thread = g_thread_new ("free", free_func, ptrs);
+  g_thread_join (thread);
+
+  ptr = gegl_tile_alloc (size);
+
+  g_assert_true (ptr == first);
+
+  gegl_tile_free (ptr);
+
+  g_ptr_array_free (ptrs, TRUE);
+
+  gegl_tile_alloc_trim ();
+}
+
+/**
+ * Tests that writing to a tile sharing its data with another tile gives it a
+ * private copy, allocated from the tile pools.
+ **/
+static void
+unclone (void)
+{
+  GeglTile *tile  = gegl_tile_new (4096);
+  GeglTile *clone;
+  guchar   *data;
+
+  memset (gegl_tile_get_data (tile), 1, 4096);
+
+  clone = gegl_tile_dup (tile);
+
+  gegl_tile_lock (clone);
+  data = gegl_tile_get_data (clone);
+  g_assert_true (data != gegl_tile_get_data (tile));
+  g_assert_cmpint (data[4095], ==, 1);
+  memset (data, 2, 4096);
+  gegl_tile_unlock (clone);
+
+  g_assert_cmpint (((guchar *) gegl_tile_get_data (tile))[0], ==, 1);
+
+  gegl_tile_unref (clone);
+  gegl_tile_unref (tile);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  ADD_TEST (size_classes);
+  ADD_TEST (reuse_after_trim);
+  ADD_TEST (free_other_thread);
+  ADD_TEST (unclone);
+
+  return g_test_run ();
+}
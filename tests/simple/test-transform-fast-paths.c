@@ -0,0 +1,298 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <gegl.h>
+
+
+#define ADD_TEST(function) g_test_add_func ("/gegl-transform-fast-paths/" #function, function);
+
+#define WIDTH  37
+#define HEIGHT 23
+
+#define FORMAT "RaGaBaA float"
+
+
+static GeglBuffer *
+create_buffer (void)
+{
+  GeglBuffer *buffer;
+  gfloat     *data;
+  gint        i;
+
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, WIDTH, HEIGHT),
+                            babl_format (FORMAT));
+
+  data = g_new (gfloat, 4 * WIDTH * HEIGHT);
+
+  for (i = 0; i < 4 * WIDTH * HEIGHT; i++)
+    data[i] = (i * 7919 % 1009) / 1009.0f;
+
+  gegl_buffer_set (buffer, NULL, 0, babl_format (FORMAT),
+                   data, GEGL_AUTO_ROWSTRIDE);
+
+  g_free (data);
+
+  return buffer;
+}
+
+/* renders the buffer transformed by the transform string, and returns the
+ * result, and its extent in rect.
+ */
+static gfloat *
+render (GeglBuffer      *buffer,
+        const gchar     *transform,
+        GeglSamplerType  sampler,
+        GeglRectangle   *rect)
+{
+  GeglNode *graph;
+  GeglNode *source;
+  GeglNode *node;
+  gfloat   *data;
+
+  graph  = gegl_node_new ();
+  source = gegl_node_new_child (graph,
+                                "operation", "gegl:buffer-source",
+                                "buffer",    buffer,
+                                NULL);
+  node   = gegl_node_new_child (graph,
+                                "operation", "gegl:transform",
+                                "transform", transform,
+                                "sampler",   sampler,
+                                NULL);
+
+  gegl_node_link (source, node);
+
+  *rect = gegl_node_get_bounding_box (node);
+
+  data = g_new0 (gfloat, 4 * rect->width * rect->height);
+
+  gegl_node_blit (node, 1.0, rect, babl_format (FORMAT), data,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  g_object_unref (graph);
+
+  return data;
+}
+
+/* renders a rotation by a multiple of 90 degrees, or a flip, whose matrix
+ * is [a c e; b d f], up to round off error, and checks that each input pixel
+ * ends up, unchanged, where the matrix maps it.
+ */
+static void
+check_orthogonal (GeglSamplerType sampler,
+                  const gchar     *transform,
+                  gint             a,
+                  gint             b,
+                  gint             c,
+                  gint             d,
+                  gint             e,
+                  gint             f)
+{
+  GeglBuffer    *buffer = create_buffer ();
+  GeglRectangle  rect;
+  gfloat        *input;
+  gfloat        *output;
+  gfloat        *expected;
+  gint           x;
+  gint           y;
+
+  input = g_new (gfloat, 4 * WIDTH * HEIGHT);
+
+  gegl_buffer_get (buffer, NULL, 1.0, babl_format (FORMAT), input,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  output   = render (buffer, transform, sampler, &rect);
+  expected = g_new0 (gfloat, 4 * rect.width * rect.height);
+
+  for (y = 0; y < HEIGHT; y++)
+    {
+      for (x = 0; x < WIDTH; x++)
+        {
+          /* the output pixel the center of (x, y) maps to */
+          gint ox = floor (a * (x + 0.5) + c * (y + 0.5) + e) - rect.x;
+          gint oy = floor (b * (x + 0.5) + d * (y + 0.5) + f) - rect.y;
+
+          g_assert_cmpint (ox, >=, 0);
+          g_assert_cmpint (oy, >=, 0);
+          g_assert_cmpint (ox, <, rect.width);
+          g_assert_cmpint (oy, <, rect.height);
+
+          memcpy (expected + 4 * (oy * rect.width + ox),
+                  input    + 4 * (y  * WIDTH      + x),
+                  4 * sizeof (gfloat));
+        }
+    }
+
+  g_assert_true (memcmp (output, expected,
+                         4 * sizeof (gfloat) * rect.width * rect.height) == 0);
+
+  g_free (expected);
+  g_free (output);
+  g_free (input);
+
+  g_object_unref (buffer);
+}
+
+/**
+ * Tests that rotations by multiples of 90 degrees, and flips, move the input
+ * pixels without altering them.
+ **/
+static void
+orthogonal (void)
+{
+  GeglSamplerType samplers[] = {GEGL_SAMPLER_NEAREST, GEGL_SAMPLER_LINEAR};
+  gint            i;
+
+  for (i = 0; i < (gint) G_N_ELEMENTS (samplers); i++)
+    {
+      /* rotate by 90 degrees, with cos (G_PI / 2) != 0 */
+      check_orthogonal (samplers[i],
+                        "matrix(6.123234e-17,1,0,-1,6.123234e-17,0,0,0,1)",
+                        0,  1, -1,  0,  0,  0);
+      check_orthogonal (samplers[i], "matrix(-1,0,0,0,-1,0,0,0,1)",
+                        -1,  0,  0, -1,  0,  0);
+      check_orthogonal (samplers[i], "matrix(0,-1,0,1,0,0,4,2,1)",
+                        0, -1,  1,  0,  4,  2);
+      check_orthogonal (samplers[i], "matrix(-1,0,0,0,1,0,0,0,1)",
+                        -1,  0,  0,  1,  0,  0);
+      check_orthogonal (samplers[i], "matrix(0,1,0,1,0,0,3,-5,1)",
+                        0,  1,  1,  0,  3, -5);
+    }
+}
+
+/* checks that the pixels of a scaled rendering, whose centers map to points
+ * well within the input, are the same as sampling the input directly.
+ */
+static void
+check_scale (gdouble scale_x,
+             gdouble scale_y)
+{
+  GeglBuffer    *buffer = create_buffer ();
+  GeglSampler   *sampler;
+  GeglRectangle  rect;
+  gchar         *transform;
+  gfloat        *output;
+  gint           x;
+  gint           y;
+
+  transform = g_strdup_printf ("matrix(%g,0,0,0,%g,0,0,0,1)", scale_x, scale_y);
+  output    = render (buffer, transform, GEGL_SAMPLER_LINEAR, &rect);
+
+  sampler = gegl_buffer_sampler_new (buffer, babl_format (FORMAT),
+                                     GEGL_SAMPLER_LINEAR);
+
+  for (y = 0; y < rect.height; y++)
+    {
+      for (x = 0; x < rect.width; x++)
+        {
+          gdouble u = (rect.x + x + 0.5) / scale_x;
+          gdouble v = (rect.y + y + 0.5) / scale_y;
+          gfloat  pixel[4];
+          gint    c;
+
+          if (u < 1.0 || u > WIDTH - 1.0 || v < 1.0 || v > HEIGHT - 1.0)
+            continue;
+
+          gegl_sampler_get (sampler, u, v, NULL, pixel, GEGL_ABYSS_NONE);
+
+          for (c = 0; c < 4; c++)
+            {
+              g_assert_cmpfloat (fabs (output[4 * (y * rect.width + x) + c] -
+                                       pixel[c]), <, 1e-4);
+            }
+        }
+    }
+
+  g_object_unref (sampler);
+
+  g_free (output);
+  g_free (transform);
+
+  g_object_unref (buffer);
+}
+
+/**
+ * Tests that axis-aligned scales, which aren't box-filtered, give the same
+ * result as the linear sampler.
+ **/
+static void
+scale (void)
+{
+  check_scale (1.5,   1.25);
+  check_scale (3.0,   0.75);
+  check_scale (-1.75, 0.6);
+}
+
+/**
+ * Tests that, when trading quality for speed, downscaling by a power of 2
+ * samples the corresponding mipmap level.
+ **/
+static void
+scale_mipmap (void)
+{
+  GeglBuffer    *buffer = create_buffer ();
+  GeglRectangle  rect;
+  gfloat        *output;
+  gfloat        *expected;
+  gint           x;
+  gint           y;
+
+  g_object_set (gegl_config (), "quality", 0.0, NULL);
+
+  output = render (buffer, "matrix(0.25,0,0,0,0.25,0,0,0,1)",
+                   GEGL_SAMPLER_LINEAR, &rect);
+
+  g_object_set (gegl_config (), "quality", 1.0, NULL);
+
+  expected = g_new0 (gfloat, 4 * rect.width * rect.height);
+
+  gegl_buffer_get (buffer, &rect, 0.25, babl_format (FORMAT), expected,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  /* only compare the pixels averaging full blocks of input pixels */
+  for (y = 0; y < HEIGHT / 4; y++)
+    {
+      for (x = 0; x < WIDTH / 4; x++)
+        {
+          gint i = 4 * ((y - rect.y) * rect.width + (x - rect.x));
+          gint c;
+
+          for (c = 0; c < 4; c++)
+            g_assert_cmpfloat (fabs (output[i + c] - expected[i + c]), <, 1e-5);
+        }
+    }
+
+  g_free (expected);
+  g_free (output);
+
+  g_object_unref (buffer);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gegl_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  ADD_TEST (orthogonal);
+  ADD_TEST (scale);
+  ADD_TEST (scale_mipmap);
+
+  return g_test_run ();
+}